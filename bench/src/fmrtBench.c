@@ -0,0 +1,863 @@
+/*******************************************************************************
+ * ---------------------------------------------------                         *
+ * C/C++ Fast Memory Resident Tables Library (libfmrt)                         *
+ * ---------------------------------------------------                         *
+ * Copyright 2022 Roberto Mameli                                               *
+ *                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");             *
+ * you may not use this file except in compliance with the License.            *
+ * You may obtain a copy of the License at                                     *
+ *                                                                             *
+ *     http://www.apache.org/licenses/LICENSE-2.0                              *
+ *                                                                             *
+ * Unless required by applicable law or agreed to in writing, software         *
+ * distributed under the License is distributed on an "AS IS" BASIS,           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.    *
+ * See the License for the specific language governing permissions and         *
+ * limitations under the License.                                              *
+ * --------------------------------------------------------------------------  *
+ *                                                                             *
+ * FILE:        fmrtBench.c                                                    *
+ * VERSION:     1.0.0                                                          *
+ * AUTHOR(S):   Roberto Mameli                                                 *
+ * PRODUCT:     Library libfmrt benchmarks                                     *
+ * DESCRIPTION: Non-interactive benchmark of the libfmrt library calls.        *
+ *              For each storage engine, key type, key distribution and table  *
+ *              size it measures fmrtCreate(), fmrtRead(), fmrtModify(),       *
+ *              fmrtCreateModify(), fmrtDelete(), fmrtImportTableCsv(),        *
+ *              fmrtExportTableCsv() and fmrtExportRangeCsv(), then it runs    *
+ *              two workloads based on the datasets bundled with the examples  *
+ *              (barcodes import/export and word count over the books).        *
+ *              Results (ops/s and p50/p99/p999 latency) are written in JSON   *
+ *              format. See ../README.txt for usage                            *
+ *                                                                             *
+ *******************************************************************************/
+
+
+/**********************
+ * Linux system files *
+ **********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+
+
+/*********************
+ * libfmrt header    *
+ *********************/
+#include "fmrt.h"
+#include "fmrtApi.h"
+
+
+/***************
+ * Definitions *
+ ***************/
+#define TABLEID                    1   /* Table used by the benchmarks                   */
+#define RELOADID                   2   /* Table used to reload exported data             */
+#define BENCHMAXELEM        ( (MAXFMRTELEM<UINT32_MAX) ? (unsigned long long) MAXFMRTELEM : UINT32_MAX )   /* Max table size (MAXFMRTELEM, sizes are 32 bit) */
+#define MAXSIZES                  16   /* Max number of table sizes in a single run       */
+#define KEYLEN                    32   /* Max length of string keys                       */
+#define CHARKEYS                  64   /* Char keys are printable, from '0' to 'o'        */
+#define TENANTLEN                  8   /* Length of the string component of composite keys */
+#define DESCRIPTIONLEN            48   /* Max length of the description field             */
+#define MAXLINE                  256   /* Max length of a line of the datasets            */
+#define NODESIZE                 256   /* Node size of the B+-tree engine                 */
+#define ZIPFTHETA               0.99   /* Skew of the Zipfian distribution                */
+#define RANGECALLS               100   /* Number of fmrtExportRangeCsv() calls per run    */
+#define RANGEFRACTION            100   /* Each range covers 1/RANGEFRACTION of the keys   */
+#define BASETIMESTAMP     1577836800   /* First timestamp key (2020-01-01 00:00:00 UTC)    */
+#define DEFAULTSIZES     "1000,10000"  /* Sizes used when -s is not specified             */
+#define DEFAULTWORDS          100000   /* Words counted when -w is not specified          */
+#define DEFAULTDATADIR "../examples/data"
+
+/* Key distributions */
+#define DISTSEQ                    0   /* Keys in ascending order                         */
+#define DISTRAND                   1   /* Keys in random order                            */
+#define DISTZIPF                   2   /* Hot keys (Zipfian) for reads and updates        */
+#define NUMDISTS                   3
+
+
+/********************
+ * Type Definitions *
+ ********************/
+/* Key types under test */
+typedef struct
+{
+    const char  *name;
+    fmrtType    type;
+} benchKeyType;
+
+/* Key value, only the members matching the key type are meaningful */
+typedef struct
+{
+    uint32_t    keyInt;
+    int32_t     keySigned;
+    double      keyDouble;
+    char        keyChar,
+                keyString[KEYLEN+1];
+    time_t      keyTimestamp;
+} benchKey;
+
+/* Zipfian generator (Gray et al., "Quickly generating billion-record synthetic databases") */
+typedef struct
+{
+    uint32_t    n;
+    double      theta,
+                alpha,
+                zetan,
+                eta;
+} benchZipf;
+
+
+/********************
+ * Global variables *
+ ********************/
+static const benchKeyType keyTypes[] =
+{
+    { "int",       FMRTINT       },
+    { "signed",    FMRTSIGNED    },
+    { "double",    FMRTDOUBLE    },
+    { "char",      FMRTCHAR      },
+    { "string",    FMRTSTRING    },
+    { "timestamp", FMRTTIMESTAMP },
+    { "composite", FMRTCOMPOSITE }
+};
+#define NUMKEYTYPES   (sizeof(keyTypes)/sizeof(keyTypes[0]))
+
+static const char   *distNames[NUMDISTS] = { "seq", "rand", "zipf" };
+static const char   *engineNames[] = { "avl", "btree", "hash" };
+
+static char         **words = NULL,         /* Sorted dictionary words, used for string keys */
+                    **descriptions = NULL;  /* Item descriptions, used for the string field  */
+static uint32_t     numWords = 0,
+                    numDescriptions = 0,
+                    wordReps = 1;           /* Keys generated from each dictionary word      */
+static uint64_t     rngState = 88172645463325252ULL;
+static FILE         *out;
+static int          numResults = 0;
+
+
+/**********************
+ * Internal functions *
+ **********************/
+
+
+/*****************************************
+ * Monotonic clock in nanoseconds        *
+ *****************************************/
+static uint64_t nowNs (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ( (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec );
+}
+
+
+/*****************************************
+ * Pseudo random numbers (xorshift64*)   *
+ *****************************************/
+static uint64_t nextRandom (void)
+{
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return (rngState * 2685821657736338717ULL);
+}
+
+static double nextUniform (void)
+{
+    return ( (nextRandom() >> 11) * (1.0/9007199254740992.0) );
+}
+
+
+/*****************************************
+ * Zipfian distribution over [0,n)       *
+ *****************************************/
+static void initZipf (benchZipf *z, uint32_t n, double theta)
+{
+    uint32_t    i;
+    double      zeta2;
+
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0/(1.0-theta);
+    for (i=1, z->zetan=0; i<=n; i++)
+        z->zetan += 1.0/pow((double)i,theta);
+    zeta2 = 1.0 + 1.0/pow(2.0,theta);
+    z->eta = (1.0-pow(2.0/n,1.0-theta)) / (1.0-zeta2/z->zetan);
+}
+
+static uint32_t nextZipf (benchZipf *z)
+{
+    double      u,uz;
+    uint32_t    rank;
+
+    if (z->n<2)
+        return (0);
+    u = nextUniform();
+    uz = u*z->zetan;
+    if (uz<1.0)
+        return (0);
+    if (uz<1.0+pow(0.5,z->theta))
+        return (1);
+    rank = (uint32_t) (z->n * pow(z->eta*u-z->eta+1.0, z->alpha));
+    return ( (rank<z->n) ? rank : z->n-1 );
+}
+
+
+/*****************************************
+ * Load the lines of a dataset file      *
+ *****************************************/
+static char **loadLines (const char *dir, const char *name, int column, uint32_t *num)
+{
+    FILE        *fptr;
+    char        filename[512],
+                line[MAXLINE+1],
+                *p, *q,
+                **lines = NULL;
+    uint32_t    size = 0;
+    int         c;
+
+    *num = 0;
+    snprintf (filename, sizeof(filename), "%s/%s", dir, name);
+    if ( (fptr=fopen(filename,"r")) == NULL )
+    {
+        fprintf (stderr, "Warning: dataset %s not found, using generated values\n", filename);
+        return (NULL);
+    }
+
+    while (fgets(line,MAXLINE,fptr))
+    {
+        /* Select the requested column (comma separated) and strip the newline */
+        for (p=line, c=0; (c<column)&&(p!=NULL); c++)
+            p = ((p=strchr(p,','))!=NULL) ? p+1 : NULL;
+        if (p==NULL)
+            continue;
+        for (q=p; (*q!='\0')&&(*q!=',')&&(*q!='\n')&&(*q!='\r'); q++);
+        *q = '\0';
+        if (*p=='\0')
+            continue;
+
+        if (*num==size)
+        {
+            size = (size) ? 2*size : 4096;
+            lines = (char **) realloc (lines, size*sizeof(char *));
+        }
+        lines[(*num)++] = strdup (p);
+    }
+    fclose (fptr);
+
+    return (lines);
+}
+
+static int compareWords (const void *a, const void *b)
+{
+    return ( strcmp (*(char * const *)a, *(char * const *)b) );
+}
+
+
+/*****************************************************
+ * Build the key of the given rank. Keys are strictly *
+ * increasing with the rank for every key type        *
+ *****************************************************/
+static void makeKey (fmrtType type, uint32_t rank, benchKey *key)
+{
+    switch (type)
+    {
+        case FMRTINT:
+            key->keyInt = rank;
+            break;
+        case FMRTSIGNED:
+            key->keySigned = (int32_t)rank - (1<<30);
+            break;
+        case FMRTDOUBLE:
+            key->keyDouble = rank*0.25 - 1000000.0;
+            break;
+        case FMRTCHAR:
+            key->keyChar = (char) ('0' + rank);
+            break;
+        case FMRTSTRING:
+        {   /* Dictionary words (each one repeated with a numeric suffix if there are not enough words) */
+            if (numWords==0)
+                snprintf (key->keyString, KEYLEN+1, "key%010u", rank);
+            else if (wordReps==1)
+                snprintf (key->keyString, KEYLEN+1, "%s", words[rank]);
+            else
+                snprintf (key->keyString, KEYLEN+1, "%s#%05u", words[rank/wordReps], rank%wordReps);
+            break;
+        }
+        case FMRTTIMESTAMP:
+            key->keyTimestamp = (time_t) BASETIMESTAMP + rank;
+            break;
+        case FMRTCOMPOSITE:
+        {   /* (tenant, sequence number) with 1024 sequence numbers per tenant */
+            snprintf (key->keyString, KEYLEN+1, "t%0*u", TENANTLEN-1, rank>>10);
+            key->keyInt = rank & 1023;
+            break;
+        }
+    }   /* switch (type) */
+}
+
+
+/*****************************************************
+ * Wrappers of the variadic library calls, one case  *
+ * for each key type                                 *
+ *****************************************************/
+static fmrtResult benchCreate (fmrtId id, fmrtType type, benchKey *k, uint32_t value, char *desc)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtCreate (id, k->keyInt, value, desc);
+        case FMRTSIGNED:    return fmrtCreate (id, k->keySigned, value, desc);
+        case FMRTDOUBLE:    return fmrtCreate (id, k->keyDouble, value, desc);
+        case FMRTCHAR:      return fmrtCreate (id, k->keyChar, value, desc);
+        case FMRTSTRING:    return fmrtCreate (id, k->keyString, value, desc);
+        case FMRTTIMESTAMP: return fmrtCreate (id, k->keyTimestamp, value, desc);
+        case FMRTCOMPOSITE: return fmrtCreate (id, k->keyString, k->keyInt, value, desc);
+    }
+    return (FMRTKO);
+}
+
+static fmrtResult benchRead (fmrtId id, fmrtType type, benchKey *k, uint32_t *value, char *desc)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtRead (id, k->keyInt, value, desc);
+        case FMRTSIGNED:    return fmrtRead (id, k->keySigned, value, desc);
+        case FMRTDOUBLE:    return fmrtRead (id, k->keyDouble, value, desc);
+        case FMRTCHAR:      return fmrtRead (id, k->keyChar, value, desc);
+        case FMRTSTRING:    return fmrtRead (id, k->keyString, value, desc);
+        case FMRTTIMESTAMP: return fmrtRead (id, k->keyTimestamp, value, desc);
+        case FMRTCOMPOSITE: return fmrtRead (id, k->keyString, k->keyInt, value, desc);
+    }
+    return (FMRTKO);
+}
+
+static fmrtResult benchModify (fmrtId id, fmrtType type, benchKey *k, uint32_t value, char *desc)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtModify (id, 1, k->keyInt, value, desc);
+        case FMRTSIGNED:    return fmrtModify (id, 1, k->keySigned, value, desc);
+        case FMRTDOUBLE:    return fmrtModify (id, 1, k->keyDouble, value, desc);
+        case FMRTCHAR:      return fmrtModify (id, 1, k->keyChar, value, desc);
+        case FMRTSTRING:    return fmrtModify (id, 1, k->keyString, value, desc);
+        case FMRTTIMESTAMP: return fmrtModify (id, 1, k->keyTimestamp, value, desc);
+        case FMRTCOMPOSITE: return fmrtModify (id, 1, k->keyString, k->keyInt, value, desc);
+    }
+    return (FMRTKO);
+}
+
+static fmrtResult benchCreateModify (fmrtId id, fmrtType type, benchKey *k, uint32_t value, char *desc)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtCreateModify (id, 3, k->keyInt, value, desc);
+        case FMRTSIGNED:    return fmrtCreateModify (id, 3, k->keySigned, value, desc);
+        case FMRTDOUBLE:    return fmrtCreateModify (id, 3, k->keyDouble, value, desc);
+        case FMRTCHAR:      return fmrtCreateModify (id, 3, k->keyChar, value, desc);
+        case FMRTSTRING:    return fmrtCreateModify (id, 3, k->keyString, value, desc);
+        case FMRTTIMESTAMP: return fmrtCreateModify (id, 3, k->keyTimestamp, value, desc);
+        case FMRTCOMPOSITE: return fmrtCreateModify (id, 3, k->keyString, k->keyInt, value, desc);
+    }
+    return (FMRTKO);
+}
+
+static fmrtResult benchDelete (fmrtId id, fmrtType type, benchKey *k)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtDelete (id, k->keyInt);
+        case FMRTSIGNED:    return fmrtDelete (id, k->keySigned);
+        case FMRTDOUBLE:    return fmrtDelete (id, k->keyDouble);
+        case FMRTCHAR:      return fmrtDelete (id, k->keyChar);
+        case FMRTSTRING:    return fmrtDelete (id, k->keyString);
+        case FMRTTIMESTAMP: return fmrtDelete (id, k->keyTimestamp);
+        case FMRTCOMPOSITE: return fmrtDelete (id, k->keyString, k->keyInt);
+    }
+    return (FMRTKO);
+}
+
+static fmrtResult benchExportRange (fmrtId id, fmrtType type, FILE *fptr, benchKey *min, benchKey *max)
+{
+    switch (type)
+    {
+        case FMRTINT:       return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyInt, max->keyInt);
+        case FMRTSIGNED:    return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keySigned, max->keySigned);
+        case FMRTDOUBLE:    return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyDouble, max->keyDouble);
+        case FMRTCHAR:      return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyChar, max->keyChar);
+        case FMRTSTRING:    return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyString, max->keyString);
+        case FMRTTIMESTAMP: return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyTimestamp, max->keyTimestamp);
+        case FMRTCOMPOSITE: return fmrtExportRangeCsv (id, fptr, ',', FMRTASCENDING, min->keyString, min->keyInt, max->keyString, max->keyInt);
+    }
+    return (FMRTKO);
+}
+
+
+/*****************************************************
+ * Define the table used by the benchmarks           *
+ *****************************************************/
+static fmrtResult defineBenchTable (fmrtId id, fmrtType type, uint8_t engine, uint32_t size)
+{
+    fmrtResult  res;
+
+    if ( (res=fmrtDefineTable(id,"Bench",size)) != FMRTOK )
+        return (res);
+    if (type==FMRTCOMPOSITE)
+        res = fmrtDefineCompositeKey (id, "Key", 2, "Tenant", FMRTSTRING, TENANTLEN, "Seq", FMRTINT);
+    else
+        res = fmrtDefineKey (id, "Key", type, KEYLEN);
+    if ( (res!=FMRTOK) ||
+         ((res=fmrtDefineFields(id,2,"Value",FMRTINT,"Description",FMRTSTRING,DESCRIPTIONLEN)) != FMRTOK) ||
+         ((engine!=FMRTENGINEAVL) && ((res=fmrtDefineEngine(id,engine,NODESIZE)) != FMRTOK)) )
+        fmrtClearTable (id);
+
+    return (res);
+}
+
+
+/*****************************************************
+ * Latency percentiles and JSON output               *
+ *****************************************************/
+static int compareLatency (const void *a, const void *b)
+{
+    uint32_t    x = *(const uint32_t *)a,
+                y = *(const uint32_t *)b;
+
+    return ( (x>y) - (x<y) );
+}
+
+static uint32_t percentile (uint32_t *sorted, uint32_t num, double p)
+{
+    uint64_t    pos = (uint64_t) ceil (p*num);
+
+    return ( sorted[(pos>0) ? pos-1 : 0] );
+}
+
+static void printResult (const char *op, const char *engine, const char *key, const char *dist, uint32_t size,
+                         uint32_t ops, uint32_t errors, uint64_t elapsedNs, uint32_t *latency)
+{
+    /* latency (if not NULL) holds the latency of each operation in ns, it is sorted here */
+    fprintf (out, "%s\n    { \"op\": \"%s\", \"engine\": \"%s\", \"key\": \"%s\", \"dist\": \"%s\", \"size\": %u, "
+             "\"ops\": %u, \"errors\": %u, \"elapsed_s\": %.6f, \"ops_per_sec\": %.1f",
+             (numResults++) ? "," : "", op, engine, key, dist, size, ops, errors,
+             elapsedNs/1e9, (elapsedNs) ? ops/(elapsedNs/1e9) : 0.0);
+    if ( (latency!=NULL) && (ops>0) )
+    {
+        qsort (latency, ops, sizeof(uint32_t), compareLatency);
+        fprintf (out, ", \"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u",
+                 percentile(latency,ops,0.5), percentile(latency,ops,0.99), percentile(latency,ops,0.999));
+    }
+    else
+        fprintf (out, ", \"p50_ns\": null, \"p99_ns\": null, \"p999_ns\": null");
+    fprintf (out, " }");
+    fflush (out);
+}
+
+
+/*****************************************************
+ * Run all the operations for a given engine, key    *
+ * type, key distribution and table size             *
+ *****************************************************/
+static void runBench (uint8_t engine, const benchKeyType *kt, uint8_t dist, uint32_t size, uint32_t *perm, uint32_t *latency)
+{
+    uint32_t    i, rank, value, errors, lines, ops;
+    uint64_t    start, t0, t1;
+    fmrtIndex   num;
+    char        desc[DESCRIPTIONLEN+1];
+    benchKey    key, keyMax;
+    benchZipf   zipf;
+    FILE        *fptr, *devNull;
+    const char  *en = engineNames[engine],
+                *dn = distNames[dist];
+
+    if (defineBenchTable(TABLEID,kt->type,engine,size) != FMRTOK)
+    {
+        fprintf (stderr, "Skipping %s/%s: not supported\n", en, kt->name);
+        return;
+    }
+    fprintf (stderr, "Running engine %s, key %s, distribution %s, size %u\n", en, kt->name, dn, size);
+
+    /* Random permutation of the ranks (also maps Zipfian ranks, so that hot keys are scattered) */
+    for (i=0; i<size; i++)
+        perm[i] = i;
+    for (i=size-1; i>0; i--)
+    {
+        rank = nextRandom() % (i+1);
+        value = perm[i]; perm[i] = perm[rank]; perm[rank] = value;
+    }
+    if (dist==DISTZIPF)
+        initZipf (&zipf, size, ZIPFTHETA);
+    wordReps = (numWords>0) ? (size+numWords-1)/numWords : 1;
+
+    /* fmrtCreate() - each key is inserted once (ascending for seq, random order otherwise) */
+    start = nowNs();
+    for (i=0, errors=0; i<size; i++)
+    {
+        makeKey (kt->type, (dist==DISTSEQ) ? i : perm[i], &key);
+        strcpy (desc, (numDescriptions) ? descriptions[i%numDescriptions] : "description");
+        t0 = nowNs();
+        if (benchCreate(TABLEID,kt->type,&key,i,desc) != FMRTOK)
+            errors++;
+        t1 = nowNs();
+        latency[i] = (uint32_t) (t1-t0);
+    }
+    printResult ("create", en, kt->name, dn, size, size, errors, nowNs()-start, latency);
+
+    /* fmrtRead(), fmrtModify(), fmrtCreateModify() - keys follow the selected distribution */
+    for (ops=0; ops<3; ops++)
+    {
+        start = nowNs();
+        for (i=0, errors=0; i<size; i++)
+        {
+            rank = (dist==DISTSEQ) ? i : (dist==DISTRAND) ? perm[i] : perm[nextZipf(&zipf)];
+            makeKey (kt->type, rank, &key);
+            t0 = nowNs();
+            switch (ops)
+            {
+                case 0:
+                    errors += (benchRead(TABLEID,kt->type,&key,&value,desc) != FMRTOK);
+                    break;
+                case 1:
+                    errors += (benchModify(TABLEID,kt->type,&key,i,desc) != FMRTOK);
+                    break;
+                case 2:
+                    errors += (benchCreateModify(TABLEID,kt->type,&key,i,desc) != FMRTOK);
+                    break;
+            }
+            t1 = nowNs();
+            latency[i] = (uint32_t) (t1-t0);
+        }
+        printResult ((ops==0) ? "read" : (ops==1) ? "modify" : "createModify", en, kt->name, dn, size, size, errors, nowNs()-start, latency);
+    }
+
+    /* fmrtExportTableCsv() in ascending order, and in optimized order into a temporary file to be reloaded */
+    devNull = fopen ("/dev/null", "w");
+    start = nowNs();
+    errors = (fmrtExportTableCsv(TABLEID,devNull,',',FMRTASCENDING) != FMRTOK);
+    printResult ("exportTable", en, kt->name, dn, size, size, errors, nowNs()-start, NULL);
+
+    fptr = tmpfile ();
+    start = nowNs();
+    errors = (fmrtExportTableCsv(TABLEID,fptr,',',FMRTOPTIMIZED) != FMRTOK);
+    printResult ("exportTableOptimized", en, kt->name, dn, size, size, errors, nowNs()-start, NULL);
+
+    /* fmrtExportRangeCsv() - RANGECALLS ranges, each covering 1/RANGEFRACTION of the keys */
+    for (i=0, errors=0, start=nowNs(); i<RANGECALLS; i++)
+    {
+        rank = (size>RANGEFRACTION) ? nextRandom() % (size-size/RANGEFRACTION) : 0;
+        makeKey (kt->type, rank, &key);
+        makeKey (kt->type, rank + ((size>RANGEFRACTION) ? size/RANGEFRACTION : size) - 1, &keyMax);
+        t0 = nowNs();
+        errors += (benchExportRange(TABLEID,kt->type,devNull,&key,&keyMax) != FMRTOK);
+        t1 = nowNs();
+        latency[i] = (uint32_t) (t1-t0);
+    }
+    printResult ("exportRange", en, kt->name, dn, size, RANGECALLS, errors, nowNs()-start, latency);
+    fclose (devNull);
+
+    /* fmrtImportTableCsv() - reload the optimized export into a new table */
+    errors = 1;
+    lines = 0;
+    if ( (fptr!=NULL) && (defineBenchTable(RELOADID,kt->type,engine,size)==FMRTOK) )
+    {
+        rewind (fptr);
+        start = nowNs();
+        errors = (fmrtImportTableCsv(RELOADID,fptr,',',&num) != FMRTOK);
+        t1 = nowNs();
+        lines = fmrtCountEntries (RELOADID);
+        errors += (lines!=size);
+        printResult ("import", en, kt->name, dn, size, lines, errors, t1-start, NULL);
+        fmrtClearTable (RELOADID);
+    }
+    if (fptr!=NULL)
+        fclose (fptr);
+
+    /* fmrtDelete() - each key is removed once */
+    start = nowNs();
+    for (i=0, errors=0; i<size; i++)
+    {
+        makeKey (kt->type, (dist==DISTSEQ) ? i : perm[size-1-i], &key);
+        t0 = nowNs();
+        errors += (benchDelete(TABLEID,kt->type,&key) != FMRTOK);
+        t1 = nowNs();
+        latency[i] = (uint32_t) (t1-t0);
+    }
+    printResult ("delete", en, kt->name, dn, size, size, errors, nowNs()-start, latency);
+
+    fmrtClearTable (TABLEID);
+}
+
+
+/*****************************************************
+ * Dataset workloads: barcodes import/export (as in  *
+ * BarCodeCache.c) and word count over the books (as *
+ * in CountWordsOccurrence.c)                        *
+ *****************************************************/
+static void runDatasets (const char *dir, uint8_t engine, uint32_t *latency, uint32_t maxOps)
+{
+    static const char *books[] =
+    {
+        "Alice_in_Wonderland_Lewis_Carroll.txt",
+        "Macbeth_William_Shakespeare.txt",
+        "Ivanhoe_Walter_Scott.txt",
+        "The_Notebooks_of_Leonardo_Da_Vinci.txt",
+        "Ulysses_James_Joyce.txt"
+    };
+    FILE        *fptr, *devNull;
+    char        filename[512],
+                line[MAXLINE+1],
+                *p, *q;
+    uint32_t    b, ops, errors, count;
+    uint64_t    start, t0, t1;
+    fmrtIndex   num;
+    const char  *en = engineNames[engine];
+
+    /* Barcodes: string key and two string fields */
+    snprintf (filename, sizeof(filename), "%s/largeDatasets/items_10K.csv", dir);
+    if ( (fptr=fopen(filename,"r")) != NULL )
+    {
+        if ( (fmrtDefineTable(TABLEID,"BarCodes",20000)==FMRTOK) &&
+             (fmrtDefineKey(TABLEID,"BarCode",FMRTSTRING,13)==FMRTOK) &&
+             (fmrtDefineFields(TABLEID,2,"Size/Format",FMRTSTRING,24,"Description",FMRTSTRING,DESCRIPTIONLEN)==FMRTOK) &&
+             ((engine==FMRTENGINEAVL) || (fmrtDefineEngine(TABLEID,engine,NODESIZE)==FMRTOK)) )
+        {
+            start = nowNs();
+            errors = (fmrtImportTableCsv(TABLEID,fptr,',',&num) != FMRTOK);
+            t1 = nowNs();
+            count = fmrtCountEntries (TABLEID);
+            printResult ("import", en, "string", "items_10K", count, count, errors, t1-start, NULL);
+
+            devNull = fopen ("/dev/null", "w");
+            start = nowNs();
+            errors = (fmrtExportTableCsv(TABLEID,devNull,',',FMRTASCENDING) != FMRTOK);
+            printResult ("exportTable", en, "string", "items_10K", count, count, errors, nowNs()-start, NULL);
+            fclose (devNull);
+        }
+        fmrtClearTable (TABLEID);
+        fclose (fptr);
+    }
+
+    /* Word count: natural (Zipf-like) distribution of the words in the books */
+    if ( (fmrtDefineTable(TABLEID,"WordCount",200000)!=FMRTOK) ||
+         (fmrtDefineKey(TABLEID,"Word",FMRTSTRING,KEYLEN)!=FMRTOK) ||
+         (fmrtDefineFields(TABLEID,1,"Frequency",FMRTINT)!=FMRTOK) ||
+         ((engine!=FMRTENGINEAVL) && (fmrtDefineEngine(TABLEID,engine,NODESIZE)!=FMRTOK)) )
+    {
+        fmrtClearTable (TABLEID);
+        return;
+    }
+    start = nowNs();
+    for (b=0, ops=0, errors=0; b<sizeof(books)/sizeof(books[0]); b++)
+    {
+        snprintf (filename, sizeof(filename), "%s/books/%s", dir, books[b]);
+        if ( (fptr=fopen(filename,"r")) == NULL )
+            continue;
+        while ( (ops<maxOps) && fgets(line,MAXLINE,fptr) )
+        {
+            p = line;
+            while ( (ops<maxOps) && (q=strtok(p," .,:;!?()'\"\n\r\t<>[]{}+-^*$%&")) )
+            {
+                p = NULL;
+                t0 = nowNs();
+                if (fmrtRead(TABLEID,q,&count)==FMRTOK)
+                    errors += (fmrtModify(TABLEID,1,q,count+1) != FMRTOK);
+                else
+                    errors += (fmrtCreate(TABLEID,q,1) != FMRTOK);
+                t1 = nowNs();
+                latency[ops++] = (uint32_t) (t1-t0);
+            }
+        }
+        fclose (fptr);
+    }
+    if (ops>0)
+        printResult ("wordCount", en, "string", "books", fmrtCountEntries(TABLEID), ops, errors, nowNs()-start, latency);
+    fmrtClearTable (TABLEID);
+}
+
+
+/*****************************************************
+ * Parse a comma separated list of names             *
+ *****************************************************/
+static int parseNames (char *list, const char **names, int num, uint8_t *selected)
+{
+    char    *p;
+    int     i;
+
+    memset (selected, 0, num);
+    for (p=strtok(list,","); p!=NULL; p=strtok(NULL,","))
+    {
+        for (i=0; (i<num)&&(strcmp(p,names[i])); i++);
+        if (i==num)
+        {
+            fprintf (stderr, "Unknown value: %s\n", p);
+            return (-1);
+        }
+        selected[i] = 1;
+    }
+    return (0);
+}
+
+static void usage (const char *prog)
+{
+    fprintf (stderr, "Usage: %s [-s sizes] [-k keys] [-d dists] [-e engines] [-D datadir] [-o file] [-r seed] [-w words] [-n]\n", prog);
+    fprintf (stderr, "  -s sizes    comma separated table sizes, up to %llu (default %s)\n", BENCHMAXELEM, DEFAULTSIZES);
+    fprintf (stderr, "  -k keys     int,signed,double,char,string,timestamp,composite (default all)\n");
+    fprintf (stderr, "  -d dists    seq,rand,zipf (default all)\n");
+    fprintf (stderr, "  -e engines  avl,btree,hash (default avl)\n");
+    fprintf (stderr, "  -D datadir  directory of the bundled datasets (default %s)\n", DEFAULTDATADIR);
+    fprintf (stderr, "  -o file     JSON output file (default stdout)\n");
+    fprintf (stderr, "  -r seed     seed of the pseudo random generator\n");
+    fprintf (stderr, "  -w words    max number of words counted over the books (default %u)\n", DEFAULTWORDS);
+    fprintf (stderr, "  -n          skip the dataset workloads\n");
+}
+
+
+/*****************
+ * Main Function *
+ *****************/
+int main(int argc, char *argv[])
+{
+    /* Local variables */
+    int         opt, s, numSizes = 0, datasets = 1;
+    char        sizesList[256] = DEFAULTSIZES,
+                *dataDir = DEFAULTDATADIR,
+                *outName = NULL,
+                *p;
+    const char  *keyNames[NUMKEYTYPES];
+    uint8_t     selKeys[NUMKEYTYPES],
+                selDists[NUMDISTS],
+                selEngines[3] = {1,0,0},
+                e, d;
+    uint32_t    sizes[MAXSIZES],
+                size, maxSize = 0, k,
+                maxWords = DEFAULTWORDS,
+                *perm, *latency;
+    unsigned long long value;
+    time_t      now;
+
+    for (k=0; k<NUMKEYTYPES; k++)
+    {
+        keyNames[k] = keyTypes[k].name;
+        selKeys[k] = 1;
+    }
+    memset (selDists, 1, sizeof(selDists));
+
+    while ( (opt=getopt(argc,argv,"s:k:d:e:D:o:r:w:nh")) != -1 )
+    {
+        switch (opt)
+        {
+            case 's':
+                snprintf (sizesList, sizeof(sizesList), "%s", optarg);
+                break;
+            case 'k':
+                if (parseNames(optarg,keyNames,NUMKEYTYPES,selKeys)) return (1);
+                break;
+            case 'd':
+                if (parseNames(optarg,distNames,NUMDISTS,selDists)) return (1);
+                break;
+            case 'e':
+                if (parseNames(optarg,engineNames,3,selEngines)) return (1);
+                break;
+            case 'D':
+                dataDir = optarg;
+                break;
+            case 'o':
+                outName = optarg;
+                break;
+            case 'r':
+                rngState = strtoull (optarg, NULL, 0) | 1;
+                break;
+            case 'w':
+                maxWords = (uint32_t) strtoul (optarg, NULL, 10);
+                break;
+            case 'n':
+                datasets = 0;
+                break;
+            default:
+                usage (argv[0]);
+                return (1);
+        }
+    }
+
+    /* Table sizes */
+    for (p=strtok(sizesList,","); (p!=NULL)&&(numSizes<MAXSIZES); p=strtok(NULL,","))
+    {
+        value = strtoull (p, NULL, 10);
+        if ( (value<1) || (value>BENCHMAXELEM) )
+        {
+            fprintf (stderr, "Invalid size %s (allowed 1-%llu)\n", p, BENCHMAXELEM);
+            return (1);
+        }
+        size = (uint32_t) value;
+        sizes[numSizes++] = size;
+        maxSize = (size>maxSize) ? size : maxSize;
+    }
+    if (maxSize<RANGECALLS)
+        maxSize = RANGECALLS;
+    /* One latency sample for each word counted over the books */
+    if ( (datasets) && (maxSize<maxWords) )
+        maxSize = maxWords;
+
+    perm = (uint32_t *) malloc (maxSize*sizeof(uint32_t));
+    latency = (uint32_t *) malloc (maxSize*sizeof(uint32_t));
+    if ( (perm==NULL) || (latency==NULL) )
+    {
+        fprintf (stderr, "Not enough memory\n");
+        return (1);
+    }
+
+    out = stdout;
+    if ( (outName!=NULL) && ((out=fopen(outName,"w"))==NULL) )
+    {
+        fprintf (stderr, "Not able to open %s\n", outName);
+        return (1);
+    }
+
+    /* Realistic inputs: dictionary words for string keys, item descriptions for the string field */
+    words = loadLines (dataDir, "dict/words.italian.txt", 0, &numWords);
+    if (numWords>0)
+    {   /* Keys shall be unique and increasing with their rank */
+        qsort (words, numWords, sizeof(char *), compareWords);
+        for (k=1, s=1; k<numWords; k++)
+            if ( (strcmp(words[k],words[s-1])) && (strlen(words[k])<=KEYLEN-6) )
+                words[s++] = words[k];
+        numWords = s;
+    }
+    descriptions = loadLines (dataDir, "largeDatasets/items_10K.csv", 2, &numDescriptions);
+
+    /* Timestamps are exported and imported in raw format */
+    fmrtDefineTimeFormat ("");
+
+    time (&now);
+    fprintf (out, "{\n  \"benchmark\": \"fmrtBench\",\n  \"timestamp\": %ld,\n  \"results\": [", (long)now);
+    for (e=0; e<3; e++)
+    {
+        if (!selEngines[e])
+            continue;
+        for (s=0; s<numSizes; s++)
+            for (k=0; k<NUMKEYTYPES; k++)
+                for (d=0; d<NUMDISTS; d++)
+                {
+                    if ( (!selKeys[k]) || (!selDists[d]) )
+                        continue;
+                    /* FMRTCHAR keys have only CHARKEYS distinct values */
+                    size = ( (keyTypes[k].type==FMRTCHAR) && (sizes[s]>CHARKEYS) ) ? CHARKEYS : sizes[s];
+                    runBench (e, &keyTypes[k], d, size, perm, latency);
+                }
+        if (datasets)
+            runDatasets (dataDir, e, latency, maxWords);
+    }
+    fprintf (out, "\n  ]\n}\n");
+
+    if (out!=stdout)
+        fclose (out);
+    free (perm);
+    free (latency);
+    exit(0);
+}
@@ -0,0 +1,423 @@
+/*******************************************************************************
+ * ---------------------------------------------------                         *
+ * C/C++ Fast Memory Resident Tables Library (libfmrt)                         *
+ * ---------------------------------------------------                         *
+ * Copyright 2022 Roberto Mameli                                               *
+ *                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");             *
+ * you may not use this file except in compliance with the License.            *
+ * You may obtain a copy of the License at                                     *
+ *                                                                             *
+ *     http://www.apache.org/licenses/LICENSE-2.0                              *
+ *                                                                             *
+ * Unless required by applicable law or agreed to in writing, software         *
+ * distributed under the License is distributed on an "AS IS" BASIS,           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.    *
+ * See the License for the specific language governing permissions and         *
+ * limitations under the License.                                              *
+ * --------------------------------------------------------------------------  *
+ *                                                                             *
+ * FILE:        fmrtBenchMT.c                                                  *
+ * VERSION:     1.0.0                                                          *
+ * AUTHOR(S):   Roberto Mameli                                                 *
+ * PRODUCT:     Library libfmrt benchmarks                                     *
+ * DESCRIPTION: Non-interactive multi-threaded scaling benchmark, modeled on   *
+ *              the Televoting.c example. Several threads read (fmrtRead())   *
+ *              and update (fmrtModify()) preloaded tables for a fixed time;   *
+ *              the number of threads, the read/write mix and the number of    *
+ *              tables are swept, and throughput, per-thread fairness and lock *
+ *              wait time are written in JSON format. See ../README.txt        *
+ *                                                                             *
+ *******************************************************************************/
+
+
+/**********************
+ * Linux system files *
+ **********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+
+/*********************
+ * libfmrt header    *
+ *********************/
+#include "fmrt.h"
+
+
+/***************
+ * Definitions *
+ ***************/
+#define MAXNUMTHREADS            256   /* Max number of concurrent threads                */
+#define MAXNUMTABLES              16   /* Max number of tables in a single configuration  */
+#define MAXLIST                   16   /* Max number of values in -T, -m and -x lists     */
+#define MAXSAMPLES             65536   /* Latency samples kept by each thread (power of 2) */
+#define NODESIZE                 256   /* Node size of the B+-tree engine                 */
+#define DEFAULTKEYS            10000   /* Keys preloaded in each table                    */
+#define DEFAULTDURATION          1.0   /* Duration of each run (seconds)                  */
+#define DEFAULTMIXES   "100,95,50,0"   /* Percentage of reads in each run                 */
+#define DEFAULTTABLES          "1,4"   /* Number of tables in each run                    */
+
+
+/********************
+ * Type Definitions *
+ ********************/
+/* Per-thread parameters and results */
+typedef struct
+{
+    pthread_t   tid;
+    fmrtId      tableId;
+    uint32_t    numKeys,
+                readPct,
+                errors,
+                samples[MAXSAMPLES];
+    uint64_t    rngState,
+                ops,
+                busyNs;             /* Time spent inside the library calls */
+} benchThread;
+
+
+/********************
+ * Global variables *
+ ********************/
+static volatile int     startFlag = 0,
+                        stopFlag = 0;
+static benchThread      threads[MAXNUMTHREADS];
+static const char       *engineNames[] = { "avl", "btree", "hash" };
+static int              numResults = 0;
+
+
+/**********************
+ * Internal functions *
+ **********************/
+
+
+/*****************************************
+ * Monotonic clock in nanoseconds        *
+ *****************************************/
+static uint64_t nowNs (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ( (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec );
+}
+
+
+/*****************************************
+ * Pseudo random numbers (xorshift64*)   *
+ *****************************************/
+static uint64_t nextRandom (uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (*state * 2685821657736338717ULL);
+}
+
+
+/*****************************************
+ * Parse a comma separated list of       *
+ * numbers                               *
+ *****************************************/
+static int parseList (char *list, uint32_t *values, uint32_t min, uint32_t max)
+{
+    char    *p;
+    int     num = 0;
+
+    for (p=strtok(list,","); (p!=NULL)&&(num<MAXLIST); p=strtok(NULL,","))
+    {
+        values[num] = (uint32_t) strtoul (p, NULL, 10);
+        if ( (values[num]<min) || (values[num]>max) )
+        {
+            fprintf (stderr, "Invalid value %s (allowed %u-%u)\n", p, min, max);
+            return (-1);
+        }
+        num++;
+    }
+    return (num);
+}
+
+
+/*****************************************************
+ * Thread body: random reads and updates of the keys *
+ * of its table until the run is stopped             *
+ *****************************************************/
+static void *benchThreadBody (void *arg)
+{
+    /* Local variables */
+    benchThread     *t = (benchThread *)arg;
+    uint32_t        key, value, latency;
+    uint64_t        r, t0, t1;
+    fmrtResult      res;
+
+    while (!startFlag);
+
+    while (!stopFlag)
+    {
+        r = nextRandom (&t->rngState);
+        key = (uint32_t) (r >> 32) % t->numKeys;
+        t0 = nowNs();
+        if ( (uint32_t)(r % 100) < t->readPct )
+            res = fmrtRead (t->tableId, key, &value);
+        else
+            res = fmrtModify (t->tableId, 1, key, (uint32_t)t->ops);
+        t1 = nowNs();
+        latency = (uint32_t) (t1-t0);
+        t->errors += (res!=FMRTOK);
+        t->busyNs += latency;
+        t->samples[t->ops & (MAXSAMPLES-1)] = latency;
+        t->ops++;
+    }
+
+    return (NULL);
+}
+
+
+/*****************************************************
+ * Define and preload the tables                     *
+ *****************************************************/
+static int loadTables (uint32_t numTables, uint32_t numKeys, uint8_t engine)
+{
+    fmrtId      id;
+    uint32_t    k;
+
+    for (id=1; id<=numTables; id++)
+    {
+        if ( (fmrtDefineTable(id,"BenchMT",numKeys)!=FMRTOK) ||
+             (fmrtDefineKey(id,"Key",FMRTINT,0)!=FMRTOK) ||
+             (fmrtDefineFields(id,1,"Value",FMRTINT)!=FMRTOK) ||
+             ((engine!=FMRTENGINEAVL) && (fmrtDefineEngine(id,engine,NODESIZE)!=FMRTOK)) )
+            return (-1);
+        for (k=0; k<numKeys; k++)
+            if (fmrtCreate(id,k,k)!=FMRTOK)
+                return (-1);
+    }
+    return (0);
+}
+
+static int compareLatency (const void *a, const void *b)
+{
+    uint32_t    x = *(const uint32_t *)a,
+                y = *(const uint32_t *)b;
+
+    return ( (x>y) - (x<y) );
+}
+
+
+/*****************************************************
+ * Run a configuration and print its results. The    *
+ * mean latency of the single thread run with the    *
+ * same mix (baseNs) is used to estimate lock wait   *
+ *****************************************************/
+static double runConfig (FILE *out, uint8_t engine, uint32_t numTables, uint32_t numThreads, uint32_t readPct,
+                         uint32_t numKeys, double duration, double baseNs, uint32_t *all)
+{
+    /* Local variables */
+    uint32_t    i, n, numSamples, errors = 0;
+    uint64_t    start, elapsed, ops = 0, busy = 0, minOps = UINT64_MAX, maxOps = 0;
+    double      sum = 0, sumSq = 0, fairness, meanNs, waitS;
+    struct timespec pause;
+
+    for (i=0; i<numThreads; i++)
+    {
+        memset (&threads[i], 0, sizeof(benchThread));
+        threads[i].tableId = (fmrtId) (1 + i%numTables);
+        threads[i].numKeys = numKeys;
+        threads[i].readPct = readPct;
+        threads[i].rngState = 0x9E3779B97F4A7C15ULL * (i+1);
+    }
+
+    startFlag = 0;
+    stopFlag = 0;
+    for (i=0; i<numThreads; i++)
+        pthread_create (&threads[i].tid, NULL, &benchThreadBody, (void *)&threads[i]);
+    start = nowNs();
+    startFlag = 1;
+    pause.tv_sec = (time_t) duration;
+    pause.tv_nsec = (long) ((duration-(double)pause.tv_sec)*1e9);
+    nanosleep (&pause, NULL);
+    stopFlag = 1;
+    for (i=0; i<numThreads; i++)
+        pthread_join (threads[i].tid, NULL);
+    elapsed = nowNs()-start;
+
+    /* Aggregate per-thread results */
+    for (i=0, numSamples=0; i<numThreads; i++)
+    {
+        ops += threads[i].ops;
+        busy += threads[i].busyNs;
+        errors += threads[i].errors;
+        minOps = (threads[i].ops<minOps) ? threads[i].ops : minOps;
+        maxOps = (threads[i].ops>maxOps) ? threads[i].ops : maxOps;
+        sum += (double)threads[i].ops;
+        sumSq += (double)threads[i].ops*(double)threads[i].ops;
+        n = (threads[i].ops<MAXSAMPLES) ? (uint32_t)threads[i].ops : MAXSAMPLES;
+        memcpy (all+numSamples, threads[i].samples, n*sizeof(uint32_t));
+        numSamples += n;
+    }
+    qsort (all, numSamples, sizeof(uint32_t), compareLatency);
+
+    /* Jain's fairness index: 1 when all threads complete the same number of operations */
+    fairness = (sumSq>0) ? (sum*sum)/(numThreads*sumSq) : 0.0;
+    meanNs = (ops) ? (double)busy/ops : 0.0;
+    /* Time spent in the library calls in excess of the single thread latency (never negative) */
+    waitS = ( (baseNs>0) && (meanNs>baseNs) ) ? (meanNs-baseNs)*ops/1e9 : 0.0;
+
+    fprintf (out, "%s\n    { \"engine\": \"%s\", \"tables\": %u, \"threads\": %u, \"read_pct\": %u, \"keys\": %u, "
+             "\"ops\": %llu, \"errors\": %u, \"elapsed_s\": %.6f, \"ops_per_sec\": %.1f, "
+             "\"fairness\": %.4f, \"min_thread_ops\": %llu, \"max_thread_ops\": %llu, "
+             "\"mean_ns\": %.1f, \"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u, "
+             "\"lock_wait_s\": %.6f, \"lock_wait_pct\": %.2f }",
+             (numResults++) ? "," : "", engineNames[engine], numTables, numThreads, readPct, numKeys,
+             (unsigned long long)ops, errors, elapsed/1e9, ops/(elapsed/1e9),
+             fairness, (unsigned long long)minOps, (unsigned long long)maxOps, meanNs,
+             (numSamples) ? all[numSamples/2] : 0,
+             (numSamples) ? all[(uint32_t)(numSamples*0.99)] : 0,
+             (numSamples) ? all[(uint32_t)(numSamples*0.999)] : 0,
+             waitS, (busy) ? 100.0*waitS*1e9/busy : 0.0);
+    fflush (out);
+
+    return (meanNs);
+}
+
+static void usage (const char *prog)
+{
+    fprintf (stderr, "Usage: %s [-T threads] [-x mixes] [-m tables] [-k keys] [-t seconds] [-e engine] [-o file]\n", prog);
+    fprintf (stderr, "  -T threads  comma separated thread counts (default 1,2,4,... up to the number of CPUs)\n");
+    fprintf (stderr, "  -x mixes    comma separated percentages of reads (default %s)\n", DEFAULTMIXES);
+    fprintf (stderr, "  -m tables   comma separated numbers of tables, up to %d (default %s)\n", MAXNUMTABLES, DEFAULTTABLES);
+    fprintf (stderr, "  -k keys     keys preloaded in each table (default %d)\n", DEFAULTKEYS);
+    fprintf (stderr, "  -t seconds  duration of each run (default %.1f)\n", DEFAULTDURATION);
+    fprintf (stderr, "  -e engine   avl, btree or hash (default avl)\n");
+    fprintf (stderr, "  -o file     JSON output file (default stdout)\n");
+}
+
+
+/*****************
+ * Main Function *
+ *****************/
+int main(int argc, char *argv[])
+{
+    /* Local variables */
+    int         opt, numThreadCounts = 0, numMixes, numTableCounts, t, x, m;
+    char        mixList[64] = DEFAULTMIXES,
+                tableList[64] = DEFAULTTABLES,
+                *outName = NULL;
+    uint32_t    threadCounts[MAXLIST],
+                mixes[MAXLIST],
+                tableCounts[MAXLIST],
+                numKeys = DEFAULTKEYS,
+                cpus, n, *all;
+    uint8_t     engine = FMRTENGINEAVL;
+    double      duration = DEFAULTDURATION,
+                baseNs, meanNs;
+    FILE        *out = stdout;
+    time_t      now;
+
+    while ( (opt=getopt(argc,argv,"T:x:m:k:t:e:o:h")) != -1 )
+    {
+        switch (opt)
+        {
+            case 'T':
+                if ( (numThreadCounts=parseList(optarg,threadCounts,1,MAXNUMTHREADS)) <= 0 ) return (1);
+                break;
+            case 'x':
+                snprintf (mixList, sizeof(mixList), "%s", optarg);
+                break;
+            case 'm':
+                snprintf (tableList, sizeof(tableList), "%s", optarg);
+                break;
+            case 'k':
+                numKeys = (uint32_t) strtoul (optarg, NULL, 10);
+                break;
+            case 't':
+                duration = atof (optarg);
+                break;
+            case 'e':
+                for (engine=0; (engine<3)&&(strcmp(optarg,engineNames[engine])); engine++);
+                if (engine==3)
+                {
+                    usage (argv[0]);
+                    return (1);
+                }
+                break;
+            case 'o':
+                outName = optarg;
+                break;
+            default:
+                usage (argv[0]);
+                return (1);
+        }
+    }
+    if ( ((numMixes=parseList(mixList,mixes,0,100)) <= 0) ||
+         ((numTableCounts=parseList(tableList,tableCounts,1,MAXNUMTABLES)) <= 0) ||
+         (numKeys<1) || (duration<=0) )
+    {
+        usage (argv[0]);
+        return (1);
+    }
+
+    /* Default thread sweep: powers of 2 up to the number of CPUs, plus the number of CPUs */
+    if (numThreadCounts==0)
+    {
+        cpus = (uint32_t) sysconf (_SC_NPROCESSORS_ONLN);
+        cpus = (cpus<1) ? 1 : (cpus>MAXNUMTHREADS) ? MAXNUMTHREADS : cpus;
+        for (n=1; (n<cpus)&&(numThreadCounts<MAXLIST-1); n*=2)
+            threadCounts[numThreadCounts++] = n;
+        threadCounts[numThreadCounts++] = cpus;
+    }
+    else if (threadCounts[0]!=1)
+    {   /* The single thread run is always the first one, since it is the reference for lock wait */
+        memmove (threadCounts+1, threadCounts, (numThreadCounts-(numThreadCounts==MAXLIST))*sizeof(uint32_t));
+        threadCounts[0] = 1;
+        numThreadCounts += (numThreadCounts<MAXLIST);
+    }
+
+    if ( (all=(uint32_t *)malloc(MAXNUMTHREADS*MAXSAMPLES*sizeof(uint32_t))) == NULL )
+    {
+        fprintf (stderr, "Not enough memory\n");
+        return (1);
+    }
+    if ( (outName!=NULL) && ((out=fopen(outName,"w"))==NULL) )
+    {
+        fprintf (stderr, "Not able to open %s\n", outName);
+        return (1);
+    }
+
+    time (&now);
+    fprintf (out, "{\n  \"benchmark\": \"fmrtBenchMT\",\n  \"timestamp\": %ld,\n  \"cpus\": %ld,\n  \"results\": [",
+             (long)now, sysconf(_SC_NPROCESSORS_ONLN));
+    for (m=0; m<numTableCounts; m++)
+    {
+        fprintf (stderr, "Loading %u table(s) with %u keys\n", tableCounts[m], numKeys);
+        if (loadTables(tableCounts[m],numKeys,engine))
+        {
+            fprintf (stderr, "Not able to load the tables\n");
+            return (1);
+        }
+        for (x=0; x<numMixes; x++)
+        {
+            /* Single thread latency of the mix, used as reference for lock wait estimates */
+            for (t=0, baseNs=0; t<numThreadCounts; t++)
+            {
+                fprintf (stderr, "Running %u table(s), %u thread(s), %u%% reads\n", tableCounts[m], threadCounts[t], mixes[x]);
+                meanNs = runConfig (out, engine, tableCounts[m], threadCounts[t], mixes[x], numKeys, duration, baseNs, all);
+                if (threadCounts[t]==1)
+                    baseNs = meanNs;
+            }
+        }
+        for (n=1; n<=tableCounts[m]; n++)
+            fmrtClearTable ((fmrtId)n);
+    }
+    fprintf (out, "\n  ]\n}\n");
+
+    if (out!=stdout)
+        fclose (out);
+    free (all);
+    exit(0);
+}
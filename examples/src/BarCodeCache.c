@@ -64,7 +64,7 @@
 /***************
  * Definitions *
  ***************/
-#define TABLEID                    1   /* Arbitrary value between 0 and 255 */
+#define TABLEID                    1   /* Arbitrary value between 0 and 65535 */
 #define BARCODELEN                13   /* Barcode Fixed Length              */
 #define SIZEFORMATLEN             24   /* Max Size of the Size/Format Field */
 #define DESCRIPTIONLEN            48   /* Max Size of the Description Field */
@@ -207,7 +207,8 @@ void waitEnterKey (void)
 int main(int argc, char *argv[], char *envp[])
 {
     /* Local variables */
-    int         choice,num;
+    int         choice;
+    fmrtIndex   num;
     fmrtResult  res;
     char        filename[128],
                 Key[128],
@@ -253,11 +254,11 @@ int main(int argc, char *argv[], char *envp[])
                 time (&start);  /* evaluate start time */
                 res=fmrtImportTableCsv(TABLEID,fptr,',',&num);
                 time (&end);    /* evaluate end time*/
-                printf ("Finished reading input CSV file... %d lines read in %d seconds\n\n",num,(int)difftime(end,start));
+                printf ("Finished reading input CSV file... %llu lines read in %d seconds\n\n",(unsigned long long)num,(int)difftime(end,start));
                 if (fptr!=NULL)
                     fclose (fptr);
                 printFmrtLibError (res);
-                printf ("Read %d lines from input file\n",num);
+                printf ("Read %llu lines from input file\n",(unsigned long long)num);
                 waitEnterKey();
                 break;
             }   /* case 1 */
@@ -301,7 +302,7 @@ int main(int argc, char *argv[], char *envp[])
             {   /* Count Barcodes */
                 system ("clear");
                 num = fmrtCountEntries(TABLEID);
-                printf ("The table contains %d items\n",num);
+                printf ("The table contains %llu items\n",(unsigned long long)num);
                 waitEnterKey();
                 break;
             }   /* case 5 */
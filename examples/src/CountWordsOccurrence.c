@@ -64,7 +64,7 @@
 /***************
  * Definitions *
  ***************/
-#define TABLEID         4   /* Arbitrary value between 0 and 255 */
+#define TABLEID         4   /* Arbitrary value between 0 and 65535 */
 #define LENGTH         32   /* Max length of a word              */
 #define MAXWORDS   120000   /* Max number of words               */
 #define MAXLINE       256   /* Max length of a single line       */
@@ -201,7 +201,8 @@ void waitEnterKey (void)
 int main(int argc, char *argv[], char *envp[])
 {
     /* Local variables */
-    int         choice,num;
+    int         choice;
+    fmrtIndex   num;
     fmrtResult  res;
     char        filename[128],
                 Key[LENGTH+1];
@@ -293,7 +294,7 @@ int main(int argc, char *argv[], char *envp[])
             {   /* Count distinct words */
                 system ("clear");
                 num = fmrtCountEntries(TABLEID);
-                printf ("The table contains %d distinct words\n",num);
+                printf ("The table contains %llu distinct words\n",(unsigned long long)num);
                 waitEnterKey();
                 break;
             }   /* case 3 */
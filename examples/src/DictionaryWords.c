@@ -64,7 +64,7 @@
 /***************
  * Definitions *
  ***************/
-#define TABLEID         4   /* Arbitrary value between 0 and 255 */
+#define TABLEID         4   /* Arbitrary value between 0 and 65535 */
 #define LENGTH         32   /* Max length of dictionary word     */
 #define MAXWORDS    80000   /* Max number of words               */
 
@@ -201,7 +201,8 @@ void waitEnterKey (void)
 int main(int argc, char *argv[], char *envp[])
 {
     /* Local variables */
-    int         choice,num;
+    int         choice;
+    fmrtIndex   num;
     fmrtResult  res;
     char        filename[128],
                 Key[LENGTH+1];
@@ -238,11 +239,11 @@ int main(int argc, char *argv[], char *envp[])
                 time (&start);  /* evaluate start time */
                 res=fmrtImportTableCsv(TABLEID,fptr,',',&num);
                 time (&end);    /* evaluate end time*/
-                printf ("Finished reading txt file... %d lines read in %d seconds\n\n",num,(int)difftime(end,start));
+                printf ("Finished reading txt file... %llu lines read in %d seconds\n\n",(unsigned long long)num,(int)difftime(end,start));
                 if (fptr!=NULL)
                     fclose (fptr);
                 printFmrtLibError (res);
-                printf ("Read %d lines from input file\n",num);
+                printf ("Read %llu lines from input file\n",(unsigned long long)num);
                 waitEnterKey();
                 break;
             }   /* case 1 */
@@ -282,7 +283,7 @@ int main(int argc, char *argv[], char *envp[])
             {   /* Count words */
                 system ("clear");
                 num = fmrtCountEntries(TABLEID);
-                printf ("The table contains %d entries\n",num);
+                printf ("The table contains %llu entries\n",(unsigned long long)num);
                 waitEnterKey();
                 break;
             }   /* case 5 */
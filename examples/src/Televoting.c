@@ -65,8 +65,8 @@
 /***************
  * Definitions *
  ***************/
-#define VOTESTABLEID           4   /* Arbitrary value between 0 and 255               */
-#define EVENTSTABLEID         12   /* Arbitrary value between 0 and 255               */
+#define VOTESTABLEID           4   /* Arbitrary value between 0 and 65535             */
+#define EVENTSTABLEID         12   /* Arbitrary value between 0 and 65535             */
 #define PHONENOLEN            15   /* Max length in DB of a phone number              */
 #define MAXPHONENUMBERS  1000000   /* Size of Votes Table (observe that we have one   *
                                       million numbers, ie. trail digits 000000-999999)*/
@@ -380,12 +380,12 @@ int main(int argc, char *argv[], char *envp[])
                 printf ("Table Votes:\n");
                 printf ("\tTable Id:         %d\n",VOTESTABLEID);
                 printf ("\tTable Size:       %d\n",MAXPHONENUMBERS);
-                printf ("\tNumber of Votes:  %d\n",fmrtCountEntries(VOTESTABLEID));
+                printf ("\tNumber of Votes:  %llu\n",(unsigned long long)fmrtCountEntries(VOTESTABLEID));
                 printf ("\tMemory Size (KB): %.2f\n\n",fmrtGetMemoryFootPrint(VOTESTABLEID)/1024.0);
                 printf ("Table LoggedEvents:\n");
                 printf ("\tTable Id:         %d\n",EVENTSTABLEID);
                 printf ("\tTable Size:       %d\n",EVENTSNUMBERS);
-                printf ("\tNumber of Events: %d\n",fmrtCountEntries(EVENTSTABLEID));
+                printf ("\tNumber of Events: %llu\n",(unsigned long long)fmrtCountEntries(EVENTSTABLEID));
                 printf ("\tMemory Size (KB): %.2f\n\n",fmrtGetMemoryFootPrint(EVENTSTABLEID)/1024.0);
                 waitEnterKey();
                 break;
@@ -56,15 +56,90 @@ extern "C" {
 #define FMRTCHAR                 3    /* FMRT Char Type (8 bits)               */
 #define FMRTSTRING               4    /* FMRT String Type (max len 256 chars)  */
 #define FMRTTIMESTAMP            5    /* FMRT Time Stamp (i.e. time_t type)    */
+#define FMRTCOMPOSITE            6    /* FMRT Composite Key (keys only)        */
 
 /* Constant used to indicate the null fmrtIndex pointer */
+#ifdef FMRTINDEX64
+#define FMRTNULLPTR     0xFFFFFFFFFFFFFFFFULL   /* Constant used to identify NULL ptr */
+#else
 #define FMRTNULLPTR     0xFFFFFFFF    /* Constant used to identify NULL ptr    */
+#endif
 
 /* Constant used to specify selected ordering of CSV exports */
 #define FMRTASCENDING            0    /* Export data in ascending order        */
 #define FMRTDESCENDING           1    /* Export data in descending order       */
 #define FMRTOPTIMIZED            2    /* Export data to optimize data reload   */
 
+/* Constants used to specify the memory layout of table elements */
+#define FMRTLAYOUTUNIFIED        0    /* Links, key and fields in one block    */
+#define FMRTLAYOUTSPLIT          1    /* Fields apart from links and key       */
+#define FMRTLAYOUTPADDED         2    /* Element size padded to cache lines    */
+
+/* Constants used to specify the storage engine of a table */
+#define FMRTENGINEAVL            0    /* AVL tree, one element per node        */
+#define FMRTENGINEBTREE          1    /* B+-tree indexing the elements         */
+#define FMRTENGINEHASH           2    /* Hash index, no ordered access         */
+
+/* Constants used to specify the kind of secondary indexes */
+#define FMRTINDEXNONUNIQUE       0    /* Several entries may share a value     */
+#define FMRTINDEXUNIQUE          1    /* Values cannot be duplicated           */
+
+/* Operation classes of the latency histograms provided by fmrtGetStats() */
+#define FMRTSTATREAD             0    /* fmrtRead()                            */
+#define FMRTSTATCREATE           1    /* fmrtCreate(), new fmrtCreateModify()  */
+#define FMRTSTATMODIFY           2    /* fmrtModify(), fmrtCreateModify()      */
+#define FMRTSTATDELETE           3    /* fmrtDelete()                          */
+#define FMRTSTATIMPORT           4    /* fmrtImportTableCsv()                  */
+#define FMRTSTATEXPORT           5    /* fmrtExportTableCsv/RangeCsv()         */
+#define FMRTSTATCLASSES          6    /* Number of operation classes           */
+#define FMRTSTATBUCKETS         32    /* Bucket b counts [2^b,2^(b+1)) ns      */
+
+/* Library calls acquiring the locks instrumented by fmrtEnableLockStats() */
+#define FMRTCALLDEFINETABLE      0    /* fmrtDefineTable()                     */
+#define FMRTCALLCLEARTABLE       1    /* fmrtClearTable()                      */
+#define FMRTCALLDEFINEKEY        2    /* fmrtDefineKey()                       */
+#define FMRTCALLDEFINECOMPOSITEKEY 3    /* fmrtDefineCompositeKey()            */
+#define FMRTCALLDEFINEFIELDS     4    /* fmrtDefineFields()                    */
+#define FMRTCALLREAD             5    /* fmrtRead()                            */
+#define FMRTCALLCREATE           6    /* fmrtCreate()                          */
+#define FMRTCALLMODIFY           7    /* fmrtModify()                          */
+#define FMRTCALLCREATEMODIFY     8    /* fmrtCreateModify()                    */
+#define FMRTCALLDELETE           9    /* fmrtDelete()                          */
+#define FMRTCALLIMPORTTABLECSV  10    /* fmrtImportTableCsv()                  */
+#define FMRTCALLEXPORTTABLECSV  11    /* fmrtExportTableCsv()                  */
+#define FMRTCALLEXPORTRANGECSV  12    /* fmrtExportRangeCsv()                  */
+#define FMRTCALLCOUNTENTRIES    13    /* fmrtCountEntries()                    */
+#define FMRTCALLDEFINEAGGREGATE 14    /* fmrtDefineAggregate()                 */
+#define FMRTCALLAGGREGATERANGE  15    /* fmrtAggregateRange()                  */
+#define FMRTCALLFLOOR           16    /* fmrtFloor()                           */
+#define FMRTCALLCEIL            17    /* fmrtCeil()                            */
+#define FMRTCALLPREV            18    /* fmrtPrev()                            */
+#define FMRTCALLNEXT            19    /* fmrtNext()                            */
+#define FMRTCALLMIN             20    /* fmrtMin()                             */
+#define FMRTCALLMAX             21    /* fmrtMax()                             */
+#define FMRTCALLPREFIXSCAN      22    /* fmrtPrefixScan()                      */
+#define FMRTCALLDEFINEEXPIRY    23    /* fmrtDefineExpiry()                    */
+#define FMRTCALLSETEXPIRY       24    /* fmrtSetExpiry()                       */
+#define FMRTCALLEXPIRE          25    /* fmrtExpire()                          */
+#define FMRTCALLDEFINEEVICTION  26    /* fmrtDefineEviction()                  */
+#define FMRTCALLGETCACHESTATS   27    /* fmrtGetCacheStats()                   */
+#define FMRTCALLDEFINELAYOUT    28    /* fmrtDefineLayout()                    */
+#define FMRTCALLDEFINESTRINGHEAP 29    /* fmrtDefineStringHeap()               */
+#define FMRTCALLCOMPACTSTRINGHEAP 30    /* fmrtCompactStringHeap()             */
+#define FMRTCALLFREEZE          31    /* fmrtFreeze()                          */
+#define FMRTCALLTHAW            32    /* fmrtThaw()                            */
+#define FMRTCALLCOMPACT         33    /* fmrtCompact()                         */
+#define FMRTCALLDEFINEENGINE    34    /* fmrtDefineEngine()                    */
+#define FMRTCALLDEFINEINDEX     35    /* fmrtDefineIndex()                     */
+#define FMRTCALLREADBYINDEX     36    /* fmrtReadByIndex()                     */
+#define FMRTCALLEXPORTINDEXRANGECSV 37    /* fmrtExportIndexRangeCsv()         */
+#define FMRTCALLGETTREEINFO     38    /* fmrtGetTreeInfo()                     */
+#define FMRTCALLGETMEMORYINFO   39    /* fmrtGetMemoryInfo() and related calls */
+#define FMRTCALLRESERVEMEMORY   40    /* fmrtReserveMemory()                   */
+#define FMRTCALLENABLESTATS     41    /* fmrtEnable[Lock]Stats(), lock dumps   */
+#define FMRTCALLS               42    /* Number of instrumented library calls  */
+#define FMRTCALLALL            255    /* All calls, see fmrtGet*LockStats()    */
+
 
 /*********************
  * Error Definitions *
@@ -81,20 +156,114 @@ extern "C" {
 #define FMRTNOTFOUND         9    /* Searched Element has not been found   */
 #define FMRTFIELDTOOLONG    10    /* String field exceeds max length (256) */
 #define FMRTOUTOFMEMORY     11    /* No More space left for new elements   */
+#define FMRTFROZEN          12    /* Table frozen, write operations denied */
+#define FMRTNOTSUPPORTED    13    /* Operation not supported by the engine */
+#define FMRTDUPLICATEVALUE  14    /* Value of unique index already present */
 
 
 /********************
  * Type Definitions *
  ********************/
-typedef uint8_t     fmrtId,
-                    fmrtType,
+typedef uint16_t    fmrtId;
+
+typedef uint8_t     fmrtType,
                     fmrtLen,
                     fmrtResult;
 
+/* Element indexes and counts are 32 bits wide, unless the library is built with "make index64" */
+/* (see makefile), which defines FMRTINDEX64: in that case it shall be defined also when      */
+/* compiling the programs using the library, since the size of all links and counts changes   */
+#ifdef FMRTINDEX64
+typedef uint64_t    fmrtIndex;
+#else
 typedef uint32_t    fmrtIndex;
+#endif
 
 typedef uint16_t    fmrtParamMask;
 
+/* Aggregates of a numeric field provided by fmrtAggregateRange() */
+typedef struct aggregate
+{
+    fmrtIndex       count;      /* Number of entries in the interval   */
+    double          sum,        /* Sum of the field values             */
+                    min,        /* Minimum value of the field          */
+                    max;        /* Maximum value of the field          */
+} fmrtAggregate;
+
+/* Operation counters and latency histograms provided by fmrtGetStats() */
+typedef struct stats
+{
+    uint64_t        reads,      /* fmrtRead() calls                    */
+                    hits,       /* fmrtRead() calls finding the entry  */
+                    misses,     /* fmrtRead() calls not finding it     */
+                    creates,    /* Entries created                     */
+                    duplicates, /* Creations failed for duplicate key  */
+                    modifies,   /* Entries modified                    */
+                    deletes,    /* Entries deleted                     */
+                    imports,    /* Successful CSV imports              */
+                    exports,    /* Successful CSV exports              */
+                    outOfMemory,/* Calls failed for lack of space      */
+                    latency[FMRTSTATCLASSES][FMRTSTATBUCKETS];  /* Calls per latency bucket */
+} fmrtStats;
+
+/* Acquisitions of a lock by a library call, provided by fmrtGetLockStats() */
+typedef struct lockStats
+{
+    uint64_t        acquisitions,   /* Number of times the lock was taken    */
+                    contended,      /* Lock busy at first attempt            */
+                    waitNs,         /* Total and max time waiting for the    */
+                    maxWaitNs,      /* lock (ns)                             */
+                    holdNs,         /* Total and max time holding the lock   */
+                    maxHoldNs;      /* (ns)                                  */
+} fmrtLockStats;
+
+/* Shape of the AVL tree of a table provided by fmrtGetTreeInfo() */
+typedef struct treeInfo
+{
+    fmrtIndex       entries,        /* Number of entries in the tree         */
+                    height,         /* Height of the tree (0 when empty)     */
+                    maxDepth,       /* Max nodes visited by a lookup         */
+                    freeList,       /* Elements in the free list             */
+                    unused,         /* Elements never used so far            */
+                    capacity;       /* Max number of entries of the table    */
+    double          avgDepth,       /* Average nodes visited by a lookup     */
+                    avgGap,         /* Average distance in the element array */
+                                    /* between nodes adjacent in key order   */
+                    fragmentation;  /* Fraction of nodes adjacent in key     */
+                                    /* order not stored next to each other   */
+    uint64_t        insertSingleRotations,  /* Rotations performed when     */
+                    insertDoubleRotations,  /* rebalancing the tree after   */
+                    deleteSingleRotations,  /* insertions and deletions     */
+                    deleteDoubleRotations;
+} fmrtTreeInfo;
+
+/* Memory used by a table (or by all the tables) provided by fmrtGetMemoryInfo() */
+typedef struct memoryInfo
+{
+    uint64_t        allocated,      /* Bytes currently allocated             */
+                    resident,       /* Allocated bytes resident in RAM       */
+                    descriptor,     /* Table descriptor                      */
+                    elements,       /* Element arrays, split into:           */
+                    live,           /* - elements holding entries            */
+                    freeList,       /* - elements in the free list           */
+                    unused,         /* - elements never used so far          */
+                    padding,        /* Alignment padding within elements     */
+                    stringHeap,     /* String heap and bytes of the live     */
+                    stringLive,     /* strings it holds                      */
+                    engine,         /* B+-tree nodes or hash engine slots    */
+                    indexes,        /* Secondary indexes                     */
+                    expiry,         /* Expiry timer wheel                    */
+                    stats,          /* Statistics shards                     */
+                    transient;      /* Peak of temporary buffers of a call   */
+    uint32_t        elemSize;       /* Bytes taken by each element           */
+} fmrtMemoryInfo;
+
+/* Callback invoked by fmrtPrefixScan() for each matching key (non-zero return value stops the scan) */
+typedef int (*fmrtKeySink) (char *key, void *userData);
+
+/* Callback invoked with each entry evicted from a table (see fmrtDefineEviction()) */
+typedef void (*fmrtEvictSink) (fmrtId tableId, char *row, void *userData);
+
 /***********************
  * Function Prototypes *
  ***********************/
@@ -103,27 +272,36 @@ typedef uint16_t    fmrtParamMask;
  * ---------------------------------------------------------
  * Define a new table with the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255
+ *   unique identifier of the table between 0 and 65535
  * - tableName
  *   string of up to 32 chars identifying table name
  * - tableNumElem
- *   max number of elements in table between 1 and 2^26
+ *   max number of elements in table between 1 and 2^26,
+ *   or 2^40 if the library is built with 64 bit element
+ *   indexes (see fmrtIndex)
  * This shall necessarily be the first library function
  * invoked by the caller.
  * A table cannot be redefined unless it is cleared first
  * through fmrtClearTable()
- * The library supports the definition of up to 32 tables
+ * The library supports the definition of up to 65536
+ * tables, the memory for the descriptor of each table is
+ * allocated only when a table with that tableId is defined
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
  *   Table successfully defined
  * - FMRTKO
  *   Result obtained when the number of elements is outside the
- *   allowed interval (1 - 2^26)
+ *   allowed interval (1 - 2^26, or 1 - 2^40)
  * - FMRTIDALREADYEXISTS
  *   tableId is already in use by another table
  * - FMRTMAXTABLEREACHED
- *   Result obtained when more than 32 tables are defined
+ *   Result obtained when the address space for the table
+ *   descriptors cannot be reserved (first definition)
+ * - FMRTOUTOFMEMORY
+ *   The memory budget would be exceeded (see
+ *   fmrtSetMemoryBudget()), or the memory of the table
+ *   descriptor cannot be committed
  ***********************************************************/
 fmrtResult fmrtDefineTable (fmrtId, char*, fmrtIndex);
 
@@ -133,7 +311,7 @@ fmrtResult fmrtDefineTable (fmrtId, char*, fmrtIndex);
  * ---------------------------------------------------------
  * Deallocate a previously allocated table:
  * - tableId
- *   unique identifier of the table between 0 and 255
+ *   unique identifier of the table between 0 and 65535
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
@@ -153,7 +331,7 @@ fmrtResult fmrtClearTable (fmrtId);
  * Define key name, type (and also key length for string key
  * type) for a previously defined Table:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - keyName
  *   descriptive name of the key (up to 16 chars allowed,
@@ -195,6 +373,78 @@ fmrtResult fmrtClearTable (fmrtId);
 fmrtResult fmrtDefineKey (fmrtId, char*, fmrtType, fmrtLen);
 
 
+/***********************************************************
+ * fmrtDefineCompositeKey()
+ * ---------------------------------------------------------
+ * Define a composite key, made of up to 4 typed components,
+ * for a previously defined Table. This is an alternative to
+ * fmrtDefineKey(), and the key type is FMRTCOMPOSITE.
+ * Elements are ordered by the first component, then by the
+ * second one and so on (lexicographic order). Components
+ * are stored packed in the element, encoded so that the
+ * encoded keys can be compared with memcmp(), i.e. with a
+ * single byte-wise comparison at each node of the tree.
+ * It is a call with a variable number of arguments. The
+ * first three parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - keyName
+ *   descriptive name of the key (up to 16 chars allowed,
+ *   in case of length exceeding this limit the name will
+ *   be truncated)
+ * - numComponents
+ *   number of components, in the interval 2-4
+ * The following parameters specify name, type (and also
+ * length for string components) of each component, as in
+ * fmrtDefineFields():
+ * - component name
+ *   descriptive name of the component (up to 16 chars), it
+ *   is used as column name in CSV exports
+ * - component type
+ *   FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR, FMRTSTRING
+ *   or FMRTTIMESTAMP
+ * - component len
+ *   THIS SHALL BE INSERTED ONLY if component type is
+ *   FMRTSTRING, it represents the maximum string length
+ * Library calls taking a key (e.g. fmrtRead(), fmrtCreate()
+ * or fmrtDelete()) take one argument for each component
+ * instead, in the same order and with the same types used
+ * for fields. Similarly, fmrtExportRangeCsv() takes all the
+ * components of the minimum key followed by all the
+ * components of the maximum key, therefore the elements
+ * sharing the leading components are exported by setting
+ * the remaining components to their minimum and maximum
+ * values. In CSV files each component takes one column.
+ * This call can be invoked only once after fmrtDefineTable()
+ * and before invoking fmrtDefineFields(). Tables with a
+ * composite key support only the default engine (see
+ * fmrtDefineEngine())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Key definition successful
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when one of the component
+ *   type parameters is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The key cannot be redefined (it has been already
+ *   defined, either through this call or through
+ *   fmrtDefineKey()) or fields have been already defined
+ * - FMRTMAXFIELDSINVALID
+ *   The specified number of components is outside the
+ *   allowed range (2-4)
+ * - FMRTFIELDTOOLONG
+ *   The maximum length specified for one of the FMRTSTRING
+ *   components is outside the allowed interval (1-254) or
+ *   the components take more than 255 bytes overall
+ ***********************************************************/
+fmrtResult fmrtDefineCompositeKey (fmrtId, char*, uint8_t, ...);
+
+
 /***********************************************************
  * fmrtDefineFields()
  * ---------------------------------------------------------
@@ -202,7 +452,7 @@ fmrtResult fmrtDefineKey (fmrtId, char*, fmrtType, fmrtLen);
  * variable number of arguments. The first two parameters
  * (always present) are respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - numFields
  *   number of fields, in the interval 1-16 (excluding the
@@ -246,6 +496,10 @@ fmrtResult fmrtDefineKey (fmrtId, char*, fmrtType, fmrtLen);
  * - FMRTFIELDTOOLONG
  *   The maximum length specified for one of the FMRTSTRING
  *   parameters is outside the allowed interval (1-256)
+ * - FMRTOUTOFMEMORY
+ *   The array of elements of the table, allocated at the
+ *   first insertion, would exceed the memory budget (see
+ *   fmrtSetMemoryBudget()). Fields are not defined
  ***********************************************************/
 fmrtResult fmrtDefineFields (fmrtId, uint8_t, ...);
 
@@ -258,7 +512,7 @@ fmrtResult fmrtDefineFields (fmrtId, uint8_t, ...);
  * The first two parameters (always present) are
  * respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - key
  *   contains the key value to be searched into the table.
@@ -298,7 +552,7 @@ fmrtResult fmrtRead (fmrtId, ...);
  * arguments. The first two parameters (always present) are
  * respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - key
  *   contains the key value to be searched into the table.
@@ -328,7 +582,15 @@ fmrtResult fmrtRead (fmrtId, ...);
  * - FMRTIDNOTFOUND
  *   tableId is not defined
  * - FMRTOUTOFMEMORY
- *   The FMRT tree is full
+ *   The FMRT tree is full, or there is not enough memory
+ *   to grow the string heap (see fmrtDefineStringHeap());
+ *   the table is left untouched
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
  ***********************************************************/
 fmrtResult fmrtCreate (fmrtId, ...);
 
@@ -341,7 +603,7 @@ fmrtResult fmrtCreate (fmrtId, ...);
  * arguments. The first three parameters (always present) are
  * respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - paramMask
  *   It is a bitwise mask that is used to identify the
@@ -385,6 +647,16 @@ fmrtResult fmrtCreate (fmrtId, ...);
  *   call invoked by the caller
  * - FMRTIDNOTFOUND
  *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
+ * - FMRTOUTOFMEMORY
+ *   There is not enough memory to grow the string heap
+ *   (see fmrtDefineStringHeap()); the table is left
+ *   untouched
  ***********************************************************/
 fmrtResult fmrtModify (fmrtId, fmrtParamMask, ...);
 
@@ -402,7 +674,7 @@ fmrtResult fmrtModify (fmrtId, fmrtParamMask, ...);
  * The first three parameters (always present) are
  * respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - paramMask
  *   It is a bitwise mask that is used to identify the
@@ -449,7 +721,15 @@ fmrtResult fmrtModify (fmrtId, fmrtParamMask, ...);
  * - FMRTIDNOTFOUND
  *   tableId is not defined
  * - FMRTOUTOFMEMORY
- *   The FMRT tree is full
+ *   The FMRT tree is full, or there is not enough memory
+ *   to grow the string heap (see fmrtDefineStringHeap());
+ *   the table is left untouched
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
  ***********************************************************/
 fmrtResult fmrtCreateModify (fmrtId, fmrtParamMask, ...);
 
@@ -461,7 +741,7 @@ fmrtResult fmrtCreateModify (fmrtId, fmrtParamMask, ...);
  * from the fmrt tree. It is a call with two parameters,
  * respectively:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - key
  *   contains the key value to be searched into the table.
@@ -481,6 +761,8 @@ fmrtResult fmrtCreateModify (fmrtId, fmrtParamMask, ...);
  *   call invoked by the caller
  * - FMRTIDNOTFOUND
  *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
  ***********************************************************/
 fmrtResult fmrtDelete (fmrtId, ...);
 
@@ -494,7 +776,7 @@ fmrtResult fmrtDelete (fmrtId, ...);
  * is provided by the first parameter.
  * It takes the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - filePtr
  *   pointer to a file opened by the caller in read
@@ -505,7 +787,7 @@ fmrtResult fmrtDelete (fmrtId, ...);
  *   as a separator between consecutive fields into the
  *   input CSV file
  * - lines
- *   is a pointer to an integer parameter that is provided
+ *   is a pointer to a fmrtIndex parameter that is provided
  *   back by the call. It contains either the total number
  *   of lines read from the file (if result is FMRTOK) or the
  *   line number affected by the error (in case of error)
@@ -539,11 +821,20 @@ fmrtResult fmrtDelete (fmrtId, ...);
  *   while inserting data into the table from the CSV file
  *   the maximum number of elements has been reached (the
  *   maximum number of elements is specified at table
- *   definition as a parameter of fmrtDefineTable() ). The
- *   last parameter identifies the line in the input file
- *   where data import was stopped.
+ *   definition as a parameter of fmrtDefineTable() ), or
+ *   there is not enough memory to grow the string heap
+ *   (see fmrtDefineStringHeap()). The last parameter
+ *   identifies the line in the input file where data import
+ *   was stopped.
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element. The last parameter identifies the line in the
+ *   input file where data import was stopped
  ***********************************************************/
-fmrtResult fmrtImportTableCsv (fmrtId, FILE *, char, int *);
+fmrtResult fmrtImportTableCsv (fmrtId, FILE *, char, fmrtIndex *);
 
 
 /***********************************************************
@@ -553,7 +844,7 @@ fmrtResult fmrtImportTableCsv (fmrtId, FILE *, char, int *);
  * given table into a specified file in CSV format.
  * It takes the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - filePtr
  *   pointer to a file opened by the caller in write/append
@@ -585,7 +876,8 @@ fmrtResult fmrtImportTableCsv (fmrtId, FILE *, char, int *);
  *   tableId is not defined
  * - FMRTOUTOFMEMORY
  *   There is not enough memory to allocate data structures
- *   needed to export the table in FMRTOPTIMIZED order
+ *   needed to export the table in FMRTOPTIMIZED order or,
+ *   for tables using the hash engine, to sort the elements
  ***********************************************************/
 fmrtResult fmrtExportTableCsv (fmrtId, FILE *, char, uint8_t);
 
@@ -600,7 +892,7 @@ fmrtResult fmrtExportTableCsv (fmrtId, FILE *, char, uint8_t);
  * key value (specified by the last two parameters).
  * It takes the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * - filePtr
  *   pointer to a file opened by the caller in write/append
@@ -627,6 +919,8 @@ fmrtResult fmrtExportTableCsv (fmrtId, FILE *, char, uint8_t);
  *   specified at key definition (fmrtDefineKey() call).
  *   Library call behaviour is undefined if this condition
  *   is not satisfied
+ * With FMRTCOMPOSITE keys, keyMin and keyMax take one
+ * argument for each component (see fmrtDefineCompositeKey())
  * Please note that the file shall be opened before calling
  * this function, otherwise a run-time error will occur.
  * Similarly, the function call does not close the output
@@ -641,6 +935,9 @@ fmrtResult fmrtExportTableCsv (fmrtId, FILE *, char, uint8_t);
  *   is greater than keyMax
  * - FMRTIDNOTFOUND
  *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   There is not enough memory to sort the elements of a
+ *   table using the hash engine (see fmrtDefineEngine())
  ***********************************************************/
 fmrtResult fmrtExportRangeCsv (fmrtId, FILE *, char , uint8_t , ...);
 
@@ -651,7 +948,7 @@ fmrtResult fmrtExportRangeCsv (fmrtId, FILE *, char , uint8_t , ...);
  * This library call is used to count the number of elements
  * stored into the table. It takes just one input parameter:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * ---------------------------------------------------------
  * It returns the number of elements contained into the
@@ -668,11 +965,14 @@ fmrtIndex fmrtCountEntries(fmrtId);
  * table whose tableId is given as a parameter.
  * It takes just one input parameter:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
  * ---------------------------------------------------------
- * It returns the number of bytes allocated for the given
- * table (0 in case of any problem, e.g. tableId not defined)
+ * It returns the number of bytes currently allocated for
+ * the given table (0 in case of any problem, e.g. tableId
+ * not defined). Please note that the array of elements is
+ * allocated at the first insertion. A detailed breakdown
+ * is provided by fmrtGetMemoryInfo()
  ***********************************************************/
 long fmrtGetMemoryFootPrint(fmrtId);
 
@@ -752,6 +1052,1419 @@ time_t fmrtEncodeTimeStamp(char * );
 void fmrtDecodeTimeStamp(time_t , char * );
 
 
+/***********************************************************
+ * fmrtDefineAggregate()
+ * ---------------------------------------------------------
+ * Enable subtree aggregates on a numeric field of a
+ * previously defined table. When enabled, each node of the
+ * fmrt tree keeps count, sum, min and max of the selected
+ * field over the subtree it roots; those values are kept up
+ * to date along the write path and during rotations, and
+ * allow fmrtAggregateRange() to work in O(log(n)).
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   index of the field to be aggregated, according to the
+ *   same order used in fmrtDefineFields() (0 is the first
+ *   field). The field shall be of type FMRTINT, FMRTSIGNED
+ *   or FMRTDOUBLE
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 32 additional bytes
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Aggregate successfully defined
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when fieldIdx does not identify a
+ *   numeric field
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTREDEFPROHIBITED
+ *   An aggregate has been already defined or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineAggregate (fmrtId, uint8_t);
+
+
+/***********************************************************
+ * fmrtAggregateRange()
+ * ---------------------------------------------------------
+ * This library call provides count, sum, min and max of the
+ * aggregated field (see fmrtDefineAggregate()) over all the
+ * entries whose key lies in a given interval. It is a call
+ * with a variable number of arguments. It takes the
+ * following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   index of the aggregated field, i.e. the same value
+ *   passed to fmrtDefineAggregate()
+ * - keyMin, keyMax
+ *   these are two parameters that specify the interval of
+ *   keys (extremes included). They shall be of the same type
+ *   defined by the fmrtDefineKey() call. The library
+ *   behaviour is undefined if this constraint is not
+ *   satisfied
+ * - agg
+ *   pointer to a fmrtAggregate structure filled by the call.
+ *   If no entries are found in the interval, count, sum,
+ *   min and max are all set to 0
+ * The call does not scan the entries in the interval, but it
+ * uses the aggregates stored into the tree nodes, therefore
+ * its complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Aggregates successfully computed
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when keyMin is greater than
+ *   keyMax, when agg is NULL or when fieldIdx does not
+ *   identify the aggregated field
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtAggregateRange (fmrtId, uint8_t, ...);
+
+
+/***********************************************************
+ * fmrtFloor()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key lower than or equal to the given key. It is
+ * a call with a variable number of arguments. The first
+ * two parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtFloor (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtCeil()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key greater than or equal to the given key. It is
+ * a call with a variable number of arguments. The first
+ * two parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtCeil (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtPrev()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key strictly lower than the given key
+ * (predecessor). It is a call with a variable number of
+ * arguments. The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtPrev (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtNext()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key strictly greater than the given key
+ * (successor). It is a call with a variable number of
+ * arguments. The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtNext (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtMin()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key in the table. It is a call with a variable
+ * number of arguments. The first parameter (always present)
+ * is:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * After it, there is a pointer that is filled with the key
+ * of the entry found (a char buffer for string keys and for
+ * timestamps when a time format is defined), followed by the
+ * list of pointer parameters that are filled with the
+ * fields, exactly as in fmrtRead().
+ * Complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   The table is empty
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtMin (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtMax()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key in the table. It is a call with a variable
+ * number of arguments. The first parameter (always present)
+ * is:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * After it, there is a pointer that is filled with the key
+ * of the entry found (a char buffer for string keys and for
+ * timestamps when a time format is defined), followed by the
+ * list of pointer parameters that are filled with the
+ * fields, exactly as in fmrtRead().
+ * Complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   The table is empty
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtMax (fmrtId, ...);
+
+
+/***********************************************************
+ * fmrtPrefixScan()
+ * ---------------------------------------------------------
+ * This library call looks for all the entries of a table
+ * with FMRTSTRING key whose key starts with a given prefix,
+ * and provides them in ascending order through a callback
+ * function. It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - prefix
+ *   the prefix to look for (an empty string matches all
+ *   the keys)
+ * - limit
+ *   maximum number of matching keys to be provided (0 means
+ *   no limit)
+ * - sink
+ *   callback function invoked for each matching key, with
+ *   the key and userData as parameters. If it returns a
+ *   non-zero value the scan is stopped. If NULL the call
+ *   only counts the matching keys. Please observe that the
+ *   callback is invoked while the table is locked, therefore
+ *   it shall not invoke library calls on the same table
+ * - userData
+ *   opaque pointer passed as it is to the callback
+ * - count
+ *   pointer to a variable filled with the number of matching
+ *   keys provided to the callback (or counted, if sink is
+ *   NULL). It can be NULL if not needed
+ * The subtrees that cannot contain matching keys are never
+ * visited, therefore complexity is O(log(n)+matches)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Scan completed (even if no keys have been found)
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when prefix is NULL or when
+ *   the key type of the table is not FMRTSTRING
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtPrefixScan (fmrtId, char *, fmrtIndex, fmrtKeySink, void *, fmrtIndex *);
+
+
+/***********************************************************
+ * fmrtDefineExpiry()
+ * ---------------------------------------------------------
+ * Enable per-entry expiry on a previously defined table.
+ * When enabled, each entry carries a deadline: entries whose
+ * deadline has been reached are removed from the table by a
+ * sweeper based on a timer wheel with 1 second resolution.
+ * The sweeper runs automatically at the beginning of every
+ * library call accessing the entries of the table (reads,
+ * writes, nearest key searches, scans, aggregates, counts
+ * and exports), so that expired entries are never visible,
+ * or explicitly through fmrtExpire(), and its cost depends
+ * on the number of expired entries, not on the table size.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - defaultTtl
+ *   time to live (in seconds) assigned to each new entry
+ *   when it is created. If 0, new entries never expire
+ *   unless a deadline is set through fmrtSetExpiry()
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 16 additional bytes
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Expiry successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when defaultTtl is negative
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine()) or it is frozen (see fmrtFreeze())
+ * - FMRTREDEFPROHIBITED
+ *   Expiry has been already enabled or the table already
+ *   contains data
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to allocate the timer wheel, or the
+ *   memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineExpiry (fmrtId, time_t);
+
+
+/***********************************************************
+ * fmrtSetExpiry()
+ * ---------------------------------------------------------
+ * This library call is used to set the time to live of an
+ * existing entry of a table with expiry enabled (see
+ * fmrtDefineExpiry()). It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - ttl
+ *   new time to live of the entry in seconds, starting from
+ *   now. If 0, the entry never expires
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The deadline of the entry has been updated
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the table
+ *   (or it has already expired)
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when expiry is not enabled
+ *   on the table or when ttl is negative
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ ***********************************************************/
+fmrtResult fmrtSetExpiry (fmrtId, time_t, ...);
+
+
+/***********************************************************
+ * fmrtExpire()
+ * ---------------------------------------------------------
+ * This library call runs the expiry sweeper on a table with
+ * expiry enabled (see fmrtDefineExpiry()), removing all the
+ * entries whose deadline has been reached. It can be used
+ * by applications that need to release space without
+ * waiting for the next write operation. It takes the
+ * following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - expired
+ *   pointer to a variable filled with the number of entries
+ *   removed. It can be NULL if not needed
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Sweep completed
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when expiry is not enabled
+ *   on the table
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ ***********************************************************/
+fmrtResult fmrtExpire (fmrtId, fmrtIndex *);
+
+
+/***********************************************************
+ * fmrtDefineEviction()
+ * ---------------------------------------------------------
+ * Turn a previously defined table into a capacity-bounded
+ * cache. When eviction is enabled, inserting a new entry
+ * into a full table does not fail with FMRTOUTOFMEMORY:
+ * one of the existing entries is evicted instead, selected
+ * through the CLOCK algorithm (an approximation of LRU in
+ * which each entry keeps a reference flag, set on insert,
+ * read and modify). It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - separator
+ *   character used to separate key and fields in the line
+ *   passed to the callback (same format used by
+ *   fmrtExportTableCsv())
+ * - sink
+ *   callback invoked with each evicted entry before it is
+ *   removed (e.g. to write it back to a slower storage). It
+ *   is called with the table lock held, hence it shall not
+ *   invoke library calls on the same table. It can be NULL
+ * - userData
+ *   opaque pointer passed unchanged to the callback
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 1 additional byte
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Eviction successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when fields have not been
+ *   defined yet
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTREDEFPROHIBITED
+ *   Eviction has been already enabled or the table already
+ *   contains data
+ ***********************************************************/
+fmrtResult fmrtDefineEviction (fmrtId, char, fmrtEvictSink, void *);
+
+
+/***********************************************************
+ * fmrtGetCacheStats()
+ * ---------------------------------------------------------
+ * This library call provides the cache statistics of a
+ * table, i.e. the number of successful and unsuccessful
+ * fmrtRead() calls and the number of entries evicted (see
+ * fmrtDefineEviction()) since the table was defined. Hits
+ * and misses are collected even when statistics are
+ * disabled, and they are cleared by fmrtResetStats(). It
+ * takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - hits, misses, evictions
+ *   pointers to the variables filled with the statistics.
+ *   Any of them can be NULL if not needed
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetCacheStats (fmrtId, uint64_t *, uint64_t *, uint64_t *);
+
+
+/***********************************************************
+ * fmrtDefineLayout()
+ * ---------------------------------------------------------
+ * Select the memory layout used to store the elements of a
+ * previously defined table. With the default layout
+ * (FMRTLAYOUTUNIFIED) each element holds links, key and
+ * all fields in a single block, therefore on wide tables
+ * a tree descent reads several cache lines per level just
+ * to access links and key. With the split layout
+ * (FMRTLAYOUTSPLIT) links and key are kept in a compact
+ * index array, while fields are moved into a parallel
+ * payload array addressed by the same index, which is
+ * accessed only once the element has been found. Moreover,
+ * the size of the elements can be padded (FMRTLAYOUTPADDED)
+ * to the next power of 2 up to 64 bytes, or to a multiple
+ * of 64 bytes above, so that each element spans the
+ * minimum number of cache lines.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - layout
+ *   either FMRTLAYOUTUNIFIED or FMRTLAYOUTSPLIT, possibly
+ *   combined with FMRTLAYOUTPADDED (bitwise or)
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. The memory footprint is unchanged, unless
+ * FMRTLAYOUTPADDED is specified
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Layout successfully selected
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when layout is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The layout has been already selected or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineLayout (fmrtId, uint8_t);
+
+
+/***********************************************************
+ * fmrtDefineStringHeap()
+ * ---------------------------------------------------------
+ * Enable out-of-line storage for the FMRTSTRING fields of a
+ * previously defined table. By default each string field
+ * takes its maximum length (plus the trailing 0) in every
+ * element, whatever the actual length of the stored value.
+ * When the string heap is enabled, string fields longer
+ * than 15 characters take a fixed 16 bytes slot in the
+ * element: shorter values are stored inline in the slot,
+ * longer values are stored in a per-table heap that grows
+ * on demand and is compacted when grown. The space of
+ * released strings is recovered at the next compaction
+ * (see also fmrtCompactStringHeap()). Write operations
+ * that cannot grow the heap fail with FMRTOUTOFMEMORY,
+ * leaving the element untouched.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * This call is OPTIONAL. It can be invoked after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   String heap successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when fields have not been
+ *   defined yet
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The string heap has been already enabled or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineStringHeap (fmrtId);
+
+
+/***********************************************************
+ * fmrtCompactStringHeap()
+ * ---------------------------------------------------------
+ * This library call compacts the string heap of a table
+ * (see fmrtDefineStringHeap()), recovering the space left
+ * by released strings and shrinking the heap to the size
+ * of the strings actually stored. It can be used after
+ * massive deletions or modifications.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The string heap has been compacted
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when the string heap is
+ *   not enabled on the table
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to allocate the compacted heap (the
+ *   table is left untouched)
+ ***********************************************************/
+fmrtResult fmrtCompactStringHeap (fmrtId);
+
+
+/***********************************************************
+ * fmrtFreeze()
+ * ---------------------------------------------------------
+ * Freeze a table, i.e. make it read-only and rewrite its
+ * elements in breadth first order (root first, then the
+ * nodes of the second level and so on). This is meant for
+ * tables that are loaded once (e.g. reference tables that
+ * are rebuilt periodically) and then only read: after many
+ * inserts and deletes the nodes are scattered randomly in
+ * memory, while in breadth first order the top levels of
+ * the tree, visited by every search, are packed together.
+ * While the table is frozen, all write operations (create,
+ * modify, delete, import, expiry) are rejected with
+ * FMRTFROZEN, until fmrtThaw() is invoked.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * During the operation memory is allocated for a second
+ * copy of the table, which is released before returning
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table is frozen
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine()) or it has expiry enabled (see
+ *   fmrtDefineExpiry()), as expired entries are removed
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to rewrite the table (the table is
+ *   left untouched and not frozen)
+ ***********************************************************/
+fmrtResult fmrtFreeze (fmrtId);
+
+
+/***********************************************************
+ * fmrtThaw()
+ * ---------------------------------------------------------
+ * This library call makes a table frozen through
+ * fmrtFreeze() writable again. The layout of the elements
+ * is not changed, it is progressively lost as the table is
+ * modified.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table is writable
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtThaw (fmrtId);
+
+
+/***********************************************************
+ * fmrtCompact()
+ * ---------------------------------------------------------
+ * This library call defragments the array of elements of
+ * a table. After many deletes the elements still in use
+ * are scattered across the whole array and new elements
+ * are placed wherever a slot was freed, so that memory
+ * locality is lost and the memory of the array cannot be
+ * given back. The call moves all the elements to the
+ * beginning of the array, in the order given as second
+ * parameter, and releases the memory pages left unused to
+ * the operating system (they are allocated again only when
+ * the table grows again). The content of the table is not
+ * changed, there is no need for an export/import cycle.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - selectedOrder
+ *   it can assume the following values: FMRTASCENDING or
+ *   FMRTDESCENDING, to place the elements in key order
+ *   (best for range scans and exports), and FMRTOPTIMIZED
+ *   to place them in breadth first order, root first (best
+ *   for point lookups). If an unrecognized value is
+ *   specified, FMRTOPTIMIZED is assumed
+ * During the operation memory is allocated for a second
+ * copy of the table, which is released before returning
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table has been compacted
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze()), i.e. already
+ *   compacted in breadth first order
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to rewrite the table (the table is
+ *   left untouched)
+ ***********************************************************/
+fmrtResult fmrtCompact (fmrtId, uint8_t);
+
+
+/***********************************************************
+ * fmrtDefineEngine()
+ * ---------------------------------------------------------
+ * Select the storage engine used to index the elements of
+ * a previously defined table. With the default engine
+ * (FMRTENGINEAVL) each element is a node of an AVL tree,
+ * therefore a lookup visits about 1.44*log2(n) elements,
+ * each one in a different cache line. With the B+-tree
+ * engine (FMRTENGINEBTREE) elements are indexed by a
+ * B+-tree whose nodes hold many keys packed together, so
+ * that a lookup visits only a few nodes and most of the
+ * comparisons are performed within the same cache lines.
+ * Leaves are linked together, hence exports and range
+ * exports are sequential scans. With the hash engine
+ * (FMRTENGINEHASH) elements are indexed by an open
+ * addressing hash table (Robin Hood hashing) sized for the
+ * max number of elements of the table, so that exact key
+ * lookups probe about one slot regardless of the size of
+ * the table, at the cost of ordered access: ascending,
+ * descending and range exports sort the elements at export
+ * time, while FMRTOPTIMIZED exports them unordered.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - engine
+ *   either FMRTENGINEAVL, FMRTENGINEBTREE or FMRTENGINEHASH
+ * - nodeSize
+ *   size in bytes of the nodes of the B+-tree (e.g. 64 or
+ *   256 to fit one or a few cache lines, 4096 to fit a
+ *   memory page), at least FMRTBTREEMINNODE (64 bytes, or
+ *   96 with 64 bit element indexes, so that each node holds
+ *   at least 2 keys). It is rounded down to a multiple of 8
+ *   and ignored by other engines
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. B+-tree and hash engines support
+ * fmrtRead(), fmrtCreate(), fmrtModify(),
+ * fmrtCreateModify(), fmrtDelete(), fmrtCountEntries(),
+ * import/export of CSV files (FMRTOPTIMIZED exports in
+ * ascending order with the B+-tree) and range exports,
+ * with the split layout and the string heap. Aggregates,
+ * nearest key searches, prefix scans, expiry, eviction,
+ * fmrtFreeze() and fmrtCompact() are not supported and
+ * return FMRTNOTSUPPORTED
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Engine successfully selected
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when engine or nodeSize are not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The engine has been already selected or the table
+ *   already contains data
+ * - FMRTNOTSUPPORTED
+ *   Aggregates, expiry, eviction or a FMRTCOMPOSITE key
+ *   have been defined on the table, which are not supported
+ *   by the selected engine
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory for the B+-tree work area or for the
+ *   hash index, or the memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineEngine (fmrtId, uint8_t, uint16_t);
+
+
+/***********************************************************
+ * fmrtDefineIndex()
+ * ---------------------------------------------------------
+ * Define a secondary index on a field of a previously
+ * defined table, so that entries can be looked up by the
+ * value of that field (see fmrtReadByIndex()) and exported
+ * in field order (see fmrtExportIndexRangeCsv()) in
+ * O(log(n)), rather than by scanning the whole table.
+ * Indexes are kept up to date by all write operations. Each
+ * index takes a node for each element of the table (about
+ * 32 bytes), allocated along with the index.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the field to be indexed (0 is the first
+ *   field specified in fmrtDefineFields())
+ * - unique
+ *   either FMRTINDEXUNIQUE, if two entries cannot share the
+ *   same value of the field, or FMRTINDEXNONUNIQUE. With
+ *   unique indexes, write operations that would duplicate
+ *   a value are rejected with FMRTDUPLICATEVALUE
+ * This call is OPTIONAL. It can be invoked up to
+ * MAXFMRTINDEXES times (once per field) after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Indexes are supported by all the storage
+ * engines (see fmrtDefineEngine())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Index successfully defined
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet, when fieldIdx or unique are not valid or
+ *   when the max number of indexes has been reached
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The field is already indexed or the table already
+ *   contains data
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory for the nodes of the index, or the
+ *   memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineIndex (fmrtId, uint8_t, uint8_t);
+
+
+/***********************************************************
+ * fmrtReadByIndex()
+ * ---------------------------------------------------------
+ * This library call is used to read an entry given the
+ * value of an indexed field (see fmrtDefineIndex()). It is
+ * a call with a variable number of arguments. The first
+ * three parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the indexed field (0 is the first field
+ *   specified in fmrtDefineFields())
+ * - value
+ *   contains the value to be searched. It shall be of the
+ *   same type of the field (a string for timestamps when a
+ *   time format is defined)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtFloor().
+ * With non unique indexes, the first entry inserted with
+ * the given value is provided.
+ * Complexity is O(log(n)) (single descent from the root of
+ * the index)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry with the given value
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller or when the field is not
+ *   indexed
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtReadByIndex (fmrtId, uint8_t, ...);
+
+
+/***********************************************************
+ * fmrtExportIndexRangeCsv()
+ * ---------------------------------------------------------
+ * This library call is the counterpart of
+ * fmrtExportRangeCsv() for indexed fields (see
+ * fmrtDefineIndex()): it exports in CSV format all the
+ * table entries whose value of the indexed field is in the
+ * range between a minimum and a maximum value (specified
+ * by the last two parameters), ordered by that field.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the indexed field (0 is the first field
+ *   specified in fmrtDefineFields())
+ * - filePtr
+ *   pointer to a file opened by the caller in write/append
+ *   mode. The output will be written on that file. If NULL
+ *   output is written on stdout
+ * - separator
+ *   It is a char specified by the caller that is used to
+ *   separate fields into the output
+ * - selectedOrder
+ *   either FMRTASCENDING or FMRTDESCENDING, with respect to
+ *   the value of the field (entries sharing the same value
+ *   follow insertion order). If an unrecognized value is
+ *   specified, by default data will be exported assuming
+ *   FMRTASCENDING order.
+ * - valueMin
+ *   Minimum value of the field. It must be of the same type
+ *   of the field
+ * - valueMax
+ *   Maximum value of the field. It must be of the same type
+ *   of the field
+ * Please note that the file shall be opened before calling
+ * this function, otherwise a run-time error will occur.
+ * Similarly, the function call does not close the output
+ * file, which must be closed by the caller
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Export was successful
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, when the field is not indexed
+ *   or when valueMin is greater than valueMax
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtExportIndexRangeCsv (fmrtId, uint8_t, FILE *, char, uint8_t, ...);
+
+
+/***********************************************************
+ * fmrtEnableStats()
+ * ---------------------------------------------------------
+ * Switch on or off the collection of the statistics
+ * provided by fmrtGetStats() for all the tables. Collection
+ * is disabled by default; when disabled, the cost on the
+ * library calls is limited to a test of a global flag. The
+ * statistics shards of a table are allocated only once
+ * collection is switched on (when the table is defined, if
+ * collection is already on), and they are charged against
+ * the memory budget (see fmrtSetMemoryBudget()). It takes
+ * the following parameter:
+ * - enable
+ *   1 to start collecting statistics, 0 to stop. Statistics
+ *   already collected are kept (see fmrtResetStats())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Collection switched on or off
+ * - FMRTOUTOFMEMORY
+ *   Collection switched on, but the statistics shards of
+ *   some tables could not be allocated, their statistics
+ *   are not collected
+ ***********************************************************/
+fmrtResult fmrtEnableStats (uint8_t);
+
+
+/***********************************************************
+ * fmrtGetStats()
+ * ---------------------------------------------------------
+ * This library call provides the operation counters and
+ * the latency histograms of a table, collected while
+ * statistics are enabled (see fmrtEnableStats()) since the
+ * table was defined or since the last fmrtResetStats().
+ * Counters include reads (with hits and misses, which are
+ * collected even when statistics are disabled, see
+ * fmrtGetCacheStats()), created, modified and deleted
+ * entries (fmrtCreateModify() counts as a creation or as a
+ * modification depending on the key being new or not),
+ * creations failed for duplicate key,
+ * successful imports and exports, and calls failed with
+ * FMRTOUTOFMEMORY. Each operation class (FMRTSTATREAD ...
+ * FMRTSTATEXPORT) has a histogram of the latency of its
+ * calls, lock wait included: bucket b counts the calls
+ * lasting from 2^b to 2^(b+1)-1 ns (bucket 0 also counts
+ * 0 ns, the last bucket counts all longer calls).
+ * Statistics are kept in per-thread shards and summed on
+ * request. It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - stats
+ *   pointer to the structure filled with the statistics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetStats (fmrtId, fmrtStats *);
+
+
+/***********************************************************
+ * fmrtResetStats()
+ * ---------------------------------------------------------
+ * Clear the operation counters and the latency histograms
+ * of a table (see fmrtGetStats()). Operations completing
+ * while the statistics are cleared may be lost. It takes
+ * the following parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics cleared
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtResetStats (fmrtId);
+
+
+/***********************************************************
+ * fmrtGetTreeInfo()
+ * ---------------------------------------------------------
+ * This library call provides diagnostics about the shape
+ * of the AVL tree of a table, useful to decide when the
+ * table shall be compacted or rebuilt (see fmrtCompact()).
+ * The tree is walked iteratively, holding the table lock,
+ * hence the call takes O(n) time. The following info are
+ * provided:
+ * - entries, height, average and maximum lookup depth
+ *   (number of nodes visited to find an existing key, the
+ *   root being at depth 1)
+ * - single and double rotations performed to rebalance the
+ *   tree after insertions and deletions, since the table
+ *   was defined
+ * - elements in the free list (released by deletions and
+ *   reused first), elements never used so far and capacity
+ *   of the table
+ * - fragmentation of the element array: avgGap is the
+ *   average distance (in elements) between nodes adjacent
+ *   in key order, fragmentation is the fraction of them
+ *   that are not stored in consecutive elements. Both are
+ *   minimal (1.0 and 0.0) after fmrtCompact() with
+ *   FMRTASCENDING order
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - info
+ *   pointer to the structure filled with the diagnostics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Diagnostics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, or when the tree is corrupted
+ *   (i.e. higher than the maximum AVL tree height)
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtGetTreeInfo (fmrtId, fmrtTreeInfo *);
+
+
+/***********************************************************
+ * fmrtEnableLockStats()
+ * ---------------------------------------------------------
+ * Switch on or off the instrumentation of the locks of the
+ * library, i.e. the global lock used to define and clear
+ * tables and by the other calls listed in
+ * fmrtGetGlobalLockStats(), and the lock of each table. Instrumentation is
+ * disabled by default; when enabled, each acquisition is
+ * first attempted without blocking, in order to detect
+ * contention, and wait and hold times are measured, adding
+ * some overhead to every library call. Statistics are
+ * kept for each lock and for each library call acquiring
+ * it (see fmrtGetLockStats()). The statistics of a table
+ * lock are allocated only once instrumentation is switched
+ * on (when the table is defined, if it is already on), and
+ * they are charged against the memory budget (see
+ * fmrtSetMemoryBudget()). It takes the following parameter:
+ * - enable
+ *   1 to start the instrumentation, 0 to stop it.
+ *   Statistics already collected are kept
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Instrumentation switched on or off
+ * - FMRTOUTOFMEMORY
+ *   Instrumentation switched on, but the statistics of the
+ *   locks of some tables could not be allocated, their
+ *   locks are not instrumented
+ ***********************************************************/
+fmrtResult fmrtEnableLockStats (uint8_t);
+
+
+/***********************************************************
+ * fmrtGetLockStats()
+ * ---------------------------------------------------------
+ * This library call provides the statistics of the lock of
+ * a table, collected while lock instrumentation is enabled
+ * (see fmrtEnableLockStats()) since the table was defined:
+ * number of acquisitions, number of acquisitions finding
+ * the lock busy, total and maximum time spent waiting for
+ * the lock and holding it (in ns). It takes the following
+ * parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - call
+ *   the library call acquiring the lock (FMRTCALLREAD,
+ *   FMRTCALLEXPORTTABLECSV, ...), or FMRTCALLALL to sum the
+ *   statistics of all the calls (maximum times are the
+ *   maximum among all the calls)
+ * - stats
+ *   pointer to the structure filled with the statistics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, or when call is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetLockStats (fmrtId, uint8_t, fmrtLockStats *);
+
+
+/***********************************************************
+ * fmrtGetGlobalLockStats()
+ * ---------------------------------------------------------
+ * This library call provides the statistics of the global
+ * lock, acquired by fmrtDefineTable(), fmrtClearTable(),
+ * fmrtGetTotalMemoryInfo(), fmrtEnableStats(),
+ * fmrtEnableLockStats() and fmrtDumpLockStats() (including
+ * the periodic dumps), in the same format of
+ * fmrtGetLockStats(). It takes the following parameters:
+ * - call
+ *   the library call acquiring the lock
+ *   (FMRTCALLDEFINETABLE, FMRTCALLCLEARTABLE,
+ *   FMRTCALLGETMEMORYINFO for fmrtGetTotalMemoryInfo(), or
+ *   FMRTCALLENABLESTATS for the calls enabling and dumping
+ *   statistics), or FMRTCALLALL to sum the statistics of
+ *   all of them
+ * - stats
+ *   pointer to the structure filled with the statistics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   call is not valid
+ ***********************************************************/
+fmrtResult fmrtGetGlobalLockStats (uint8_t, fmrtLockStats *);
+
+
+/***********************************************************
+ * fmrtDumpLockStats()
+ * ---------------------------------------------------------
+ * This library call prints the lock statistics (see
+ * fmrtGetLockStats()) of the global lock and of all the
+ * defined tables to a file, in CSV format: a comment line
+ * with the current time, a header line and one line for
+ * each lock and library call that acquired it at least
+ * once, with the following columns: lock ("global" or
+ * the tableId), table name, library call, acquisitions,
+ * contended acquisitions, total and max wait time, total
+ * and max hold time (in ns). Statistics are printed right
+ * away and, if a period is given, periodically until
+ * this call is invoked again: the periodic dump is printed
+ * by a thread started by this call, so that no library
+ * call pays for it. The global lock is held while the
+ * statistics are printed. It takes the following
+ * parameters:
+ * - filePtr
+ *   the output file. It shall be opened before calling this
+ *   function and, with periodic dumps, it shall not be
+ *   closed until periodic dumps are stopped. NULL stops the
+ *   periodic dumps without printing anything
+ * - period
+ *   interval between dumps (in seconds), 0 for a single
+ *   dump
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics printed and periodic dump (re)scheduled
+ * - FMRTKO
+ *   Statistics printed, but the thread printing the
+ *   periodic dump could not be started
+ ***********************************************************/
+fmrtResult fmrtDumpLockStats (FILE *, time_t);
+
+
+/***********************************************************
+ * fmrtGetMemoryInfo()
+ * ---------------------------------------------------------
+ * This library call provides a detailed breakdown of the
+ * memory used by a table, for capacity planning:
+ * - allocated: bytes currently allocated for the table,
+ *   i.e. the sum of descriptor, elements, stringHeap,
+ *   engine, indexes, expiry and stats
+ * - resident: allocated bytes actually resident in RAM,
+ *   i.e. in pages touched so far and not swapped out
+ * - descriptor: bytes of the internal table descriptor
+ * - elements: bytes of the array of elements (0 until the
+ *   first insertion), which is split into live (elements
+ *   holding entries), freeList (elements released and
+ *   available for reuse) and unused (elements never used
+ *   so far, usually not resident)
+ * - padding: bytes of the elements lost to alignment (see
+ *   fmrtDefineLayout())
+ * - stringHeap, stringLive: size of the string heap and
+ *   bytes of the live strings it holds (see
+ *   fmrtDefineStringHeap())
+ * - engine: B+-tree nodes or hash slots (see
+ *   fmrtDefineEngine())
+ * - indexes: secondary indexes (see fmrtDefineIndex())
+ * - expiry: timer wheel (see fmrtDefineExpiry())
+ * - stats: statistics shards (see fmrtEnableStats())
+ * - transient: estimated peak of the temporary buffers
+ *   allocated by a single library call on the table in its
+ *   current state (traversal stack, export and import
+ *   buffers). They are not included in allocated
+ * - elemSize: bytes taken by each element
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - info
+ *   pointer to the structure filled with the information
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Information provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetMemoryInfo (fmrtId, fmrtMemoryInfo *);
+
+
+/***********************************************************
+ * fmrtGetTotalMemoryInfo()
+ * ---------------------------------------------------------
+ * This library call provides the memory used by all the
+ * tables defined, in the same format of fmrtGetMemoryInfo().
+ * Each item is the sum of the items of the tables, except
+ * elemSize, which is set to 0, and descriptor, which also
+ * accounts the map of the defined tables. It takes just
+ * one parameter:
+ * - info
+ *   pointer to the structure filled with the information
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Information provided
+ ***********************************************************/
+fmrtResult fmrtGetTotalMemoryInfo (fmrtMemoryInfo *);
+
+
+/***********************************************************
+ * fmrtSetMemoryBudget()
+ * ---------------------------------------------------------
+ * This library call sets a budget for the memory allocated
+ * by all the tables of the process, so that an oversized
+ * configuration is detected when tables are defined,
+ * rather than when they are filled. Each table is charged
+ * with the memory it allocates (see fmrtGetMemoryInfo(),
+ * descriptors excluded) or, if greater, with the memory
+ * reserved for it (see fmrtReserveMemory()); the array of
+ * elements, allocated at the first insertion, is charged
+ * since the table is defined, according to the element
+ * size defined so far. Calls that would exceed the budget
+ * fail with FMRTOUTOFMEMORY: fmrtDefineTable(),
+ * fmrtDefineFields(), fmrtDefineAggregate(),
+ * fmrtDefineEviction(), fmrtDefineLayout(),
+ * fmrtDefineEngine(), fmrtDefineIndex(),
+ * fmrtDefineExpiry(), fmrtReserveMemory() and insertions
+ * allocating the array of elements or growing the nodes of
+ * the B+-tree engine, as well as write operations growing
+ * the string heap (see fmrtDefineStringHeap()), which leave
+ * the element untouched. Temporary buffers allocated by
+ * the library calls are not charged. It takes just one
+ * parameter:
+ * - budget
+ *   max number of bytes, 0 to remove the budget (default)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Budget set
+ * - FMRTOUTOFMEMORY
+ *   The memory already charged to the tables exceeds the
+ *   budget, which is not changed
+ ***********************************************************/
+fmrtResult fmrtSetMemoryBudget (uint64_t);
+
+
+/***********************************************************
+ * fmrtReserveMemory()
+ * ---------------------------------------------------------
+ * This library call reserves part of the memory budget (see
+ * fmrtSetMemoryBudget()) for a table, which is charged with
+ * the memory reserved until it allocates more than that.
+ * Therefore the table can grow up to its reservation (e.g.
+ * B+-tree nodes, string heap) even when the other tables
+ * have exhausted the budget. Reservations are accounted
+ * whether a budget is set or not. It takes the following
+ * parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - bytes
+ *   memory reserved for the table, 0 to cancel the
+ *   reservation
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Memory reserved
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   The reservation would exceed the memory budget, the
+ *   previous reservation is kept
+ ***********************************************************/
+fmrtResult fmrtReserveMemory (fmrtId, uint64_t);
+
+
+/***********************************************************
+ * fmrtGetMemoryBudget()
+ * ---------------------------------------------------------
+ * This library call provides the memory budget (see
+ * fmrtSetMemoryBudget()) and the memory charged to all the
+ * tables against it. It takes the following parameters:
+ * - budget
+ *   pointer to the budget (0 if no budget is set)
+ * - committed
+ *   pointer to the memory charged to the tables
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Values provided
+ ***********************************************************/
+fmrtResult fmrtGetMemoryBudget (uint64_t *, uint64_t *);
+
+
 #ifdef __cplusplus
 } //end extern "C"
 #endif
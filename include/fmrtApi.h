@@ -48,20 +48,85 @@
 //#define FMRTDEBUG
 #define FMRTDEBUGLIMIT           100    /* Debug printouts are obtained only if the number of elements is less than FMRTDEBUGLIMIT */
 
+/* Uncomment the following line (or build with "make trace") to compile in the static tracepoints. They are USDT  */
+/* probes of provider libfmrt (see sys/sdt.h), which cost a nop when no tracer is attached and can be attached  */
+/* in production by perf or bpftrace (e.g. bpftrace -e 'usdt:./libfmrt.so:libfmrt:search__end { ... }'):        */
+/* - search__start   (tableId, keyHash)                      - search__end       (tableId, keyHash, res, ns)    */
+/* - insert          (tableId, keyHash, index, entries)      - delete            (tableId, keyHash, index)      */
+/* - rotate          (tableId, index, op, double)            - freelist__exhausted (tableId, maxElem)           */
+/* - import__line    (tableId, line, updated)                - export__start     (tableId, entries)             */
+/* - export__done    (tableId, res, ns)                                                                         */
+/* keyHash is the hash of the key (see traceKeyHash()), ns the latency of the operation                         */
+/* sys/sdt.h is provided by the systemtap SDT headers (package systemtap-sdt-dev on Debian/Ubuntu,              */
+/* systemtap-sdt-devel on Fedora/RHEL), which are needed only to build with FMRTTRACE. Probes have semaphores,  */
+/* incremented by the tracer while attached, so that keyHash and latencies are computed only when a probe is   */
+/* enabled (see FMRTPROBEENABLED())                                                                            */
+//#define FMRTTRACE
+#ifdef FMRTTRACE
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define FMRTPROBESEMAPHORE(name)        __extension__ unsigned short libfmrt_##name##_semaphore __attribute__ ((unused)) __attribute__ ((section (".probes")))
+#define FMRTPROBEENABLED(name)          __builtin_expect (libfmrt_##name##_semaphore, 0)
+#define FMRTPROBE2(name,a1,a2)          DTRACE_PROBE2 (libfmrt, name, a1, a2)
+#define FMRTPROBE3(name,a1,a2,a3)       DTRACE_PROBE3 (libfmrt, name, a1, a2, a3)
+#define FMRTPROBE4(name,a1,a2,a3,a4)    DTRACE_PROBE4 (libfmrt, name, a1, a2, a3, a4)
+#else
+#define FMRTPROBEENABLED(name)          0
+#define FMRTPROBE2(name,a1,a2)          ((void) 0)
+#define FMRTPROBE3(name,a1,a2,a3)       ((void) 0)
+#define FMRTPROBE4(name,a1,a2,a3,a4)    ((void) 0)
+#endif
+
 /* Some libfmrt limits */
-#define MAXTABLES                 32    /* Max number of AVL Tree tables                    */
+#define MAXTABLES             65536    /* Max number of tables (range of fmrtId)           */
+#ifdef FMRTINDEX64
+#define MAXFMRTELEM 1099511627776ULL    /* Max Number Elements in table = 2^40              */
+#else
 #define MAXFMRTELEM         67108864    /* Max Number Elements in table = 2^26              */
+#endif
 #define MAXFMRTFIELDNUM           16    /* Max num of fieds for each table                  */
+#define MAXFMRTINDEXES             4    /* Max num of secondary indexes for each table      */
+#define MAXFMRTKEYCOMPS            4    /* Max num of components of composite keys          */
 #define MAXFMRTTABLENAME          32    /* Max Length for table name                        */
 #define MAXFMRTNAMELEN            16    /* Max length for key/field name                    */
 #define MAXFMRTSTRINGLEN         255    /* Max length for string data (excluding trailing 0 */
 #define MAXCSVLINELEN           1200    /* Max allowed length for lines in CSV files        */
+#define MAXFMRTROWLEN   ((MAXFMRTFIELDNUM+1)*(MAXFMRTSTRINGLEN+2))   /* Max length of a formatted row */
+#define FMRTNOAGGREGATE          255    /* Value of aggField when no aggregate is defined   */
+#define FMRTWHEELSIZE           1024    /* Number of 1 second slots in the expiry wheel     */
+#define FMRTEXPIRING      ((time_t)-1)  /* Deadline of elements waiting to be removed       */
+#define FMRTSTRINGSLOT            16    /* Size of string fields when string heap is enabled */
+#define FMRTHEAPTAG             0xFF    /* Tag of string slots whose string is in the heap  */
+#define FMRTHEAPMINSIZE         4096    /* Minimum growth of the string heap (bytes)        */
+#ifdef FMRTINDEX64
+#define FMRTBTREEMINNODE          96    /* Minimum size of the nodes of the B+-tree (bytes) */
+#else
+#define FMRTBTREEMINNODE          64    /* Minimum size of the nodes of the B+-tree (bytes) */
+#endif
+#define FMRTBTREEMINALLOC         16    /* Minimum growth of the B+-tree nodes pool         */
+#define FMRTHASHMINSLOTS          16    /* Minimum number of slots of the hash index        */
+#define FMRTFNVOFFSET   0xCBF29CE484222325ULL   /* FNV-1a offset basis (64 bits)            */
+#define FMRTFNVPRIME    0x00000100000001B3ULL   /* FNV-1a prime (64 bits)                   */
+#define FMRTSTATSHARDS            16    /* Per-thread shards of the statistics of a table   */
 
 /* Used in traversal node LIFO structure to indicate the path to the next node              */
 #define LEFT                      -1    /* Used to identify LEFT subtree                    */
 #define STAY                       0    /* This is the node we were looking for             */
 #define RIGHT                      1    /* Used to identify RIGHT subtree                   */
 
+/* Operations triggering the rotations counted by rebalanceSubTree() (see fmrtGetTreeInfo())  */
+#define FMRTROTINSERT              0    /* Rebalancing after an insertion                   */
+#define FMRTROTDELETE              1    /* Rebalancing after a deletion                     */
+#define FMRTMAXHEIGHT             64    /* Max height of AVL trees walked iteratively       */
+
+/* Search modes used by searchNearest() */
+#define NEARESTFLOOR               0    /* Greatest key lower than or equal to given key    */
+#define NEARESTCEIL                1    /* Lowest key greater than or equal to given key    */
+#define NEARESTPREV                2    /* Greatest key strictly lower than given key       */
+#define NEARESTNEXT                3    /* Lowest key strictly greater than given key       */
+#define NEARESTMIN                 4    /* Lowest key in the table                          */
+#define NEARESTMAX                 5    /* Greatest key in the table                        */
+
 /* Possible statuses of a fmrtTableItem */
 #define FREE                       0    /* Available for allocation to new table            */
 #define DEFINED                    1    /* Table defined, key/fields still missing          */
@@ -69,6 +134,21 @@
 #define FIELDSDEFINED              3    /* Fields defined, table still empty                */
 #define NOTEMPTY                   4    /* At least one element in the AVL Tree             */
 
+/* Alignment of fields and trailers within elements */
+#define FMRTMAXALIGN               8    /* Max alignment required by field types            */
+#define FMRTCACHELINE             64    /* Cache line size, used with FMRTLAYOUTPADDED      */
+#define FMRTALIGN(x,a)        ( ((x)+(a)-1) & ~((a)-1) )
+
+/* Three-way comparison of two scalar values (-1, 0 or 1), safe against overflow and truncation */
+#define FMRTCOMPARE(a,b)      ( ((a)>(b)) - ((a)<(b)) )
+
+/* Atomic increment of the counters of the statistics shards (see recordStats()) */
+#define FMRTSTATINC(x)        __atomic_fetch_add (&(x), 1, __ATOMIC_RELAXED)
+#define FMRTSTATADD(x,v)      __atomic_fetch_add (&(x), (v), __ATOMIC_RELAXED)
+
+/* Sign bit of 64 bits values, flipped to map signed values onto ordered unsigned keys */
+#define FMRTSIGNBIT           ( (uint64_t)1 << 63 )
+
 /* Default time format for FMRTTIMESTAMP type */
 //#define FMRTTIMEFORMAT            ""    /* Dafault value is empty string, i.e. time_stamp printed in raw format */
 #define FMRTTIMEFORMAT            "%c"    /* Dafault value is preferred date and time representation for the current locale */
@@ -86,26 +166,170 @@ typedef struct field
     uint16_t        delta;
 } fmrtField;
 
+/* Per-subtree aggregate values stored into each node (see fmrtDefineAggregate()) */
+typedef struct nodeAggregate
+{
+    double          sum,
+                    min,
+                    max;
+    fmrtIndex       count;
+} fmrtNodeAggregate;
+
+/* Per-node expiry information stored into each node (see fmrtDefineExpiry()) */
+typedef struct nodeExpiry
+{
+    time_t          deadline;           /* 0 means that the element never expires   */
+    fmrtIndex       prev,               /* Links in the list of the timer wheel     */
+                    next;               /* slot the element belongs to              */
+} fmrtNodeExpiry;
+
+/* String slot used for FMRTSTRING fields when string heap is enabled (see fmrtDefineStringHeap()) */
+/* Strings shorter than FMRTSTRINGSLOT are stored inline, longer ones are stored in the heap       */
+typedef union stringSlot
+{
+    char            inlined[FMRTSTRINGSLOT];
+    struct
+    {
+        uint32_t    offset,             /* Offset of the string in the heap         */
+                    len;                /* String length (excluding trailing 0)     */
+        uint8_t     unused[FMRTSTRINGSLOT-2*sizeof(uint32_t)-1],
+                    tag;                /* FMRTHEAPTAG for strings in the heap      */
+    } heap;
+} fmrtStringSlot;
+
+/* Header of the nodes of the B+-tree engine (see fmrtDefineEngine()). It is followed by the  */
+/* normalized keys, by the indexes of the corresponding elements and, in internal nodes, by   */
+/* the indexes of the children                                                                */
+typedef struct btNode
+{
+    uint16_t        count;              /* Number of keys in the node               */
+    uint8_t         leaf;               /* 1 for leaves, 0 for internal nodes       */
+    uint8_t         unused;
+    fmrtIndex       prev,               /* Sibling leaves, next also links free     */
+                    next;               /* nodes                                    */
+} fmrtBtNode;
+
+/* Offset of the keys within the nodes of the B+-tree */
+#define FMRTBTHEADER          FMRTALIGN (sizeof(fmrtBtNode), sizeof(uint64_t))
+
+/* Slot of the index of the hash engine (see fmrtDefineEngine()) */
+typedef struct hashSlot
+{
+    fmrtIndex       elem;               /* Index of the element                     */
+    fmrtIndex       hash;               /* Hash of its key, 0 for empty slots       */
+} fmrtHashSlot;
+
+/* Node of a secondary index (see fmrtDefineIndex()). Nodes are stored in an array parallel */
+/* to the array of elements, i.e. each element is represented by the node with its index     */
+typedef struct indexNode
+{
+    uint64_t        value;              /* Normalized value of the indexed field    */
+    fmrtIndex       left,               /* Links of the treap                       */
+                    right,
+                    parent;
+    uint32_t        priority;           /* Heap priority of the treap               */
+} fmrtIndexNode;
+
+/* Secondary index on a field, i.e. a treap of the elements ordered by field value */
+typedef struct secondaryIndex
+{
+    uint8_t         field,              /* Position of the field in fields[]        */
+                    unique;             /* 1 if values cannot be duplicated         */
+    fmrtIndex       root;
+    fmrtIndexNode  *nodes;
+} fmrtSecondaryIndex;
+
+/* Shard of the statistics of a table (see fmrtGetStats()), padded to cache lines to avoid */
+/* false sharing between threads updating different shards                                 */
+typedef union statsShard
+{
+    fmrtStats       stats;
+    uint8_t         pad[FMRTALIGN(sizeof(fmrtStats),FMRTCACHELINE)];
+} fmrtStatsShard;
+
+/* Internal structure holding a key value, only the member matching key type is meaningful */
+typedef struct keyValue
+{
+    uint32_t        keyInt;
+    int32_t         keySigned;
+    double          keyDouble;
+    char            keyChar,
+                    keyString[MAXFMRTSTRINGLEN+1];
+    time_t          keyTimestamp;
+} fmrtKeyValue;
+
 /* Set of information stored internally for each table */
 typedef struct tableItem
 {
     fmrtId          tableId;
     uint8_t         status,
-                    numFields;
+                    numFields,
+                    aggField,
+                    layout,
+                    stringHeap,
+                    frozen;
     char            tableName[MAXFMRTTABLENAME+1];
     fmrtIndex       tableMaxElem,
                     currentNumElem,
                     fmrtRoot,
                     fmrtFree,
+                    fmrtUnused,
                     fifoSize,
                     fifoIn,
                     fifoOut,
-                   *fifo;
+                   *fifo,
+                   *wheel,
+                    clockHand;
+    time_t          defaultTtl,
+                    lastSweep;
     fmrtField       key,
                     fields[MAXFMRTFIELDNUM];
-    uint16_t        elemSize;
+    uint8_t         numKeyComps;
+    fmrtField       keyComps[MAXFMRTKEYCOMPS];
+    uint16_t        elemSize,
+                    fieldsDelta,
+                    fieldsLen,
+                    aggDelta,
+                    expDelta,
+                    refDelta;
+    uint8_t         engine,
+                    btHeight;
+    uint16_t        btNodeSize,
+                    btFanout;
+    fmrtIndex       btRoot,
+                    btFirst,
+                    btLast,
+                    btFree,
+                    btUnused,
+                    btNumNodes,
+                    btMaxNodes;
+    void           *btNodes,
+                   *btScratch;
+    fmrtHashSlot   *hashSlots;
+    fmrtIndex       hashMask;
+    uint8_t         numIndexes;
+    fmrtSecondaryIndex indexes[MAXFMRTINDEXES];
+    uint8_t         evictMode;
+    char            evictSep;
+    fmrtEvictSink   evictSink;
+    void           *evictData;
+    uint64_t        hits,
+                    misses,
+                    evictions;
+    fmrtStatsShard *stats;
+    uint64_t        rotations[2][2];    /* Single and double rotations after inserts/deletes */
+    fmrtLockStats  *lockStats;          /* Per-call lock statistics, NULL until enabled     */
+    uint64_t        lockSince;          /* Acquisition time of tableMtx (ns), 0 if untimed  */
+    uint8_t         lockCall;           /* Library call holding tableMtx (FMRTCALL...)      */
+    uint64_t        memCommitted,       /* Memory charged against the budget (admitMemory()) */
+                    memReserved;        /* Memory reserved through fmrtReserveMemory()       */
+    char           *strHeap;
+    uint32_t        heapSize,
+                    heapUsed,
+                    heapLive;
     pthread_mutex_t tableMtx;
     void           *fmrtData,
+                   *fmrtPayload,
                    *row;
 } fmrtTableItem;
 
@@ -35,6 +35,7 @@
  * Linux system files *
  **********************/
 #define _XOPEN_SOURCE 500   /* glibc (2.12 or above) needs this for proper handling of strptime() */
+#define _DEFAULT_SOURCE     /* glibc needs this for madvise() flags, hidden by _XOPEN_SOURCE       */
 
 #include <stdio.h>
 #include <stdint.h>
@@ -42,6 +43,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
 
 
 /************************
@@ -55,5084 +59,13738 @@
  * Global private variables *
  ****************************/
 static uint8_t          fmrtFirstInvocation = 1;
-static fmrtTableItem    Tables[MAXTABLES];
+static fmrtTableItem   *Tables = NULL;
+static uint64_t         fmrtTableMap[MAXTABLES/64];
 static pthread_mutex_t  fmrtGlobalMtx = PTHREAD_MUTEX_INITIALIZER;
 static char             fmrtTimeFormat[MAXFMRTSTRINGLEN] = FMRTTIMEFORMAT;
+static uint8_t          fmrtStatsEnabled = 0;
+static uint32_t         fmrtStatsNextShard = 0;
+static __thread int16_t fmrtStatsThreadShard = -1;
+static uint8_t          fmrtLockStatsEnabled = 0;
+static fmrtLockStats    fmrtGlobalLockStats[FMRTCALLS];
+static uint64_t         fmrtGlobalLockSince = 0;
+static uint8_t          fmrtGlobalLockCall = 0;
+static pthread_mutex_t  fmrtLockDumpCallMtx = PTHREAD_MUTEX_INITIALIZER,
+                        fmrtLockDumpMtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   fmrtLockDumpCond = PTHREAD_COND_INITIALIZER;
+static pthread_t        fmrtLockDumpThread;
+static uint8_t          fmrtLockDumpRunning = 0;
+static FILE            *fmrtLockDumpFile = NULL;
+static time_t           fmrtLockDumpPeriod = 0;
+static pthread_mutex_t  fmrtMemoryMtx = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t         fmrtMemoryBudget = 0,
+                        fmrtMemoryCommitted = 0;
+#ifdef FMRTTRACE
+/* Semaphores of the static tracepoints (see FMRTPROBEENABLED()) */
+FMRTPROBESEMAPHORE (search__start);
+FMRTPROBESEMAPHORE (search__end);
+FMRTPROBESEMAPHORE (insert);
+FMRTPROBESEMAPHORE (delete);
+FMRTPROBESEMAPHORE (rotate);
+FMRTPROBESEMAPHORE (freelist__exhausted);
+FMRTPROBESEMAPHORE (import__line);
+FMRTPROBESEMAPHORE (export__start);
+FMRTPROBESEMAPHORE (export__done);
+#endif
+static const char      *fmrtCallNames[FMRTCALLS] =
+{
+    "fmrtDefineTable",
+    "fmrtClearTable",
+    "fmrtDefineKey",
+    "fmrtDefineCompositeKey",
+    "fmrtDefineFields",
+    "fmrtRead",
+    "fmrtCreate",
+    "fmrtModify",
+    "fmrtCreateModify",
+    "fmrtDelete",
+    "fmrtImportTableCsv",
+    "fmrtExportTableCsv",
+    "fmrtExportRangeCsv",
+    "fmrtCountEntries",
+    "fmrtDefineAggregate",
+    "fmrtAggregateRange",
+    "fmrtFloor",
+    "fmrtCeil",
+    "fmrtPrev",
+    "fmrtNext",
+    "fmrtMin",
+    "fmrtMax",
+    "fmrtPrefixScan",
+    "fmrtDefineExpiry",
+    "fmrtSetExpiry",
+    "fmrtExpire",
+    "fmrtDefineEviction",
+    "fmrtGetCacheStats",
+    "fmrtDefineLayout",
+    "fmrtDefineStringHeap",
+    "fmrtCompactStringHeap",
+    "fmrtFreeze",
+    "fmrtThaw",
+    "fmrtCompact",
+    "fmrtDefineEngine",
+    "fmrtDefineIndex",
+    "fmrtReadByIndex",
+    "fmrtExportIndexRangeCsv",
+    "fmrtGetTreeInfo",
+    "fmrtGetMemoryInfo",
+    "fmrtReserveMemory",
+    "fmrtEnableStats"
+};
 
 
-/*******************************
- * Debug Functions             *
- * --------------------------- *
- * They can be used for debug  *
- * purposes. Just add the      *
- * corresponding prototype into*
- * the calling source code and *
- * invoke them whenever needed *
- * to print relevant infos     *
- * To use the following        *
- * functions, macro FMRTDEBUG  *
- * must be enabled in fmrtApi.h*
- *******************************/
-#ifdef FMRTDEBUG
 /***********************************************************
- * __fmrtDebugPrintStructure()
+ * registryReady()
  * ---------------------------------------------------------
- * Internal function useful for debugging library
- * The prototype shall be added to the caller
- * When invoked, it prints the structure of the Table[]
- * element whose tableId is specified as a parameter
+ * This function tells whether the address space of
+ * Tables[] has been reserved, i.e. whether a table has ever
+ * been defined. fmrtFirstInvocation is cleared with a
+ * release store by fmrtDefineTable() once Tables is set,
+ * hence the acquire load makes Tables visible to threads
+ * not holding the global lock
  ***********************************************************/
-fmrtResult __fmrtDebugPrintStructure (fmrtId tableId)
+static uint8_t registryReady (void)
 {
-    /* Local Variables */
-    uint8_t     i,j;
+    return (__atomic_load_n (&fmrtFirstInvocation, __ATOMIC_ACQUIRE) == 0);
+}
 
-    /* If this is the first invocation of the library provide error and exit */
-    if (fmrtFirstInvocation)
-        return (FMRTKO);
 
-    /* Search for the table with given tableId */
-    for (i=0; (i<MAXTABLES)&&(Tables[i].tableId != tableId); i++)
+/***********************************************************
+ * tableDefined()
+ * ---------------------------------------------------------
+ * This function tells whether the table whose index is
+ * given as a parameter is defined, looking at the map of
+ * the defined tables rather than at its descriptor, whose
+ * pages are not accessible until the table is defined (see
+ * commitDescriptor()). The bit of a table is set with a
+ * release store by fmrtDefineTable() once its descriptor is
+ * initialized, hence the acquire load makes the descriptor
+ * visible to threads not holding the global lock
+ ***********************************************************/
+static uint8_t tableDefined (uint32_t i)
+{
+    return ( (__atomic_load_n (&(fmrtTableMap[i>>6]), __ATOMIC_ACQUIRE) >> (i&63)) & 1 );
+}
+
 
-    /* If not found provide an error */
-    if ( (i==MAXTABLES) || (Tables[i].status==FREE) )
-        return (FMRTIDNOTFOUND);
+/***********************************************************
+ * commitDescriptor()
+ * ---------------------------------------------------------
+ * Tables[] is reserved without access rights, so that the
+ * memory of the descriptors is neither allocated nor
+ * committed until used. This function makes accessible the
+ * pages holding the descriptor whose index is given as a
+ * parameter, when the table is defined. The global lock
+ * shall be held by the caller
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   The descriptor can be used
+ * - FMRTOUTOFMEMORY
+ *   The pages cannot be committed
+ ***********************************************************/
+static fmrtResult commitDescriptor (fmrtId i)
+{
+    /* Local Variables */
+    uintptr_t   page = sysconf (_SC_PAGESIZE),
+                start = (uintptr_t) &(Tables[i]) & ~(page-1),
+                end = ((uintptr_t) &(Tables[i+1]) + page-1) & ~(page-1);
 
-    /* Print on the screen all Table[] parameters */
-    printf ("Table Name: %s (Id: %d)\n",Tables[i].tableName,Tables[i].tableId);
-    printf ("\tMax Num Elems: %d - Element Size: %d bytes\n",Tables[i].tableMaxElem,Tables[i].elemSize);
-    printf ("\tCurrent AVL Tree Root Index: %d\n",Tables[i].fmrtRoot);
-    printf ("\tKey (Name: %s - Type: %d - Len: %d - Delta: %d\n",Tables[i].key.name, Tables[i].key.type, Tables[i].key.len, Tables[i].key.delta);
-    for (j=0; j<Tables[i].numFields; j++)
-        printf ("\tField: %d (Name: %s - Type: %d - Len: %d - Delta: %d\n",j,Tables[i].fields[j].name, Tables[i].fields[j].type, Tables[i].fields[j].len, Tables[i].fields[j].delta);
+    if (mprotect ((void *) start, end-start, PROT_READ|PROT_WRITE) != 0)
+        return (FMRTOUTOFMEMORY);
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * __fmrtDebugPrintNode()
+ * releaseDescriptor()
  * ---------------------------------------------------------
- * Internal function useful for debugging library
- * The prototype shall be added to the caller
- * When invoked, it prints the content of the fmrt tree
- * element whose tableId and index are given as parameters
+ * This function gives back to the system the pages holding
+ * the descriptor whose index is given as a parameter (see
+ * commitDescriptor()), once the table is cleared. Pages
+ * shared with the descriptor of a defined table are kept.
+ * Released pages are replaced by new inaccessible ones,
+ * zero-filled when committed again. The global lock shall
+ * be held by the caller
  ***********************************************************/
-fmrtResult __fmrtDebugPrintNode (fmrtId tableId, fmrtIndex index)
+static void releaseDescriptor (fmrtId i)
 {
     /* Local Variables */
-    uint8_t     i,j;
-    fmrtIndex    leftPtr, rightPtr;
-    void        *currentPtr;
-
-    /* If this is the first invocation of the library provide error and exit */
-    if (fmrtFirstInvocation)
-        return (FMRTKO);
-
-    /* Search for the table with given tableId */
-    for (i=0; (i<MAXTABLES)&&(Tables[i].tableId != tableId); i++)
+    uintptr_t   page = sysconf (_SC_PAGESIZE),
+                base = (uintptr_t) Tables,
+                p;
+    uint32_t    j,
+                last;
+    uint8_t     shared;
+
+    for (p = (uintptr_t) &(Tables[i]) & ~(page-1); p < (uintptr_t) &(Tables[i+1]); p += page)
+    {
+        /* Descriptors lying (even partially) in the page */
+        j = (p>base) ? (p-base)/sizeof(fmrtTableItem) : 0;
+        last = (p+page-1-base)/sizeof(fmrtTableItem);
+        for (shared=0; (j<=last)&&(j<MAXTABLES)&&(!shared); j++)
+            shared = (j!=i) && (tableDefined(j));
+        if (!shared)
+            mmap ((void *) p, page, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE|MAP_FIXED, -1, 0);
+    }
 
-    /* If not found provide an error */
-    if ( (i==MAXTABLES) || (Tables[i].status==FREE) )
-        return (FMRTIDNOTFOUND);
+    return;
+}
 
-    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
-    if (Tables[i].fmrtData==NULL)
-        return (FMRTNOTFOUND);
 
-    /* This points to the first byte of the structure that contains the given index */
-    currentPtr = Tables[i].fmrtData + index*Tables[i].elemSize;
+/***********************************************************
+ * fieldsOf()
+ * ---------------------------------------------------------
+ * This function provides the base pointer to be used to
+ * access the fields of the element pointed by the second
+ * parameter (i.e. field j is at fieldsOf()+fields[j].delta).
+ * With the default layout, fields are stored in the element
+ * itself, right after the key; with the split layout (see
+ * fmrtDefineLayout()) they are stored in a parallel payload
+ * array, addressed by the same index of the element
+ ***********************************************************/
+static void *fieldsOf (fmrtId tableIndex, void *currentPtr)
+{
+    /* Local Variables */
+    fmrtIndex   index;
 
-    /* Print first pointers and related data */
-    leftPtr = *((fmrtIndex *) currentPtr);
-    rightPtr = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-    printf ("AVL Tree Table %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
-    printf ("\tLeft Ptr: %d - Right Ptr: %d\n",leftPtr, rightPtr);
+    if (!(Tables[tableIndex].layout & FMRTLAYOUTSPLIT))
+        return (currentPtr);
 
-    /* Then print the key */
-    printf ("\tKey (%s): ",Tables[i].key.name);
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            printf ("%d\n",*((uint32_t *)(currentPtr+Tables[i].key.delta)));
-            break;
-        }   /* case FMRTINT */
-        case FMRTSIGNED:
-        {
-            printf ("%d\n",*((int32_t *)(currentPtr+Tables[i].key.delta)));
-            break;
-        }   /* case FMRTSIGNED */
-        case FMRTDOUBLE:
-        {
-            printf ("%lf\n",*((double *)(currentPtr+Tables[i].key.delta)));
-            break;
-        }   /* case FMRTDOUBLE */
-        case FMRTCHAR:
-        {
-            printf ("%c\n",*((char *)(currentPtr+Tables[i].key.delta)));
-            break;
-        }   /* case FMRTCHAR */
-        case FMRTSTRING:
-        {
-            printf ("%s\n",(char *)(currentPtr+Tables[i].key.delta));
-            break;
-        }   /* case FMRTSTRING */
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> print raw timestamp */
-                printf ("%ld\n",*((time_t *)(currentPtr+Tables[i].key.delta)));
-            else
-            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                char  timestamp[MAXFMRTSTRINGLEN+1];
-                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[i].key.delta)));
-                printf ("%s\n",timestamp);
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
+    index = (currentPtr - Tables[tableIndex].fmrtData) / Tables[tableIndex].elemSize;
+    return (Tables[tableIndex].fmrtPayload + index*Tables[tableIndex].fieldsLen - Tables[tableIndex].fieldsDelta);
+}
 
-    /* Then print all fields */
-    for (j=0; j<Tables[i].numFields; j++)
-    {
-        printf ("\tField %d (%s): ",j,Tables[i].fields[j].name);
-        switch (Tables[i].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                printf ("%d\n",*((uint32_t *)(currentPtr+Tables[i].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                printf ("%d\n",*((int32_t *)(currentPtr+Tables[i].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                printf ("%lf\n",*((double *)(currentPtr+Tables[i].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                printf ("%c\n",*((char *)(currentPtr+Tables[i].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                printf ("%s\n",(char *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    printf ("%ld\n",*((time_t *)(currentPtr+Tables[i].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[i].fields[j].delta)));
-                    printf ("%s\n",timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
 
-    return (FMRTOK);
+/***********************************************************
+ * heapField()
+ * ---------------------------------------------------------
+ * This function tells whether field j (second parameter) of
+ * the table whose index is given by the first parameter is
+ * stored in the string heap (see fmrtDefineStringHeap()).
+ * This holds for FMRTSTRING fields longer than a string
+ * slot, when the string heap is enabled
+ ***********************************************************/
+static uint8_t heapField (fmrtId tableIndex, uint8_t j)
+{
+    return ( (Tables[tableIndex].stringHeap) &&
+             (Tables[tableIndex].fields[j].type==FMRTSTRING) &&
+             (Tables[tableIndex].fields[j].len>FMRTSTRINGSLOT) );
 }
 
 
 /***********************************************************
- * __fmrtDebugPrintTreeRecurse()
+ * fieldString()
  * ---------------------------------------------------------
- * Internal function useful for debugging library
- * It is called by __fmrtDebugPrintTree() to implement
- * recursion
+ * This function provides a pointer to the value of the
+ * FMRTSTRING field j (third parameter) of the element whose
+ * fields are pointed by the second parameter (see
+ * fieldsOf()). With the string heap, short strings are
+ * stored inline in the string slot, while longer strings
+ * are stored in the heap. The pointer is valid until the
+ * next write operation on the table
  ***********************************************************/
-static void __fmrtDebugPrintTreeRecurse (uint8_t tableIndex, fmrtIndex nodeIndex)
+static char *fieldString (fmrtId tableIndex, void *fieldsPtr, uint8_t j)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex;
-    void        *currentPtr;
+    fmrtStringSlot  *slot;
 
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
+    slot = (fmrtStringSlot *) (fieldsPtr+Tables[tableIndex].fields[j].delta);
+    if ( (heapField(tableIndex,j)) && (slot->heap.tag==FMRTHEAPTAG) )
+        return (Tables[tableIndex].strHeap + slot->heap.offset);
 
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    return ((char *) slot);
+}
 
-    /* Left and Right subtree indexes */
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
 
-    /* In-order traversal -> First left subtree... */
-    __fmrtDebugPrintTreeRecurse (tableIndex,leftIndex);
+/***********************************************************
+ * residentBytes()
+ * ---------------------------------------------------------
+ * This function provides how many bytes of the memory area
+ * given by the parameters are resident in RAM, i.e. the
+ * pages of the area that have been touched and not swapped
+ * out, as reported by mincore(). The result is rounded to
+ * pages, but it never exceeds the size of the area
+ ***********************************************************/
+static uint64_t residentBytes (void *ptr, size_t len)
+{
+    /* Local Variables */
+    uintptr_t       begin,
+                    end;
+    size_t          pageSize,
+                    pages,
+                    k;
+    unsigned char  *vec;
+    uint64_t        bytes = 0;
+
+    if ( (ptr==NULL) || (len==0) )
+        return (0);
 
-    /* In-order traversal -> ... then current node... */
-    printf ("%s: ",Tables[tableIndex].key.name);
-    switch (Tables[tableIndex].key.type)
-    {
-        case FMRTINT:
-        {
-            printf ("%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTINT */
-        case FMRTSIGNED:
-        {
-            printf ("%d\n",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTSIGNED */
-        case FMRTDOUBLE:
-        {
-            printf ("%lf\n",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTDOUBLE */
-        case FMRTCHAR:
-        {
-            printf ("%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTCHAR */
-        case FMRTSTRING:
-        {
-            printf ("%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
-            break;
-        }   /* case FMRTSTRING */
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> print raw timestamp */
-                printf ("%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            else
-            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                char  timestamp[MAXFMRTSTRINGLEN+1];
-                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                printf ("%s",timestamp);
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
-    printf ("\t(Node Index: %d - Left Ptr: %d - Right Ptr: %d)\n",nodeIndex, leftIndex, rightIndex);
+    pageSize = (size_t) sysconf (_SC_PAGESIZE);
+    begin = (uintptr_t) ptr & ~(uintptr_t)(pageSize-1);
+    end = (uintptr_t) ptr + len;
+    pages = (end-begin+pageSize-1) / pageSize;
+    if ( (vec=(unsigned char *) malloc(pages))==NULL )
+        return (0);
 
-    /* In-order traversal -> ... last right subtree */
-    __fmrtDebugPrintTreeRecurse (tableIndex,rightIndex);
+    if (mincore ((void *) begin, end-begin, vec)==0)
+        for (k=0; k<pages; k++)
+            if (vec[k] & 1)
+                bytes += pageSize;
+    free (vec);
 
-    return;
+    return ( (bytes<len) ? bytes : len );
 }
 
 
 /***********************************************************
- * __fmrtDebugPrintTree()
+ * memoryInfo()
  * ---------------------------------------------------------
- * Internal function useful for debugging library
- * The prototype shall be added to the caller
- * When invoked, it prints the whole tree using an in-order
- * approach (left subtree -> node -> right subtree)
- * To achieve this result, it uses the previous function
- * __fmrtDebugPrintTreeRecurse()
+ * This function fills the structure given by the second
+ * parameter with the memory used by the table given by the
+ * first one (see fmrtGetMemoryInfo()). Element arrays are
+ * accounted only once they are allocated (first insertion),
+ * while temporary buffers are estimated from the current
+ * size of the table: the traversal stack of a search, the
+ * FIFO of an optimized export (AVL engine) or the sorting
+ * buffers of an export (hash engine), and the row buffer
+ * of an import. Resident bytes are evaluated only if the
+ * last parameter is not 0. The table lock shall be held by
+ * the caller
  ***********************************************************/
-fmrtResult __fmrtDebugPrintTree (fmrtId tableId)
+static void memoryInfo (fmrtId i, fmrtMemoryInfo *info, uint8_t resident)
 {
     /* Local Variables */
-    uint8_t     i;
+    uint64_t    rowSize,
+                rowUsed,
+                height,
+                buffer;
+    uint8_t     j;
 
-    /* If this is the first invocation of the library provide error and exit */
-    if (fmrtFirstInvocation)
-        return (FMRTKO);
+    memset (info, 0, sizeof(fmrtMemoryInfo));
 
-    /* Search for the table with given tableId */
-    for (i=0; (i<MAXTABLES)&&(Tables[i].tableId != tableId); i++)
+    /* Each element takes elemSize bytes, plus fieldsLen bytes in the payload array with the split layout */
+    rowSize = Tables[i].elemSize;
+    if (Tables[i].layout & FMRTLAYOUTSPLIT)
+        rowSize += Tables[i].fieldsLen;
+    info->elemSize = (uint32_t) rowSize;
+    info->descriptor = sizeof(fmrtTableItem);
+    info->resident = resident * sizeof(fmrtTableItem);
 
-    /* If not found provide an error */
-    if ( (i==MAXTABLES) || (Tables[i].status==FREE) )
-        return (FMRTIDNOTFOUND);
+    /* Bytes of each element holding links, key, fields and trailers, the rest is alignment padding */
+    rowUsed = 2*sizeof(fmrtIndex) + Tables[i].key.len;
+    if (Tables[i].key.type==FMRTSTRING)
+        rowUsed += sizeof(uint64_t);
+    for (j=0; j<Tables[i].numFields; j++)
+        rowUsed += heapField(i,j) ? FMRTSTRINGSLOT : Tables[i].fields[j].len;
+    if (Tables[i].aggDelta)
+        rowUsed += sizeof(fmrtNodeAggregate);
+    if (Tables[i].expDelta)
+        rowUsed += sizeof(fmrtNodeExpiry);
+    if (Tables[i].refDelta)
+        rowUsed += sizeof(uint8_t);
 
-    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
-    if (Tables[i].fmrtData==NULL)
-        return (FMRTNOTFOUND);
-
-    printf ("AVL Tree Table %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
-    if (Tables[i].currentNumElem <= FMRTDEBUGLIMIT)
-        __fmrtDebugPrintTreeRecurse (i,Tables[i].fmrtRoot);
-    else
-        printf ("More than %d elements, skipping printout...\n",FMRTDEBUGLIMIT);
+    if (Tables[i].fmrtData!=NULL)
+    {
+        info->elements = Tables[i].tableMaxElem*rowSize;
+        info->live = Tables[i].currentNumElem*rowSize;
+        info->unused = (Tables[i].tableMaxElem-Tables[i].fmrtUnused)*rowSize;
+        info->freeList = info->elements - info->live - info->unused;
+        info->padding = (rowSize>rowUsed) ? Tables[i].tableMaxElem*(rowSize-rowUsed) : 0;
+        info->resident += resident * residentBytes (Tables[i].fmrtData, (size_t)Tables[i].tableMaxElem*Tables[i].elemSize);
+        if (Tables[i].fmrtPayload!=NULL)
+            info->resident += resident * residentBytes (Tables[i].fmrtPayload, (size_t)Tables[i].tableMaxElem*Tables[i].fieldsLen);
+    }
 
-    return (FMRTOK);
-}
+    info->stringHeap = Tables[i].heapSize;
+    info->stringLive = Tables[i].heapLive;
+    info->resident += resident * residentBytes (Tables[i].strHeap, Tables[i].heapSize);
 
+    if ( (Tables[i].engine==FMRTENGINEBTREE) && (Tables[i].btScratch!=NULL) )
+    {
+        info->engine = (uint64_t)Tables[i].btMaxNodes*Tables[i].btNodeSize +
+                       (Tables[i].btFanout+1)*(sizeof(uint64_t)+sizeof(fmrtIndex)) + (Tables[i].btFanout+2)*sizeof(fmrtIndex);
+        info->resident += resident * residentBytes (Tables[i].btNodes, (size_t)Tables[i].btMaxNodes*Tables[i].btNodeSize);
+    }
+    if ( (Tables[i].engine==FMRTENGINEHASH) && (Tables[i].hashSlots!=NULL) )
+    {
+        info->engine = ((uint64_t)Tables[i].hashMask+1)*sizeof(fmrtHashSlot);
+        info->resident += resident * residentBytes (Tables[i].hashSlots, info->engine);
+    }
 
-/***********************************************************
- * __fmrtPrintStack()
- * ---------------------------------------------------------
- * Internal function useful for debugging library
- * It is an internal function invoked by searchElem(), which
- * prints the whole stack built by the latter when traversing
- * the tree. The stack is printed from found node to root
- * (i.e. elements are extracted respecting LIFO order)
- ***********************************************************/
-static void __fmrtPrintStack (uint8_t tableIndex, fmrtNodeTraversalStack * ptr)
-{
-    /* Local variables */
-    void        *currentPtr;
-    char        go;
+    for (j=0; j<Tables[i].numIndexes; j++)
+    {
+        info->indexes += (uint64_t)Tables[i].tableMaxElem*sizeof(fmrtIndexNode);
+        info->resident += resident * residentBytes (Tables[i].indexes[j].nodes, (size_t)Tables[i].tableMaxElem*sizeof(fmrtIndexNode));
+    }
 
-    /* If stack is empty exit and stop recursion */
-    if (ptr==NULL)
-        return;
+    if (Tables[i].wheel!=NULL)
+    {
+        info->expiry = (FMRTWHEELSIZE+1)*sizeof(fmrtIndex);
+        info->resident += resident * residentBytes (Tables[i].wheel, info->expiry);
+    }
 
-    /* Set currentPtr to point to the node indexed by the current LIFO element */
-    currentPtr = Tables[tableIndex].fmrtData + (ptr->index)*Tables[tableIndex].elemSize;
-    /* Print (Key)  (Balance Factor)  (Next Node) */
-    printf ("__fmrtPrintStack() --> index: %d (Key: ",ptr->index);
-    switch (Tables[tableIndex].key.type)
+    if (Tables[i].stats!=NULL)
     {
-        case FMRTINT:
-        {
-            printf ("%d)\t",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTINT */
-        case FMRTSIGNED:
-        {
-            printf ("%d)\n",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTSIGNED */
-        case FMRTDOUBLE:
-        {
-            printf ("%lf)\n",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTDOUBLE */
-        case FMRTCHAR:
-        {
-            printf ("%c)\t",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
-            break;
-        }   /* case FMRTCHAR */
-        case FMRTSTRING:
-        {
-            printf ("%s)\t",(char *)(currentPtr+Tables[tableIndex].key.delta));
-            break;
-        }   /* case FMRTSTRING */
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> print raw timestamp */
-                printf ("%ld)\t",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-            else
-            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                char  timestamp[MAXFMRTSTRINGLEN+1];
-                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                printf ("%s)\t",timestamp);
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
-    switch (ptr->go)
+        info->stats = FMRTSTATSHARDS*sizeof(fmrtStatsShard);
+        info->resident += resident * residentBytes (Tables[i].stats, info->stats);
+    }
+
+    if (Tables[i].lockStats!=NULL)
     {
-        case LEFT:
-        {
-            go = 'L';
-            break;
-        }
-        case RIGHT:
-        {
-            go = 'R';
-            break;
-        }
-        default:
-        {
-            go = '-';
-            break;
-        }
-    }   /* switch (ptr->go) */
-    printf ("(Next: %c)\n",go);
+        info->stats += FMRTCALLS*sizeof(fmrtLockStats);
+        info->resident += resident * residentBytes (Tables[i].lockStats, FMRTCALLS*sizeof(fmrtLockStats));
+    }
 
-    /* Go on with the next element in the LIFO */
-    __fmrtPrintStack (tableIndex, ptr-> next);
+    /* AVL height is at most 1.44*log2(n+2), the B+-tree engine keeps its height, hash searches push one element */
+    height = 64 - __builtin_clzll ((uint64_t)Tables[i].currentNumElem+1);
+    if (Tables[i].engine==FMRTENGINEAVL)
+        height = (height*3)/2 + 1;
+    else
+        height = (Tables[i].engine==FMRTENGINEBTREE) ? Tables[i].btHeight+1 : 1;
+    if (Tables[i].engine==FMRTENGINEAVL)
+        buffer = (Tables[i].currentNumElem/2+2)*sizeof(fmrtIndex);
+    else if (Tables[i].engine==FMRTENGINEHASH)
+        buffer = 2*Tables[i].currentNumElem*sizeof(fmrtIndex);
+    else
+        buffer = 0;
+    if (buffer<Tables[i].fieldsLen)
+        buffer = Tables[i].fieldsLen;
+    info->transient = height*sizeof(fmrtNodeTraversalStack) + buffer;
 
-    return ;
+    info->allocated = info->descriptor + info->elements + info->stringHeap + info->engine +
+                      info->indexes + info->expiry + info->stats;
+
+    return;
 }
 
 
 /***********************************************************
- * __fmrtPrintEmptyList()
+ * elemStride()
  * ---------------------------------------------------------
- * Internal function useful for debugging library
- * It is an internal function invoked whenever an operation
- * is done on the empty items list. It prints the whole list
- * of empty elements.
+ * This function provides the size of the elements of the
+ * table given by its index, rounded so that all elements
+ * are aligned (and possibly padded to cache lines, see
+ * fmrtDefineLayout()), i.e. the size they take in the array
+ * of elements allocated by initEmptyList()
  ***********************************************************/
-void __fmrtPrintEmptyList (uint8_t tableIndex, fmrtIndex node)
+static uint16_t elemStride (fmrtId i)
 {
-    /* Local variables */
-    void        *currentPtr;
-    fmrtIndex    next;
-
-    if (Tables[tableIndex].tableMaxElem > FMRTDEBUGLIMIT)
-    {
-        printf ("More than %d elements, skipping printout...\n",FMRTDEBUGLIMIT);
-        return;
-    }
-
-    /* If empty element list is empty exit and stop recursion */
-    if (node==FMRTNULLPTR)
-        return;
+    /* Local Variables */
+    uint16_t     stride;
 
-    /* otherwise print current node and call recursively the function */
-    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
-    next = *((fmrtIndex*)currentPtr);
-    printf ("Node %d --> Node %d\n",node,next);
-    __fmrtPrintEmptyList (tableIndex,next);
+    if ( (Tables[i].layout & FMRTLAYOUTPADDED) && (Tables[i].elemSize<FMRTCACHELINE) )
+        for (stride=FMRTMAXALIGN; stride<Tables[i].elemSize; stride*=2);
+    else if (Tables[i].layout & FMRTLAYOUTPADDED)
+        stride = FMRTALIGN (Tables[i].elemSize, FMRTCACHELINE);
+    else
+        stride = FMRTALIGN (Tables[i].elemSize, FMRTMAXALIGN);
 
-    return;
+    return (stride);
 }
-#endif
 
-/*******************************
- * Static Functions            *
- * --------------------------- *
- * (only visible in this file) *
- *******************************/
+
 /***********************************************************
- * getEmptyElem()
- * ---------------------------------------------------------
- * Internal function that extracts an empty element from the
- * free element list pointed by fmrtFree and makes it
- * available for inserting it into the FMRT tree
+ * memoryNeeded()
  * ---------------------------------------------------------
- * It returns the index of the free element that has been
- * extracted from the list, or FMRTNULLPTR if no more free
- * elements are available
+ * This function provides the memory charged to the table
+ * given by its index against the memory budget (see
+ * fmrtSetMemoryBudget()), i.e. the memory allocated for the
+ * table (descriptors excluded) plus
+ * the array of elements allocated at the first insertion,
+ * according to the element size defined so far, or the
+ * memory reserved for the table (see fmrtReserveMemory()),
+ * if greater
  ***********************************************************/
-static fmrtIndex getEmptyElem (uint8_t tableIndex)
+static uint64_t memoryNeeded (fmrtId i)
 {
     /* Local Variables */
-    fmrtIndex    freeElem;
-    void        *currentPtr;
-
-    /* If tableIndex does not correspond to a valid table or fmrtData is NULL provide FMRTNULLPTR */
-    if ( (Tables[tableIndex].status==FREE) || (Tables[tableIndex].fmrtData==NULL) )
-        return (FMRTNULLPTR);
-
-    /* If there are no more free elements in the list provide FMRTNULLPTR */
-    if (Tables[tableIndex].fmrtFree == FMRTNULLPTR)
-        return (FMRTNULLPTR);
+    fmrtMemoryInfo info;
+    uint64_t    needed;
 
-    /* Extract the first element from the list and provide it back */
-    freeElem = Tables[tableIndex].fmrtFree;
-    currentPtr = Tables[tableIndex].fmrtData + freeElem*Tables[tableIndex].elemSize;
-    Tables[tableIndex].fmrtFree = *((fmrtIndex*)currentPtr);
+    if (Tables[i].status==FREE)
+        return (0);
 
-    #ifdef FMRTDEBUG
-    printf ("Empty elements list\n");
-    printf ("-------------------\n");
-    __fmrtPrintEmptyList (tableIndex,Tables[tableIndex].fmrtFree);
-    #endif
+    memoryInfo (i, &info, 0);
+    needed = info.allocated - info.descriptor;
+    if (Tables[i].fmrtData==NULL)
+        needed += (uint64_t)Tables[i].tableMaxElem*elemStride(i) +
+                  ( (Tables[i].layout & FMRTLAYOUTSPLIT) ? (uint64_t)Tables[i].tableMaxElem*Tables[i].fieldsLen : 0 );
 
-    return (freeElem);
+    return ( (needed>Tables[i].memReserved) ? needed : Tables[i].memReserved );
 }
 
 
 /***********************************************************
- * freeEmptyElem()
+ * admitMemory()
  * ---------------------------------------------------------
- * Internal function that inserts the element referenced by
- * index into the free element list pointed by fmrtFree
+ * This function checks that the table given by the first
+ * parameter can allocate the further bytes given by the
+ * second one without exceeding the memory budget (see
+ * fmrtSetMemoryBudget()). If so, they are charged to the
+ * table right away, so that concurrent allocations by other
+ * tables cannot exceed the budget, and the caller shall
+ * call chargeMemory() once done, to account the memory
+ * actually allocated (or released in case of failure).
+ * The table lock (or the global lock while the table is
+ * being defined) shall be held by the caller
  * ---------------------------------------------------------
  * Possible return values:
  * - FMRTOK
- *   Function has been executed successfully
- * - FMRTKO
- *   Result obtained when no library calls have been invoked
- *   before
- * - FMRTIDNOTFOUND
- *   tableId is not defined
+ *   Memory admitted
+ * - FMRTOUTOFMEMORY
+ *   The memory budget would be exceeded
  ***********************************************************/
-static fmrtResult freeEmptyElem (uint8_t tableIndex, fmrtIndex index)
+static fmrtResult admitMemory (fmrtId i, uint64_t bytes)
 {
     /* Local Variables */
-    void        *currentPtr;
+    uint64_t    needed;
 
-    /* If not found provide an error */
-    if ( (Tables[tableIndex].status==FREE) )
-        return (FMRTIDNOTFOUND);
+    pthread_mutex_lock (&fmrtMemoryMtx);
+    needed = memoryNeeded (i) + bytes;
+    if ( (fmrtMemoryBudget>0) && (needed>Tables[i].memCommitted) &&
+         (fmrtMemoryCommitted-Tables[i].memCommitted+needed > fmrtMemoryBudget) )
+    {
+        pthread_mutex_unlock (&fmrtMemoryMtx);
+        return (FMRTOUTOFMEMORY);
+    }
+    fmrtMemoryCommitted = fmrtMemoryCommitted - Tables[i].memCommitted + needed;
+    Tables[i].memCommitted = needed;
+    pthread_mutex_unlock (&fmrtMemoryMtx);
 
-    /* If initEmptyList() was not called before, provide FMRTKO */
-    if (Tables[tableIndex].fmrtData==NULL)
-        return (FMRTKO);
+    return (FMRTOK);
+}
 
-    /* Table exists and is indexed by i */
-    /* Add element referenced by index in front of the list pointed by fmrtRoot */
-    currentPtr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
-    *((fmrtIndex*)currentPtr) = Tables[tableIndex].fmrtFree;
-    Tables[tableIndex].fmrtFree = index;
 
-    #ifdef FMRTDEBUG
-    printf ("Empty elements list\n");
-    printf ("-------------------\n");
-    __fmrtPrintEmptyList (tableIndex,Tables[tableIndex].fmrtFree);
-    #endif
+/***********************************************************
+ * chargeMemory()
+ * ---------------------------------------------------------
+ * This function updates the memory charged to the table
+ * given by its index against the memory budget, after its
+ * memory has been allocated or released (see admitMemory())
+ ***********************************************************/
+static void chargeMemory (fmrtId i)
+{
+    /* Local Variables */
+    uint64_t    needed;
 
-    return (FMRTOK);
+    pthread_mutex_lock (&fmrtMemoryMtx);
+    needed = memoryNeeded (i);
+    fmrtMemoryCommitted = fmrtMemoryCommitted - Tables[i].memCommitted + needed;
+    Tables[i].memCommitted = needed;
+    pthread_mutex_unlock (&fmrtMemoryMtx);
+
+    return;
 }
 
 
 /***********************************************************
- * initEmptyList()
+ * compactStringHeap()
  * ---------------------------------------------------------
- * Internal function that performs the following actions:
- * - allocate memory (array of tableMaxElem elements of
- *   elemSize bytes)
- * - initialize fmrtRoot pointer (index in the array of the
- *   FMRT tree root node)
- * - initialize fmrtFree pointer (index in the array of the
- *   single linked list that contains free elements
- *   available for being used in the fmrt tree)
- * - link all the array elements through left pointers to
- *   build the single linked list of free elements (the
- *   elements are linked in the following order:
- *   0 -> 1 -> 2 ..... -> tableMaxElem-1 )
+ * This function moves all the strings stored in the heap of
+ * the table whose index is given by the first parameter
+ * into a new heap of newSize bytes (second parameter),
+ * dropping the space left by released strings, and updates
+ * the string slots accordingly. Free elements have empty
+ * string slots, therefore all slots can be scanned linearly.
+ * It is used both to grow the heap and to release memory
  * ---------------------------------------------------------
  * Possible return values:
  * - FMRTOK
- *   Function has been executed successfully
- * - FMRTNOTEMPTY
- *   The table has been already initialized
+ *   The heap has been compacted
  * - FMRTOUTOFMEMORY
- *   There is no more space left for allocating memory for
- *   the table
+ *   Not enough memory for the new heap (the old one is left
+ *   untouched)
  ***********************************************************/
-static fmrtResult initEmptyList (uint8_t i)
+static fmrtResult compactStringHeap (fmrtId tableIndex, uint64_t newSize)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex;
-    void        *currentPtr;
-
-    /* If fmrtdata has already been allocated provide FMRTNOTEMPTY */
-    if (Tables[i].fmrtData!=NULL)
-        return (FMRTNOTEMPTY);
-
-    /* fmrtdata has net been allocated yet - Allocate an array of elements, ... */
-    Tables[i].fmrtData = calloc (Tables[i].tableMaxElem,Tables[i].elemSize);
-    if (Tables[i].fmrtData==NULL)
+    uint8_t         j;
+    fmrtIndex       index;
+    uint32_t        used = 0;
+    char            *newHeap = NULL;
+    fmrtStringSlot  *slot;
+    void            *fieldsPtr;
+
+    if (newSize>UINT32_MAX)
         return (FMRTOUTOFMEMORY);
-
-    /* ... initialize indexes and ... */
-    Tables[i].fmrtFree = 0;
-
-    /* ... set left pointers of each element to point to the next element in the array  */
-    for (leftIndex = 0, currentPtr = Tables[i].fmrtData; leftIndex<Tables[i].tableMaxElem-1; leftIndex++)
+    if ( (newSize>Tables[tableIndex].heapSize) && (admitMemory(tableIndex,newSize-Tables[tableIndex].heapSize)!=FMRTOK) )
+        return (FMRTOUTOFMEMORY);
+    if ( (newSize>0) && ((newHeap=(char *) malloc(newSize))==NULL) )
     {
-        *((fmrtIndex*)currentPtr) = (leftIndex+1) % MAXFMRTELEM;
-        currentPtr += Tables[i].elemSize;
+        chargeMemory (tableIndex);
+        return (FMRTOUTOFMEMORY);
     }
-    /* last pointer set to null */
-    *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
 
-    #ifdef FMRTDEBUG
-    printf ("Empty elements list\n");
-    printf ("-------------------\n");
-    __fmrtPrintEmptyList (i,Tables[i].fmrtFree);
-    #endif
+    for (index=0; (Tables[tableIndex].fmrtData!=NULL)&&(index<Tables[tableIndex].tableMaxElem); index++)
+    {
+        fieldsPtr = fieldsOf (tableIndex, Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize);
+        for (j=0; j<Tables[tableIndex].numFields; j++)
+        {
+            slot = (fmrtStringSlot *) (fieldsPtr+Tables[tableIndex].fields[j].delta);
+            if ( (!heapField(tableIndex,j)) || (slot->heap.tag!=FMRTHEAPTAG) )
+                continue;
+            memcpy (newHeap+used, Tables[tableIndex].strHeap+slot->heap.offset, slot->heap.len+1);
+            slot->heap.offset = used;
+            used += slot->heap.len+1;
+        }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+    }   /* for (index=0; ... ) */
+
+    if (Tables[tableIndex].strHeap!=NULL)
+        free (Tables[tableIndex].strHeap);
+    Tables[tableIndex].strHeap = newHeap;
+    Tables[tableIndex].heapSize = newSize;
+    Tables[tableIndex].heapUsed = Tables[tableIndex].heapLive = used;
+    chargeMemory (tableIndex);
 
-    /* Neglecting right pointers, now we have created a single linked list of empty elements  */
-    /* (linked by means of the left pointers) that can be extracted and used for storing data */
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * clearNodeTraversalStack()
+ * stringHeapLen()
  * ---------------------------------------------------------
- * Internal function that clears the stack of nodes
- * traversed built by the searchElem() function
+ * This function provides how many bytes of the string heap
+ * are needed to store the string given by the last
+ * parameter into the FMRTSTRING field j (second parameter),
+ * after truncating it to the maximum field length: it is 0
+ * for fields not stored in the heap (see heapField()) and
+ * for strings short enough to be stored inline
  ***********************************************************/
-static void clearNodeTraversalStack (fmrtNodeTraversalStack *stackPtr)
+static uint32_t stringHeapLen (fmrtId tableIndex, uint8_t j, char *string)
 {
-    /* If input list is empty exit - base scenario */
-    if (stackPtr==NULL)
-        return;
+    /* Local Variables */
+    uint32_t    len;
 
-    /* otherwise start recursion */
-    clearNodeTraversalStack(stackPtr->next);
-    free (stackPtr);
-    return;
+    if (!heapField(tableIndex,j))
+        return (0);
+
+    len = strnlen (string, Tables[tableIndex].fields[j].len-1);
+    return ( (len<FMRTSTRINGSLOT) ? 0 : len+1 );
 }
 
 
 /***********************************************************
- * searchTable()
+ * reserveStringHeap()
  * ---------------------------------------------------------
- * This function is used by fmrt library calls that perform
- * read and write access to the structure.
- * Given a tableId (first parameter) it provides the index in
- * the Table[] structure corresponding to tableId (second
- * parameter).
+ * This function makes sure that len bytes (second
+ * parameter) can be appended to the string heap of the
+ * table whose index is given by the first parameter. When
+ * the heap is full it is compacted into a larger one, twice
+ * the size of the live strings; should the memory budget
+ * refuse it (see admitMemory()), the smallest heap holding
+ * the new strings is tried as well
  * ---------------------------------------------------------
- * Possible Return Values:
+ * Possible return values:
  * - FMRTOK
- *   The table has been found and corresponding index
- *   properly set
- * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller. Second parameter
- *   is not meaningful
- * - FMRTIDNOTFOUND
- *   tableId is not defined. Second parameter is not
- *   meaningful
+ *   len bytes are available in the heap
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to grow the heap (the heap is left
+ *   untouched)
  ***********************************************************/
-static fmrtResult searchTable (fmrtId tableId, uint8_t *tableIndex)
+static fmrtResult reserveStringHeap (fmrtId tableIndex, uint64_t len)
 {
-    /* Local variables */
-    uint8_t i;
-
-    /* If this is the first invocation of the library provide error */
-    if (fmrtFirstInvocation)
-        return (FMRTKO);
-
-    /* Search for the table with given tableId */
-    for (i=0; (i<MAXTABLES)&&(Tables[i].tableId!=tableId); i++);
-
-    /* If not found provide an error */
-    if ( (i==MAXTABLES) || (Tables[i].status==FREE) )
-        return (FMRTIDNOTFOUND);
+    if ( (len==0) || ((uint64_t)Tables[tableIndex].heapUsed+len <= Tables[tableIndex].heapSize) )
+        return (FMRTOK);
 
-    /* set index as return value in the second parameter */
-    *tableIndex = i;
+    if (compactStringHeap(tableIndex, 2*((uint64_t)Tables[tableIndex].heapLive+len+FMRTHEAPMINSIZE))==FMRTOK)
+        return (FMRTOK);
 
-    return (FMRTOK);
+    return (compactStringHeap(tableIndex, (uint64_t)Tables[tableIndex].heapLive+len));
 }
 
 
 /***********************************************************
- * searchElem()
+ * storeString()
  * ---------------------------------------------------------
- * This function is used by fmrt library calls that perform
- * read and write access to the structure.
- * It takes the index of the Table[] array as first parameter
- * and the key to look for in the following parameters.
- * There are six parameters of different types for the key,
- * the function uses only the one corresponding to the key
- * type defined through fmrtDefineKey() (the remaining are not
- * meaningful). The function provides a result code and,
- * in case of result==FMRTOK, also a pointer to a LIFO
- * structure that contains all nodes traversed during the
- * search (last parameter).
+ * This function stores the string given by the last
+ * parameter into the FMRTSTRING field j (third parameter)
+ * of the element whose fields are pointed by the second
+ * parameter, truncating it to the maximum field length.
+ * With the string heap, the string previously stored in
+ * the field is released, then the new one is stored inline
+ * if it fits into the string slot, in the heap otherwise
+ * (the heap is grown when needed, see reserveStringHeap()).
+ * Write operations reserve the heap space for all the
+ * strings of an element before changing it (see
+ * reserveStringArgs() and reserveStringRow()), so that an
+ * element is never partially updated
  * ---------------------------------------------------------
- * Possible Return Values:
+ * Possible return values:
  * - FMRTOK
- *   The entry has been found and the LIFO structure is built.
- *   It contains the set of nodes traversed; the top of the
- *   stack contains the node found
- * - FMRTKO
- *   Result obtained when this is either the first library
- *   call invoked by the caller or the index passed as
- *   first argument exceeds allowed limits or corresponds
- *   to a table not defined
- * - FMRTNOTFOUND
- *   The entry with the given key is not present in the
- *   table. The last parameter is a valid pointer to a LIFO
- *   structure that represents the set of nodes traversed
+ *   The string has been stored
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to grow the heap (the field is left
+ *   untouched)
  ***********************************************************/
-static fmrtResult searchElem (uint8_t tableIndex, uint32_t keyInt, int32_t keySigned, double keyDouble, char keyChar, char *keyString, time_t keyTimestamp, fmrtNodeTraversalStack **stackPtr)
+static fmrtResult storeString (fmrtId tableIndex, void *fieldsPtr, uint8_t j, char *string)
 {
     /* Local Variables */
-    uint8_t     found=0;
-    int         cmp;
-    fmrtIndex    current;
-    void        *currentPtr;
-    fmrtNodeTraversalStack *stackElem = NULL;
-
-    /* Pre-initialize return parameters */
-    *stackPtr = NULL;
-
-    /* If this is the first invocation of the library provide error */
-    if (fmrtFirstInvocation)
-        return (FMRTKO);
+    fmrtLen         maxLen;
+    uint32_t        len;
+    fmrtStringSlot  *slot;
 
-    /* If either tableIndex is outside allowed limits or the corresponding table is not defined provide error */
-    if ( (tableIndex>=MAXTABLES) || (Tables[tableIndex].status==FREE))
-        return (FMRTKO);
+    maxLen = Tables[tableIndex].fields[j].len;     /* This field is max string length + trailing 0 */
+    slot = (fmrtStringSlot *) (fieldsPtr+Tables[tableIndex].fields[j].delta);
 
-    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
-    if (Tables[tableIndex].fmrtData==NULL)
-        return (FMRTNOTFOUND);
+    if (!heapField(tableIndex,j))
+    {   /* String stored in a fixed length slot */
+        strncpy ((char *) slot,string,maxLen);
+        *((char *) slot + maxLen-1) = '\0';
+        return (FMRTOK);
+    }
 
-    /* The FMRT tree is not empty. Set current to the root index, then start traversing the tree */
-    current = Tables[tableIndex].fmrtRoot;
-    while ( (found==0) && (current!=FMRTNULLPTR) )
-    {   /* currentPtr is set to the first byte of the element indexed by current */
-        currentPtr = Tables[tableIndex].fmrtData + current*Tables[tableIndex].elemSize;
+    /* Make room for longer strings before the field is changed (the heap might be moved) */
+    if (reserveStringHeap(tableIndex, stringHeapLen(tableIndex,j,string))!=FMRTOK)
+        return (FMRTOUTOFMEMORY);
 
-        /* Allocate an element to keep track of node traversal into a LIFO structure */
-        stackElem = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
-        stackElem->next = *stackPtr;
-        *stackPtr = stackElem;
-        (*stackPtr)->index = current;
+    /* Release the string previously stored in the field */
+    if (slot->heap.tag==FMRTHEAPTAG)
+        Tables[tableIndex].heapLive -= slot->heap.len+1;
+    memset (slot,0,sizeof(fmrtStringSlot));
 
-        /* Check the key pointed by current */
-        switch (Tables[tableIndex].key.type)
-        {
-            case FMRTINT:
-            {
-                cmp = keyInt - *((uint32_t *)(currentPtr+Tables[tableIndex].key.delta));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                cmp = keySigned - *((int32_t *)(currentPtr+Tables[tableIndex].key.delta));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                cmp = keyDouble - *((double *)(currentPtr+Tables[tableIndex].key.delta));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                cmp = keyChar - *((char *)(currentPtr+Tables[tableIndex].key.delta));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                cmp = strcmp ( keyString, (char *)(currentPtr+Tables[tableIndex].key.delta) );
-                break;
-            }   /* case FMRTSTRING */
-          case FMRTTIMESTAMP:
-          {
-              cmp = keyTimestamp - *((time_t *)(currentPtr+Tables[tableIndex].key.delta));
-              break;
-          }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].key.type) */
-        if ( cmp==0 )
-        {   /* key in the current elem is equal to the key we are looking for */
-            found = 1;
-            (*stackPtr)->go = STAY;
-            continue;
-        }
-        else if (cmp<0)
-        {   /* key we are looking for is less than the one in the current node */
-            /* go through the left subtree */
-            current = *((fmrtIndex *) currentPtr);
-            (*stackPtr)->go = LEFT;
-            continue;
-        }
-        else
-        {   /* key we are looking for is greater than the one in the current node */
-            /* go through the right subtree */
-            current = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-            (*stackPtr)->go = RIGHT;
-            continue;
-        }
-    }   /* while ( (found==0) && (current!=FMRTNULLPTR) ) */
+    /* Short strings are stored inline */
+    len = strnlen (string, maxLen-1);
+    if (len<FMRTSTRINGSLOT)
+    {
+        memcpy (slot->inlined,string,len);
+        return (FMRTOK);
+    }
 
-    #ifdef FMRTDEBUG
-    printf ("Node traversal stack\n");
-    printf ("--------------------\n");
-    __fmrtPrintStack (tableIndex, *stackPtr);
-    #endif
+    /* Longer strings are appended to the heap */
+    memcpy (Tables[tableIndex].strHeap+Tables[tableIndex].heapUsed,string,len);
+    Tables[tableIndex].strHeap[Tables[tableIndex].heapUsed+len] = '\0';
+    slot->heap.offset = Tables[tableIndex].heapUsed;
+    slot->heap.len = len;
+    slot->heap.tag = FMRTHEAPTAG;
+    Tables[tableIndex].heapUsed += len+1;
+    Tables[tableIndex].heapLive += len+1;
 
-    /* If the element was not found, then found == 0 */
-    if (found==0)
-        return (FMRTNOTFOUND);
-    else
-        return (FMRTOK);
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * countSubtreeNodes()
- * ---------------------------------------------------------
- * This function is used to count the number of nodes of
- * the subtree whose root node is given by the second
- * parameter.
- * The function is implemented through direct recursion
+ * clearElemStrings()
  * ---------------------------------------------------------
- * It returns the number of nodes including the root
+ * This function empties the string slots of the node given
+ * by the second parameter, if the string heap is enabled.
+ * If the last parameter is not 0, the strings are released
+ * as well (it is 0 for slots whose content has been moved
+ * to another node by copyNode())
  ***********************************************************/
-static int8_t countSubtreeNodes (uint8_t tableIndex, fmrtIndex node)
+static void clearElemStrings (fmrtId tableIndex, fmrtIndex node, uint8_t release)
 {
-    /* Local variables */
-    void        *currentPtr;
-    fmrtIndex    leftIndex, rightIndex;
-    int8_t      leftNodes=0, rightNodes=0;
-
-    /* If fmrtIndex is NULL exit */
-    if (node==FMRTNULLPTR)
-        return (0);
-
-    /* fmrtIndex is not NULL, evaluate currentPtr and Left and Right subtree indexes */
-    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* Local Variables */
+    uint8_t         j;
+    fmrtStringSlot  *slot;
+    void            *fieldsPtr;
 
-    /* If the node is a leaf provide 1 */
-    if ( (leftIndex==FMRTNULLPTR) && (rightIndex==FMRTNULLPTR) )
-        return (1);
+    if (!Tables[tableIndex].stringHeap)
+        return;
 
-    if (leftIndex!=FMRTNULLPTR)
-        leftNodes = countSubtreeNodes(tableIndex,leftIndex);
-    if (rightIndex!=FMRTNULLPTR)
-        rightNodes = countSubtreeNodes(tableIndex,rightIndex);
+    fieldsPtr = fieldsOf (tableIndex, Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize);
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        if (!heapField(tableIndex,j))
+            continue;
+        slot = (fmrtStringSlot *) (fieldsPtr+Tables[tableIndex].fields[j].delta);
+        if ( (release) && (slot->heap.tag==FMRTHEAPTAG) )
+            Tables[tableIndex].heapLive -= slot->heap.len+1;
+        memset (slot,0,sizeof(fmrtStringSlot));
+    }
 
-    return (1+leftNodes+rightNodes);
+    return;
 }
 
 
 /***********************************************************
- * nodeHeight()
+ * reserveStringRow()
  * ---------------------------------------------------------
- * This function is used by fmrt library calls that perform
- * write access to the structure.
- * Given a tableId (first parameter) and the fmrtIndex of a
- * node (second parameter), it provides the corresponding
- * height, defined as:
- *    1+max[height(leftsubtree),height(rightsubtree)]
- * (where leafs have height 0 by definition).
- * The function is implemented through direct recursion
+ * This function reserves the string heap space needed by
+ * the strings of a row read from a CSV file (second
+ * parameter, see storeRow()), so that the row can be
+ * stored without failing
  * ---------------------------------------------------------
- * It returns the height
+ * Possible return values:
+ * - FMRTOK
+ *   The row can be stored
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to grow the heap
  ***********************************************************/
-static int8_t nodeHeight (uint8_t tableIndex, fmrtIndex node)
+static fmrtResult reserveStringRow (fmrtId tableIndex, void *rowPtr)
 {
-    /* Local variables */
-    void        *currentPtr;
-    fmrtIndex    leftIndex, rightIndex;
-    int8_t      leftHeight=-1,
-                rightHeight=-1;
-
-    /* If fmrtIndex is NULL exit */
-    if (node==FMRTNULLPTR)
-        return (-1);
-
-    /* fmrtIndex is not NULL, evaluate currentPtr and Left and Right subtree indexes */
-    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* Local Variables */
+    uint8_t     j;
+    uint64_t    len = 0;
 
-    leftHeight = nodeHeight(tableIndex,leftIndex);
-    rightHeight = nodeHeight(tableIndex,rightIndex);
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        if (Tables[tableIndex].fields[j].type==FMRTSTRING)
+            len += stringHeapLen (tableIndex, j, (char *) rowPtr);
+        rowPtr += Tables[tableIndex].fields[j].len;
+    }
 
-    return ( 1+((leftHeight>rightHeight)?leftHeight:rightHeight) );
+    return (reserveStringHeap (tableIndex, len));
 }
 
 
 /***********************************************************
- * rotateLeft()
- * ---------------------------------------------------------
- * This function performs left rotation on the subtree whose
- * root node is given by the second parameter.
+ * storeRow()
  * ---------------------------------------------------------
- * It returns the index of the subtree after rotation
+ * This function copies all the fields of a row read from a
+ * CSV file (last parameter, where each field takes its
+ * maximum length) into the element whose fields are pointed
+ * by the second parameter. The heap space needed by the
+ * strings shall be reserved first (see reserveStringRow())
  ***********************************************************/
-static fmrtIndex rotateLeft (uint8_t tableIndex, fmrtIndex index)
+static void storeRow (fmrtId tableIndex, void *fieldsPtr, void *rowPtr)
 {
-    /* Local variables */
-    fmrtIndex    index1,
-                index2;
-    void        *ptr,
-                *ptr1;
-
-    /* If index is NULL exit without actions */
-    if (index==FMRTNULLPTR)
-        return (FMRTNULLPTR);
+    /* Local Variables */
+    uint8_t     j;
 
-    /* Set ptr to the first byte of the structure that contains the given index */
-    ptr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        if (Tables[tableIndex].fields[j].type==FMRTSTRING)
+            storeString (tableIndex, fieldsPtr, j, (char *) rowPtr);
+        else
+            memcpy (fieldsPtr+Tables[tableIndex].fields[j].delta, rowPtr, Tables[tableIndex].fields[j].len);
+        rowPtr += Tables[tableIndex].fields[j].len;
+    }
 
-    /* index1(ptr1) is the right child of the node pointed by index(ptr) */
-    index1 = *((fmrtIndex *) (ptr+sizeof(fmrtIndex)));
-    ptr1 = Tables[tableIndex].fmrtData + index1*Tables[tableIndex].elemSize;
-
-    /* index2(ptr2) is the left chid of index1(ptr1) */
-    index2 = *((fmrtIndex *) ptr1);
-
-    /* rotate left... */
-    /* let index(ptr) become left subtree of index1(ptr1)*/
-    *((fmrtIndex *) ptr1) = index;
-    /* then left subtree of index(ptr) points to index2(ptr2) */
-    *((fmrtIndex *) (ptr+sizeof(fmrtIndex))) = index2;
-
-    /* the new root is index1(ptr1) */
-    return (index1);
-}
-
-
-/***********************************************************
- * rotateRight()
- * ---------------------------------------------------------
- * This function performs right rotation on the subtree whose
- * root node is given by the second parameter.
- * ---------------------------------------------------------
- * It returns the index of the subtree after rotation
- ***********************************************************/
-static fmrtIndex rotateRight (uint8_t tableIndex, fmrtIndex index)
-{
-    /* Local variables */
-    fmrtIndex    index1,
-                index2;
-    void        *ptr,
-                *ptr1;
-
-    /* If index is NULL exit without actions */
-    if (index==FMRTNULLPTR)
-        return (FMRTNULLPTR);
-
-    /* Set ptr to the first byte of the structure that contains the given index */
-    ptr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
-
-    /* index1(ptr1) is the left child of the node pointed by index(ptr) */
-    index1 = *((fmrtIndex *) ptr);
-    ptr1 = Tables[tableIndex].fmrtData + index1*Tables[tableIndex].elemSize;
-
-    /* index2(ptr2) is the right chid of index1(ptr1) */
-    index2 = *((fmrtIndex *) (ptr1+sizeof(fmrtIndex)));
-
-    /* rotate right... */
-    /* let index(ptr) become right subtree of index1(ptr1)*/
-    *((fmrtIndex *) (ptr1+sizeof(fmrtIndex))) = index;
-    /* then left subtree of index(ptr) points to index2(ptr2) */
-    *((fmrtIndex *) ptr) = index2;
-
-    /* the new root is index1(ptr1) */
-    return (index1);
-}
-
-
-/***********************************************************
- * rebalanceSubTree()
- * ---------------------------------------------------------
- * This function is used to rebalance a subtree whose index
- * is given as second parameter. The first parameter is the
- * index of the table in the Table[] array.
- * Balance factor is defined here as:
- *    BF = height(right subtree) - height(left subtree)
- * (if BF>0 subtree on the right has an higher height
- *  vs left subtree and vice versa. In some papers/articles
- *  the opposite definition is assumed)
- * ---------------------------------------------------------
- * It returns the fmrtIndex pointer of the re-balanced tree
- ***********************************************************/
-static fmrtIndex rebalanceSubTree (uint8_t tableIndex, fmrtIndex nodeIndex)
-{
-    /* Local variables */
-    int8_t      balance,
-                lefthgt,
-                righthgt;
-    fmrtIndex    leftIndex,
-                rightIndex,
-                workIndex,
-                leftsubtree,
-                rightsubtree;
-    void        *currentPtr,
-                *subtreePtr;
-
-    /* If nodeIndex is NULL exit without actions */
-    if (nodeIndex==FMRTNULLPTR)
-        return (FMRTNULLPTR);
-
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
-
-    /* Left, Right and current subtree indexes */
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-    workIndex = nodeIndex;
-
-    /* evaluate balance factor of current node */
-    righthgt = nodeHeight(tableIndex,rightIndex);
-    lefthgt = nodeHeight(tableIndex,leftIndex);
-    balance = righthgt-lefthgt;
-
-    if (balance>1)
-    {   /* the subtree whose root is nodeIndex=workIndex is unbalanced -> right subtree has higher height */
-        /* Evaluate heights on the right and left subtrees of the right child                             */
-        /* Since (balance>=2)   ==>   height(right subtree)>=2   ==>   rightIndex!=FMRTNULLPTR             */
-        subtreePtr = Tables[tableIndex].fmrtData + rightIndex*Tables[tableIndex].elemSize;
-        leftsubtree = *((fmrtIndex *) subtreePtr);
-        rightsubtree = *((fmrtIndex *) (subtreePtr+sizeof(fmrtIndex)));
-
-        if ( nodeHeight(tableIndex,rightsubtree)>nodeHeight(tableIndex,leftsubtree) )
-        {   /* if right subtree of the right child has highest height simply rotate left */
-            workIndex = rotateLeft(tableIndex,nodeIndex);
-        }
-        else
-        {   /* otherwise we have to combine right and left rotation */
-            *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = rotateRight(tableIndex,rightIndex);
-            workIndex = rotateLeft(tableIndex,nodeIndex);
-        }
-        return (workIndex);
-    }   /* if (balance>1) */
-
-    if (balance<-1)
-    {   /* the subtree whose root is nodeIndex=workIndex is unbalanced -> left subtree has higher height */
-        /* Evaluate heights on the right and left subtrees of the left child                             */
-        /* Since (balance<=-2)   ==>   height(left subtree)>=2   ==>   leftIndex!=FMRTNULLPTR             */
-        subtreePtr = Tables[tableIndex].fmrtData + leftIndex*Tables[tableIndex].elemSize;
-        leftsubtree = *((fmrtIndex *) subtreePtr);
-        rightsubtree = *((fmrtIndex *) (subtreePtr+sizeof(fmrtIndex)));
-
-        if ( nodeHeight(tableIndex,leftsubtree)>nodeHeight(tableIndex,rightsubtree) )
-        {   /* if left subtree of the left child has highest height simply rotate right */
-            workIndex = rotateRight(tableIndex,nodeIndex);
-        }
-        else
-        {   /* otherwise we have to combine left and Right rotation */
-            *((fmrtIndex *) (currentPtr) ) = rotateLeft(tableIndex,leftIndex);;
-            workIndex = rotateRight(tableIndex,nodeIndex);
-        }
-        return (workIndex);
-    }   /* if (balance<-1) */
-
-    return (workIndex);
-
-}
+    return;
+}
 
 
 /***********************************************************
- * leftMostChild()
- * ---------------------------------------------------------
- * This function is used by fmrtDelete() library call. Given
- * a specified table (whose index is provided by the first
- * parameter) and a node index (second parameter), it looks
- * for the leftmost child of that node, i.e. the leaf that
- * can be reached by descending the tree only on the left
- * subtree. The routine provides back the fmrtIndex of such
- * node along with a LIFO structure that represents the
- * path to it
+ * layoutFields()
  * ---------------------------------------------------------
- * It returns the fmrtIndex pointer of the leftmost child
+ * This function assigns the physical offset (delta) of all
+ * the fields of the table whose index is given as a
+ * parameter, starting from fieldsDelta. The logical order
+ * of the fields (the one used in the API) is unchanged,
+ * while physically they are sorted by alignment, larger
+ * first (FMRTDOUBLE and FMRTTIMESTAMP, then FMRTINT,
+ * FMRTSIGNED and string slots, then FMRTCHAR and fixed
+ * length strings), so that no padding is needed and every
+ * field is properly aligned. The size of the fields block
+ * (fieldsLen) is rounded to FMRTMAXALIGN as well
  ***********************************************************/
-static fmrtIndex leftMostChild (uint8_t tableIndex, fmrtIndex index, fmrtNodeTraversalStack **stackPtr)
+static void layoutFields (fmrtId tableIndex)
 {
     /* Local Variables */
-    fmrtIndex    current, leftmost;
-    void        *currentPtr;
-    fmrtNodeTraversalStack *stackElem = NULL;
-
-    /* Pre-initialize return parameters */
-    *stackPtr = NULL;
+    uint8_t     j,
+                align,
+                fieldAlign;
+    uint16_t    delta;
 
-    /* The FMRT tree is not empty. Set current to the root index, then start traversing the tree */
-    current = leftmost = index;
-    while (current != FMRTNULLPTR)
+    delta = Tables[tableIndex].fieldsDelta;
+    for (align=FMRTMAXALIGN; align>0; align/=2)
     {
-        currentPtr = Tables[tableIndex].fmrtData + current*Tables[tableIndex].elemSize;
+        for (j=0; j<Tables[tableIndex].numFields; j++)
+        {
+            if (Tables[tableIndex].fields[j].type==FMRTSTRING)
+                fieldAlign = heapField(tableIndex,j) ? sizeof (uint32_t) : sizeof (char);
+            else
+                fieldAlign = Tables[tableIndex].fields[j].len;
+            if (fieldAlign!=align)
+                continue;
 
-        /* Allocate an element to keep track of node traversal into a LIFO structure */
-        stackElem = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
-        stackElem->next = *stackPtr;
-        *stackPtr = stackElem;
-        (*stackPtr)->index = current;
-        (*stackPtr)->go = LEFT;
+            Tables[tableIndex].fields[j].delta = delta;
+            delta += heapField(tableIndex,j) ? FMRTSTRINGSLOT : Tables[tableIndex].fields[j].len;
+        }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+    }   /* for (align=FMRTMAXALIGN; align>0; align/=2) */
 
-        leftmost = current;
-        current = *((fmrtIndex *) currentPtr);
-    }   /* while (current != FMRTNULLPTR) */
+    Tables[tableIndex].fieldsLen = FMRTALIGN (delta - Tables[tableIndex].fieldsDelta, FMRTMAXALIGN);
 
-    return (leftmost);
+    return;
 }
 
 
+/*******************************
+ * Debug Functions             *
+ * --------------------------- *
+ * They can be used for debug  *
+ * purposes. Just add the      *
+ * corresponding prototype into*
+ * the calling source code and *
+ * invoke them whenever needed *
+ * to print relevant infos     *
+ * To use the following        *
+ * functions, macro FMRTDEBUG  *
+ * must be enabled in fmrtApi.h*
+ *******************************/
+#ifdef FMRTDEBUG
 /***********************************************************
- * copyNode()
- * ---------------------------------------------------------
- * This function is used by fmrtDelete() library call. Given
- * a specified table (whose index is provided by the first
- * parameter) it copies all the data from source node (third
- * parameter) to the destination node (second parameter).
- * Data means the key alomg with all relevant fields.
+ * __fmrtDebugPrintStructure()
  * ---------------------------------------------------------
- * It returns the fmrtIndex pointer of the leftmost child
+ * Internal function useful for debugging library
+ * The prototype shall be added to the caller
+ * When invoked, it prints the structure of the Table[]
+ * element whose tableId is specified as a parameter
  ***********************************************************/
-static void copyNode (uint8_t tableIndex, fmrtIndex toIndex, fmrtIndex fromIndex)
+fmrtResult __fmrtDebugPrintStructure (fmrtId tableId)
 {
     /* Local Variables */
-    void        *fromPtr,
-                *toPtr;
-    int         numBytes;
-
-    if ( (fromIndex==FMRTNULLPTR) || (toIndex==FMRTNULLPTR) )
-        return;
+    fmrtId      i;
+    uint8_t     j;
 
-    fromPtr = Tables[tableIndex].fmrtData + fromIndex*Tables[tableIndex].elemSize+2*sizeof(fmrtIndex);
-    toPtr = Tables[tableIndex].fmrtData + toIndex*Tables[tableIndex].elemSize+2*sizeof(fmrtIndex);
-    numBytes = Tables[tableIndex].elemSize - 2*sizeof(fmrtIndex);
+    /* If this is the first invocation of the library provide error and exit */
+    if (!registryReady())
+        return (FMRTKO);
 
-    memcpy (toPtr, fromPtr, numBytes);
+    /* The table with given tableId is the element of Tables[] indexed by it, if not defined provide an error */
+    i = tableId;
+    if (!tableDefined(i))
+        return (FMRTIDNOTFOUND);
 
-    return;
+    /* Print on the screen all Table[] parameters */
+    printf ("Table Name: %s (Id: %d)\n",Tables[i].tableName,Tables[i].tableId);
+    printf ("\tMax Num Elems: %llu - Element Size: %d bytes\n",(unsigned long long)Tables[i].tableMaxElem,Tables[i].elemSize);
+    printf ("\tCurrent AVL Tree Root Index: %llu\n",(unsigned long long)Tables[i].fmrtRoot);
+    printf ("\tKey (Name: %s - Type: %d - Len: %d - Delta: %d\n",Tables[i].key.name, Tables[i].key.type, Tables[i].key.len, Tables[i].key.delta);
+    for (j=0; j<Tables[i].numFields; j++)
+        printf ("\tField: %d (Name: %s - Type: %d - Len: %d - Delta: %d\n",j,Tables[i].fields[j].name, Tables[i].fields[j].type, Tables[i].fields[j].len, Tables[i].fields[j].delta);
 
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * initFifo()
+ * __fmrtDebugPrintNode()
  * ---------------------------------------------------------
- * This function is used by the fmrt internal function
- * exportTableOptimized(). It takes the table index (first
- * parameter, which is the index of the Table[] array, not
- * the TableId) and the requested FIFO Size. It allocates
- * a FIFO associated to the given table, to be used when
- * exporting it in FMRTOPTIMIZED
+ * Internal function useful for debugging library
+ * The prototype shall be added to the caller
+ * When invoked, it prints the content of the fmrt tree
+ * element whose tableId and index are given as parameters
  ***********************************************************/
-static fmrtResult initFifo (uint8_t index, fmrtIndex fifoSize)
+fmrtResult __fmrtDebugPrintNode (fmrtId tableId, fmrtIndex index)
 {
     /* Local Variables */
-    fmrtIndex * fifoPtr;
+    fmrtId      i;
+    uint8_t     j;
+    fmrtIndex    leftPtr, rightPtr;
+    void        *currentPtr,
+                *fieldsPtr;
 
-    if ( (fifoPtr=calloc(fifoSize,sizeof(fmrtIndex))) == NULL)
-    {
-        Tables[index].fifo = NULL;
-        Tables[index].fifoSize = Tables[index].fifoIn = Tables[index].fifoOut = 0;
-        return (FMRTOUTOFMEMORY);
-    }
+    /* If this is the first invocation of the library provide error and exit */
+    if (!registryReady())
+        return (FMRTKO);
 
-    Tables[index].fifo = fifoPtr;
-    Tables[index].fifoSize = fifoSize;
-    Tables[index].fifoIn = Tables[index].fifoOut = 0;
+    /* The table with given tableId is the element of Tables[] indexed by it, if not defined provide an error */
+    i = tableId;
+    if (!tableDefined(i))
+        return (FMRTIDNOTFOUND);
 
-    return (FMRTOK);
-}
+    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
+    if (Tables[i].fmrtData==NULL)
+        return (FMRTNOTFOUND);
 
+    /* This points to the first byte of the structure that contains the given index */
+    currentPtr = Tables[i].fmrtData + index*Tables[i].elemSize;
 
-/***********************************************************
- * releaseFifo()
- * ---------------------------------------------------------
- * This function is used by the fmrt internal function
- * exportTableOptimized(). It takes the table index (first
- * parameter, which is the index of the Table[] array, not
- * the TableId) and releases memory allocated for the
- * FIFO
- ***********************************************************/
-static void releaseFifo (uint8_t index)
-{
-    if (Tables[index].fifo)
-        free (Tables[index].fifo);
-
-    Tables[index].fifo = NULL;
-    Tables[index].fifoSize = Tables[index].fifoIn = Tables[index].fifoOut = 0;
-
-    return;
-}
-
-
-/***********************************************************
- * getFifoSize()
- * ---------------------------------------------------------
- * This function is used by the fmrt internal function
- * exportTableOptimized(). It takes the table index (first
- * parameter, which is the index of the Table[] array, not
- * the TableId) and provides the current queue size of the
- * FIFO used to export data according to level order traversal
- * ---------------------------------------------------------
- * NOTE WELL: the implementation of this FIFO is simplified
- * for efficiency reasons. Specifically:
- *    - In and Out pointers cannot overlap, otherwise the
- *      FIFO is considered empty (i.e. given N the FIFO
- *      dimension, it can host up to (N-1) elements)
- *    - There is no control upon insertion or extraction
- *      about the number of elements already queued, and
- *      insertFifo() and extractFifo() routines do not
- *      provide errors
- ***********************************************************/
-static fmrtIndex getFifoSize (uint8_t index)
-{
-    /* Local Variables */
-    fmrtIndex currSize;
-
-    if ( (currSize=Tables[index].fifoIn-Tables[index].fifoOut) < 0)
-        currSize = currSize+Tables[index].fifoSize;
-
-    return (currSize);
-
-}
-
-
-/***********************************************************
- * insertFifo()
- * ---------------------------------------------------------
- * This function is used by the fmrt internal function
- * exportTableOptimized(). It takes the table index (first
- * parameter, which is the index of the Table[] array, not
- * the TableId) and puts the element given as second parameter
- * in the FIFO structure used to explore the tree according
- * to level order traversal (elements in the FIFO represent
- * the indexes of AVL Tree nodes that belong to the table)
- * ---------------------------------------------------------
- * NOTE WELL: the implementation of this FIFO is simplified
- * for efficiency reasons. Specifically:
- *    - In and Out pointers cannot overlap, otherwise the
- *      FIFO is considered empty (i.e. given N the FIFO
- *      dimension, it can host up to (N-1) elements)
- *    - There is no control upon insertion or extraction
- *      about the number of elements already queued, and
- *      insertFifo() and extractFifo() routines do not
- *      provide errors
- ***********************************************************/
-static void insertFifo (uint8_t index, fmrtIndex node)
-{
-    /* Local Variables */
-    fmrtIndex i;
-
-    i = Tables[index].fifoIn;
-
-    Tables[index].fifo[i] = node;
-    Tables[index].fifoIn = (i+1) % Tables[index].fifoSize;
-
-    return;
-}
-
-
-/***********************************************************
- * extractFifo()
- * ---------------------------------------------------------
- * This function is used by the fmrt internal function
- * exportTableOptimized(). It takes the table index (first
- * parameter, which is the index of the Table[] array, not
- * the TableId) and provides the next element extracted
- * from the FIFO structure, which represents the next node
- * to explore according to level order traversal (elements
- * in the FIFO represent the indexes of AVL Tree nodes that
- * belong to the table)
- * ---------------------------------------------------------
- * NOTE WELL: the implementation of this FIFO is simplified
- * for efficiency reasons. Specifically:
- *    - In and Out pointers cannot overlap, otherwise the
- *      FIFO is considered empty (i.e. given N the FIFO
- *      dimension, it can host up to (N-1) elements)
- *    - There is no control upon insertion or extraction
- *      about the number of elements already queued, and
- *      insertFifo() and extractFifo() routines do not
- *      provide errors
- ***********************************************************/
-static fmrtIndex extractFifo (uint8_t index)
-{
-    /* Local Variables */
-    fmrtIndex i, ret;
-
-    i = Tables[index].fifoOut;
-    ret = Tables[index].fifo[i];
-    Tables[index].fifoOut = (i+1) % Tables[index].fifoSize;
-
-    return(ret);
-
-}
-
-
-/***********************************************************
- * exportTableRecurse()
- * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportTableCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields and a flag that indicates
- * the export ordering. The routine consider the
- * index as the root of a subtree which is printed into
- * the file pointed by the third parameter by using
- * in order approach.
- ***********************************************************/
-static void exportTableRecurse (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering)
-{
-    /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex;
-    uint8_t     j;
-    void        *currentPtr;
-
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
-
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
-
-    /* Left and Right subtree indexes */
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    if (ordering==FMRTASCENDING)
-        exportTableRecurse (tableIndex, leftIndex, fPtr, sep, ordering);
-    else
-        exportTableRecurse (tableIndex, rightIndex, fPtr, sep, ordering);
+    /* Print first pointers and related data */
+    leftPtr = *((fmrtIndex *) currentPtr);
+    rightPtr = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    printf ("AVL Tree Table %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
+    printf ("\tLeft Ptr: %llu - Right Ptr: %llu\n",(unsigned long long)leftPtr, (unsigned long long)rightPtr);
 
-    /* In-order traversal -> ... then current node... */
-    /* Print the key... */
-    switch (Tables[tableIndex].key.type)
+    /* Then print the key */
+    printf ("\tKey (%s): ",Tables[i].key.name);
+    switch (Tables[i].key.type)
     {
         case FMRTINT:
         {
-            fprintf (fPtr, "%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            printf ("%d\n",*((uint32_t *)(currentPtr+Tables[i].key.delta)));
             break;
         }   /* case FMRTINT */
         case FMRTSIGNED:
         {
-            fprintf (fPtr, "%d",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            printf ("%d\n",*((int32_t *)(currentPtr+Tables[i].key.delta)));
             break;
         }   /* case FMRTSIGNED */
         case FMRTDOUBLE:
         {
-            fprintf (fPtr, "%lf",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+            printf ("%lf\n",*((double *)(currentPtr+Tables[i].key.delta)));
             break;
         }   /* case FMRTDOUBLE */
         case FMRTCHAR:
         {
-            fprintf (fPtr, "%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+            printf ("%c\n",*((char *)(currentPtr+Tables[i].key.delta)));
             break;
         }   /* case FMRTCHAR */
         case FMRTSTRING:
         {
-            fprintf (fPtr, "%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
+            printf ("%s\n",(char *)(currentPtr+Tables[i].key.delta));
             break;
         }   /* case FMRTSTRING */
         case FMRTTIMESTAMP:
         {
             if (fmrtTimeFormat[0]=='\0')
                 /* time format empty --> print raw timestamp */
-                fprintf (fPtr, "%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                printf ("%ld\n",*((time_t *)(currentPtr+Tables[i].key.delta)));
             else
             {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
                 char  timestamp[MAXFMRTSTRINGLEN+1];
-                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                fprintf (fPtr, "%s",timestamp);
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[i].key.delta)));
+                printf ("%s\n",timestamp);
             }
             break;
         }   /* case FMRTTIMESTAMP */
     }   /* switch (Tables[i].key.type) */
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
+
+    fieldsPtr = fieldsOf (i, currentPtr);
+    /* Then print all fields */
+    for (j=0; j<Tables[i].numFields; j++)
+    {
+        printf ("\tField %d (%s): ",j,Tables[i].fields[j].name);
+        switch (Tables[i].fields[j].type)
         {
             case FMRTINT:
             {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
+                printf ("%d\n",*((uint32_t *)(fieldsPtr+Tables[i].fields[j].delta)));
                 break;
             }   /* case FMRTINT */
             case FMRTSIGNED:
             {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
+                printf ("%d\n",*((int32_t *)(fieldsPtr+Tables[i].fields[j].delta)));
                 break;
             }   /* case FMRTSIGNED */
             case FMRTDOUBLE:
             {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
+                printf ("%lf\n",*((double *)(fieldsPtr+Tables[i].fields[j].delta)));
                 break;
             }   /* case FMRTDOUBLE */
             case FMRTCHAR:
             {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
+                printf ("%c\n",*((char *)(fieldsPtr+Tables[i].fields[j].delta)));
                 break;
             }   /* case FMRTCHAR */
             case FMRTSTRING:
             {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
+                printf ("%s\n",fieldString (i, fieldsPtr, j));
                 break;
             }   /* case FMRTSTRING */
             case FMRTTIMESTAMP:
             {
                 if (fmrtTimeFormat[0]=='\0')
                     /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
+                    printf ("%ld\n",*((time_t *)(fieldsPtr+Tables[i].fields[j].delta)));
                 else
                 {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
                     char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[i].fields[j].delta)));
+                    printf ("%s\n",timestamp);
                 }
                 break;
             }   /* case FMRTTIMESTAMP */
         }   /* switch (Tables[i].fields[j].type) */
     }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
-
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTASCENDING)
-        exportTableRecurse (tableIndex, rightIndex, fPtr, sep, ordering);
-    else
-        exportTableRecurse (tableIndex, leftIndex, fPtr, sep, ordering);
 
-    return;
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * exportTableOptimized()
+ * __fmrtDebugPrintTreeRecurse()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportTableCsv(), and implements an iterative level
- * order traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter) and a char representing a user defined
- * separator between fields. The routine prints the
- * content of the table into the file specified by filePtr
- * by using a level order traversal, so that the
- * subsequent reload does not require any rebalancing and
- * occurs in an optimized way
+ * Internal function useful for debugging library
+ * It is called by __fmrtDebugPrintTree() to implement
+ * recursion
  ***********************************************************/
-static fmrtResult exportTableOptimized (uint8_t tableIndex, fmrtIndex rootIndex, FILE *fPtr, char sep)
+static void __fmrtDebugPrintTreeRecurse (fmrtId tableIndex, fmrtIndex nodeIndex)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex, currentIndex, fifoSize;
-    uint8_t      j;
-    fmrtResult   res;
+    fmrtIndex    leftIndex, rightIndex;
     void        *currentPtr;
 
-    /* Exit if rootIndex is NULL */
-    if (rootIndex==FMRTNULLPTR)
-        return (FMRTOK);
-
-    /* Initialize FIFO Queue used for level order traversal           */
-    /* Since the tree is balanced, the lowest  level contains at most */
-    /* half of the current number of elements plus 1. This is the     */
-    /* maximum number of elements in the FIFO structure. However,     */
-    /* allocate one more element to be on the safe side               */
-    fifoSize = Tables[tableIndex].currentNumElem/2 + 2;
-    if ( (res=initFifo (tableIndex,fifoSize)) != FMRTOK)
-        return (res);
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
 
-    /* Insert root node into the queue */
-    insertFifo (tableIndex,rootIndex);
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
 
-    /* While loop until the queue is empty */
-    while ( (fifoSize=getFifoSize(tableIndex)) )
-    {
-        /* Index of the element just extracted from the FIFO structure */
-        currentIndex = extractFifo (tableIndex);
+    /* Left and Right subtree indexes */
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
 
-        /* Set currentPtr to the first byte of the structure that contains the index just extracted */
-        currentPtr = Tables[tableIndex].fmrtData + currentIndex*Tables[tableIndex].elemSize;
+    /* In-order traversal -> First left subtree... */
+    __fmrtDebugPrintTreeRecurse (tableIndex,leftIndex);
 
-        /* Left and Right subtree indexes */
-        leftIndex = *((fmrtIndex *) currentPtr);
-        rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-
-        /* Process current node... First print the key... */
-        switch (Tables[tableIndex].key.type)
+    /* In-order traversal -> ... then current node... */
+    printf ("%s: ",Tables[tableIndex].key.name);
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
         {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%d",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%lf",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
-                    fprintf (fPtr, "%s",timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[tableIndex].key.type) */
-        /* then loop through all the fields and print them separated by sep */
-        for (j=0; j<Tables[tableIndex].numFields; j++)
-        {   /* Loop through all fields */
-            switch (Tables[tableIndex].fields[j].type)
-            {
-                case FMRTINT:
-                {
-                    fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    break;
-                }   /* case FMRTINT */
-                case FMRTSIGNED:
-                {
-                    fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    break;
-                }   /* case FMRTSIGNED */
-                case FMRTDOUBLE:
-                {
-                    fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    break;
-                }   /* case FMRTDOUBLE */
-                case FMRTCHAR:
-                {
-                    fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    break;
-                }   /* case FMRTCHAR */
-                case FMRTSTRING:
-                {
-                    fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                    break;
-                }   /* case FMRTSTRING */
-                case FMRTTIMESTAMP:
-                {
-                    if (fmrtTimeFormat[0]=='\0')
-                        /* time format empty --> print raw timestamp */
-                        fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    else
-                    {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                        char  timestamp[MAXFMRTSTRINGLEN+1];
-                        strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                        fprintf (fPtr, "%c%s",sep,timestamp);
-                    }
-                    break;
-                }   /* case FMRTTIMESTAMP */
-            }   /* switch (Tables[tableIndex].fields[j].type) */
-        }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
-        fprintf (fPtr,"\n");
-
-        /* Now insert in FIFO the root nodes of the left and right subtree  to go to the next level */
-        if (leftIndex!=FMRTNULLPTR)
-            insertFifo (tableIndex,leftIndex);
-        if (rightIndex!=FMRTNULLPTR)
-            insertFifo (tableIndex,rightIndex);
-
-    }   /* while ( fifoSize = getFifoSize(tableIndex) ) */
+            printf ("%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            printf ("%d\n",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            printf ("%lf\n",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            printf ("%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {
+            printf ("%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> print raw timestamp */
+                printf ("%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            else
+            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                char  timestamp[MAXFMRTSTRINGLEN+1];
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                printf ("%s",timestamp);
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+    }   /* switch (Tables[i].key.type) */
+    printf ("\t(Node Index: %llu - Left Ptr: %llu - Right Ptr: %llu)\n",(unsigned long long)nodeIndex, (unsigned long long)leftIndex, (unsigned long long)rightIndex);
 
-    /* the Queue is empty -> the table has been completely traversed */
-    /* release Fifo and exit */
-    releaseFifo(tableIndex);
+    /* In-order traversal -> ... last right subtree */
+    __fmrtDebugPrintTreeRecurse (tableIndex,rightIndex);
 
-    return (FMRTOK);
+    return;
 }
 
 
 /***********************************************************
- * exportRangeRecurseInt()
+ * __fmrtDebugPrintTree()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two integer values representing respectively
- * the minimum and maximum key value.
- * The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * Internal function useful for debugging library
+ * The prototype shall be added to the caller
+ * When invoked, it prints the whole tree using an in-order
+ * approach (left subtree -> node -> right subtree)
+ * To achieve this result, it uses the previous function
+ * __fmrtDebugPrintTreeRecurse()
  ***********************************************************/
-static void exportRangeRecurseInt (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, uint32_t keyMin, uint32_t keyMax)
+fmrtResult __fmrtDebugPrintTree (fmrtId tableId)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex;
-    uint8_t     j;
-    uint32_t    key;
-    void        *currentPtr;
-
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
-
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    fmrtId      i;
 
-    /* Extract Key, Left and Right subtree indexes */
-    key = *((uint32_t *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* If this is the first invocation of the library provide error and exit */
+    if (!registryReady())
+        return (FMRTKO);
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (key<keyMin)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (key>keyMax)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                              */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    /* The table with given tableId is the element of Tables[] indexed by it, if not defined provide an error */
+    i = tableId;
+    if (!tableDefined(i))
+        return (FMRTIDNOTFOUND);
 
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    fprintf (fPtr, "%d",key);
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
+    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
+    if (Tables[i].fmrtData==NULL)
+        return (FMRTNOTFOUND);
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    printf ("AVL Tree Table %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
+    if (Tables[i].currentNumElem <= FMRTDEBUGLIMIT)
+        __fmrtDebugPrintTreeRecurse (i,Tables[i].fmrtRoot);
     else
-        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        printf ("More than %d elements, skipping printout...\n",FMRTDEBUGLIMIT);
 
-    return;
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * exportRangeRecurseSigned()
+ * __fmrtPrintStack()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two signed integer values
- * representing respectively the minimum and maximum key
- * value. The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * Internal function useful for debugging library
+ * It is an internal function invoked by searchElem(), which
+ * prints the whole stack built by the latter when traversing
+ * the tree. The stack is printed from found node to root
+ * (i.e. elements are extracted respecting LIFO order)
  ***********************************************************/
-static void exportRangeRecurseSigned (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, int32_t keyMin, int32_t keyMax)
+static void __fmrtPrintStack (fmrtId tableIndex, fmrtNodeTraversalStack * ptr)
 {
-    /* Local Variables */
-    fmrtIndex   leftIndex, rightIndex;
-    uint8_t     j;
-    int32_t     key;
-    void       *currentPtr;
+    /* Local variables */
+    void        *currentPtr;
+    char        go;
 
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
+    /* If stack is empty exit and stop recursion */
+    if (ptr==NULL)
         return;
 
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    /* Set currentPtr to point to the node indexed by the current LIFO element */
+    currentPtr = Tables[tableIndex].fmrtData + (ptr->index)*Tables[tableIndex].elemSize;
+    /* Print (Key)  (Balance Factor)  (Next Node) */
+    printf ("__fmrtPrintStack() --> index: %llu (Key: ",(unsigned long long)ptr->index);
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+        {
+            printf ("%d)\t",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            printf ("%d)\n",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            printf ("%lf)\n",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            printf ("%c)\t",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {
+            printf ("%s)\t",(char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> print raw timestamp */
+                printf ("%ld)\t",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            else
+            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                char  timestamp[MAXFMRTSTRINGLEN+1];
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                printf ("%s)\t",timestamp);
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+    }   /* switch (Tables[i].key.type) */
+    switch (ptr->go)
+    {
+        case LEFT:
+        {
+            go = 'L';
+            break;
+        }
+        case RIGHT:
+        {
+            go = 'R';
+            break;
+        }
+        default:
+        {
+            go = '-';
+            break;
+        }
+    }   /* switch (ptr->go) */
+    printf ("(Next: %c)\n",go);
 
-    /* Extract Key, Left and Right subtree indexes */
-    key = *((int32_t *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* Go on with the next element in the LIFO */
+    __fmrtPrintStack (tableIndex, ptr-> next);
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (key<keyMin)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (key>keyMax)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    return ;
+}
+
+
+/***********************************************************
+ * __fmrtPrintEmptyList()
+ * ---------------------------------------------------------
+ * Internal function useful for debugging library
+ * It is an internal function invoked whenever an operation
+ * is done on the empty items list. It prints the whole list
+ * of empty elements.
+ ***********************************************************/
+void __fmrtPrintEmptyList (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local variables */
+    void        *currentPtr;
+    fmrtIndex    next;
+
+    if (Tables[tableIndex].tableMaxElem > FMRTDEBUGLIMIT)
+    {
+        printf ("More than %d elements, skipping printout...\n",FMRTDEBUGLIMIT);
         return;
     }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                             */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
 
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    fprintf (fPtr, "%d",key);
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
+    /* If empty element list is empty exit and stop recursion */
+    if (node==FMRTNULLPTR)
+        return;
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    /* otherwise print current node and call recursively the function */
+    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
+    next = *((fmrtIndex*)currentPtr);
+    printf ("Node %llu --> Node %llu\n",(unsigned long long)node,(unsigned long long)next);
+    __fmrtPrintEmptyList (tableIndex,next);
 
     return;
 }
+#endif
+
+/*******************************
+ * Static Functions            *
+ * --------------------------- *
+ * (only visible in this file) *
+ *******************************/
+/***********************************************************
+ * btNode()
+ * ---------------------------------------------------------
+ * This function provides a pointer to the node of the
+ * B+-tree whose index in the pool of nodes is given by the
+ * second parameter. Each node takes btNodeSize bytes: the
+ * header is followed by up to btFanout normalized keys, by
+ * the indexes of the corresponding elements and, in
+ * internal nodes, by btFanout+1 children (see btKeys(),
+ * btElems() and btChildren())
+ ***********************************************************/
+static fmrtBtNode *btNode (fmrtId tableIndex, fmrtIndex node)
+{
+    return ((fmrtBtNode *) (Tables[tableIndex].btNodes + (size_t) node*Tables[tableIndex].btNodeSize));
+}
 
 
 /***********************************************************
- * exportRangeRecurseDouble()
+ * btKeys()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two double values
- * representing respectively the minimum and maximum key
- * value. The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * This function provides the array of the normalized keys
+ * of the B+-tree node given by the second parameter
  ***********************************************************/
-static void exportRangeRecurseDouble (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, double keyMin, double keyMax)
+static uint64_t *btKeys (fmrtId tableIndex, fmrtBtNode *node)
 {
-    /* Local Variables */
-    fmrtIndex   leftIndex, rightIndex;
-    uint8_t     j;
-    double      key;
-    void       *currentPtr;
+    return ((uint64_t *) ((void *) node + FMRTBTHEADER));
+}
 
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
 
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+/***********************************************************
+ * btElems()
+ * ---------------------------------------------------------
+ * This function provides the array of the indexes of the
+ * elements corresponding to the keys of the B+-tree node
+ * given by the second parameter. In leaves they are the
+ * elements of the table, in internal nodes they are the
+ * elements whose keys are used as separators
+ ***********************************************************/
+static fmrtIndex *btElems (fmrtId tableIndex, fmrtBtNode *node)
+{
+    return ((fmrtIndex *) ((void *) node + FMRTBTHEADER + Tables[tableIndex].btFanout*sizeof(uint64_t)));
+}
 
-    /* Extract Key, Left and Right subtree indexes */
-    key = *((double *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (key<keyMin)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (key>keyMax)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                              */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+/***********************************************************
+ * btChildren()
+ * ---------------------------------------------------------
+ * This function provides the array of the children of the
+ * internal B+-tree node given by the second parameter
+ ***********************************************************/
+static fmrtIndex *btChildren (fmrtId tableIndex, fmrtBtNode *node)
+{
+    return ((fmrtIndex *) ((void *) node + FMRTBTHEADER + Tables[tableIndex].btFanout*(sizeof(uint64_t)+sizeof(fmrtIndex))));
+}
 
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    fprintf (fPtr, "%lf",key);
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+/***********************************************************
+ * btReserve()
+ * ---------------------------------------------------------
+ * This function makes sure that at least the given number
+ * of nodes can be allocated from the pool of nodes of the
+ * B+-tree, growing it if needed (the pool is doubled each
+ * time, nodes are aligned to cache lines). Nodes are
+ * reserved before starting an insertion, since the pool
+ * cannot be moved while the B+-tree is being modified
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   The nodes are available
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to grow the pool
+ ***********************************************************/
+static fmrtResult btReserve (fmrtId tableIndex, fmrtIndex needed)
+{
+    /* Local Variables */
+    fmrtIndex   newMax;
+    void        *newNodes;
+
+    if (Tables[tableIndex].btMaxNodes-Tables[tableIndex].btNumNodes >= needed)
+        return (FMRTOK);
+
+    newMax = (Tables[tableIndex].btMaxNodes>0) ? 2*Tables[tableIndex].btMaxNodes : FMRTBTREEMINALLOC;
+    while (newMax-Tables[tableIndex].btNumNodes < needed)
+        newMax *= 2;
+    if (admitMemory (tableIndex, (uint64_t)(newMax-Tables[tableIndex].btMaxNodes)*Tables[tableIndex].btNodeSize) != FMRTOK)
+        return (FMRTOUTOFMEMORY);
+    if (posix_memalign (&newNodes, FMRTCACHELINE, (size_t) newMax*Tables[tableIndex].btNodeSize) != 0)
+    {
+        chargeMemory (tableIndex);
+        return (FMRTOUTOFMEMORY);
+    }
+
+    /* Nodes never used so far need not be copied */
+    if (Tables[tableIndex].btNodes!=NULL)
+    {
+        memcpy (newNodes, Tables[tableIndex].btNodes, (size_t) Tables[tableIndex].btUnused*Tables[tableIndex].btNodeSize);
+        free (Tables[tableIndex].btNodes);
+    }
+    Tables[tableIndex].btNodes = newNodes;
+    Tables[tableIndex].btMaxNodes = newMax;
+    chargeMemory (tableIndex);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * btAllocNode()
+ * ---------------------------------------------------------
+ * This function extracts an empty node from the pool of
+ * nodes of the B+-tree (nodes released are reused first)
+ * and initializes it as a leaf or as an internal node,
+ * depending on the second parameter. Nodes shall have been
+ * reserved before through btReserve()
+ * ---------------------------------------------------------
+ * It returns the index of the node
+ ***********************************************************/
+static fmrtIndex btAllocNode (fmrtId tableIndex, uint8_t leaf)
+{
+    /* Local Variables */
+    fmrtIndex   index;
+    fmrtBtNode  *node;
+
+    if (Tables[tableIndex].btFree!=FMRTNULLPTR)
+    {
+        index = Tables[tableIndex].btFree;
+        Tables[tableIndex].btFree = btNode(tableIndex,index)->next;
+    }
     else
-        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        index = Tables[tableIndex].btUnused++;
+    Tables[tableIndex].btNumNodes += 1;
 
-    return;
+    node = btNode (tableIndex, index);
+    node->count = 0;
+    node->leaf = leaf;
+    node->prev = node->next = FMRTNULLPTR;
+
+    return (index);
 }
 
 
 /***********************************************************
- * exportRangeRecurseChar()
+ * btFreeNode()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two char values
- * representing respectively the minimum and maximum key
- * value. The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * This function gives back the node of the B+-tree given by
+ * the second parameter to the pool of nodes
+ ***********************************************************/
+static void btFreeNode (fmrtId tableIndex, fmrtIndex index)
+{
+    btNode(tableIndex,index)->next = Tables[tableIndex].btFree;
+    Tables[tableIndex].btFree = index;
+    Tables[tableIndex].btNumNodes -= 1;
+}
+
+
+/***********************************************************
+ * getEmptyElem()
+ * ---------------------------------------------------------
+ * Internal function that extracts an empty element from the
+ * free element list pointed by fmrtFree and makes it
+ * available for inserting it into the FMRT tree. When the
+ * list is empty, the first element never used so far (the
+ * one pointed by fmrtUnused) is provided instead. With the
+ * B+-tree engine, the nodes needed to index the element are
+ * reserved as well
+ * ---------------------------------------------------------
+ * It returns the index of the free element that has been
+ * extracted from the list, or FMRTNULLPTR if no more free
+ * elements are available
  ***********************************************************/
-static void exportRangeRecurseChar (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, char keyMin, char keyMax)
+static fmrtIndex getEmptyElem (fmrtId tableIndex)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex;
-    uint8_t     j;
-    char        key;
+    fmrtIndex    freeElem;
     void        *currentPtr;
 
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
-
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    /* If tableIndex does not correspond to a valid table or fmrtData is NULL provide FMRTNULLPTR */
+    if ( (Tables[tableIndex].status==FREE) || (Tables[tableIndex].fmrtData==NULL) )
+        return (FMRTNULLPTR);
 
-    /* Extract Key, Left and Right subtree indexes */
-    key = *((char *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* With the B+-tree engine the nodes needed to link the element are reserved first (see btInsert()) */
+    if ( (Tables[tableIndex].engine==FMRTENGINEBTREE) && (btReserve(tableIndex,Tables[tableIndex].btHeight+2)!=FMRTOK) )
+        return (FMRTNULLPTR);
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (key<keyMin)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (key>keyMax)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
+    /* If there are no more free elements in the list take the next unused one, if any, otherwise provide FMRTNULLPTR */
+    if (Tables[tableIndex].fmrtFree == FMRTNULLPTR)
+    {
+        if (Tables[tableIndex].fmrtUnused == Tables[tableIndex].tableMaxElem)
+        {
+            FMRTPROBE2 (freelist__exhausted, Tables[tableIndex].tableId, Tables[tableIndex].tableMaxElem);
+            return (FMRTNULLPTR);
+        }
+        return (Tables[tableIndex].fmrtUnused++);
     }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                              */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
 
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    fprintf (fPtr, "%c",key);
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
+    /* Extract the first element from the list and provide it back */
+    freeElem = Tables[tableIndex].fmrtFree;
+    currentPtr = Tables[tableIndex].fmrtData + freeElem*Tables[tableIndex].elemSize;
+    Tables[tableIndex].fmrtFree = *((fmrtIndex*)currentPtr);
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    #ifdef FMRTDEBUG
+    printf ("Empty elements list\n");
+    printf ("-------------------\n");
+    __fmrtPrintEmptyList (tableIndex,Tables[tableIndex].fmrtFree);
+    #endif
 
-    return;
+    return (freeElem);
 }
 
 
 /***********************************************************
- * exportRangeRecurseString()
+ * freeEmptyElem()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two string values
- * representing respectively the minimum and maximum key
- * value. The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * Internal function that inserts the element referenced by
+ * index into the free element list pointed by fmrtFree
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   Function has been executed successfully
+ * - FMRTKO
+ *   Result obtained when no library calls have been invoked
+ *   before
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
  ***********************************************************/
-static void exportRangeRecurseString (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, char *keyMin, char *keyMax)
+static fmrtResult freeEmptyElem (fmrtId tableIndex, fmrtIndex index)
 {
     /* Local Variables */
-    fmrtIndex    leftIndex, rightIndex;
-    uint8_t     j;
-    char        key[MAXFMRTSTRINGLEN+1];
     void        *currentPtr;
 
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
+    /* If not found provide an error */
+    if ( (Tables[tableIndex].status==FREE) )
+        return (FMRTIDNOTFOUND);
 
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    /* If initEmptyList() was not called before, provide FMRTKO */
+    if (Tables[tableIndex].fmrtData==NULL)
+        return (FMRTKO);
 
-    /* Extract Key, Left and Right subtree indexes */
-    strcpy (key,(char *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* Table exists and is indexed by i */
+    /* Add element referenced by index in front of the list pointed by fmrtRoot */
+    currentPtr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
+    *((fmrtIndex*)currentPtr) = Tables[tableIndex].fmrtFree;
+    Tables[tableIndex].fmrtFree = index;
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (strcmp(key,keyMin)<0)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (strcmp(key,keyMax)>0)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                              */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    fprintf (fPtr, "%s",key);
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
+    /* String slots of free elements are kept empty (their strings, if any, now belong to another node) */
+    clearElemStrings (tableIndex, index, 0);
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    #ifdef FMRTDEBUG
+    printf ("Empty elements list\n");
+    printf ("-------------------\n");
+    __fmrtPrintEmptyList (tableIndex,Tables[tableIndex].fmrtFree);
+    #endif
 
-    return;
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * exportRangeRecurseTimestamp()
+ * initEmptyList()
  * ---------------------------------------------------------
- * This function is used by the fmrt library call
- * fmrtExportRangeCsv(), and implements a recursive in-order
- * traversal of the fmrt tree.
- * It takes the table index (first parameter, which is the
- * index of the Table[] array, not the TableId), the
- * current node index (second parameter), a file pointer
- * (third parameter), a char representing a user defined
- * separator between fields, a flag indicating the export
- * ordering and two time_t values
- * representing respectively the minimum and maximum key
- * value. The routine consider the index as the root of a
- * subtree which is printed into the file pointed by the
- * third parameter by using in order approach.
+ * Internal function that performs the following actions:
+ * - allocate memory (array of tableMaxElem elements of
+ *   elemSize bytes)
+ * - initialize fmrtRoot pointer (index in the array of the
+ *   FMRT tree root node)
+ * - initialize fmrtFree pointer (index in the array of the
+ *   single linked list that contains free elements
+ *   available for being used in the fmrt tree), which is
+ *   empty at the beginning
+ * - initialize fmrtUnused index (first element of the
+ *   array never used so far): elements from fmrtUnused to
+ *   tableMaxElem-1 are available too and are handed out in
+ *   order by getEmptyElem() once the free list is empty.
+ *   This way the array is not walked (and its memory pages
+ *   are not touched) until elements are actually used
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   Function has been executed successfully
+ * - FMRTNOTEMPTY
+ *   The table has been already initialized
+ * - FMRTOUTOFMEMORY
+ *   There is no more space left for allocating memory for
+ *   the table
  ***********************************************************/
-static void exportRangeRecurseTimestamp (uint8_t tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, time_t keyMin, time_t keyMax)
+static fmrtResult initEmptyList (fmrtId i)
 {
-    /* Local Variables */
-    fmrtIndex   leftIndex, rightIndex;
-    uint8_t     j;
-    time_t      key;
-    void       *currentPtr;
-
-    /* If nodeIndex is NULL stop recursion */
-    if (nodeIndex==FMRTNULLPTR)
-        return;
+    /* If fmrtdata has already been allocated provide FMRTNOTEMPTY */
+    if (Tables[i].fmrtData!=NULL)
+        return (FMRTNOTEMPTY);
 
-    /* Set currentPtr to the first byte of the structure that contains the given index */
-    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    /* The element size is rounded so that all elements are aligned (and possibly padded to cache lines) */
+    Tables[i].elemSize = elemStride (i);
 
-    /* Extract Key, Left and Right subtree indexes */
-    key = *((time_t *)(currentPtr+Tables[tableIndex].key.delta));
-    leftIndex = *((fmrtIndex *) currentPtr);
-    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    /* The arrays shall fit into the memory budget (see fmrtSetMemoryBudget()) */
+    if (admitMemory (i, 0)!=FMRTOK)
+        return (FMRTOUTOFMEMORY);
 
-    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
-    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
-    if (key<keyMin)
-    {   /* current element is lower than keyMin -> explore only right subtree */
-        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
-    }
-    if (key>keyMax)
-    {   /* current element is higher than keyMax -> explore only left subtree */
-        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-        return;
+    /* fmrtdata has net been allocated yet - Allocate an array of elements, ... */
+    Tables[i].fmrtData = calloc (Tables[i].tableMaxElem,Tables[i].elemSize);
+    if (Tables[i].fmrtData==NULL)
+    {
+        chargeMemory (i);
+        return (FMRTOUTOFMEMORY);
     }
-    /* Current key is within the interval... explore both subtrees, with */
-    /* order depending on ordering parameter                              */
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
 
-    /* In-order traversal -> ... after subtree print current node... */
-    /* Print the key... */
-    if (fmrtTimeFormat[0]=='\0')
-        /* time format empty --> print raw timestamp */
-        fprintf (fPtr, "%ld",key);
-    else
-    {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-        char  timestamp[MAXFMRTSTRINGLEN+1];
-        strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(&key)));
-        fprintf (fPtr, "%c%s",sep,timestamp);
-    }
-    /* then loop through all the fields and print them separated by sep */
-    for (j=0; j<Tables[tableIndex].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[tableIndex].fields[j].type)
+    /* ... the payload array with the fields, if they are stored apart (split layout), ... */
+    if (Tables[i].layout & FMRTLAYOUTSPLIT)
+    {
+        Tables[i].fmrtPayload = calloc (Tables[i].tableMaxElem,Tables[i].fieldsLen);
+        if (Tables[i].fmrtPayload==NULL)
         {
-            case FMRTINT:
-            {
-                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTINT */
-            case FMRTSIGNED:
-            {
-                fprintf (fPtr, "%c%d",sep,*((int32_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTSIGNED */
-            case FMRTDOUBLE:
-            {
-                fprintf (fPtr, "%c%lf",sep,*((double *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTDOUBLE */
-            case FMRTCHAR:
-            {
-                fprintf (fPtr, "%c%c",sep,*((char *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                break;
-            }   /* case FMRTCHAR */
-            case FMRTSTRING:
-            {
-                fprintf (fPtr, "%c%s",sep,(char *)(currentPtr+Tables[tableIndex].fields[j].delta));
-                break;
-            }   /* case FMRTSTRING */
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> print raw timestamp */
-                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].fields[j].delta)));
-                    fprintf (fPtr, "%c%s",sep,timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    fprintf (fPtr,"\n");
+            free (Tables[i].fmrtData);
+            Tables[i].fmrtData = NULL;
+            chargeMemory (i);
+            return (FMRTOUTOFMEMORY);
+        }
+    }
 
-    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
-    if (ordering==FMRTDESCENDING)
-        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
-    else
-        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    /* ... and initialize indexes (all the elements are unused) */
+    Tables[i].fmrtFree = FMRTNULLPTR;
+    Tables[i].fmrtUnused = 0;
+    chargeMemory (i);
 
-    return;
+    #ifdef FMRTDEBUG
+    printf ("Empty elements list\n");
+    printf ("-------------------\n");
+    __fmrtPrintEmptyList (i,Tables[i].fmrtFree);
+    #endif
+
+    return (FMRTOK);
 }
 
 
-/**********************************
- *  Public Functions              *
- * ------------------------------ *
- * (can be used outside this file *
- *  and are part of the library)  *
- **********************************/
 /***********************************************************
- * fmrtDefineTable()
+ * clearNodeTraversalStack()
  * ---------------------------------------------------------
- * Define a new table with the following parameters:
- * - tableId
- *   unique identifier of the table between 0 and 255
- * - tableName
- *   string of up to 32 chars identifying table name
- * - tableNumElem
- *   max number of elements in table between 1 and 2^26
- * This shall necessarily be the first library function
- * invoked by the caller.
- * A table cannot be redefined unless it is cleared first
- * through fmrtClearTable()
- * The library supports the definition of up to 32 tables
+ * Internal function that clears the stack of nodes
+ * traversed built by the searchElem() function
+ ***********************************************************/
+static void clearNodeTraversalStack (fmrtNodeTraversalStack *stackPtr)
+{
+    /* If input list is empty exit - base scenario */
+    if (stackPtr==NULL)
+        return;
+
+    /* otherwise start recursion */
+    clearNodeTraversalStack(stackPtr->next);
+    free (stackPtr);
+    return;
+}
+
+
+/***********************************************************
+ * monotonicNs()
  * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   Table successfully defined
- * - FMRTKO
- *   Result obtained when the number of elements is outside the
- *   allowed interval (1 - 2^26)
- * - FMRTIDALREADYEXISTS
- *   tableId is already in use by another table
- * - FMRTMAXTABLEREACHED
- *   Result obtained when more than 32 tables are defined
+ * This function provides the current time (in ns) from the
+ * monotonic clock, used to measure latencies and lock times
  ***********************************************************/
-fmrtResult fmrtDefineTable (fmrtId tableId, char* tableName, fmrtIndex tableNumElem)
+static uint64_t monotonicNs (void)
 {
     /* Local Variables */
-    uint8_t     i,j;
+    struct timespec now;
 
-    /* Set global lock to avoid cuncurrent access in case of parallel definition/clear of tables by different threads */
-    pthread_mutex_lock(&fmrtGlobalMtx);
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return ( (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec );
+}
 
-    /* If this is the first invocation of the library initialize Tables[] */
-    if (fmrtFirstInvocation)
-    {   /* All Tables[] element are set as not busy */
-        fmrtFirstInvocation = 0;
-        for (i=0; i<MAXTABLES; i++)
-            Tables[i].status = FREE;
-    }   /* if (fmrtFirstInvocation) */
-
-    /* If tableId is already used return FMRTIDALREADYEXISTS */
-    for (i=0; i<MAXTABLES; i++)
-        if ( (Tables[i].tableId==tableId) && (Tables[i].status!=FREE) )
-        {   /* Remove global lock before exiting */
-            pthread_mutex_unlock(&fmrtGlobalMtx);
-            return (FMRTIDALREADYEXISTS);
-        }
 
-    /* Loop again searching for the first element with Tables[i].status==FREE */
-    for (i=0; (i<MAXTABLES)&&(Tables[i].status!=FREE); i++ );
+/***********************************************************
+ * statsStart()
+ * ---------------------------------------------------------
+ * This function provides the start time (in ns) of a
+ * library call, to be passed to recordStats() when the
+ * call completes. It provides 0 when statistics are
+ * disabled (see fmrtEnableStats()), so that the call is not
+ * accounted and the clock is not read, unless the
+ * export__done tracepoint is enabled (see FMRTTRACE), since
+ * it reports the latency of exports
+ ***********************************************************/
+static uint64_t statsStart (void)
+{
+    if ( (!fmrtStatsEnabled) && (!FMRTPROBEENABLED(export__done)) )
+        return (0);
 
-    /* If i==MAXTABLES all elements are busy - return FMRTMAXTABLEREACHED */
-    if (i==MAXTABLES)
-    {   /* Remove global lock before exiting */
-        pthread_mutex_unlock(&fmrtGlobalMtx);
-        return (FMRTMAXTABLEREACHED);
-    }
+    return (monotonicNs());
+}
 
-    /* Check the requested number of elements against MAXFMRTELEM and eventually provide FMRTKO */
-    if ( (tableNumElem < 1) || (tableNumElem > MAXFMRTELEM) )
-    {   /* Remove global lock before exiting */
-        pthread_mutex_unlock(&fmrtGlobalMtx);
-        return (FMRTKO);
-    }
 
-    /* If control reaches here, i is the index of the free element to use */
-    Tables[i].tableId = tableId;
-    Tables[i].status = DEFINED;
-    Tables[i].numFields = 0;
-    /* Assign Table Name truncating it to MAXFMRTTABLENAME if too long */
-    strncpy(Tables[i].tableName,tableName,MAXFMRTTABLENAME+1);
-    Tables[i].tableName[MAXFMRTTABLENAME] ='\0';
-    Tables[i].tableMaxElem = tableNumElem;
-    Tables[i].currentNumElem = 0;
-    /* Set key and field names to empty string */
-    Tables[i].key.name[0]='\0';
-    for (j=0;j<MAXFMRTFIELDNUM;j++)
-        Tables[i].fields[j].name[0] = '\0';
-    /* Initial size consists in left ptr + right ptr */
-    Tables[i].elemSize = 2*sizeof (fmrtIndex);
-    Tables[i].fmrtRoot = FMRTNULLPTR;
-    Tables[i].fmrtFree = FMRTNULLPTR;
-    Tables[i].fmrtData = NULL;
-    /* Initialize Table specific mutex */
-    pthread_mutex_init(&(Tables[i].tableMtx), NULL);
+/***********************************************************
+ * allocStatsShards()
+ * ---------------------------------------------------------
+ * This function allocates the statistics shards of the
+ * table whose index is given as a parameter, once
+ * statistics are enabled (see fmrtEnableStats()), charging
+ * them against the memory budget. The shards are published
+ * with a release store, since recordStats() reads them
+ * without holding the table lock. The table lock shall be
+ * held by the caller
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   The shards are allocated
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory, or the memory budget would be
+ *   exceeded
+ ***********************************************************/
+static fmrtResult allocStatsShards (fmrtId i)
+{
+    /* Local Variables */
+    fmrtStatsShard  *shards;
 
-    /* Remove global lock before exiting */
-    pthread_mutex_unlock(&fmrtGlobalMtx);
+    if (Tables[i].stats!=NULL)
+        return (FMRTOK);
 
-    #ifdef FMRTDEBUG
-    printf ("Inside fmrtDefineTable() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
-    #endif
+    if (admitMemory (i, FMRTSTATSHARDS*sizeof(fmrtStatsShard))!=FMRTOK)
+        return (FMRTOUTOFMEMORY);
+    if (posix_memalign ((void **) &shards, FMRTCACHELINE, FMRTSTATSHARDS*sizeof(fmrtStatsShard)) != 0)
+    {
+        chargeMemory (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    memset (shards, 0, FMRTSTATSHARDS*sizeof(fmrtStatsShard));
+    __atomic_store_n (&(Tables[i].stats), shards, __ATOMIC_RELEASE);
+    chargeMemory (i);
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtClearTable()
+ * allocLockStats()
  * ---------------------------------------------------------
- * Deallocate a previously allocated table:
- * - tableId
- *   unique identifier of the table between 0 and 255
+ * This function allocates the lock statistics of the table
+ * whose index is given as a parameter, once lock
+ * statistics are enabled (see fmrtEnableLockStats()),
+ * charging them against the memory budget. They are
+ * published with a release store, since lockTable() loads
+ * them before taking the table lock. The table lock shall
+ * be held by the caller
  * ---------------------------------------------------------
- * Possible Return Values:
+ * Possible return values:
  * - FMRTOK
- *   Table successfully deallocated
- * - FMRTKO
- *   Result obtained when this is the first library call
- *   invoked by the caller
- * - FMRTIDNOTFOUND
- *   tableId is not defined
+ *   The lock statistics are allocated
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory, or the memory budget would be
+ *   exceeded
  ***********************************************************/
-fmrtResult fmrtClearTable (fmrtId tableId)
+static fmrtResult allocLockStats (fmrtId i)
 {
     /* Local Variables */
-    uint8_t     i;
-    fmrtResult   res;
+    fmrtLockStats   *lockStats;
 
-    /* Set global lock to avoid cuncurrent access in case of parallel definition/clear of tables by different threads */
-    pthread_mutex_lock(&fmrtGlobalMtx);
+    if (Tables[i].lockStats!=NULL)
+        return (FMRTOK);
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-    {   /* Remove global lock before exiting */
-        pthread_mutex_unlock(&fmrtGlobalMtx);
-        return (res);
+    if (admitMemory (i, FMRTCALLS*sizeof(fmrtLockStats))!=FMRTOK)
+        return (FMRTOUTOFMEMORY);
+    if ( (lockStats=calloc (FMRTCALLS, sizeof(fmrtLockStats))) == NULL )
+    {
+        chargeMemory (i);
+        return (FMRTOUTOFMEMORY);
     }
-
-    /* Otherwise deallocate stored data, set busy flag to 0 and destroy Table specific mutex */
-    if (Tables[i].fmrtData)
-        free (Tables[i].fmrtData);
-    Tables[i].status = FREE;
-    pthread_mutex_destroy(&(Tables[i].tableMtx));
-
-    /* Remove global lock before exiting */
-    pthread_mutex_unlock(&fmrtGlobalMtx);
-
-    #ifdef FMRTDEBUG
-    printf ("Inside fmrtClearTable() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
-    #endif
+    __atomic_store_n (&(Tables[i].lockStats), lockStats, __ATOMIC_RELEASE);
+    chargeMemory (i);
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtDefineKey()
- * ---------------------------------------------------------
- * Define key name, type (and also key length for string key
- * type) for a previously defined Table:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - keyName
- *   descriptive name of the key (up to 16 chars allowed,
- *   in case of length exceeding this limit the name will
- *   be truncated)
- * - keyType
- *   identifies key type. Allowed values defined in header
- *   fmrt.h (FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR,
- *   FMRTSTRING and FMRTTIMESTAMP)
- * - keyLen
- *   meaningful only in case of keyType==FMRTSTRING, when it
- *   represents the maximum string length for the key value
- *   Allowed values are in the interval 1-256.
- *   For FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR and
- *   FMRTTIMESTAMP types, the parameter is meaningless,
- *   since by default key lengths in those cases are
- *   fixed (e.g. 1 for FMRTCHAR, 4 for FMRTINT, etc.).
- * This call can be invoked only once after fmrtDefineTable()
- * and before invoking fmrtDefineFields(). In case of
- * multiple invokations a proper error is provided (see
- * below the list of possible Return Values)
+ * recordStats()
  * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   Key definition successful
- * - FMRTKO
- *   Result obtained either when this is the first library
- *   call invoked by the caller or when keyType parameter
- *   is not valid
- * - FMRTIDNOTFOUND
- *   tableId is not defined
- * - FMRTREDEFPROHIBITED
- *   The key cannot be redefined (it has been already
- *   defined)
- * - FMRTFIELDTOOLONG
- *   In case of keyType==FMRTSTRING the keyLen parameter is
- *   outside the allowed interval
+ * This function accounts a library call of the class given
+ * by the second parameter (FMRTSTATREAD ... FMRTSTATEXPORT),
+ * started at the time given by the third parameter (see
+ * statsStart()) and completed with the result given by the
+ * fourth one. Counters and latency histogram are updated in
+ * the shard of the calling thread, threads being assigned
+ * to shards in round robin. Updates are atomic, since
+ * several threads may share the same shard. Nothing is
+ * accounted while the shards of the table are not
+ * allocated (see allocStatsShards()). Hits and misses of
+ * fmrtRead() are not accounted here, they are the cache
+ * statistics of the table (see fmrtGetCacheStats()). The
+ * result is returned unchanged, so that the function can
+ * wrap the return values of the library calls
  ***********************************************************/
-fmrtResult fmrtDefineKey (fmrtId tableId, char* keyName, fmrtType keyType, fmrtLen keyLen)
+static fmrtResult recordStats (fmrtId tableIndex, uint8_t op, uint64_t start, fmrtResult res)
 {
     /* Local Variables */
-    uint8_t     i;
-    fmrtResult   res;
+    fmrtStatsShard  *shards;
+    fmrtStats       *stats;
+    uint64_t        elapsed;
+    uint8_t         bucket;
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+    if ( (start==0) || (!fmrtStatsEnabled) ||
+         ((shards=__atomic_load_n(&(Tables[tableIndex].stats), __ATOMIC_ACQUIRE)) == NULL) )
         return (res);
 
-    /* If found, set lock and check that the key has not been already defined, otherwise provide error FMRTREDEFPROHIBITED */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
-    if (Tables[i].status >= KEYDEFINED)
-    {   /* Clear lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTREDEFPROHIBITED);
-    }
+    elapsed = monotonicNs() - start;
 
-    /* Check keyType and, in case of string type, also keyLen     */
-    /* Also, set properly keytype and keylen into Table[] element */
-    switch (keyType)
+    if (fmrtStatsThreadShard<0)
+        fmrtStatsThreadShard = __atomic_fetch_add (&fmrtStatsNextShard, 1, __ATOMIC_RELAXED) % FMRTSTATSHARDS;
+    stats = &(shards[fmrtStatsThreadShard].stats);
+
+    /* Bucket b counts latencies from 2^b to 2^(b+1)-1 ns */
+    bucket = (elapsed>1) ? 63-__builtin_clzll(elapsed) : 0;
+    if (bucket>=FMRTSTATBUCKETS)
+        bucket = FMRTSTATBUCKETS-1;
+    FMRTSTATINC (stats->latency[op][bucket]);
+
+    switch (op)
     {
-        case FMRTINT:
+        case FMRTSTATREAD:
         {
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = sizeof (uint32_t);
+            FMRTSTATINC (stats->reads);
             break;
         }
-        case FMRTSIGNED:
+        case FMRTSTATCREATE:
         {
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = sizeof (int32_t);
+            if (res==FMRTOK)
+                FMRTSTATINC (stats->creates);
+            else if (res==FMRTDUPLICATEKEY)
+                FMRTSTATINC (stats->duplicates);
             break;
         }
-        case FMRTDOUBLE:
+        case FMRTSTATMODIFY:
         {
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = sizeof (double);
+            if (res==FMRTOK)
+                FMRTSTATINC (stats->modifies);
             break;
         }
-        case FMRTCHAR:
+        case FMRTSTATDELETE:
         {
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = sizeof (char);
+            if (res==FMRTOK)
+                FMRTSTATINC (stats->deletes);
             break;
         }
-        case FMRTSTRING:
+        case FMRTSTATIMPORT:
         {
-            if ( (keyLen<=0) || (keyLen>MAXFMRTSTRINGLEN) )
-            {   /* Clear lock before exiting */
-                pthread_mutex_unlock(&(Tables[i].tableMtx));
-                return (FMRTFIELDTOOLONG);
-            }
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = keyLen + 1;
+            if (res==FMRTOK)
+                FMRTSTATINC (stats->imports);
             break;
         }
-        case FMRTTIMESTAMP:
+        case FMRTSTATEXPORT:
         {
-            Tables[i].key.type = keyType;
-            Tables[i].key.len = sizeof (time_t);
+            if (res==FMRTOK)
+                FMRTSTATINC (stats->exports);
             break;
         }
-        default:
-        {   /* Clear lock before exiting */
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            return (FMRTKO);
-        }
-    }   /* switch (keyType) */
+    }   /* switch (op) */
 
-    /* Assign Key Name truncating it to MAXFMRTNAMELEN if too long */
-    strncpy (Tables[i].key.name,keyName,MAXFMRTNAMELEN+1);
-    Tables[i].key.name[MAXFMRTNAMELEN]='\0';
+    if (res==FMRTOUTOFMEMORY)
+        FMRTSTATINC (stats->outOfMemory);
 
-    /* Set also key.delta and update Table[] element size */
-    Tables[i].key.delta = Tables[i].elemSize;
-    Tables[i].elemSize += Tables[i].key.len;
+    return (res);
+}
 
-    /* Clear lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
 
-    #ifdef FMRTDEBUG
-    printf ("Inside fmrtDefineKey() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
-    #endif
+/***********************************************************
+ * dumpLockStatsLine()
+ * ---------------------------------------------------------
+ * This function prints to the given file one CSV line with
+ * the lock statistics of a library call (see
+ * fmrtDumpLockStats()), if the lock was ever acquired
+ ***********************************************************/
+static void dumpLockStatsLine (FILE *fPtr, char *lock, char *tableName, uint8_t call, fmrtLockStats *stats)
+{
+    if (__atomic_load_n (&(stats->acquisitions), __ATOMIC_RELAXED) == 0)
+        return;
 
-    return (FMRTOK);
+    fprintf (fPtr, "%s,%s,%s,%llu,%llu,%llu,%llu,%llu,%llu\n", lock, tableName, fmrtCallNames[call],
+             (unsigned long long) __atomic_load_n (&(stats->acquisitions), __ATOMIC_RELAXED),
+             (unsigned long long) __atomic_load_n (&(stats->contended), __ATOMIC_RELAXED),
+             (unsigned long long) __atomic_load_n (&(stats->waitNs), __ATOMIC_RELAXED),
+             (unsigned long long) __atomic_load_n (&(stats->maxWaitNs), __ATOMIC_RELAXED),
+             (unsigned long long) __atomic_load_n (&(stats->holdNs), __ATOMIC_RELAXED),
+             (unsigned long long) __atomic_load_n (&(stats->maxHoldNs), __ATOMIC_RELAXED));
+
+    return;
 }
 
 
 /***********************************************************
- * fmrtDefineFields()
- * ---------------------------------------------------------
- * Define fields for each table entry. It is a call with a
- * variable number of arguments. The first two parameters
- * (always present) are respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - numFields
- *   number of fields, in the interval 1-16 (excluding the
- *   key, which is defined apart through fmrtDefineKey() )
- * The parameters after the two above mentioned are used
- * to specify name, type (and also length for string field
- * type). Specifically, for each field, there shall be:
- * - field name
- *   descriptive name of the field (up to 16 chars allowed,
- *   in case of length exceeding this limit the name will
- *   be truncated)
- * - field type
- *   identifies field type. Allowed values defined in header
- *   fmrt.h (FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR,
- *   FMRTSTRING and FMRTTIMESTAMP)
- * - field len
- *   THIS SHALL BE INSERTED ONLY if field type == FMRTSTRING.
- *   DO NOT INSERT FIELD LEN FOR OTHER TYPES
- *   It represents the maximum string length for the field
- *   value. Allowed values are in the interval 1-256.
- * This call can be invoked only once after fmrtDefineKey()
- * and before invoking fmrtCreate(). In case of
- * multiple invokations a proper error is provided (see
- * below the list of possible Return Values)
+ * nextTable()
  * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   Fields definition successful
- * - FMRTKO
- *   Result obtained either when this is the first library
- *   call invoked by the caller or when one of the field
- *   type parameters is not valid
- * - FMRTIDNOTFOUND
- *   tableId is not defined
- * - FMRTREDEFPROHIBITED
- *   The fields cannot be redefined (they have been already
- *   defined)
- * - FMRTMAXFIELDSINVALID
- *   The specified number of fields is outside the allowed
- *   range (1-16)
- * - FMRTFIELDTOOLONG
- *   The maximum length specified for one of the FMRTSTRING
- *   parameters is outside the allowed interval (1-256)
+ * This function provides the index in Tables[] of the first
+ * defined table whose index is not lower than the one given
+ * as parameter, or MAXTABLES if there is none. The map of
+ * the defined tables is scanned 64 tables at a time, so
+ * that loops on all the tables skip the undefined ones
+ * without touching their descriptors
  ***********************************************************/
-fmrtResult fmrtDefineFields (fmrtId tableId, uint8_t numFields, ...)
+static uint32_t nextTable (uint32_t i)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,j;
-    char        *name;
-    int         type,len;
-    fmrtResult   res;
+    uint64_t    word;
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
-
-    /* If found, set lock and check that the fields have not been already defined, otherwise provide error FMRTREDEFPROHIBITED */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
-    if (Tables[i].status >= FIELDSDEFINED)
-    {   /* Clear lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTREDEFPROHIBITED);
+    while (i<MAXTABLES)
+    {
+        word = __atomic_load_n (&(fmrtTableMap[i>>6]), __ATOMIC_ACQUIRE) >> (i&63);
+        if (word)
+            return (i + __builtin_ctzll(word));
+        i = (i|63) + 1;
     }
 
-    /* If specified number of fields is outside the allowed range provide an error */
-    if ( (numFields<=0) || (numFields>MAXFMRTFIELDNUM) )
-    {   /* Clear lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTMAXFIELDSINVALID);
-    }
+    return (MAXTABLES);
+}
 
-    /* Start parsing variable arguments */
-    va_start(args, numFields);
 
-    for (j=0; j<numFields; j++)
-    {   /* Loop on the number of fields */
-        /* The first expected argument is field name (up to 16 chars, otherwise it is truncated) */
-        name = va_arg (args,char*);
-        strncpy (Tables[i].fields[j].name,name,MAXFMRTNAMELEN+1);
-        Tables[i].fields[j].name[MAXFMRTNAMELEN]='\0';
-        /* The second expected argument is argument type */
-        type = va_arg (args, int);
-        if ( (type<FMRTINT) || (type>FMRTTIMESTAMP) )
-        {   /* Clear lock before exiting */
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            va_end (args);
-            return (FMRTKO);
-        }
-        Tables[i].fields[j].type = (fmrtType) type;
-        /* In case of FMRTSTRING type we expect also string length (up to MAXFMRTSTRINGLEN characters) */
-        if (type==FMRTSTRING)
-        {
-            len = va_arg (args, int);
-            if ( (len<=0) || (len>MAXFMRTSTRINGLEN) )
-            {   /* Clear lock before exiting */
-                pthread_mutex_unlock(&(Tables[i].tableMtx));
-                va_end (args);
-                return (FMRTFIELDTOOLONG);
-            }
-        }   /* if (type==FMRTSTRING) */
+/***********************************************************
+ * updateMax()
+ * ---------------------------------------------------------
+ * This function atomically raises the counter given by the
+ * first parameter to the value given by the second one, if
+ * greater. Since several threads may update the same max,
+ * the value is stored by compare and swap, retried until
+ * either the store succeeds or the counter is found not
+ * lower than the value
+ ***********************************************************/
+static void updateMax (uint64_t *max, uint64_t value)
+{
+    /* Local Variables */
+    uint64_t    current;
 
-        switch (type)
-        {
-            case FMRTINT:
-            {
-                Tables[i].fields[j].len = sizeof (uint32_t);
-                break;
-            }
-            case FMRTSIGNED:
-            {
-                Tables[i].fields[j].len = sizeof (int32_t);
-                break;
-            }
-            case FMRTDOUBLE:
-            {
-                Tables[i].fields[j].len = sizeof (double);
-                break;
-            }
-            case FMRTCHAR:
-            {
-                Tables[i].fields[j].len = sizeof (char);
-                break;
-            }
-            case FMRTSTRING:
-            {
-                Tables[i].fields[j].len = (fmrtLen) len + 1;
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                Tables[i].fields[j].len = sizeof (time_t);
-                break;
-            }
-        }   /* switch (type) */
+    current = __atomic_load_n (max, __ATOMIC_RELAXED);
+    while ( (value>current) &&
+            (!__atomic_compare_exchange_n (max, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) );
 
-        Tables[i].fields[j].delta = Tables[i].elemSize;
-        Tables[i].elemSize += Tables[i].fields[j].len;
-    }   /* for (j=0; j<numFields; j++) */
+    return;
+}
 
-    /* All fields have been read, update numberof fields in Table[], */
-    /* close the variable list argument and return FMRTOK             */
-    Tables[i].numFields = numFields;
-    va_end (args);
 
-    /* Clear lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * sumLockStats()
+ * ---------------------------------------------------------
+ * This function provides into the third parameter the lock
+ * statistics of the library call given by the second one,
+ * taken from the array of per-call statistics of a lock
+ * (first parameter). If the call is FMRTCALLALL, counters
+ * and total times of all the calls are summed, while max
+ * times are the max among all the calls
+ ***********************************************************/
+static fmrtResult sumLockStats (fmrtLockStats *lockStats, uint8_t call, fmrtLockStats *stats)
+{
+    /* Local Variables */
+    uint8_t     c;
+    uint64_t    value;
 
-    #ifdef FMRTDEBUG
-    printf ("Inside fmrtDefineFields() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
-    #endif
+    if ( (call>=FMRTCALLS) && (call!=FMRTCALLALL) )
+        return (FMRTKO);
+
+    memset (stats, 0, sizeof(fmrtLockStats));
+    for (c=0; c<FMRTCALLS; c++)
+    {
+        if ( (call!=FMRTCALLALL) && (call!=c) )
+            continue;
+        stats->acquisitions += __atomic_load_n (&(lockStats[c].acquisitions), __ATOMIC_RELAXED);
+        stats->contended += __atomic_load_n (&(lockStats[c].contended), __ATOMIC_RELAXED);
+        stats->waitNs += __atomic_load_n (&(lockStats[c].waitNs), __ATOMIC_RELAXED);
+        stats->holdNs += __atomic_load_n (&(lockStats[c].holdNs), __ATOMIC_RELAXED);
+        if ( (value=__atomic_load_n(&(lockStats[c].maxWaitNs),__ATOMIC_RELAXED)) > stats->maxWaitNs )
+            stats->maxWaitNs = value;
+        if ( (value=__atomic_load_n(&(lockStats[c].maxHoldNs),__ATOMIC_RELAXED)) > stats->maxHoldNs )
+            stats->maxHoldNs = value;
+    }
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtRead()
- * ---------------------------------------------------------
- * This library call is used to read an entry from the fmrt
- * tree. It is a call with a variable number of arguments.
- * The first two parameters (always present) are
- * respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - key
- *   contains the key value to be searched into the table.
- *   It shall be of the same type defined by the
- *   fmrtDefineKey() call. The library behaviour is undefined
- *   if this constraint is not satisfied. In case of string
- *   key, the length is truncated to the max length specified
- *   at key definition through fmrtDefineKey().
- * After those mandatory parameters, there is a list of
- * pointer parameters that are filled with values read
- * from the entry (if present). Parameters are ordered
- * according to the same order used in definition (i.e.
- * in fmrtDefinFields() library call). Be aware that
- * parameters number and types shall be correct, otherwise
- * the call may cause run-time errors.
+ * acquireLock()
  * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   The entry has been found and corresponding parameters
- *   extracted
- * - FMRTNOTFOUND
- *   The entry with the given key is not present in the table
- * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller
- * - FMRTIDNOTFOUND
- *   tableId is not defined
+ * This function acquires the mutex given by the first
+ * parameter. When lock statistics are enabled (see
+ * fmrtEnableLockStats()) the acquisition is accounted into
+ * the statistics given by the second parameter, unless
+ * they are not allocated yet (NULL): the mutex
+ * is considered contended when it cannot be taken at the
+ * first attempt, and the time spent waiting for it is
+ * measured. The time of the acquisition is provided back
+ * (or 0 when statistics are disabled), to be passed to
+ * releaseLock()
  ***********************************************************/
-fmrtResult fmrtRead (fmrtId tableId, ...)
+static uint64_t acquireLock (pthread_mutex_t *mtx, fmrtLockStats *stats)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,j,maxLen;
-    void        *currentPtr;
-    fmrtResult   res;
-    uint32_t    keyInt;
-    int32_t     keySigned;
-    double      keyDouble;
-    time_t      keyTimestamp;
-    char        keyChar,
-                *string,
-                keyString[MAXFMRTSTRINGLEN+1];
-    fmrtNodeTraversalStack *traversal;
+    uint64_t    start,
+                now,
+                wait;
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    if ( (!fmrtLockStatsEnabled) || (stats==NULL) )
+    {
+        pthread_mutex_lock(mtx);
+        return (0);
+    }
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    if (pthread_mutex_trylock(mtx)==0)
+    {   /* Uncontended acquisition */
+        now = monotonicNs();
+        FMRTSTATINC (stats->acquisitions);
+        return (now);
+    }
 
-    /* Initialize the list of variable arguments in order to read the key first */
-    va_start (args,tableId);
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            keyInt = va_arg (args, uint32_t);
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            keySigned = va_arg (args, int32_t);
-            break;
-        }
-        case FMRTDOUBLE:
-        {
-            keyDouble = va_arg (args, double);
-            break;
-        }
-        case FMRTCHAR:
-        {
-            keyChar = (unsigned char) va_arg (args,int);
-            break;
-        }
-        case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            string = va_arg (args,char*);
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            strncpy (keyString,string,maxLen);
-            keyString[maxLen-1] = '\0';
-            break;
-        }
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> read raw timestamp from argument */
-                keyTimestamp = va_arg (args, time_t);
-            else
-            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestamp = mktime (&TimeFromString);
-                else
-                    keyTimestamp = 0;
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
+    /* The mutex is held by another thread, measure the time spent waiting for it */
+    start = monotonicNs();
+    pthread_mutex_lock(mtx);
+    now = monotonicNs();
+    wait = now - start;
+    FMRTSTATINC (stats->acquisitions);
+    FMRTSTATINC (stats->contended);
+    FMRTSTATADD (stats->waitNs, wait);
+    updateMax (&(stats->maxWaitNs), wait);
+
+    return (now);
+}
 
-    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
-    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+
+/***********************************************************
+ * releaseLock()
+ * ---------------------------------------------------------
+ * This function releases the mutex given by the first
+ * parameter, which was acquired by acquireLock() at the
+ * time given by the third parameter. The time the mutex
+ * has been held is accounted into the statistics given by
+ * the second parameter (unless the acquisition time is 0,
+ * i.e. lock statistics were disabled at acquisition)
+ ***********************************************************/
+static void releaseLock (pthread_mutex_t *mtx, fmrtLockStats *stats, uint64_t since)
+{
+    /* Local Variables */
+    uint64_t    hold;
+
+    if (since==0)
     {
-        va_end (args);
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (res);
+        pthread_mutex_unlock(mtx);
+        return;
     }
 
-    /* The element was found and traversal is a pointer to a LIFO structure */
-    /* whose top element contains the index of the node we searched         */
-    /* Set currentPtr to point to the first byte of the structure           */
-    currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+    /* Hold statistics are updated before releasing the mutex */
+    hold = monotonicNs() - since;
+    FMRTSTATADD (stats->holdNs, hold);
+    updateMax (&(stats->maxHoldNs), hold);
+    pthread_mutex_unlock(mtx);
 
-    /* Now read all remaining arguments and loop through the fields */
-    for (j=0; j<Tables[i].numFields; j++)
-    {   /* @@@ - By removing comment from the following line we obtain for each field the pair name, value */
-        /* @@@ - If the comment is present, we obtain only a list of values according to the same order    */
-        /* @@@ - defined in fmrtDefineFields() library call                                                 */
-        /* strcpy (va_arg (args, char *),Tables[i].fields[j].name); */
-        switch (Tables[i].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                *va_arg (args, uint32_t *) = *((uint32_t *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }
-            case FMRTSIGNED:
-            {
-                *va_arg (args, int32_t *) = *((int32_t *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }
-            case FMRTDOUBLE:
-            {
-                *va_arg (args, double *) = *((double *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }
-            case FMRTCHAR:
-            {
-                *va_arg (args, char *) = *((char *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }
-            case FMRTSTRING:
-            {
-                strcpy (va_arg (args, char *),(char *)(currentPtr+Tables[i].fields[j].delta));
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> use raw timestamp from argument */
-                    *va_arg (args, time_t *) = *((time_t *)(currentPtr+Tables[i].fields[j].delta));
-                else
-                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
-                    char  timestamp[MAXFMRTSTRINGLEN+1];
-                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[i].fields[j].delta)));
-                    strcpy (va_arg (args, char *),timestamp);
-                }
-                break;
-            }   /* case FMRTTIMESTAMP */
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    va_end (args);
+    return;
+}
 
-    #ifdef FMRTDEBUG
-    printf ("\n\nRead node at index: %d\n",traversal->index);
-    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
-    printf ("Path from node up to the root:\n");
-    __fmrtPrintStack(i,traversal);
-    #endif
 
-    /* clear node traversal LIFO structure allocated by searchElem() and exit */
-    clearNodeTraversalStack (traversal);
+/***********************************************************
+ * lockTable()
+ * ---------------------------------------------------------
+ * This function acquires the lock of the table whose index
+ * is given by the first parameter, on behalf of the library
+ * call given by the second one (FMRTCALL...). The lock
+ * statistics of the table are allocated by
+ * fmrtEnableLockStats() and published with a release
+ * store, hence they are loaded before taking the lock
+ ***********************************************************/
+static void lockTable (fmrtId tableIndex, uint8_t call)
+{
+    uint64_t        since;
+    fmrtLockStats   *lockStats;
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+    lockStats = __atomic_load_n (&(Tables[tableIndex].lockStats), __ATOMIC_ACQUIRE);
+    since = acquireLock (&(Tables[tableIndex].tableMtx), (lockStats!=NULL) ? &(lockStats[call]) : NULL);
+    Tables[tableIndex].lockSince = since;
+    Tables[tableIndex].lockCall = call;
 
-    return (FMRTOK);
+    return;
 }
 
 
 /***********************************************************
- * fmrtCreate()
+ * unlockTable()
  * ---------------------------------------------------------
- * This library call is used to insert a new entry into the
- * fmrt tree. It is a call with a variable number of
- * arguments. The first two parameters (always present) are
- * respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - key
- *   contains the key value to be searched into the table.
- *   It shall be of the same type defined by the
- *   fmrtDefineKey() call. The library behaviour is undefined
- *   if this constraint is not satisfied. In case of string
- *   key, the length is truncated to the max length specified
- *   at key definition through fmrtDefineKey().
- * After those mandatory parameters, there is a list of
- * parameters that are used to fill the fields of the new
- * entry that is going to be created. Parameters are ordered
- * according to the same order used in definition (i.e.
- * in fmrtDefinFields() library call). Be aware that
- * parameters number and types shall be correct, otherwise
- * the call may cause run-time errors. In case of string
- * parameters, the length is truncated to the max length
- * specified at field definition through fmrtDefineFields().
+ * This function releases the lock of the table whose index
+ * is given by the first parameter (see lockTable()). The
+ * lock statistics are there whenever the acquisition was
+ * timed
+ ***********************************************************/
+static void unlockTable (fmrtId tableIndex)
+{
+    /* Local Variables */
+    fmrtLockStats   *lockStats;
+
+    lockStats = Tables[tableIndex].lockStats;
+    releaseLock (&(Tables[tableIndex].tableMtx), (lockStats!=NULL) ? &(lockStats[Tables[tableIndex].lockCall]) : NULL, Tables[tableIndex].lockSince);
+
+    return;
+}
+
+
+/***********************************************************
+ * lockGlobal()
+ * ---------------------------------------------------------
+ * This function acquires the global lock (fmrtGlobalMtx) on
+ * behalf of the library call given by the parameter
+ ***********************************************************/
+static void lockGlobal (uint8_t call)
+{
+    uint64_t    since;
+
+    since = acquireLock (&fmrtGlobalMtx, &(fmrtGlobalLockStats[call]));
+    fmrtGlobalLockSince = since;
+    fmrtGlobalLockCall = call;
+
+    return;
+}
+
+
+/***********************************************************
+ * unlockGlobal()
+ * ---------------------------------------------------------
+ * This function releases the global lock (see lockGlobal())
+ ***********************************************************/
+static void unlockGlobal (void)
+{
+    releaseLock (&fmrtGlobalMtx, &(fmrtGlobalLockStats[fmrtGlobalLockCall]), fmrtGlobalLockSince);
+
+    return;
+}
+
+
+/***********************************************************
+ * dumpLockStats()
+ * ---------------------------------------------------------
+ * This function prints to the given file the lock
+ * statistics of the global lock and of all the defined
+ * tables (see fmrtDumpLockStats()). The global lock is
+ * held, so that tables are not defined or cleared during
+ * the dump, while the table locks are not taken, so that
+ * the dump is not delayed by a table lock held for a long
+ * time
+ ***********************************************************/
+static void dumpLockStats (FILE *fPtr)
+{
+    /* Local Variables */
+    uint32_t        i;
+    uint8_t         call;
+    char            lock[8];
+    time_t          now;
+    fmrtLockStats   *lockStats;
+
+    if (fPtr==NULL)
+        return;
+
+    /* Set global lock */
+    lockGlobal (FMRTCALLENABLESTATS);
+
+    time (&now);
+    fprintf (fPtr, "# libfmrt lock statistics at %ld\n", (long) now);
+    fprintf (fPtr, "lock,table,call,acquisitions,contended,waitNs,maxWaitNs,holdNs,maxHoldNs\n");
+    for (call=0; call<FMRTCALLS; call++)
+        dumpLockStatsLine (fPtr, "global", "", call, &(fmrtGlobalLockStats[call]));
+    for (i=nextTable(0); (i<MAXTABLES)&&(registryReady()); i=nextTable(i+1))
+    {
+        if ( (lockStats=Tables[i].lockStats) == NULL )
+            continue;
+        snprintf (lock, sizeof(lock), "%u", Tables[i].tableId);
+        for (call=0; call<FMRTCALLS; call++)
+            dumpLockStatsLine (fPtr, lock, Tables[i].tableName, call, &(lockStats[call]));
+    }
+    fflush (fPtr);
+
+    /* Remove global lock before exiting */
+    unlockGlobal ();
+
+    return;
+}
+
+
+/***********************************************************
+ * lockDumpThread()
+ * ---------------------------------------------------------
+ * This function is the body of the thread started by
+ * fmrtDumpLockStats() to print the lock statistics
+ * periodically, so that library calls releasing a lock
+ * never pay for the dump. The thread waits for the period
+ * on fmrtLockDumpCond, and terminates as soon as the period
+ * is set to 0 by fmrtDumpLockStats()
+ ***********************************************************/
+static void *lockDumpThread (void *arg)
+{
+    /* Local Variables */
+    struct timespec deadline;
+    FILE            *fPtr;
+
+    (void) arg;
+    pthread_mutex_lock (&fmrtLockDumpMtx);
+    clock_gettime (CLOCK_REALTIME, &deadline);
+    while (fmrtLockDumpPeriod>0)
+    {
+        deadline.tv_sec += fmrtLockDumpPeriod;
+        while ( (fmrtLockDumpPeriod>0) &&
+                (pthread_cond_timedwait (&fmrtLockDumpCond, &fmrtLockDumpMtx, &deadline) != ETIMEDOUT) );
+        if (fmrtLockDumpPeriod==0)
+            break;
+
+        /* The dump takes the global lock, fmrtLockDumpMtx is released not to block fmrtDumpLockStats() */
+        fPtr = fmrtLockDumpFile;
+        pthread_mutex_unlock (&fmrtLockDumpMtx);
+        dumpLockStats (fPtr);
+        pthread_mutex_lock (&fmrtLockDumpMtx);
+    }
+    pthread_mutex_unlock (&fmrtLockDumpMtx);
+
+    return (NULL);
+}
+
+
+/***********************************************************
+ * searchTable()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that perform
+ * read and write access to the structure.
+ * Given a tableId (first parameter) it provides the index in
+ * the Table[] structure corresponding to tableId (second
+ * parameter).
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   The entry has been correctly inserted into the tree
- * - FMRTDUPLICATEKEY
- *   The specified key is already present in the AVL Tree
+ *   The table has been found and corresponding index
+ *   properly set
  * - FMRTKO
  *   Result obtained when this is the first library
- *   call invoked by the caller
+ *   call invoked by the caller. Second parameter
+ *   is not meaningful
  * - FMRTIDNOTFOUND
- *   tableId is not defined
- * - FMRTOUTOFMEMORY
- *   The FMRT tree is full
+ *   tableId is not defined. Second parameter is not
+ *   meaningful
  ***********************************************************/
-fmrtResult fmrtCreate (fmrtId tableId, ...)
+static fmrtResult searchTable (fmrtId tableId, fmrtId *tableIndex)
+{
+    /* If this is the first invocation of the library provide error */
+    if (!registryReady())
+        return (FMRTKO);
+
+    /* The descriptor of each table is the element of Tables[] indexed by its tableId */
+    if (!tableDefined(tableId))
+        return (FMRTIDNOTFOUND);
+
+    /* set index as return value in the second parameter */
+    *tableIndex = tableId;
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * keyPrefix()
+ * ---------------------------------------------------------
+ * This function provides the normalized prefix of the
+ * string given as a parameter, i.e. its first 8 characters
+ * packed into an unsigned integer in big-endian order and
+ * padded with zeroes. Comparing the prefixes of two strings
+ * as integers gives the same ordering as strcmp() applied
+ * to their first 8 characters. The prefix is stored right
+ * before FMRTSTRING keys (see fmrtDefineKey())
+ ***********************************************************/
+static uint64_t keyPrefix (char *string)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,j,maxLen;
-    fmrtIndex    newElement,
-                rebalIndex;
-    void        *currentPtr;
-    fmrtResult   res;
-    uint32_t    keyInt;
-    int32_t     keySigned;
-    double      keyDouble;
-    time_t      keyTimestamp;
-    char        keyChar,
-                *string,
-                keyString[MAXFMRTSTRINGLEN+1];
-    fmrtNodeTraversalStack  *traversal,
-                            *rebalPtr;
+    uint8_t     j;
+    uint64_t    prefix = 0;
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    for (j=0; j<sizeof(uint64_t); j++)
+    {
+        prefix <<= 8;
+        if (*string!='\0')
+            prefix |= (unsigned char) *(string++);
+    }
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    return (prefix);
+}
 
-    /* Initialize the list of variable arguments in order to read the key first */
-    va_start (args,tableId);
-    switch (Tables[i].key.type)
+
+/***********************************************************
+ * compareStringKey()
+ * ---------------------------------------------------------
+ * This function compares a string key (third parameter),
+ * whose normalized prefix is given by the second parameter,
+ * with the FMRTSTRING key of the element pointed by the last
+ * parameter, in the table whose index is given by the first
+ * parameter. Most comparisons are resolved by comparing the
+ * prefixes, strcmp() is invoked only on prefix ties between
+ * keys longer than 7 characters
+ * ---------------------------------------------------------
+ * It returns a negative value, 0 or a positive value if the
+ * key is respectively lower, equal or greater than the one
+ * of the element
+ ***********************************************************/
+static int compareStringKey (fmrtId tableIndex, uint64_t prefix, char *string, void *currentPtr)
+{
+    /* Local Variables */
+    uint64_t    elemPrefix;
+
+    elemPrefix = *((uint64_t *)(currentPtr+Tables[tableIndex].key.delta-sizeof(uint64_t)));
+    if (prefix!=elemPrefix)
+        return ( FMRTCOMPARE (prefix, elemPrefix) );
+
+    /* Same prefix: if the last byte is 0 both strings are shorter than 8 chars, hence they are equal */
+    if ( (prefix & 0xFF)==0 )
+        return (0);
+
+    return ( strcmp (string+sizeof(uint64_t), (char *)(currentPtr+Tables[tableIndex].key.delta+sizeof(uint64_t))) );
+}
+
+
+/***********************************************************
+ * normalizeValue()
+ * ---------------------------------------------------------
+ * This function maps a value of the type given by the first
+ * parameter, pointed by the second parameter (with the same
+ * representation used into the elements, i.e. a char
+ * array for FMRTSTRING values), onto an unsigned 64 bits
+ * value preserving the order of the values, which is used
+ * by the B+-tree engine and by secondary indexes to compare
+ * values without accessing the elements. The mapping is
+ * exact for all types but FMRTSTRING, whose values are
+ * mapped onto their normalized prefix (see keyPrefix())
+ ***********************************************************/
+static uint64_t normalizeValue (fmrtType type, void *valuePtr)
+{
+    /* Local Variables */
+    uint64_t    nvalue = 0;
+    double      valueDouble;
+
+    switch (type)
     {
         case FMRTINT:
         {
-            keyInt = va_arg (args, uint32_t);
+            nvalue = (uint64_t) *((uint32_t *)valuePtr);
             break;
-        }
+        }   /* case FMRTINT */
         case FMRTSIGNED:
         {
-            keySigned = va_arg (args, int32_t);
+            nvalue = (uint64_t) (int64_t) *((int32_t *)valuePtr) ^ FMRTSIGNBIT;
             break;
-        }
+        }   /* case FMRTSIGNED */
         case FMRTDOUBLE:
-        {
-            keyDouble = va_arg (args, double);
+        {   /* -0.0 and 0.0 are equal, negative values are reversed */
+            valueDouble = *((double *)valuePtr);
+            if (valueDouble==0)
+                valueDouble = 0;
+            memcpy (&nvalue, &valueDouble, sizeof(nvalue));
+            nvalue = (nvalue & FMRTSIGNBIT) ? ~nvalue : nvalue | FMRTSIGNBIT;
             break;
-        }
+        }   /* case FMRTDOUBLE */
         case FMRTCHAR:
         {
-            keyChar = (unsigned char) va_arg (args,int);
+            nvalue = (uint64_t) (int64_t) *((char *)valuePtr) ^ FMRTSIGNBIT;
             break;
-        }
+        }   /* case FMRTCHAR */
         case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            string = va_arg (args,char*);
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            strncpy (keyString,string,maxLen);
-            keyString[maxLen-1] = '\0';
+        {
+            nvalue = keyPrefix ((char *)valuePtr);
             break;
-        }
+        }   /* case FMRTSTRING */
         case FMRTTIMESTAMP:
         {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> read raw timestamp from argument */
-                keyTimestamp = va_arg (args, time_t);
-            else
-            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestamp = mktime (&TimeFromString);
-                else
-                    keyTimestamp = 0;
-            }
+            nvalue = (uint64_t) (int64_t) *((time_t *)valuePtr) ^ FMRTSIGNBIT;
             break;
         }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
+    }   /* switch (type) */
 
-    /* call searchElem() internal function to look for the element and provide error if result is FMRTOK */
-    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTOK)
-    {   /* The element has been found, therefore it is already present */
-        va_end (args);
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTDUPLICATEKEY);
-    }
-    if (res!=FMRTNOTFOUND)
-    {   /* go on only if key is not present, otherwise provide error and return */
-        va_end (args);
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (res);
-    }
+    return (nvalue);
+}
 
-    /* The element is not present and traversal is a pointer to a LIFO structure     */
-    /* whose top element contains the index of the parent node and the corresponding */
-    /* subtree on which insertion shall be done                                      */
 
-    /* If not already called before, this is the first insertion */
-    if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
-    {   /* Initialize Empty elements list */
-        res = initEmptyList(i);
-        if (res!=FMRTOK)
-        {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
-            va_end (args);
-            clearNodeTraversalStack (traversal);
-            /* Clear the lock before exiting */
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            return (res);
-        }
-    }   /* if ( (Tables[i].fmrtData==NULL) ... */
+/***********************************************************
+ * normalizeKey()
+ * ---------------------------------------------------------
+ * This function maps the key given by the last six
+ * parameters (only the one corresponding to the key type
+ * of the table is meaningful, as in searchElem()) onto its
+ * normalized value (see normalizeValue())
+ ***********************************************************/
+static uint64_t normalizeKey (fmrtId tableIndex, uint32_t keyInt, int32_t keySigned, double keyDouble, char keyChar, char *keyString, time_t keyTimestamp)
+{
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+            return ( normalizeValue (FMRTINT, &keyInt) );
+        case FMRTSIGNED:
+            return ( normalizeValue (FMRTSIGNED, &keySigned) );
+        case FMRTDOUBLE:
+            return ( normalizeValue (FMRTDOUBLE, &keyDouble) );
+        case FMRTCHAR:
+            return ( normalizeValue (FMRTCHAR, &keyChar) );
+        case FMRTSTRING:
+            return ( normalizeValue (FMRTSTRING, keyString) );
+        case FMRTTIMESTAMP:
+            return ( normalizeValue (FMRTTIMESTAMP, &keyTimestamp) );
+    }   /* switch (Tables[tableIndex].key.type) */
 
-    /* Get an empty element from the list of empty nodes */
-    if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
-    {   /* Not able to fetch an empty element - Probably the table is full */
-        va_end (args);
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTOUTOFMEMORY);
-    }
+    return (0);
+}
 
-    /* Link the new element to the existing structure (if present) */
-    if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
-        Tables[i].fmrtRoot = newElement;
-    else if (traversal->go == LEFT)
-    {   /* the stack exists and the path from parent node goes through the left subtree */
-        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-        *((fmrtIndex*)currentPtr) = newElement;
-    }
-    else
-    {   /* the stack exists and the path from parent node goes through the right subtree */
-        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
-        *((fmrtIndex*)currentPtr) = newElement;
-    }
 
-    /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
-    currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+/***********************************************************
+ * elemKey()
+ * ---------------------------------------------------------
+ * This function provides the normalized key (see
+ * normalizeKey()) of the element pointed by currentPtr
+ ***********************************************************/
+static uint64_t elemKey (fmrtId tableIndex, void *currentPtr)
+{
+    /* The normalized prefix of FMRTSTRING keys is stored right before the key */
+    if (Tables[tableIndex].key.type==FMRTSTRING)
+        return ( *((uint64_t *)(currentPtr+Tables[tableIndex].key.delta-sizeof(uint64_t))) );
 
-    /* Insert null pointers to left and right subtree */
-    *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
-    *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+    return ( normalizeValue (Tables[tableIndex].key.type, currentPtr+Tables[tableIndex].key.delta) );
+}
 
-    /* copy the key into the newly created element */
-    switch (Tables[i].key.type)
+
+/***********************************************************
+ * encodeComponent()
+ * ---------------------------------------------------------
+ * This function encodes one component of a FMRTCOMPOSITE
+ * key (first parameter, see fmrtDefineCompositeKey()),
+ * whose value is held by the proper member of the
+ * fmrtKeyValue structure given by the second parameter, and
+ * stores it into the encoded key pointed by the last
+ * parameter, at the offset of the component (delta). Each
+ * component takes len bytes and is encoded so that the
+ * byte-wise order of the encoded values (i.e. memcmp())
+ * matches the order of the values:
+ * - FMRTINT, FMRTSIGNED, FMRTCHAR are stored big endian,
+ *   with the sign bit flipped for signed types
+ * - FMRTDOUBLE and FMRTTIMESTAMP are stored big endian
+ *   after normalization (see normalizeValue())
+ * - FMRTSTRING are stored as they are, padded with zeros
+ * Therefore the encoded keys compare as the sequences of
+ * their components, i.e. in lexicographic order
+ ***********************************************************/
+static void encodeComponent (fmrtField *comp, fmrtKeyValue *value, char *encoded)
+{
+    /* Local Variables */
+    uint64_t    nvalue = 0;
+    uint8_t     j;
+
+    switch (comp->type)
     {
         case FMRTINT:
         {
-            *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
+            nvalue = value->keyInt;
             break;
-        }
+        }   /* case FMRTINT */
         case FMRTSIGNED:
         {
-            *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
+            nvalue = (uint32_t) value->keySigned ^ 0x80000000;
             break;
-        }
+        }   /* case FMRTSIGNED */
+        case FMRTCHAR:
+        {
+            nvalue = (uint8_t) value->keyChar ^ 0x80;
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {   /* The string has been already truncated to len-1 characters, the component is padded with zeros */
+            memset (encoded+comp->delta, 0, comp->len);
+            memcpy (encoded+comp->delta, value->keyString, strnlen(value->keyString, comp->len));
+            return;
+        }   /* case FMRTSTRING */
         case FMRTDOUBLE:
         {
-            *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
+            nvalue = normalizeValue (FMRTDOUBLE, &(value->keyDouble));
             break;
-        }
+        }   /* case FMRTDOUBLE */
+        case FMRTTIMESTAMP:
+        {
+            nvalue = normalizeValue (FMRTTIMESTAMP, &(value->keyTimestamp));
+            break;
+        }   /* case FMRTTIMESTAMP */
+    }   /* switch (comp->type) */
+
+    /* Store the value big endian, i.e. most significant byte first */
+    for (j=comp->len; j>0; j--)
+    {
+        encoded[comp->delta+j-1] = (char) (nvalue & 0xFF);
+        nvalue >>= 8;
+    }
+
+    return;
+}
+
+
+/***********************************************************
+ * decodeComponent()
+ * ---------------------------------------------------------
+ * This function is the inverse of encodeComponent(). It
+ * decodes the component given by the first parameter from
+ * the encoded FMRTCOMPOSITE key pointed by the second
+ * parameter and stores its value into the proper member of
+ * the fmrtKeyValue structure given by the last parameter
+ ***********************************************************/
+static void decodeComponent (fmrtField *comp, void *encoded, fmrtKeyValue *value)
+{
+    /* Local Variables */
+    uint64_t    nvalue = 0;
+    uint8_t     j;
+    double      valueDouble;
+
+    if (comp->type==FMRTSTRING)
+    {   /* Strings are stored as they are (and always contain a trailing 0) */
+        strcpy (value->keyString, (char *)encoded+comp->delta);
+        return;
+    }
+
+    /* Load the value, stored big endian */
+    for (j=0; j<comp->len; j++)
+        nvalue = (nvalue << 8) | *((uint8_t *)encoded+comp->delta+j);
+
+    switch (comp->type)
+    {
+        case FMRTINT:
+        {
+            value->keyInt = (uint32_t) nvalue;
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            value->keySigned = (int32_t) (uint32_t) (nvalue ^ 0x80000000);
+            break;
+        }   /* case FMRTSIGNED */
         case FMRTCHAR:
         {
-            *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
+            value->keyChar = (char) (nvalue ^ 0x80);
             break;
-        }
-        case FMRTSTRING:
-        {   /* Please observe that keyString has been truncated when it has been read from the function argument */
-            strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
+        }   /* case FMRTCHAR */
+        case FMRTDOUBLE:
+        {   /* Reverse the mapping of normalizeValue() */
+            nvalue = (nvalue & FMRTSIGNBIT) ? nvalue & ~FMRTSIGNBIT : ~nvalue;
+            memcpy (&valueDouble, &nvalue, sizeof(valueDouble));
+            value->keyDouble = valueDouble;
             break;
-        }
+        }   /* case FMRTDOUBLE */
         case FMRTTIMESTAMP:
         {
-            *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
+            value->keyTimestamp = (time_t) (int64_t) (nvalue ^ FMRTSIGNBIT);
             break;
+        }   /* case FMRTTIMESTAMP */
+    }   /* switch (comp->type) */
+
+    return;
+}
+
+
+/***********************************************************
+ * formatCompositeKey()
+ * ---------------------------------------------------------
+ * This function formats the FMRTCOMPOSITE key pointed by
+ * the second parameter (encoded, see encodeComponent()) as
+ * its components separated by sep, using for each of them
+ * the same representation adopted by fmrtExportTableCsv()
+ * for keys and fields of the same type. The result is
+ * written into buf, whose size is bufLen (the result is
+ * truncated if longer)
+ * ---------------------------------------------------------
+ * It returns the number of characters written (as
+ * snprintf())
+ ***********************************************************/
+static size_t formatCompositeKey (fmrtId tableIndex, void *keyPtr, char sep, char *buf, size_t bufLen)
+{
+    /* Local Variables */
+    uint8_t         c;
+    size_t          len = 0;
+    fmrtKeyValue    value;
+    char            timestamp[MAXFMRTSTRINGLEN+1];
+
+    if (bufLen>0)
+        buf[0] = '\0';
+    for (c=0; (c<Tables[tableIndex].numKeyComps)&&(len<bufLen); c++)
+    {   /* Loop through all components, separated by sep */
+        if (c>0)
+            len += snprintf (buf+len, bufLen-len, "%c",sep);
+        if (len>=bufLen)
+            break;
+
+        decodeComponent (&(Tables[tableIndex].keyComps[c]), keyPtr, &value);
+        switch (Tables[tableIndex].keyComps[c].type)
+        {
+            case FMRTINT:
+            {
+                len += snprintf (buf+len, bufLen-len, "%u",value.keyInt);
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                len += snprintf (buf+len, bufLen-len, "%d",value.keySigned);
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                len += snprintf (buf+len, bufLen-len, "%lf",value.keyDouble);
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c",value.keyChar);
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                len += snprintf (buf+len, bufLen-len, "%s",value.keyString);
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    len += snprintf (buf+len, bufLen-len, "%ld",value.keyTimestamp);
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime(&(value.keyTimestamp)));
+                    len += snprintf (buf+len, bufLen-len, "%s",timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[tableIndex].keyComps[c].type) */
+    }   /* for (c=0; c<Tables[tableIndex].numKeyComps; c++) */
+
+    return (len);
+}
+
+
+/***********************************************************
+ * printKeyNames()
+ * ---------------------------------------------------------
+ * This function prints into the file pointed by the second
+ * parameter the name of the key of the table whose index is
+ * given by the first parameter, as in the header of CSV
+ * exports. FMRTCOMPOSITE keys take one column for each
+ * component, so the names of the components are printed,
+ * separated by sep
+ ***********************************************************/
+static void printKeyNames (fmrtId tableIndex, FILE *fPtr, char sep)
+{
+    /* Local Variables */
+    uint8_t     c;
+
+    if (Tables[tableIndex].key.type!=FMRTCOMPOSITE)
+    {
+        fprintf (fPtr, "%s", Tables[tableIndex].key.name);
+        return;
+    }
+
+    for (c=0; c<Tables[tableIndex].numKeyComps; c++)
+    {   /* Loop through all components, separated by sep */
+        if (c>0)
+            fprintf (fPtr, "%c", sep);
+        fprintf (fPtr, "%s", Tables[tableIndex].keyComps[c].name);
+    }
+
+    return;
+}
+
+
+/***********************************************************
+ * parseCompositeKey()
+ * ---------------------------------------------------------
+ * This function is used by fmrtImportCsv() to read a
+ * FMRTCOMPOSITE key from a CSV line, where its components
+ * take consecutive columns. On entry p and q (second and
+ * third parameters) point respectively to the beginning
+ * and to the end (already replaced by '\0') of the first
+ * column; the following columns are delimited by separator
+ * (fourth parameter). The encoded key is stored into the
+ * buffer pointed by the last parameter
+ * ---------------------------------------------------------
+ * It returns the pointer to the end of the last column of
+ * the key, or NULL if the line has not enough columns
+ ***********************************************************/
+static char *parseCompositeKey (fmrtId tableIndex, char *p, char *q, char separator, char *encoded)
+{
+    /* Local Variables */
+    uint8_t         c,
+                    maxLen;
+    size_t          len;
+    fmrtKeyValue    value;
+
+    memset (encoded, 0, Tables[tableIndex].key.len);
+    for (c=0; c<Tables[tableIndex].numKeyComps; c++)
+    {   /* Loop on the components of the key */
+        if (c>0)
+        {   /* Move to the next column */
+            p=q+1;
+            if (*p=='\0')
+                return (NULL);
+            for (q=p; (*q!='\0')&&(*q!=separator)&&(*q!='\n'); q+=1); /* stop at EOL or at separator */
+            *q = '\0';  /* p and q now points to the beginning and to the end of the c-th component */
         }
-    }   /* switch (Tables[i].key.type) */
 
-    /* Now read the variable list of arguments and use them to fill in the fields */
-    for (j=0; j<Tables[i].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[i].fields[j].type)
+        switch (Tables[tableIndex].keyComps[c].type)
         {
             case FMRTINT:
             {
-                *((uint32_t *)(currentPtr+Tables[i].fields[j].delta)) = va_arg (args,uint32_t);
-                 break;
+                value.keyInt = atoi (p);
+                break;
             }
             case FMRTSIGNED:
             {
-                *((int32_t *)(currentPtr+Tables[i].fields[j].delta)) = va_arg (args,int32_t);
-                 break;
+                value.keySigned = atoi (p);
+                break;
             }
             case FMRTDOUBLE:
             {
-                *((double *)(currentPtr+Tables[i].fields[j].delta)) = va_arg (args,double);
-                 break;
+                value.keyDouble = atof (p);
+                break;
             }
             case FMRTCHAR:
             {
-                *((char *)(currentPtr+Tables[i].fields[j].delta)) = (unsigned char) va_arg (args,int);
+                value.keyChar = *p;
                 break;
             }
             case FMRTSTRING:
-            {   /* In case of string exceeding the maximum length it is automatically truncated */
-                string = va_arg (args, char*);
-                maxLen = Tables[i].fields[j].len;       /* This field is max string length + trailing 0 */
-                strncpy ((char *)(currentPtr+Tables[i].fields[j].delta),string,maxLen);
-                *((char *)(currentPtr+Tables[i].fields[j].delta+maxLen-1)) = '\0';
+            {   /* Read the component and truncate to the maximum length specified during definition */
+                maxLen = Tables[tableIndex].keyComps[c].len;    /* This field is max string length + trailing 0 */
+                len = strnlen (p, maxLen-1);
+                memcpy (value.keyString, p, len);
+                value.keyString[len] = '\0';
                 break;
             }
             case FMRTTIMESTAMP:
             {
                 if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> read raw timestamp from argument */
-                    *((time_t *)(currentPtr+Tables[i].fields[j].delta)) = va_arg (args,time_t);
+                    /* time format empty --> read raw timestamp from input line */
+                    value.keyTimestamp = atol (p);
                 else
-                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                {   /* convert string read from input line to raw timestamp according to fmrtTimeFormat */
                     struct tm   TimeFromString;
-                    string = va_arg (args, char*);
-                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                        *((time_t *)(currentPtr+Tables[i].fields[j].delta)) = mktime (&TimeFromString);
+                    if (strptime (p, fmrtTimeFormat, &TimeFromString) != NULL)
+                        value.keyTimestamp = mktime (&TimeFromString);
                     else
-                        *((time_t *)(currentPtr+Tables[i].fields[j].delta)) = 0;
+                        value.keyTimestamp = 0;
                 }
                 break;
-            }
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    va_end (args);
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[tableIndex].keyComps[c].type) */
+        encodeComponent (&(Tables[tableIndex].keyComps[c]), &value, encoded);
+    }   /* for (c=0; c<Tables[tableIndex].numKeyComps; c++) */
 
-    /* Element has been inserted - Now go through the traversal LIFO structure and */
-    /* rebalance fmrt tree starting from the bottom and going up to the root        */
-    rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
-    while (rebalPtr!=NULL)
-    {   /* rebalance the subtree whose root is the current node */
-        rebalIndex = rebalanceSubTree (i,rebalPtr->index);  /* the root might change due to rotations */
-        /* go up to the parent */
-        rebalPtr = rebalPtr->next;
-        if (rebalPtr!=NULL)
-        {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
-            if (rebalPtr->go == LEFT)
-                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
-            else
-                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
-            /* The proper pointer is updated with the output of the rebalance structure */
-            *((fmrtIndex*)currentPtr) = rebalIndex;
-        }   /* if (rebalPtr!=NULL) */
-        else
-            /* There is no parent node - Rotation implies a change of the fmrt root pointer */
-            Tables[i].fmrtRoot = rebalIndex;
-    }   /* while (rebalPtr!=NULL) */
+    return (q);
+}
 
-    #ifdef FMRTDEBUG
-    printf ("\n\nCreated node at index: %d\n",newElement);
-    __fmrtDebugPrintNode (Tables[i].tableId, newElement);
-    printf ("Path from node up to the root:\n");
-    __fmrtPrintStack(i,traversal);
-    #endif
 
-    /* set Tables[i].status, increment number of stored elements, clear node traversal LIFO structure allocated by searchElem() and exit */
-    Tables[i].status = NOTEMPTY;
-    Tables[i].currentNumElem += 1;
-    clearNodeTraversalStack (traversal);
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * btCompare()
+ * ---------------------------------------------------------
+ * This function compares a key, given by its normalized
+ * value (second parameter) and, for FMRTSTRING keys, by the
+ * string itself (third parameter), with the key in position
+ * pos of the B+-tree node given by the fourth parameter.
+ * The element is accessed only on ties between FMRTSTRING
+ * keys longer than 7 characters
+ * ---------------------------------------------------------
+ * It returns a negative value, 0 or a positive value if the
+ * key is respectively lower, equal or greater than the one
+ * in the node
+ ***********************************************************/
+static int btCompare (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtBtNode *node, uint16_t pos)
+{
+    /* Local Variables */
+    uint64_t    nodeKey = btKeys(tableIndex,node)[pos];
 
-    return (FMRTOK);
+    if ( (nkey!=nodeKey) || (Tables[tableIndex].key.type!=FMRTSTRING) || ((nkey & 0xFF)==0) )
+        return ( FMRTCOMPARE (nkey, nodeKey) );
+
+    return ( compareStringKey (tableIndex, nkey, keyString, Tables[tableIndex].fmrtData + btElems(tableIndex,node)[pos]*Tables[tableIndex].elemSize) );
 }
 
 
 /***********************************************************
- * fmrtModify()
+ * btLowerBound()
  * ---------------------------------------------------------
- * This library call is used to update an existing entry
- * into the fmrt tree. It is a call with a variable number of
- * arguments. The first three parameters (always present) are
- * respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - paramMask
- *   It is a bitwise mask that is used to identify the
- *   parameters to be changed. For example, assuming that
- *   5 parameters have been defined through fmrtDefineFields(),
- *   e.g.
- *     fmrtDefineFields(tableId,5,param#0,..,param#1,..param#4)
- *   and that we want to update only parameters 0,1 and 4,
- *   we would set paramMask as follows:
- *     paramMask = 19  -->  binary 10011
- *   The rightmost bit represents the first parameter in
- *   fmrtDefineFields(), the one immediately at its left is the
- *   second parameter, and so on.
- * - key
- *   contains the key value to be searched into the table.
- *   It shall be of the same type defined by the
- *   fmrtDefineKey() call. The library behaviour is undefined
- *   if this constraint is not satisfied. In case of string
- *   key, the length is truncated to the max length specified
- *   at key definition through fmrtDefineKey().
- * After those mandatory parameters, there is a list of
- * parameters that are used to update the fields of the
- * entry that is going to be modified. Parameters are ordered
- * according to the same order used in definition (i.e.
- * in fmrtDefinFields() library call). Be aware that
- * parameters number and types shall be correct, otherwise
- * the call may cause run-time errors. All parameters shall be
- * included in the call, but the only ones that will be updated
- * are those pointed by the paramMask, as explained above.
- * In case of string parameters, the length is truncated to
- * the max length specified at field definition through
- * fmrtDefineFields().
+ * This function performs a binary search of a key (given as
+ * in btCompare()) into the B+-tree node given by the fourth
+ * parameter. found is set to 1 if the key is in the node
+ * ---------------------------------------------------------
+ * It returns the position of the first key of the node
+ * greater than or equal to the given one (i.e. node->count
+ * if all keys are lower)
+ ***********************************************************/
+static uint16_t btLowerBound (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtBtNode *node, uint8_t *found)
+{
+    /* Local Variables */
+    uint16_t    low = 0,
+                high = node->count,
+                mid;
+
+    while (low<high)
+    {
+        mid = (low+high)/2;
+        if (btCompare(tableIndex, nkey, keyString, node, mid) > 0)
+            low = mid+1;
+        else
+            high = mid;
+    }   /* while (low<high) */
+    *found = (low<node->count) && (btCompare(tableIndex, nkey, keyString, node, low)==0);
+
+    return (low);
+}
+
+
+/***********************************************************
+ * btLocate()
+ * ---------------------------------------------------------
+ * This function descends the B+-tree from the root down to
+ * the leaf that contains (or would contain) the given key,
+ * i.e. keys equal to a separator are looked for into the
+ * right subtree of the separator. leaf and pos are set to
+ * the leaf and to the position of the first key greater
+ * than or equal to the given one (leaf is FMRTNULLPTR if
+ * the B+-tree is empty)
+ * ---------------------------------------------------------
+ * It returns 1 if the key has been found, 0 otherwise
+ ***********************************************************/
+static uint8_t btLocate (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtIndex *leaf, uint16_t *pos)
+{
+    /* Local Variables */
+    uint8_t     found = 0;
+    fmrtBtNode  *node;
+
+    *leaf = Tables[tableIndex].btRoot;
+    *pos = 0;
+    while (*leaf!=FMRTNULLPTR)
+    {
+        node = btNode (tableIndex, *leaf);
+        *pos = btLowerBound (tableIndex, nkey, keyString, node, &found);
+        if (node->leaf)
+            break;
+        *leaf = btChildren(tableIndex,node)[found ? *pos+1 : *pos];
+    }   /* while (*leaf!=FMRTNULLPTR) */
+
+    return (found);
+}
+
+
+/***********************************************************
+ * btSearchElem()
+ * ---------------------------------------------------------
+ * This is the counterpart of searchElem() for tables using
+ * the B+-tree engine. If the element is found, the LIFO
+ * structure provided back contains just the element itself
+ * (there is no path to be rebalanced, as opposed to the
+ * AVL tree)
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   The entry has been correctly updated into the tree
+ *   The entry has been found
  * - FMRTNOTFOUND
- *   The entry with the given key is not present in the table
- * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller
- * - FMRTIDNOTFOUND
- *   tableId is not defined
+ *   The entry with the given key is not present in the
+ *   table, the LIFO structure is empty
  ***********************************************************/
-fmrtResult fmrtModify (fmrtId tableId, fmrtParamMask paramMask, ...)
+static fmrtResult btSearchElem (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtNodeTraversalStack **stackPtr)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,j,maxLen;
-    void        *currentPtr;
-    fmrtResult   res;
-    uint32_t    keyInt,
-                fieldInt;
-    int32_t     keySigned,
-                fieldSigned;
-    double      keyDouble,
-                fieldDouble;
-    time_t      keyTimestamp,
-                fieldTimestamp;
-    char        keyChar,
-                fieldChar,
-                *string,
-                keyString[MAXFMRTSTRINGLEN+1];
-    fmrtParamMask    mask;
-    fmrtNodeTraversalStack *traversal;
+    fmrtIndex   leaf;
+    uint16_t    pos;
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    if (!btLocate(tableIndex, nkey, keyString, &leaf, &pos))
+        return (FMRTNOTFOUND);
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    *stackPtr = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
+    (*stackPtr)->index = btElems(tableIndex,btNode(tableIndex,leaf))[pos];
+    (*stackPtr)->go = STAY;
+    (*stackPtr)->next = NULL;
 
-    /* Initialize the list of variable arguments in order to read the key first */
-    va_start (args,paramMask);
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            keyInt = va_arg (args, uint32_t);
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            keySigned = va_arg (args, int32_t);
-            break;
-        }
-        case FMRTDOUBLE:
-        {
-            keyDouble = va_arg (args, double);
-            break;
-        }
-        case FMRTCHAR:
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * btInsertEntry()
+ * ---------------------------------------------------------
+ * This function inserts a key (normalized value and element
+ * index) in position pos of the B+-tree node given by the
+ * second parameter and, for internal nodes, the child
+ * holding the keys greater than or equal to it in position
+ * pos+1. If the node is full, it is split in two halves and
+ * the new node is provided back along with the key to be
+ * inserted into the parent (the first key of the new node
+ * for leaves, the median key for internal nodes). The node
+ * is split through the scratch area of the table, which
+ * can hold btFanout+1 keys
+ * ---------------------------------------------------------
+ * It returns 1 if the node has been split, 0 otherwise
+ ***********************************************************/
+static uint8_t btInsertEntry (fmrtId tableIndex, fmrtIndex index, uint16_t pos, uint64_t nkey, fmrtIndex elem, fmrtIndex child, uint64_t *upKey, fmrtIndex *upElem, fmrtIndex *upNode)
+{
+    /* Local Variables */
+    uint16_t    fanout = Tables[tableIndex].btFanout,
+                left;
+    fmrtIndex   newIndex,
+                *scratchElems,
+                *scratchChildren;
+    uint64_t    *scratchKeys;
+    fmrtBtNode  *node = btNode (tableIndex, index),
+                *newNode;
+
+    if (node->count<fanout)
+    {   /* There is room for the new key */
+        memmove (btKeys(tableIndex,node)+pos+1, btKeys(tableIndex,node)+pos, (node->count-pos)*sizeof(uint64_t));
+        memmove (btElems(tableIndex,node)+pos+1, btElems(tableIndex,node)+pos, (node->count-pos)*sizeof(fmrtIndex));
+        btKeys(tableIndex,node)[pos] = nkey;
+        btElems(tableIndex,node)[pos] = elem;
+        if (!node->leaf)
         {
-            keyChar = (unsigned char) va_arg (args,int);
-            break;
-        }
-        case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            string = va_arg (args,char*);
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            strncpy (keyString,string,maxLen);
-            keyString[maxLen-1] = '\0';
-            break;
+            memmove (btChildren(tableIndex,node)+pos+2, btChildren(tableIndex,node)+pos+1, (node->count-pos)*sizeof(fmrtIndex));
+            btChildren(tableIndex,node)[pos+1] = child;
         }
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> read raw timestamp from argument */
-                keyTimestamp = va_arg (args, time_t);
-            else
-            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestamp = mktime (&TimeFromString);
-                else
-                    keyTimestamp = 0;
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
+        node->count += 1;
+        return (0);
+    }
 
-    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
-    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+    /* The node is full: merge its content with the new key into the scratch area... */
+    scratchKeys = (uint64_t *) Tables[tableIndex].btScratch;
+    scratchElems = (fmrtIndex *) (scratchKeys+fanout+1);
+    scratchChildren = scratchElems+fanout+1;
+    memcpy (scratchKeys, btKeys(tableIndex,node), pos*sizeof(uint64_t));
+    memcpy (scratchKeys+pos+1, btKeys(tableIndex,node)+pos, (fanout-pos)*sizeof(uint64_t));
+    memcpy (scratchElems, btElems(tableIndex,node), pos*sizeof(fmrtIndex));
+    memcpy (scratchElems+pos+1, btElems(tableIndex,node)+pos, (fanout-pos)*sizeof(fmrtIndex));
+    scratchKeys[pos] = nkey;
+    scratchElems[pos] = elem;
+    if (!node->leaf)
     {
-        va_end (args);
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (res);
+        memcpy (scratchChildren, btChildren(tableIndex,node), (pos+1)*sizeof(fmrtIndex));
+        memcpy (scratchChildren+pos+2, btChildren(tableIndex,node)+pos+1, (fanout-pos)*sizeof(fmrtIndex));
+        scratchChildren[pos+1] = child;
     }
 
-    /* The element was found and traversal is a pointer to a LIFO structure */
-    /* whose top element contains the index of the node we searched         */
-    /* Set currentPtr to point to the first byte of the structure           */
-    currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-
-    /* Now read the variable list of arguments and use them to fill in the fields according to the param mask */
-    mask=paramMask;
-    for (j=0; j<Tables[i].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[i].fields[j].type)
-        {   /* read all parameters, but update them if and only if the orresponding bit in the mask is set */
-            case FMRTINT:
-            {
-                fieldInt = va_arg (args,uint32_t);
-                if (mask%2)
-                    *((uint32_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldInt;
-                 break;
-            }
-            case FMRTSIGNED:
-            {
-                fieldSigned = va_arg (args,int32_t);
-                if (mask%2)
-                    *((int32_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldSigned;
-                 break;
-            }
-            case FMRTDOUBLE:
-            {
-                fieldDouble = va_arg (args,double);
-                if (mask%2)
-                    *((double *)(currentPtr+Tables[i].fields[j].delta)) = fieldDouble;
-                 break;
-            }
-            case FMRTCHAR:
-            {
-                fieldChar = (unsigned char) va_arg (args,int);
-                if (mask%2)
-                    *((char *)(currentPtr+Tables[i].fields[j].delta)) = fieldChar;
-                break;
-            }
-            case FMRTSTRING:
-            {   /* In case of string exceeding the maximum length it is automatically truncated */
-                string = va_arg (args,char*);
-                maxLen = Tables[i].fields[j].len;       /* This field is max string length + trailing 0 */
-                if (mask%2)
-                {
-                    strncpy ((char *)(currentPtr+Tables[i].fields[j].delta),string,maxLen);
-                    *((char *)(currentPtr+Tables[i].fields[j].delta+maxLen-1)) = '\0';
-                }
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> read raw timestamp from argument */
-                    fieldTimestamp = va_arg (args,time_t);
-                else
-                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                    struct tm   TimeFromString;
-                    string = va_arg (args, char*);
-                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                        fieldTimestamp = mktime (&TimeFromString);
-                    else
-                        fieldTimestamp = 0;
-                }
-                if (mask%2)
-                    *((time_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldTimestamp;
-                 break;
-            }
-        }   /* switch (Tables[i].fields[j].type) */
-        mask>>=1;
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    va_end (args);
-
-    /* Element has been updated - There is no need to rebalance the fmrt tree */
+    /* ... then split it between the node and a new one (nodes have been reserved, node is still valid) */
+    newIndex = btAllocNode (tableIndex, node->leaf);
+    newNode = btNode (tableIndex, newIndex);
+    if (node->leaf)
+    {   /* Leaves: the first key of the new leaf is copied into the parent */
+        left = (fanout+2)/2;
+        node->count = left;
+        newNode->count = fanout+1-left;
+        memcpy (btKeys(tableIndex,node), scratchKeys, left*sizeof(uint64_t));
+        memcpy (btElems(tableIndex,node), scratchElems, left*sizeof(fmrtIndex));
+        memcpy (btKeys(tableIndex,newNode), scratchKeys+left, newNode->count*sizeof(uint64_t));
+        memcpy (btElems(tableIndex,newNode), scratchElems+left, newNode->count*sizeof(fmrtIndex));
+        *upKey = scratchKeys[left];
+        *upElem = scratchElems[left];
+        /* Link the new leaf into the list of leaves */
+        newNode->next = node->next;
+        newNode->prev = index;
+        if (node->next!=FMRTNULLPTR)
+            btNode(tableIndex,node->next)->prev = newIndex;
+        else
+            Tables[tableIndex].btLast = newIndex;
+        node->next = newIndex;
+    }
+    else
+    {   /* Internal nodes: the median key is moved into the parent */
+        left = (fanout+1)/2;
+        node->count = left;
+        newNode->count = fanout-left;
+        memcpy (btKeys(tableIndex,node), scratchKeys, left*sizeof(uint64_t));
+        memcpy (btElems(tableIndex,node), scratchElems, left*sizeof(fmrtIndex));
+        memcpy (btChildren(tableIndex,node), scratchChildren, (left+1)*sizeof(fmrtIndex));
+        memcpy (btKeys(tableIndex,newNode), scratchKeys+left+1, newNode->count*sizeof(uint64_t));
+        memcpy (btElems(tableIndex,newNode), scratchElems+left+1, newNode->count*sizeof(fmrtIndex));
+        memcpy (btChildren(tableIndex,newNode), scratchChildren+left+1, (newNode->count+1)*sizeof(fmrtIndex));
+        *upKey = scratchKeys[left];
+        *upElem = scratchElems[left];
+    }
+    *upNode = newIndex;
 
-    #ifdef FMRTDEBUG
-    printf ("\n\nModified node at index: %d\n",traversal->index);
-    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
-    printf ("Path from node up to the root:\n");
-    __fmrtPrintStack(i,traversal);
-    #endif
+    return (1);
+}
 
-    /* clear node traversal LIFO structure allocated by searchElem() and exit */
-    clearNodeTraversalStack (traversal);
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * btInsertRecurse()
+ * ---------------------------------------------------------
+ * This function inserts a key (given as in btCompare()),
+ * corresponding to the element given by the fifth
+ * parameter, into the subtree of the B+-tree rooted in the
+ * node given by the second parameter. The key shall not be
+ * already present. If the root of the subtree is split,
+ * the new node and the key to be inserted into the parent
+ * are provided back (see btInsertEntry())
+ * ---------------------------------------------------------
+ * It returns 1 if the root of the subtree has been split,
+ * 0 otherwise
+ ***********************************************************/
+static uint8_t btInsertRecurse (fmrtId tableIndex, fmrtIndex index, uint64_t nkey, char *keyString, fmrtIndex elem, uint64_t *upKey, fmrtIndex *upElem, fmrtIndex *upNode)
+{
+    /* Local Variables */
+    uint8_t     found;
+    uint16_t    pos;
+    uint64_t    childKey;
+    fmrtIndex   childElem,
+                childNode;
+    fmrtBtNode  *node = btNode (tableIndex, index);
+
+    pos = btLowerBound (tableIndex, nkey, keyString, node, &found);
+    if (node->leaf)
+        return ( btInsertEntry (tableIndex, index, pos, nkey, elem, FMRTNULLPTR, upKey, upElem, upNode) );
+
+    /* Keys equal to a separator are in its right subtree; if the child is split, its new sibling follows it */
+    pos = found ? pos+1 : pos;
+    if (!btInsertRecurse(tableIndex, btChildren(tableIndex,node)[pos], nkey, keyString, elem, &childKey, &childElem, &childNode))
+        return (0);
 
-    return (FMRTOK);
+    return ( btInsertEntry (tableIndex, index, pos, childKey, childElem, childNode, upKey, upElem, upNode) );
 }
 
 
 /***********************************************************
- * fmrtCreateModify()
+ * btInsert()
  * ---------------------------------------------------------
- * This library call is used to insert or update an entry
- * into the fmrt tree. If the entry esists, its data are
- * updated according to the mask specified as second
- * parameter. Rather, if the entry does not exist, it is
- * created. In this case the bitwise mask is meaningless, i.e.
- * all parameters specified are used to fill the content of
- * corresponding fields in the newly created element.
- * The first three parameters (always present) are
- * respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - paramMask
- *   It is a bitwise mask that is used to identify the
- *   parameters to be changed (in case of entry already
- *   present in the table). For example, assuming that
- *   5 parameters have been defined through fmrtDefineFields(),
- *   e.g.
- *     fmrtDefineFields(tableId,5,param#0,..,param#1,..param#4)
- *   and that we want to update only parameters 0,1 and 4,
- *   we would set paramMask as follows:
- *     paramMask = 19  -->  binary 10011
- *   The rightmost bit represents the first parameter in
- *   fmrtDefineFields(), the one immediately at its left is the
- *   second parameter, and so on.
- *   This parameter is meaningless in case of new element
- *   created in the table.
- * - key
- *   contains the key value to be searched into the table.
- *   It shall be of the same type defined by the
- *   fmrtDefineKey() call. The library behaviour is undefined
- *   if this constraint is not satisfied. In case of string
- *   key, the length is truncated to the max length specified
- *   at key definition through fmrtDefineKey().
- * After those mandatory parameters, there is a list of
- * parameters that are used to update the fields of the
- * entry that is going to be modified. Parameters are ordered
- * according to the same order used in definition (i.e.
- * in fmrtDefinFields() library call). Be aware that
- * parameters number and types shall be correct, otherwise
- * the call may cause run-time errors. All parameters shall be
- * included in the call, but the only ones that will be updated
- * are those pointed by the paramMask, as explained above.
- * In case of string parameters, the length is truncated to
- * the max length specified at field definition through
- * fmrtDefineFields().
- * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   The entry has been correctly inserted or updated into
- *   the tree
- * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller
- * - FMRTIDNOTFOUND
- *   tableId is not defined
- * - FMRTOUTOFMEMORY
- *   The FMRT tree is full
+ * This function links the element given by the second
+ * parameter, whose key shall be already stored and shall
+ * not be present in the table, into the B+-tree. The nodes
+ * needed have been reserved by getEmptyElem(), which gets
+ * the element, therefore the operation cannot fail
  ***********************************************************/
-fmrtResult fmrtCreateModify (fmrtId tableId, fmrtParamMask paramMask, ...)
+static void btInsert (fmrtId tableIndex, fmrtIndex elem)
 {
     /* Local Variables */
-    va_list         args;
-    uint8_t         i,j,maxLen,duplKey;
-    void            *currentPtr;
-    fmrtResult      res;
-    fmrtIndex       newElement,
-                    rebalIndex;
-    uint32_t        keyInt,
-                    fieldInt[MAXFMRTFIELDNUM];
-    int32_t         keySigned,
-                    fieldSigned[MAXFMRTFIELDNUM];
-    double          keyDouble,
-                    fieldDouble[MAXFMRTFIELDNUM];
-    time_t          keyTimestamp,
-                    fieldTimestamp[MAXFMRTFIELDNUM];
-    char            keyChar,
-                    fieldChar[MAXFMRTFIELDNUM],
-                    *string,
-                    keyString[MAXFMRTSTRINGLEN+1],
-                    fieldString[MAXFMRTFIELDNUM][MAXFMRTSTRINGLEN+1];
-    fmrtParamMask    mask;
-    fmrtNodeTraversalStack *traversal,
-                           *rebalPtr;
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+    uint64_t    upKey;
+    fmrtIndex   upElem,
+                upNode,
+                newRoot;
+    fmrtBtNode  *root;
+
+    /* The first element creates the root, which is a leaf */
+    if (Tables[tableIndex].btRoot==FMRTNULLPTR)
+    {
+        Tables[tableIndex].btRoot = btAllocNode (tableIndex, 1);
+        Tables[tableIndex].btFirst = Tables[tableIndex].btLast = Tables[tableIndex].btRoot;
+        Tables[tableIndex].btHeight = 1;
+    }
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    /* If the root is split, a new root is created and the B+-tree grows by one level */
+    if (btInsertRecurse(tableIndex, Tables[tableIndex].btRoot, elemKey(tableIndex,currentPtr), (char *)(currentPtr+Tables[tableIndex].key.delta), elem, &upKey, &upElem, &upNode))
+    {
+        newRoot = btAllocNode (tableIndex, 0);
+        root = btNode (tableIndex, newRoot);
+        root->count = 1;
+        btKeys(tableIndex,root)[0] = upKey;
+        btElems(tableIndex,root)[0] = upElem;
+        btChildren(tableIndex,root)[0] = Tables[tableIndex].btRoot;
+        btChildren(tableIndex,root)[1] = upNode;
+        Tables[tableIndex].btRoot = newRoot;
+        Tables[tableIndex].btHeight += 1;
+    }
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    return;
+}
 
-    /* Initialize the list of variable arguments in order to read the key first */
-    va_start (args,paramMask);
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            keyInt = va_arg (args, uint32_t);
-            break;
-        }
-        case FMRTSIGNED:
+
+/***********************************************************
+ * btRebalance()
+ * ---------------------------------------------------------
+ * This function restores the minimum occupancy (btFanout/2
+ * keys) of the child in position pos of the internal node
+ * given by the second parameter, after a deletion. A key
+ * is borrowed from a sibling if it has more keys than the
+ * minimum, otherwise the child is merged with a sibling,
+ * and the node loses one key
+ ***********************************************************/
+static void btRebalance (fmrtId tableIndex, fmrtIndex index, uint16_t pos)
+{
+    /* Local Variables */
+    uint16_t    minKeys = Tables[tableIndex].btFanout/2;
+    fmrtIndex   *children,
+                leftIndex,
+                rightIndex;
+    fmrtBtNode  *parent = btNode (tableIndex, index),
+                *child,
+                *sibling,
+                *left,
+                *right;
+
+    children = btChildren (tableIndex, parent);
+    child = btNode (tableIndex, children[pos]);
+
+    if ( (pos>0) && ((sibling=btNode(tableIndex,children[pos-1]))->count > minKeys) )
+    {   /* Borrow the last key of the left sibling */
+        memmove (btKeys(tableIndex,child)+1, btKeys(tableIndex,child), child->count*sizeof(uint64_t));
+        memmove (btElems(tableIndex,child)+1, btElems(tableIndex,child), child->count*sizeof(fmrtIndex));
+        if (child->leaf)
         {
-            keySigned = va_arg (args, int32_t);
-            break;
+            btKeys(tableIndex,child)[0] = btKeys(tableIndex,sibling)[sibling->count-1];
+            btElems(tableIndex,child)[0] = btElems(tableIndex,sibling)[sibling->count-1];
+            btKeys(tableIndex,parent)[pos-1] = btKeys(tableIndex,child)[0];
+            btElems(tableIndex,parent)[pos-1] = btElems(tableIndex,child)[0];
         }
-        case FMRTDOUBLE:
-        {
-            keyDouble = va_arg (args, double);
-            break;
+        else
+        {   /* Internal nodes: the separator goes down and the last key of the sibling goes up */
+            memmove (btChildren(tableIndex,child)+1, btChildren(tableIndex,child), (child->count+1)*sizeof(fmrtIndex));
+            btKeys(tableIndex,child)[0] = btKeys(tableIndex,parent)[pos-1];
+            btElems(tableIndex,child)[0] = btElems(tableIndex,parent)[pos-1];
+            btChildren(tableIndex,child)[0] = btChildren(tableIndex,sibling)[sibling->count];
+            btKeys(tableIndex,parent)[pos-1] = btKeys(tableIndex,sibling)[sibling->count-1];
+            btElems(tableIndex,parent)[pos-1] = btElems(tableIndex,sibling)[sibling->count-1];
         }
-        case FMRTCHAR:
+        child->count += 1;
+        sibling->count -= 1;
+        return;
+    }
+
+    if ( (pos<parent->count) && ((sibling=btNode(tableIndex,children[pos+1]))->count > minKeys) )
+    {   /* Borrow the first key of the right sibling */
+        if (child->leaf)
         {
-            keyChar = (unsigned char) va_arg (args,int);
-            break;
+            btKeys(tableIndex,child)[child->count] = btKeys(tableIndex,sibling)[0];
+            btElems(tableIndex,child)[child->count] = btElems(tableIndex,sibling)[0];
+            btKeys(tableIndex,parent)[pos] = btKeys(tableIndex,sibling)[1];
+            btElems(tableIndex,parent)[pos] = btElems(tableIndex,sibling)[1];
         }
-        case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            string = va_arg (args,char*);
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            strncpy (keyString,string,maxLen);
-            keyString[maxLen-1] = '\0';
-            break;
+        else
+        {   /* Internal nodes: the separator goes down and the first key of the sibling goes up */
+            btKeys(tableIndex,child)[child->count] = btKeys(tableIndex,parent)[pos];
+            btElems(tableIndex,child)[child->count] = btElems(tableIndex,parent)[pos];
+            btChildren(tableIndex,child)[child->count+1] = btChildren(tableIndex,sibling)[0];
+            btKeys(tableIndex,parent)[pos] = btKeys(tableIndex,sibling)[0];
+            btElems(tableIndex,parent)[pos] = btElems(tableIndex,sibling)[0];
+            memmove (btChildren(tableIndex,sibling), btChildren(tableIndex,sibling)+1, sibling->count*sizeof(fmrtIndex));
         }
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> read raw timestamp from argument */
-                keyTimestamp = va_arg (args, time_t);
-            else
-            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestamp = mktime (&TimeFromString);
-                else
-                    keyTimestamp = 0;
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
-
-    /* Now read the variable list of arguments and use them to fill in the fields */
-    for (j=0; j<Tables[i].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[i].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                fieldInt[j] = va_arg (args,uint32_t);
-                break;
-            }
-            case FMRTSIGNED:
-            {
-                fieldSigned[j] = va_arg (args,int32_t);
-                break;
-            }
-            case FMRTDOUBLE:
-            {
-                fieldDouble[j] = va_arg (args,double);
-                break;
-            }
-            case FMRTCHAR:
-            {
-                fieldChar[j] = (unsigned char) va_arg (args,int);
-                break;
-            }
-            case FMRTSTRING:
-            {   /* In case of string exceeding the maximum length it is automatically truncated */
-                string = va_arg (args,char*);
-                maxLen = Tables[i].fields[j].len;       /* This field is max string length + trailing 0 */
-                strncpy (fieldString[j],string,maxLen);
-                fieldString[j][maxLen-1] = '\0';
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> read raw timestamp from argument */
-                    fieldTimestamp[j] = va_arg (args,time_t);
-                else
-                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                    struct tm   TimeFromString;
-                    string = va_arg (args, char*);
-                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                        fieldTimestamp[j] = mktime (&TimeFromString);
-                    else
-                        fieldTimestamp[j] = 0;
-                }
-                break;
-            }
-        }   /* switch (Tables[i].fields[j].type) */
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
-    va_end (args);
-
-    /* call searchElem() internal function to look for the element and provide error if result is FMRTKO */
-
-    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTKO)
-    {   /* This is a blocking error -> release traversal stack, clear the lock and exit */
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTKO);
+        memmove (btKeys(tableIndex,sibling), btKeys(tableIndex,sibling)+1, (sibling->count-1)*sizeof(uint64_t));
+        memmove (btElems(tableIndex,sibling), btElems(tableIndex,sibling)+1, (sibling->count-1)*sizeof(fmrtIndex));
+        child->count += 1;
+        sibling->count -= 1;
+        return;
     }
 
-    /* If the element is already present set duplKey to 1 and use input parameter mask*/
-    if (res==FMRTOK)
-    {   /* the element exists and shall be modified changing only parameters specified by paramMask */
-        duplKey = 1;
-        mask = paramMask;
+    /* Siblings cannot lend keys: merge the child with one of them (the right node into the left one) */
+    if (pos>0)
+        pos -= 1;
+    leftIndex = children[pos];
+    rightIndex = children[pos+1];
+    left = btNode (tableIndex, leftIndex);
+    right = btNode (tableIndex, rightIndex);
+    if (left->leaf)
+    {   /* Leaves: the right one is removed from the list of leaves */
+        left->next = right->next;
+        if (right->next!=FMRTNULLPTR)
+            btNode(tableIndex,right->next)->prev = leftIndex;
+        else
+            Tables[tableIndex].btLast = leftIndex;
     }
     else
-    {   /* the element does not exist and shall be created - mask is set to all 1's in order to set all elements */
-        duplKey = 0;
-        mask = -1;
+    {   /* Internal nodes: the separator goes down between the keys of the two nodes */
+        btKeys(tableIndex,left)[left->count] = btKeys(tableIndex,parent)[pos];
+        btElems(tableIndex,left)[left->count] = btElems(tableIndex,parent)[pos];
+        left->count += 1;
+        memcpy (btChildren(tableIndex,left)+left->count, btChildren(tableIndex,right), (right->count+1)*sizeof(fmrtIndex));
     }
+    memcpy (btKeys(tableIndex,left)+left->count, btKeys(tableIndex,right), right->count*sizeof(uint64_t));
+    memcpy (btElems(tableIndex,left)+left->count, btElems(tableIndex,right), right->count*sizeof(fmrtIndex));
+    left->count += right->count;
+    btFreeNode (tableIndex, rightIndex);
 
-    /* traversal is a pointer to a LIFO structure, while duplKey specifies if the key */
-    /* is already present in the table (and shall be overwritten), or is new. In the  */
-    /* former case the top element of traversal stack points directly to the index    */
-    /* in the FMRT structure, while in the latter it points to the parent on which     */
-    /* insertion shall be done                                                        */
+    /* The separator and the right node are removed from the parent */
+    memmove (btKeys(tableIndex,parent)+pos, btKeys(tableIndex,parent)+pos+1, (parent->count-pos-1)*sizeof(uint64_t));
+    memmove (btElems(tableIndex,parent)+pos, btElems(tableIndex,parent)+pos+1, (parent->count-pos-1)*sizeof(fmrtIndex));
+    memmove (children+pos+1, children+pos+2, (parent->count-pos-1)*sizeof(fmrtIndex));
+    parent->count -= 1;
 
-    if (duplKey)
-    {   /* the element is still present, overwrite data contained into the internal structure */
-        /* since the element has been found traversal cannot be NULL in this case             */
-        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-    }   /* if (duplKey) */
-    else
-    {   /* the element is not present -> create it */
-        /* Check if this is the first insertion */
-        if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
-        {   /* Initialize Empty elements list */
-            res = initEmptyList(i);
-            if (res!=FMRTOK)
-            {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
-                clearNodeTraversalStack (traversal);
-                /* Clear the lock before exiting */
-                pthread_mutex_unlock(&(Tables[i].tableMtx));
-                return (res);
-            }
-        }   /* if ( (Tables[i].fmrtData==NULL) ... */
+    return;
+}
 
-        /* Get an empty element from the list of empty nodes */
-        if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
-        {   /* Not able to fetch an empty element - Probably the table is full */
-            clearNodeTraversalStack (traversal);
-            /* Clear the lock before exiting */
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            return (FMRTOUTOFMEMORY);
-        }
 
-        /* Link the new element to the existing structure (if present) */
-        if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
-            Tables[i].fmrtRoot = newElement;
-        else if (traversal->go == LEFT)
-        {   /* the stack exists and the path from parent node goes through the left subtree */
-            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-            *((fmrtIndex*)currentPtr) = newElement;
-        }
-        else
-        {   /* the stack exists and the path from parent node goes through the right subtree */
-            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
-            *((fmrtIndex*)currentPtr) = newElement;
+/***********************************************************
+ * btRemoveRecurse()
+ * ---------------------------------------------------------
+ * This function removes a key (given as in btCompare())
+ * from the subtree of the B+-tree rooted in the node given
+ * by the second parameter, restoring the occupancy of the
+ * nodes on the way back to the root of the subtree, whose
+ * occupancy is restored by the caller
+ ***********************************************************/
+static void btRemoveRecurse (fmrtId tableIndex, fmrtIndex index, uint64_t nkey, char *keyString)
+{
+    /* Local Variables */
+    uint8_t     found;
+    uint16_t    pos;
+    fmrtBtNode  *node = btNode (tableIndex, index);
+
+    pos = btLowerBound (tableIndex, nkey, keyString, node, &found);
+    if (node->leaf)
+    {   /* The key is in this leaf (it has been found before by the caller) */
+        if (found)
+        {
+            memmove (btKeys(tableIndex,node)+pos, btKeys(tableIndex,node)+pos+1, (node->count-pos-1)*sizeof(uint64_t));
+            memmove (btElems(tableIndex,node)+pos, btElems(tableIndex,node)+pos+1, (node->count-pos-1)*sizeof(fmrtIndex));
+            node->count -= 1;
         }
+        return;
+    }
 
-        /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
-        currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+    pos = found ? pos+1 : pos;
+    btRemoveRecurse (tableIndex, btChildren(tableIndex,node)[pos], nkey, keyString);
+    if (btNode(tableIndex,btChildren(tableIndex,node)[pos])->count < Tables[tableIndex].btFanout/2)
+        btRebalance (tableIndex, index, pos);
 
-        /* Insert null pointers to left and right subtree */
-        *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
-        *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+    return;
+}
 
-        Tables[i].status = NOTEMPTY;
-        Tables[i].currentNumElem += 1;
-    }   /* else if (duplKey) */
 
-    /* Now currentPtr points to the element that shall be filled, in both cases of new element or existing one */
-    /* Fill the element with the key and the fields read from CSV file */
-    switch (Tables[i].key.type)
+/***********************************************************
+ * btRemove()
+ * ---------------------------------------------------------
+ * This function unlinks the element given by the second
+ * parameter from the B+-tree. The element shall not be
+ * released yet, since its key is used to find it.
+ * Separators are copies of keys found in the leaves: for
+ * FMRTSTRING keys they refer to the element for comparisons
+ * on prefix ties, hence a separator referring to the
+ * element is replaced with the key that follows it
+ ***********************************************************/
+static void btRemove (fmrtId tableIndex, fmrtIndex elem)
+{
+    /* Local Variables */
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+    char        *keyString = (char *) (currentPtr+Tables[tableIndex].key.delta);
+    uint8_t     found;
+    uint16_t    pos;
+    uint64_t    nkey = elemKey (tableIndex, currentPtr);
+    fmrtIndex   index,
+                next;
+    fmrtBtNode  *node;
+
+    btRemoveRecurse (tableIndex, Tables[tableIndex].btRoot, nkey, keyString);
+
+    /* An internal root left with a single child is removed, the B+-tree shrinks by one level */
+    node = btNode (tableIndex, Tables[tableIndex].btRoot);
+    if ( (node->count==0) && (!node->leaf) )
     {
-        case FMRTINT:
-        {
-            *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
-            break;
-        }
-        case FMRTDOUBLE:
-        {
-            *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
-            break;
-        }
-        case FMRTCHAR:
-        {
-            *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
-            break;
-        }
-        case FMRTSTRING:
-        {   /* Please observe that keyString has been truncated when it has been read from the input csv file */
-            strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
-            break;
-        }
-        case FMRTTIMESTAMP:
-        {
-            *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
-            break;
-        }
-    }   /* switch (Tables[i].key.type) */
+        index = Tables[tableIndex].btRoot;
+        Tables[tableIndex].btRoot = btChildren(tableIndex,node)[0];
+        btFreeNode (tableIndex, index);
+        Tables[tableIndex].btHeight -= 1;
+    }
+    else if (node->count==0)
+    {   /* The table is empty */
+        btFreeNode (tableIndex, Tables[tableIndex].btRoot);
+        Tables[tableIndex].btRoot = Tables[tableIndex].btFirst = Tables[tableIndex].btLast = FMRTNULLPTR;
+        Tables[tableIndex].btHeight = 0;
+        return;
+    }
 
-    /* Now read the variable list of arguments and use them to fill in the fields */
-    for (j=0; j<Tables[i].numFields; j++)
-    {   /* Loop through all fields */
-        switch (Tables[i].fields[j].type)
-        {
-            case FMRTINT:
-            {
-                if (mask%2)
-                    *((uint32_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldInt[j];
-                break;
-            }
-            case FMRTSIGNED:
-            {
-                if (mask%2)
-                    *((int32_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldSigned[j];
-                break;
-            }
-            case FMRTDOUBLE:
-            {
-                if (mask%2)
-                    *((double *)(currentPtr+Tables[i].fields[j].delta)) = fieldDouble[j];
-                break;
-            }
-            case FMRTCHAR:
-            {
-                if (mask%2)
-                    *((char *)(currentPtr+Tables[i].fields[j].delta)) = fieldChar[j];
-                break;
-            }
-            case FMRTSTRING:
-            {   /* Please observe that fieldsString[j] has been truncated when it has been read from the input csv file */
-                if (mask%2)
-                    strcpy ((char *)(currentPtr+Tables[i].fields[j].delta),fieldString[j]);
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                if (mask%2)
-                    *((time_t *)(currentPtr+Tables[i].fields[j].delta)) = fieldTimestamp[j];
-                break;
-            }
-        }   /* switch (Tables[i].fields[j].type) */
-        mask>>=1;
-    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    if (Tables[tableIndex].key.type!=FMRTSTRING)
+        return;
 
-    /* Element has been inserted - if duplKey==0 (i.e. new element) go through the   */
-    /* traversal LIFO structure and rebalance fmrt tree starting from the bottom and  */
-    /* going up to the root. This shal not be done if duplKey==1 (the element already*/
-    /* exists and it is assumed that it is already balanced                          */
-    if (duplKey==0)
+    /* Look for a separator referring to the element (at most one exists) */
+    index = Tables[tableIndex].btRoot;
+    while (!(node=btNode(tableIndex,index))->leaf)
     {
-        rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
-        while (rebalPtr!=NULL)
-        {   /* rebalance the subtree whose root is the current node */
-            rebalIndex = rebalanceSubTree (i,rebalPtr->index);  /* the root might change due to rotations */
-            /* go up to the parent */
-            rebalPtr = rebalPtr->next;
-            if (rebalPtr!=NULL)
-            {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
-                if (rebalPtr->go == LEFT)
-                    currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
-                else
-                    currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
-                /* The proper pointer is updated with the output of the rebalance structure */
-                *((fmrtIndex*)currentPtr) = rebalIndex;
-            }   /* if (rebalPtr!=NULL) */
-            else
-                /* There is no parent node - Rotation implies a change of the fmrt root pointer */
-                Tables[i].fmrtRoot = rebalIndex;
-        }   /* while (rebalPtr!=NULL) */
-    }   /* if (duplKey==0) */
+        pos = btLowerBound (tableIndex, nkey, keyString, node, &found);
+        if (found)
+        {   /* Replace it with the first key of its right subtree */
+            for (next=btChildren(tableIndex,node)[pos+1]; !btNode(tableIndex,next)->leaf; next=btChildren(tableIndex,btNode(tableIndex,next))[0]);
+            btKeys(tableIndex,node)[pos] = btKeys(tableIndex,btNode(tableIndex,next))[0];
+            btElems(tableIndex,node)[pos] = btElems(tableIndex,btNode(tableIndex,next))[0];
+            return;
+        }
+        index = btChildren(tableIndex,node)[pos];
+    }   /* while (!(node=btNode(tableIndex,index))->leaf) */
 
-    #ifdef FMRTDEBUG
-    printf ("\n\nCreateModify node at index: %d\n",traversal->index);
-    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
-    printf ("Path from node up to the root:\n");
-    __fmrtPrintStack(i,traversal);
-    #endif
+    return;
+}
 
-    /* clear node traversal LIFO structure allocated by searchElem() and exit */
-    clearNodeTraversalStack (traversal);
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * mixBits()
+ * ---------------------------------------------------------
+ * This function mixes the bits of the given value (same as
+ * the finalizer of splitmix64), so that each bit of the
+ * result depends on all the bits of the value
+ ***********************************************************/
+static uint64_t mixBits (uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    value ^= value >> 31;
 
-    return (FMRTOK);
+    return (value);
+}
+
+
+/***********************************************************
+ * hashKey()
+ * ---------------------------------------------------------
+ * This function provides the hash of a key, given by its
+ * normalized value (see normalizeKey()) or, for FMRTSTRING
+ * keys, by the string itself, which is used by the hash
+ * engine. The bits of the key are mixed so that the lowest
+ * ones, which select the home slot, depend on all of them.
+ * The hash is as wide as fmrtIndex, so that it can select
+ * any slot of the index, and it is never 0, which marks
+ * empty slots
+ ***********************************************************/
+static fmrtIndex hashKey (fmrtId tableIndex, uint64_t nkey, char *keyString)
+{
+    /* Local Variables */
+    uint64_t    hash = nkey;
+
+    /* Strings are hashed through FNV-1a, since their normalized value is just a prefix */
+    if (Tables[tableIndex].key.type==FMRTSTRING)
+        for (hash=FMRTFNVOFFSET; *keyString!='\0'; keyString++)
+            hash = (hash ^ (unsigned char) *keyString) * FMRTFNVPRIME;
 
+    hash = mixBits (hash);
+
+    return ( ((fmrtIndex)hash!=0) ? (fmrtIndex)hash : 1 );
 }
 
 
+#ifdef FMRTTRACE
 /***********************************************************
- * fmrtDelete()
+ * traceKeyHash()
  * ---------------------------------------------------------
- * This library call is used to delete an existing entry
- * from the fmrt tree. It is a call with two parameters,
- * respectively:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - key
- *   contains the key value to be searched into the table.
- *   It shall be of the same type defined by the
- *   fmrtDefineKey() call. The library behaviour is undefined
- *   if this constraint is not satisfied. In case of string
- *   key, the length is truncated to the max length specified
- *   at key definition through fmrtDefineKey().
+ * This function provides the hash of a key reported by the
+ * static tracepoints (see FMRTTRACE), which allows to spot
+ * slow or hot keys without exposing their value. It is the
+ * same hash of the hash engine (see hashKey()), extended to
+ * FMRTCOMPOSITE keys, whose encoded bytes are hashed
+ ***********************************************************/
+static uint32_t traceKeyHash (fmrtId tableIndex, uint64_t nkey, char *keyString)
+{
+    /* Local Variables */
+    uint64_t    hash;
+    uint16_t    j;
+
+    if (Tables[tableIndex].key.type!=FMRTCOMPOSITE)
+        return ( (uint32_t) hashKey (tableIndex, nkey, keyString) );
+
+    for (hash=FMRTFNVOFFSET, j=0; j<Tables[tableIndex].key.len; j++)
+        hash = (hash ^ (unsigned char) keyString[j]) * FMRTFNVPRIME;
+
+    return ( (uint32_t) mixBits (hash) );
+}
+
+
+/***********************************************************
+ * traceElemHash()
+ * ---------------------------------------------------------
+ * This function provides the hash (see traceKeyHash()) of
+ * the key of the element given by the second parameter
+ ***********************************************************/
+static uint32_t traceElemHash (fmrtId tableIndex, fmrtIndex elem)
+{
+    /* Local Variables */
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+
+    return ( traceKeyHash (tableIndex, elemKey(tableIndex,currentPtr), (char *)(currentPtr+Tables[tableIndex].key.delta)) );
+}
+#endif
+
+
+/***********************************************************
+ * hashCompare()
+ * ---------------------------------------------------------
+ * This function compares a key, given by its normalized
+ * value and, for FMRTSTRING keys, by the string itself,
+ * with the key of the element given by the last parameter
+ * ---------------------------------------------------------
+ * It returns a negative value, 0 or a positive value if the
+ * key is respectively lower, equal or greater than the one
+ * of the element
+ ***********************************************************/
+static int hashCompare (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtIndex elem)
+{
+    /* Local Variables */
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+
+    if (Tables[tableIndex].key.type==FMRTSTRING)
+        return ( compareStringKey (tableIndex, nkey, keyString, currentPtr) );
+
+    return ( FMRTCOMPARE (nkey, elemKey(tableIndex,currentPtr)) );
+}
+
+
+/***********************************************************
+ * hashSearchElem()
+ * ---------------------------------------------------------
+ * This is the counterpart of searchElem() for tables using
+ * the hash engine. Slots are probed starting from the home
+ * slot of the key; since elements are kept sorted by
+ * distance from their home slot (Robin Hood hashing), the
+ * search stops as soon as an empty slot or an element
+ * closer to its home slot than the key would be is found.
+ * If the element is found, the LIFO structure provided back
+ * contains just the element itself
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   The entry has been correctly deleted from the tree
+ *   The entry has been found
  * - FMRTNOTFOUND
- *   The entry with the given key is not present in the table
- * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller
- * - FMRTIDNOTFOUND
- *   tableId is not defined
+ *   The entry with the given key is not present in the
+ *   table, the LIFO structure is empty
  ***********************************************************/
-fmrtResult fmrtDelete (fmrtId tableId, ...)
+static fmrtResult hashSearchElem (fmrtId tableIndex, uint64_t nkey, char *keyString, fmrtNodeTraversalStack **stackPtr)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,maxLen;
-    void        *currentPtr;
-    fmrtResult   res;
-    uint32_t    keyInt;
-    int32_t     keySigned;
-    double      keyDouble;
-    time_t      keyTimestamp;
-    char        keyChar,
-                *string,
-                keyString[MAXFMRTSTRINGLEN+1];
-    fmrtIndex    leftSubtree,
-                rightSubtree,
-                leftmost,
-                leftmostRightChild,
-                rebalIndex;
-    fmrtNodeTraversalStack  *traversal,
-                            *toLeaf,
-                            *rebalPtr;
+    fmrtIndex   hash = hashKey (tableIndex, nkey, keyString),
+                mask = Tables[tableIndex].hashMask,
+                pos,
+                dist;
+    fmrtHashSlot *slot;
 
+    for (pos=hash&mask, dist=0; ; pos=(pos+1)&mask, dist++)
+    {
+        slot = &(Tables[tableIndex].hashSlots[pos]);
+        if ( (slot->hash==0) || (((pos-slot->hash)&mask) < dist) )
+            return (FMRTNOTFOUND);
+        if ( (slot->hash==hash) && (hashCompare(tableIndex, nkey, keyString, slot->elem)==0) )
+            break;
+    }   /* for (pos=hash&mask, ...) */
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    *stackPtr = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
+    (*stackPtr)->index = slot->elem;
+    (*stackPtr)->go = STAY;
+    (*stackPtr)->next = NULL;
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    return (FMRTOK);
+}
 
-    /* Initialize the list of variable arguments in order to read the key */
-    va_start (args,tableId);
-    switch (Tables[i].key.type)
+
+/***********************************************************
+ * hashInsert()
+ * ---------------------------------------------------------
+ * This function links the element given by the second
+ * parameter, whose key shall be already stored and shall
+ * not be present in the table, into the hash index. While
+ * probing, the element takes the place of any element
+ * closer to its home slot, which goes on probing in its
+ * stead (Robin Hood hashing). The index has more slots than
+ * the max number of elements, therefore the operation
+ * cannot fail
+ ***********************************************************/
+static void hashInsert (fmrtId tableIndex, fmrtIndex elem)
+{
+    /* Local Variables */
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+    fmrtIndex   mask = Tables[tableIndex].hashMask,
+                pos,
+                dist,
+                slotDist;
+    fmrtHashSlot entry,
+                swap,
+                *slot;
+
+    entry.elem = elem;
+    entry.hash = hashKey (tableIndex, elemKey(tableIndex,currentPtr), (char *)(currentPtr+Tables[tableIndex].key.delta));
+    for (pos=entry.hash&mask, dist=0; ; pos=(pos+1)&mask, dist++)
     {
-        case FMRTINT:
-        {
-            keyInt = va_arg (args, uint32_t);
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            keySigned = va_arg (args, int32_t);
-            break;
-        }
-        case FMRTDOUBLE:
+        slot = &(Tables[tableIndex].hashSlots[pos]);
+        if (slot->hash==0)
         {
-            keyDouble = va_arg (args, double);
-            break;
+            *slot = entry;
+            return;
         }
-        case FMRTCHAR:
+
+        /* The element in the slot is closer to its home slot: swap them */
+        slotDist = (pos-slot->hash) & mask;
+        if (slotDist<dist)
         {
-            keyChar = (unsigned char) va_arg (args,int);
-            break;
+            swap = *slot;
+            *slot = entry;
+            entry = swap;
+            dist = slotDist;
         }
-        case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            string = va_arg (args,char*);
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            strncpy (keyString,string,maxLen);
-            keyString[maxLen-1] = '\0';
-            break;
-        }
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-                /* time format empty --> read raw timestamp from argument */
-                keyTimestamp = va_arg (args, time_t);
-            else
-            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestamp = mktime (&TimeFromString);
-                else
-                    keyTimestamp = 0;
-            }
-            break;
-        }   /* case FMRTTIMESTAMP */
-    }   /* switch (Tables[i].key.type) */
-    va_end (args);
+    }   /* for (pos=entry.hash&mask, ...) */
+}
 
-    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
-    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+
+/***********************************************************
+ * hashRemove()
+ * ---------------------------------------------------------
+ * This function unlinks the element given by the second
+ * parameter from the hash index. The following elements
+ * which are not in their home slot are shifted back by one
+ * slot, so that no tombstone is left behind and searches
+ * never get longer after deletes
+ ***********************************************************/
+static void hashRemove (fmrtId tableIndex, fmrtIndex elem)
+{
+    /* Local Variables */
+    void        *currentPtr = Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize;
+    fmrtIndex   mask = Tables[tableIndex].hashMask,
+                pos,
+                next;
+    fmrtHashSlot *slots = Tables[tableIndex].hashSlots;
+
+    /* Find the slot of the element, starting from its home slot */
+    pos = hashKey (tableIndex, elemKey(tableIndex,currentPtr), (char *)(currentPtr+Tables[tableIndex].key.delta)) & mask;
+    while ( (slots[pos].hash==0) || (slots[pos].elem!=elem) )
+        pos = (pos+1) & mask;
+
+    /* Shift back the following elements up to an empty slot or an element in its home slot */
+    for (next=(pos+1)&mask; (slots[next].hash!=0) && (((next-slots[next].hash)&mask)!=0); next=(next+1)&mask)
     {
-        clearNodeTraversalStack (traversal);
-        /* Clear the lock before exiting */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (res);
+        slots[pos] = slots[next];
+        pos = next;
     }
+    slots[pos].hash = 0;
+    slots[pos].elem = FMRTNULLPTR;
 
-    /* The element was found and traversal is a pointer to a LIFO structure */
-    /* whose top element contains the index of the node we searched         */
-    /* Set currentPtr to point to the first byte of the structure           */
-    currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+    return;
+}
 
-    /* Extract left and right subtree pointers associated to the node to be deleted and initialize a pointer needed in case of leftMostChild() search */
-    leftSubtree = *((fmrtIndex *) (currentPtr));
-    rightSubtree = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-    toLeaf = NULL;
 
-    /* Now there are 3 possible cases:                                              */
-    /* 1 - the node is a leaf           -> delete it                                */
-    /* 2 - the node has only one child  -> substitute the content of the current    */
-    /*                                     node with the child and delete the child */
-    /* 3 - the node has both subtrees   -> find the left most child on the right    */
-    /*                                     subtree, substitute the content of the   */
-    /*                                     current node with it and delete it       */
+/***********************************************************
+ * indexFieldValue()
+ * ---------------------------------------------------------
+ * This function provides the normalized value (see
+ * normalizeValue()) of the field indexed by the secondary
+ * index idx (second parameter) in the element given by the
+ * last but one parameter. For FMRTSTRING fields, the last
+ * parameter is set to point to the whole string, which is
+ * needed to compare values with the same prefix
+ ***********************************************************/
+static uint64_t indexFieldValue (fmrtId tableIndex, uint8_t idx, fmrtIndex elem, char **string)
+{
+    /* Local Variables */
+    uint8_t     j = Tables[tableIndex].indexes[idx].field;
+    void        *fieldsPtr;
 
-    if ( (leftSubtree==FMRTNULLPTR) && (rightSubtree==FMRTNULLPTR) )
-    {   /* case 1 - the node is a leaf */
-        rebalPtr = traversal->next;
-        if (rebalPtr!=NULL)
-        {   /* the leaf we are deleting is not the root */
-            /* Set left or right pointer of the parent (depending on content of traversal LIFO) to FMRTNULLPTR */
-            currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
-            if (rebalPtr->go == LEFT)
-                *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
-            else
-                *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
-        }   /* if (rebalPtr!=NULL) */
-        else
-        {   /* the node we are deleting is a leaf, but it is also the root */
-            /*  Set fmrt Root pointer to FMRTNULLPTR */
-            Tables[i].fmrtRoot = FMRTNULLPTR;
-        }
-        /* return deleted element to the empty list and remove element from traversal LIFO */
-        freeEmptyElem (i,traversal->index);
-        free (traversal);
-        traversal = rebalPtr;
-    }   /* if ( (leftSubtree==FMRTNULLPTR) && (rightSubtree==FMRTNULLPTR) ) */
+    fieldsPtr = fieldsOf (tableIndex, Tables[tableIndex].fmrtData + elem*Tables[tableIndex].elemSize);
+    *string = NULL;
+    if (Tables[tableIndex].fields[j].type==FMRTSTRING)
+    {
+        *string = fieldString (tableIndex, fieldsPtr, j);
+        return ( keyPrefix (*string) );
+    }
 
-    else if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) )
-    {   /* case 3 - the node has both subtrees */
-        /* find the leftmost child on the right subtree and substitute its content with the node to delete */
-        leftmost = leftMostChild(i,rightSubtree,&toLeaf);
-        copyNode (i,traversal->index,leftmost);
-        currentPtr = Tables[i].fmrtData + leftmost*Tables[i].elemSize;
-        /* The leftmost child on the right subtree is either a leaf or has just one child on the right subtree - there are no other possibilities */
-        leftmostRightChild = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
-        if (leftmostRightChild==FMRTNULLPTR)
-        {   /* The leftmost child on the right subtree is a leaf */
-            freeEmptyElem (i,leftmost);
-            rebalPtr = toLeaf->next;
-            free (toLeaf);
-            toLeaf=rebalPtr;
-            if (toLeaf!=NULL)
-            {
-                currentPtr = Tables[i].fmrtData + (toLeaf->index)*Tables[i].elemSize;
-                *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
-            }
-        }   /* if (leftmostRightChild==FMRTNULLPTR) */
-        else
-        {
-            copyNode (i,leftmost,leftmostRightChild);
-            freeEmptyElem (i,leftmostRightChild);
-            if (toLeaf!=NULL)
-            {
-                currentPtr = Tables[i].fmrtData + (toLeaf->index)*Tables[i].elemSize;
-                *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
-            }
-        }   /* else if (leftmostRightChild==FMRTNULLPTR) */
-        /* join traversal and toLeaf LIFO traversal structures to allow rebalance on the whole path */
-        traversal->go = RIGHT;
-        rebalPtr = toLeaf;
-        while (rebalPtr != NULL)
-        {
-            if (rebalPtr->next==NULL)
-            {
-                rebalPtr->next=traversal;
-                traversal = toLeaf;
-                rebalPtr = NULL;
-            }
-            else
-                rebalPtr=rebalPtr->next;
-        }   /* while (toLeaf != NULL) */
+    return ( normalizeValue (Tables[tableIndex].fields[j].type, fieldsPtr+Tables[tableIndex].fields[j].delta) );
+}
 
-    }   /* if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) ) */
 
-    else
-    {   /* case 2 - the node has only one child -> Since the tree is balanced, this child cannot have further children -> this child is a leaf */
-        if (leftSubtree!=FMRTNULLPTR)
-        {   /* the child is on the left subtree */
-            /* copy the content of the child into the node to be deleted */
-            /* update the pointer and return the child to the list of empty nodes */
-            copyNode (i,traversal->index,leftSubtree);
-            freeEmptyElem (i,leftSubtree);
-            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-            *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
-        }   /* if (leftSubtree!=FMRTNULLPTR) */
-        else
-        {   /* the child is on the right subtree */
-            /* copy the content of the child into the node to be deleted */
-            /* update the pointer and return the child to the list of empty nodes */
-            copyNode (i,traversal->index,rightSubtree);
-            freeEmptyElem (i,rightSubtree);
-            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-            *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
-        }   /* else if (leftSubtree!=FMRTNULLPTR) */
-    }   /* else if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) ) */
+/***********************************************************
+ * indexCompare()
+ * ---------------------------------------------------------
+ * This function compares a value of the field indexed by
+ * the secondary index idx (second parameter), given by its
+ * normalized value and, for FMRTSTRING fields, by the
+ * string itself, with the value of the node given by the
+ * last parameter
+ * ---------------------------------------------------------
+ * It returns a negative value, 0 or a positive value if the
+ * value is respectively lower, equal or greater than the
+ * one of the node
+ ***********************************************************/
+static int indexCompare (fmrtId tableIndex, uint8_t idx, uint64_t nvalue, char *string, fmrtIndex node)
+{
+    /* Local Variables */
+    int         res;
+    char        *nodeString;
 
-    /* Element has been deleted, now rebalance the FMRT tree */
-    /* starting from the bottom and going up to the root    */
-    rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. from the leaf */
-    while (rebalPtr!=NULL)
-    {   /* rebalance the subtree whose root is the current node */
-        rebalIndex = rebalanceSubTree (i,rebalPtr->index);  /* the root might change due to rotations */
-        /* go up to the parent */
-        rebalPtr = rebalPtr->next;
-        if (rebalPtr!=NULL)
-        {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
-            if (rebalPtr->go == LEFT)
-                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
-            else
-                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
-            /* The proper pointer is updated with the output of the rebalance structure */
-            *((fmrtIndex*)currentPtr) = rebalIndex;
-        }   /* if (rebalPtr!=NULL) */
-        else
-            /* There is no parent node - Rotation implies a change of the fmrt root pointer */
-            Tables[i].fmrtRoot = rebalIndex;
-    }   /* while (rebalPtr!=NULL) */
+    res = FMRTCOMPARE (nvalue, Tables[tableIndex].indexes[idx].nodes[node].value);
+    if ( (res!=0) || (string==NULL) )
+        return (res);
 
-    #ifdef FMRTDEBUG
-    printf ("\n\nDeleted node\n");
-    printf ("Path from deleted node up to the root:\n");
-    __fmrtPrintStack(i,traversal);
-    #endif
+    /* Same prefix, compare the whole strings */
+    indexFieldValue (tableIndex, idx, node, &nodeString);
+    return ( strcmp (string, nodeString) );
+}
 
-    /* set Tables[i].status, increment number of stored elements, clear node traversal LIFO structure allocated by searchElem() and exit */
-    Tables[i].currentNumElem -= 1;
-    clearNodeTraversalStack (traversal);
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * indexRotateUp()
+ * ---------------------------------------------------------
+ * This function rotates the node given by the last
+ * parameter of the secondary index idx (second parameter)
+ * with its parent, so that the node takes the place of the
+ * parent and the parent becomes its child
+ ***********************************************************/
+static void indexRotateUp (fmrtId tableIndex, uint8_t idx, fmrtIndex node)
+{
+    /* Local Variables */
+    fmrtSecondaryIndex  *index = &(Tables[tableIndex].indexes[idx]);
+    fmrtIndexNode       *nodes = index->nodes;
+    fmrtIndex           parent = nodes[node].parent,
+                        grandParent = nodes[parent].parent;
+
+    if (nodes[parent].left==node)
+    {   /* Right rotation */
+        nodes[parent].left = nodes[node].right;
+        if (nodes[node].right!=FMRTNULLPTR)
+            nodes[nodes[node].right].parent = parent;
+        nodes[node].right = parent;
+    }
+    else
+    {   /* Left rotation */
+        nodes[parent].right = nodes[node].left;
+        if (nodes[node].left!=FMRTNULLPTR)
+            nodes[nodes[node].left].parent = parent;
+        nodes[node].left = parent;
+    }
+    nodes[parent].parent = node;
+
+    /* The node takes the place of its former parent */
+    nodes[node].parent = grandParent;
+    if (grandParent==FMRTNULLPTR)
+        index->root = node;
+    else if (nodes[grandParent].left==parent)
+        nodes[grandParent].left = node;
+    else
+        nodes[grandParent].right = node;
 
-    return (FMRTOK);
+    return;
 }
 
 
 /***********************************************************
- * fmrtImportTableCsv()
- * ---------------------------------------------------------
- * This library call is used to import the content of a
- * given file in CSV format (specified by the file pointer
- * given by the second parameter) into the table whose id
- * is provided by the first parameter.
- * It takes the following parameters:
- * - tableId
- *   unique identifier of the table between 0 and 255. The
- *   table shall be defined first through fmrtDefineTable()
- * - filePtr
- *   pointer to a file opened by the caller in read
- *   mode. It cannot be NULL, otherwise an error will be
- *   provided
- * - separator
- *   It is a char specified by the caller that is recognized
- *   as a separator between consecutive fields into the
- *   input CSV file
- * - lines
- *   is a pointer to an integer parameter that is provided
- *   back by the call. It contains either the total number
- *   of lines read from the file (if result is FMRTOK) or the
- *   line number affected by the error (in case of error)
- * Please note that the file shall be opened before calling
- * this function, otherwise a run-time error will occur.
- * Similarly, the function call does not close the input
- * file, which must be closed by the caller.
- * Data read from the file are appended to existing data
- * in the table (if the input table is not empty).
- * In case of duplicate key, the entry is overwritten:
- * no errors are provided in this case
+ * indexInsert()
  * ---------------------------------------------------------
- * Possible Return Values:
- * - FMRTOK
- *   The table has been successfully imported from CSV file.
- *   The last parameter contains the total number of lines
- *   read from the file
- * - FMRTKO
- *   Result obtained when this is the first library call
- *   invoked by the caller or when the specified file
- *   pointer is NULL. In those cases the last parameter
- *   provides 0. This result code is also obtained when
- *   an error is detected while reading input lines
- *   from the file (e.g. incomplete line); in such cases
- *   the last parameter reports the line where the error
- *   has been detected. Elements read from the file up to
- *   the wrong line are inserted into the table
- * - FMRTIDNOTFOUND
- *   tableId is not defined
- * - FMRTOUTOFMEMORY
- *   while inserting data into the table from the CSV file
- *   the maximum number of elements has been reached (the
- *   maximum number of elements is specified at table
- *   definition as a parameter of fmrtDefineTable() ). The
- *   last parameter identifies the line in the input file
- *   where data import was stopped.
+ * This function links the element given by the last
+ * parameter, whose fields shall be already stored, into the
+ * secondary index idx (second parameter). Indexes are
+ * treaps whose nodes are stored in an array parallel to the
+ * elements: the node is inserted as a leaf according to the
+ * field value (elements with the same value are kept in
+ * insertion order) and it is then rotated up according to
+ * its priority, which is derived from its index, so that
+ * the treap is balanced on average
  ***********************************************************/
-fmrtResult fmrtImportTableCsv (fmrtId tableId, FILE *filePtr, char separator, int *lines)
+static void indexInsert (fmrtId tableIndex, uint8_t idx, fmrtIndex elem)
 {
     /* Local Variables */
-    char                    *p,
-                            *q,
-                            keyChar,
-                            keyString[MAXFMRTSTRINGLEN+1],
-                            inputString[MAXCSVLINELEN];
-    void                   *currentPtr,
-                           *rowPtr;
-    uint8_t                 i,j, duplKey, maxLen;
-    uint32_t                keyInt,
-                            fieldsLen;
-    int32_t                 keySigned;
-    double                  keyDouble;
-    time_t                  keyTimestamp;
-    fmrtResult              res;
-    fmrtIndex               newElement,
-                            rebalIndex;
-    fmrtNodeTraversalStack *traversal,
-                           *rebalPtr;
+    fmrtSecondaryIndex  *index = &(Tables[tableIndex].indexes[idx]);
+    fmrtIndexNode       *nodes = index->nodes;
+    fmrtIndex           parent = FMRTNULLPTR,
+                        current = index->root;
+    uint64_t            nvalue;
+    char                *string;
+    int                 res = 0;
+
+    nvalue = indexFieldValue (tableIndex, idx, elem, &string);
+    nodes[elem].value = nvalue;
+    nodes[elem].left = nodes[elem].right = FMRTNULLPTR;
+    nodes[elem].priority = (uint32_t) mixBits (elem+1);
+
+    /* Look for the leaf where the node shall be inserted */
+    while (current!=FMRTNULLPTR)
+    {
+        parent = current;
+        res = indexCompare (tableIndex, idx, nvalue, string, current);
+        current = (res<0) ? nodes[current].left : nodes[current].right;
+    }
 
-    /* Reset line counter */
-    *lines=0;
+    nodes[elem].parent = parent;
+    if (parent==FMRTNULLPTR)
+        index->root = elem;
+    else if (res<0)
+        nodes[parent].left = elem;
+    else
+        nodes[parent].right = elem;
 
-    /* If file pointer is NULL, return FMRTKO */
-    if (filePtr==NULL)
-        return (FMRTKO);
+    /* Restore the heap property of priorities */
+    while ( (nodes[elem].parent!=FMRTNULLPTR) && (nodes[nodes[elem].parent].priority<nodes[elem].priority) )
+        indexRotateUp (tableIndex, idx, elem);
 
-    /* Call searchTable() internal function to look for the given tableId */
-    /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
-    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (res);
+    return;
+}
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
 
-    /* Allocate a buffer that will be used to store data read line by line */
-    fieldsLen = Tables[i].elemSize - 2*sizeof(fmrtIndex) - Tables[i].key.len;
-    if  ( (rowPtr=(void *) malloc(fieldsLen)) == NULL)
-    {   /* Not enough system memory to read the row -> clear the lock and exit */
-        pthread_mutex_unlock(&(Tables[i].tableMtx));
-        return (FMRTOUTOFMEMORY);
+/***********************************************************
+ * indexRemove()
+ * ---------------------------------------------------------
+ * This function unlinks the element given by the last
+ * parameter from the secondary index idx (second
+ * parameter). The node is rotated down, swapping it with
+ * the child with higher priority, until it has at most one
+ * child, which then takes its place
+ ***********************************************************/
+static void indexRemove (fmrtId tableIndex, uint8_t idx, fmrtIndex elem)
+{
+    /* Local Variables */
+    fmrtSecondaryIndex  *index = &(Tables[tableIndex].indexes[idx]);
+    fmrtIndexNode       *nodes = index->nodes;
+    fmrtIndex           child,
+                        parent;
+
+    while ( (nodes[elem].left!=FMRTNULLPTR) && (nodes[elem].right!=FMRTNULLPTR) )
+    {
+        if (nodes[nodes[elem].left].priority > nodes[nodes[elem].right].priority)
+            indexRotateUp (tableIndex, idx, nodes[elem].left);
+        else
+            indexRotateUp (tableIndex, idx, nodes[elem].right);
     }
-    Tables[i].row = rowPtr;
 
-    /* Read lines from CSV input file and fill the structure */
-    while (fgets (inputString,MAXCSVLINELEN,filePtr))
+    child = (nodes[elem].left!=FMRTNULLPTR) ? nodes[elem].left : nodes[elem].right;
+    parent = nodes[elem].parent;
+    if (child!=FMRTNULLPTR)
+        nodes[child].parent = parent;
+    if (parent==FMRTNULLPTR)
+        index->root = child;
+    else if (nodes[parent].left==elem)
+        nodes[parent].left = child;
+    else
+        nodes[parent].right = child;
+
+    return;
+}
+
+
+/***********************************************************
+ * indexRelocate()
+ * ---------------------------------------------------------
+ * This function moves the node of the secondary index idx
+ * (second parameter) from the slot fromIndex (last
+ * parameter) to the slot toIndex, whose node shall not be
+ * linked to the index, updating its parent and children
+ * accordingly (see relocateElem())
+ ***********************************************************/
+static void indexRelocate (fmrtId tableIndex, uint8_t idx, fmrtIndex toIndex, fmrtIndex fromIndex)
+{
+    /* Local Variables */
+    fmrtSecondaryIndex  *index = &(Tables[tableIndex].indexes[idx]);
+    fmrtIndexNode       *nodes = index->nodes;
+    fmrtIndex           parent;
+
+    nodes[toIndex] = nodes[fromIndex];
+    parent = nodes[toIndex].parent;
+    if (parent==FMRTNULLPTR)
+        index->root = toIndex;
+    else if (nodes[parent].left==fromIndex)
+        nodes[parent].left = toIndex;
+    else
+        nodes[parent].right = toIndex;
+    if (nodes[toIndex].left!=FMRTNULLPTR)
+        nodes[nodes[toIndex].left].parent = toIndex;
+    if (nodes[toIndex].right!=FMRTNULLPTR)
+        nodes[nodes[toIndex].right].parent = toIndex;
+
+    return;
+}
+
+
+/***********************************************************
+ * indexStep()
+ * ---------------------------------------------------------
+ * This function provides the node following (if the last
+ * parameter is RIGHT) or preceding (if it is LEFT) the node
+ * given by the third parameter in the order of the
+ * secondary index idx (second parameter), or FMRTNULLPTR if
+ * there is none
+ ***********************************************************/
+static fmrtIndex indexStep (fmrtId tableIndex, uint8_t idx, fmrtIndex node, int8_t go)
+{
+    /* Local Variables */
+    fmrtIndexNode       *nodes = Tables[tableIndex].indexes[idx].nodes;
+    fmrtIndex           child,
+                        parent;
+
+    child = (go==RIGHT) ? nodes[node].right : nodes[node].left;
+    if (child!=FMRTNULLPTR)
+    {   /* Leftmost (rightmost) node of the right (left) subtree */
+        node = child;
+        while ( (child=((go==RIGHT) ? nodes[node].left : nodes[node].right)) != FMRTNULLPTR )
+            node = child;
+        return (node);
+    }
+
+    /* Go up until the node is in the left (right) subtree of its parent */
+    parent = nodes[node].parent;
+    while ( (parent!=FMRTNULLPTR) && (node==((go==RIGHT) ? nodes[parent].right : nodes[parent].left)) )
     {
-        (*lines) += 1;
-        /* skip empty lines */
-        if (inputString[0] == '\0')
-            continue;
+        node = parent;
+        parent = nodes[node].parent;
+    }
 
-        /* skip leading spaces and tabs */
-        p = inputString;
-        while ( (*p==' ') || (*p=='\t') )
-            p++;
+    return (parent);
+}
 
-        /* Check whether this is an empty line or a comment and, if so, skip this line */
-        if ( (*p=='\0') || (*p=='#') )
-            continue ;
 
-        /* the line is neither a comment nor an empty line - therefore we assume it is a valid line */
-        for (q=p; (*q!='\0')&&(*q!=separator)&&(*q!='\n'); q+=1); /* stop at EOL or at separator */
-        if ( (p==q) && (*q=='\n') )
-            continue;
-        *q = '\0';  /* p and q now points to the beginning and to the end of the first parameter, which should be the key */
+/***********************************************************
+ * indexBound()
+ * ---------------------------------------------------------
+ * This function looks for a value, given by its normalized
+ * value and, for FMRTSTRING fields, by the string itself,
+ * in the secondary index idx (second parameter). It
+ * provides the first node whose value is greater than or
+ * equal to the given one if the last parameter is 0, the
+ * last node whose value is lower than or equal to it
+ * otherwise. FMRTNULLPTR is provided if there is none
+ ***********************************************************/
+static fmrtIndex indexBound (fmrtId tableIndex, uint8_t idx, uint64_t nvalue, char *string, uint8_t upper)
+{
+    /* Local Variables */
+    fmrtIndexNode       *nodes = Tables[tableIndex].indexes[idx].nodes;
+    fmrtIndex           current = Tables[tableIndex].indexes[idx].root,
+                        bound = FMRTNULLPTR;
+    int                 res;
 
-        switch (Tables[i].key.type)
+    while (current!=FMRTNULLPTR)
+    {
+        res = indexCompare (tableIndex, idx, nvalue, string, current);
+        if ( (!upper) && (res<=0) )
+        {   /* Candidate, look for a lower one on the left */
+            bound = current;
+            current = nodes[current].left;
+        }
+        else if ( (upper) && (res>=0) )
+        {   /* Candidate, look for a greater one on the right */
+            bound = current;
+            current = nodes[current].right;
+        }
+        else
+            current = (upper) ? nodes[current].left : nodes[current].right;
+    }   /* while (current!=FMRTNULLPTR) */
+
+    return (bound);
+}
+
+
+/***********************************************************
+ * indexConflict()
+ * ---------------------------------------------------------
+ * This function tells whether the value pointed by the
+ * third parameter (with the same representation used into
+ * the elements) is already present in the secondary index
+ * idx (second parameter), in an element other than the one
+ * given by the last parameter (FMRTNULLPTR if none)
+ ***********************************************************/
+static uint8_t indexConflict (fmrtId tableIndex, uint8_t idx, void *valuePtr, fmrtIndex self)
+{
+    /* Local Variables */
+    fmrtType    type = Tables[tableIndex].fields[Tables[tableIndex].indexes[idx].field].type;
+    char        *string = (type==FMRTSTRING) ? (char *) valuePtr : NULL;
+    uint64_t    nvalue = normalizeValue (type, valuePtr);
+    fmrtIndex   node;
+
+    for (node = indexBound (tableIndex, idx, nvalue, string, 0);
+         (node!=FMRTNULLPTR) && (indexCompare(tableIndex, idx, nvalue, string, node)==0);
+         node = indexStep (tableIndex, idx, node, RIGHT))
+        if (node!=self)
+            return (1);
+
+    return (0);
+}
+
+
+/***********************************************************
+ * linkIndexes()
+ * ---------------------------------------------------------
+ * This function links the element given by the second
+ * parameter into the secondary indexes of the fields
+ * selected by the last parameter (with the same meaning of
+ * paramMask in fmrtModify())
+ ***********************************************************/
+static void linkIndexes (fmrtId tableIndex, fmrtIndex elem, fmrtParamMask mask)
+{
+    /* Local Variables */
+    uint8_t     k;
+
+    for (k=0; k<Tables[tableIndex].numIndexes; k++)
+        if ( (mask >> Tables[tableIndex].indexes[k].field) & 1 )
+            indexInsert (tableIndex, k, elem);
+
+    return;
+}
+
+
+/***********************************************************
+ * unlinkIndexes()
+ * ---------------------------------------------------------
+ * This function unlinks the element given by the second
+ * parameter from the secondary indexes of the fields
+ * selected by the last parameter (see linkIndexes())
+ ***********************************************************/
+static void unlinkIndexes (fmrtId tableIndex, fmrtIndex elem, fmrtParamMask mask)
+{
+    /* Local Variables */
+    uint8_t     k;
+
+    for (k=0; k<Tables[tableIndex].numIndexes; k++)
+        if ( (mask >> Tables[tableIndex].indexes[k].field) & 1 )
+            indexRemove (tableIndex, k, elem);
+
+    return;
+}
+
+
+/***********************************************************
+ * searchIndex()
+ * ---------------------------------------------------------
+ * This function looks for the secondary index defined on
+ * the field given by the second parameter and provides its
+ * position in indexes[] through the last parameter
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The field is indexed
+ * - FMRTKO
+ *   There is no secondary index on the field
+ ***********************************************************/
+static fmrtResult searchIndex (fmrtId tableIndex, uint8_t fieldIdx, uint8_t *idx)
+{
+    for (*idx=0; *idx<Tables[tableIndex].numIndexes; (*idx)++)
+        if (Tables[tableIndex].indexes[*idx].field==fieldIdx)
+            return (FMRTOK);
+
+    return (FMRTKO);
+}
+
+
+/***********************************************************
+ * lookupElem()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that perform
+ * read and write access to the structure, through
+ * searchElem(), which adds the static tracepoints.
+ * It takes the index of the Table[] array as first parameter
+ * and the key to look for in the following parameters.
+ * There are six parameters of different types for the key,
+ * the function uses only the one corresponding to the key
+ * type defined through fmrtDefineKey() (the remaining are not
+ * meaningful). The function provides a result code and,
+ * in case of result==FMRTOK, also a pointer to a LIFO
+ * structure that contains all nodes traversed during the
+ * search (last parameter).
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and the LIFO structure is built.
+ *   It contains the set of nodes traversed; the top of the
+ *   stack contains the node found
+ * - FMRTKO
+ *   Result obtained when this is either the first library
+ *   call invoked by the caller or the index passed as
+ *   first argument exceeds allowed limits or corresponds
+ *   to a table not defined
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the
+ *   table. The last parameter is a valid pointer to a LIFO
+ *   structure that represents the set of nodes traversed
+ ***********************************************************/
+static fmrtResult lookupElem (fmrtId tableIndex, uint32_t keyInt, int32_t keySigned, double keyDouble, char keyChar, char *keyString, time_t keyTimestamp, fmrtNodeTraversalStack **stackPtr)
+{
+    /* Local Variables */
+    uint8_t     found=0;
+    int         cmp;
+    fmrtIndex    current;
+    uint64_t    prefix = 0;
+    void        *currentPtr;
+    fmrtNodeTraversalStack *stackElem = NULL;
+
+    /* Pre-initialize return parameters */
+    *stackPtr = NULL;
+
+    /* If this is the first invocation of the library provide error */
+    if (!registryReady())
+        return (FMRTKO);
+
+    /* If the table is not defined provide error */
+    if (!tableDefined(tableIndex))
+        return (FMRTKO);
+
+    /* tableId has been found, if the AVL Tree is empty provide FMRTNOTFOUND */
+    if (Tables[tableIndex].fmrtData==NULL)
+        return (FMRTNOTFOUND);
+
+    /* Tables using the B+-tree or the hash engine are searched through their own index */
+    if (Tables[tableIndex].engine==FMRTENGINEBTREE)
+        return ( btSearchElem (tableIndex, normalizeKey(tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp), keyString, stackPtr) );
+    if (Tables[tableIndex].engine==FMRTENGINEHASH)
+        return ( hashSearchElem (tableIndex, normalizeKey(tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp), keyString, stackPtr) );
+
+    /* String keys are compared through their normalized prefix first */
+    if (Tables[tableIndex].key.type==FMRTSTRING)
+        prefix = keyPrefix (keyString);
+
+    /* The FMRT tree is not empty. Set current to the root index, then start traversing the tree */
+    current = Tables[tableIndex].fmrtRoot;
+    while ( (found==0) && (current!=FMRTNULLPTR) )
+    {   /* currentPtr is set to the first byte of the element indexed by current */
+        currentPtr = Tables[tableIndex].fmrtData + current*Tables[tableIndex].elemSize;
+
+        /* Allocate an element to keep track of node traversal into a LIFO structure */
+        stackElem = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
+        stackElem->next = *stackPtr;
+        *stackPtr = stackElem;
+        (*stackPtr)->index = current;
+
+        /* Check the key pointed by current */
+        switch (Tables[tableIndex].key.type)
         {
             case FMRTINT:
             {
-                keyInt = atoi (p);
+                cmp = FMRTCOMPARE ( keyInt, *((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)) );
                 break;
-            }
+            }   /* case FMRTINT */
             case FMRTSIGNED:
             {
-                keySigned = atoi (p);
+                cmp = FMRTCOMPARE ( keySigned, *((int32_t *)(currentPtr+Tables[tableIndex].key.delta)) );
                 break;
-            }
+            }   /* case FMRTSIGNED */
             case FMRTDOUBLE:
             {
-                keyDouble = atof (p);
+                cmp = FMRTCOMPARE ( keyDouble, *((double *)(currentPtr+Tables[tableIndex].key.delta)) );
                 break;
-            }
+            }   /* case FMRTDOUBLE */
             case FMRTCHAR:
             {
-                keyChar = *p;
+                cmp = FMRTCOMPARE ( keyChar, *((char *)(currentPtr+Tables[tableIndex].key.delta)) );
                 break;
-            }
+            }   /* case FMRTCHAR */
             case FMRTSTRING:
-            {   /* Read the key and truncate to the maximum length specified during definition */
-                maxLen = Tables[i].key.len;    /* This field is max string length + trailing 0 */
-                strncpy (keyString,p,maxLen);
-                keyString[maxLen-1] = '\0';
-                break;
-            }
-            case FMRTTIMESTAMP:
             {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> read raw timestamp from input line */
-                    keyTimestamp = atol (p);
-                else
-                {   /* convert string read from input line to raw timestamp according to fmrtTimeFormat */
-                    struct tm   TimeFromString;
-                    if (strptime (p, fmrtTimeFormat, &TimeFromString) != NULL)
-                        keyTimestamp = mktime (&TimeFromString);
-                    else
-                        keyTimestamp = 0;
-                }
+                cmp = compareStringKey ( tableIndex, prefix, keyString, currentPtr );
                 break;
-            }   /* case FMRTTIMESTAMP */
+            }   /* case FMRTSTRING */
+          case FMRTTIMESTAMP:
+          {
+              cmp = FMRTCOMPARE ( keyTimestamp, *((time_t *)(currentPtr+Tables[tableIndex].key.delta)) );
+              break;
+          }   /* case FMRTTIMESTAMP */
+            case FMRTCOMPOSITE:
+            {   /* Composite keys are encoded so that byte order matches component-wise order (see encodeComponent()) */
+                cmp = memcmp ( keyString, currentPtr+Tables[tableIndex].key.delta, Tables[tableIndex].key.len );
+                break;
+            }   /* case FMRTCOMPOSITE */
         }   /* switch (Tables[i].key.type) */
+        if ( cmp==0 )
+        {   /* key in the current elem is equal to the key we are looking for */
+            found = 1;
+            (*stackPtr)->go = STAY;
+            continue;
+        }
+        else if (cmp<0)
+        {   /* key we are looking for is less than the one in the current node */
+            /* go through the left subtree */
+            current = *((fmrtIndex *) currentPtr);
+            (*stackPtr)->go = LEFT;
+            continue;
+        }
+        else
+        {   /* key we are looking for is greater than the one in the current node */
+            /* go through the right subtree */
+            current = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+            (*stackPtr)->go = RIGHT;
+            continue;
+        }
+    }   /* while ( (found==0) && (current!=FMRTNULLPTR) ) */
 
-        /* Restore pointer at the beginning of the buffer to be filled up with relevat fields and clear data */
-        rowPtr = Tables[i].row;
-        memset (rowPtr,0,fieldsLen);
-        /* Now loop through all fields and fill the buffer */
-        for (j=0; j<Tables[i].numFields; j++)
-        {
-            p=q+1;
-            if (*p=='\0')
-                break;
+    #ifdef FMRTDEBUG
+    printf ("Node traversal stack\n");
+    printf ("--------------------\n");
+    __fmrtPrintStack (tableIndex, *stackPtr);
+    #endif
 
-            for (q=p; (*q!='\0')&&(*q!=separator)&&(*q!='\n'); q+=1); /* stop at EOL or at separator */
-            *q = '\0';  /* p and q now points to the beginning and to the end of the j-th parameter  */
+    /* If the element was not found, then found == 0 */
+    if (found==0)
+        return (FMRTNOTFOUND);
+    else
+        return (FMRTOK);
+}
 
-            switch (Tables[i].fields[j].type)
-            {
-                case FMRTINT:
-                {
-                    *((uint32_t *)rowPtr) = atoi (p);
-                    rowPtr += sizeof (uint32_t);
-                    break;
-                }
-                case FMRTSIGNED:
-                {
-                    *((int32_t *)rowPtr) = atoi (p);
-                    rowPtr += sizeof (int32_t);
-                    break;
-                }
-                case FMRTDOUBLE:
-                {
-                    *((double *)rowPtr) = atof (p);
-                    rowPtr += sizeof (double);
-                    break;
-                }
-                case FMRTCHAR:
-                {
-                    *((char *)rowPtr) = *p;
-                    rowPtr += sizeof (char);
-                    break;
-                }
-                case FMRTSTRING:
-                {   /* In case of string exceeding the maximum length it is automatically truncated */
-                    maxLen = Tables[i].fields[j].len;    /* This field is max string length + trailing 0 */
-                    strncpy ((char*)rowPtr,p,maxLen);
-                    rowPtr += maxLen-1;
-                    *((char*)rowPtr) = '\0';
-                    rowPtr +=1;
-                    break;
-                }
-            case FMRTTIMESTAMP:
-            {
-                if (fmrtTimeFormat[0]=='\0')
-                    /* time format empty --> read raw timestamp from input line */
-                    *((time_t *)rowPtr) = atol (p);
-                else
-                {   /* convert string read from input line to raw timestamp according to fmrtTimeFormat */
-                    struct tm   TimeFromString;
-                    if (strptime (p, fmrtTimeFormat, &TimeFromString) != NULL)
-                        *((time_t *)rowPtr) = mktime (&TimeFromString);
-                    else
-                        *((time_t *)rowPtr) = 0;
-                }
-                rowPtr += sizeof (time_t);
-                break;
-            }   /* case FMRTTIMESTAMP */
-            }   /* switch (Tables[i].fields[j].type) */
-        }   /* for (j=0; j<Tables[i].numFields; j++) */
 
-        if (j<Tables[i].numFields)
-        {   /* This is a blocking error -> clear the lock and exit */
-            free (Tables[i].row);
-            Tables[i].row = NULL;
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            return (FMRTKO);
-        }
+/***********************************************************
+ * searchElem()
+ * ---------------------------------------------------------
+ * This function looks for a key in a table, with the same
+ * parameters and return values of lookupElem(), which
+ * performs the search. When the static tracepoints are
+ * compiled in (FMRTTRACE), the search is surrounded by the
+ * search__start and search__end probes, carrying tableId,
+ * hash of the key (see traceKeyHash()) and, at the end,
+ * result and latency (in ns) of the search. Hash and
+ * latency are computed only while one of the two probes is
+ * enabled
+ ***********************************************************/
+static fmrtResult searchElem (fmrtId tableIndex, uint32_t keyInt, int32_t keySigned, double keyDouble, char keyChar, char *keyString, time_t keyTimestamp, fmrtNodeTraversalStack **stackPtr)
+{
+    #ifdef FMRTTRACE
+    /* Local Variables */
+    fmrtResult  res;
+    uint64_t    start;
+    uint32_t    keyHash;
 
-        /* call searchElem() internal function to look for the element and provide error if result is FMRTKO */
-        duplKey = 0;
-        if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTKO)
-        {   /* This is a blocking error -> release resources, clear the lock and exit */
-            clearNodeTraversalStack (traversal);
-            free (Tables[i].row);
-            Tables[i].row = NULL;
-            /* Clear the lock before exiting */
-            pthread_mutex_unlock(&(Tables[i].tableMtx));
-            return (FMRTKO);
-        }
+    /* Invalid tables are reported by lookupElem() and not traced, as well as searches when no tracer is attached */
+    if ( ((!FMRTPROBEENABLED(search__start)) && (!FMRTPROBEENABLED(search__end))) ||
+         (!registryReady()) || (!tableDefined(tableIndex)) || (Tables[tableIndex].status<KEYDEFINED) )
+        return ( lookupElem (tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, stackPtr) );
 
-        /* If the element is already present set duplKey to 1 */
-        if (res==FMRTOK)
-            duplKey = 1;
+    keyHash = traceKeyHash (tableIndex, normalizeKey(tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp), keyString);
+    FMRTPROBE2 (search__start, Tables[tableIndex].tableId, keyHash);
+    start = monotonicNs ();
+    res = lookupElem (tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, stackPtr);
+    FMRTPROBE4 (search__end, Tables[tableIndex].tableId, keyHash, res, monotonicNs()-start);
 
-        /* traversal is a pointer to a LIFO structure, while duplKey specifies if the key */
-        /* is already present in the table (and shall be overwritten), or is new. In the  */
-        /* former case the top element of traversal stack points directly to the index    */
-        /* in the FMRT structure, while in the latter it points to the parent on which     */
-        /* insertion shall be done                                                        */
+    return (res);
+    #else
+    return ( lookupElem (tableIndex, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, stackPtr) );
+    #endif
+}
 
-        if (duplKey)
-        {   /* the element is already present, overwrite data contained into the internal structure with those read from CSV */
-            /* since the element has been found traversal cannot be NULL in this case */
-            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-        }   /* if (duplKey) */
-        else
-        {   /* the element is not present -> create it */
-            /* Check if this is the first insertion */
-            if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
-            {   /* Initialize Empty elements list */
-                res = initEmptyList(i);
-                if (res!=FMRTOK)
-                {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
-                    clearNodeTraversalStack (traversal);
-                    free (Tables[i].row);
-                    Tables[i].row = NULL;
-                    /* Clear the lock before exiting */
-                    pthread_mutex_unlock(&(Tables[i].tableMtx));
-                    return (res);
-                }
-            }   /* if ( (Tables[i].fmrtData==NULL) ... */
 
-            /* Get an empty element from the list of empty nodes */
-            if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
-            {   /* Not able to fetch an empty element - Probably the table is full */
-                clearNodeTraversalStack (traversal);
-                free (Tables[i].row);
-                Tables[i].row = NULL;
-                /* Clear the lock before exiting */
-                pthread_mutex_unlock(&(Tables[i].tableMtx));
-                return (FMRTOUTOFMEMORY);
-            }
+/***********************************************************
+ * readValueArg()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that take a
+ * key or field value from their variable list of arguments.
+ * It reads from args (second parameter) one value of the
+ * type of the key or field given by the first parameter,
+ * and stores it into the proper member of the fmrtKeyValue
+ * structure (last parameter). Strings are truncated to the
+ * max length specified at definition, while timestamps are
+ * converted according to fmrtTimeFormat
+ ***********************************************************/
+static void readValueArg (fmrtField *field, va_list *args, fmrtKeyValue *value)
+{
+    /* Local Variables */
+    uint8_t     maxLen;
+    char        *string;
 
-            /* Link the new element to the existing structure (if present) */
-            if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
-                Tables[i].fmrtRoot = newElement;
-            else if (traversal->go == LEFT)
-            {   /* the stack exists and the path from parent node goes through the left subtree */
-                currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
-                *((fmrtIndex*)currentPtr) = newElement;
-            }
+    switch (field->type)
+    {
+        case FMRTINT:
+        {
+            value->keyInt = va_arg (*args, uint32_t);
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            value->keySigned = va_arg (*args, int32_t);
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            value->keyDouble = va_arg (*args, double);
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            value->keyChar = (unsigned char) va_arg (*args,int);
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {   /* Read the value and truncate to the maximum length specified during definition */
+            string = va_arg (*args,char*);
+            maxLen = field->len;     /* This field is max string length + trailing 0 */
+            strncpy (value->keyString,string,maxLen);
+            value->keyString[maxLen-1] = '\0';
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                value->keyTimestamp = va_arg (*args, time_t);
             else
-            {   /* the stack exists and the path from parent node goes through the right subtree */
-                currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
-                *((fmrtIndex*)currentPtr) = newElement;
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (*args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    value->keyTimestamp = mktime (&TimeFromString);
+                else
+                    value->keyTimestamp = 0;
             }
+            break;
+        }   /* case FMRTTIMESTAMP */
+    }   /* switch (field->type) */
 
-            /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
-            currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+    return;
+}
 
-            /* Insert null pointers to left and right subtree */
-            *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
-            *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
 
-            Tables[i].status = NOTEMPTY;
-            Tables[i].currentNumElem += 1;
-        }   /* else if (duplKey) */
+/***********************************************************
+ * readCompositeArg()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that take a
+ * FMRTCOMPOSITE key from their variable list of arguments.
+ * It reads from args (second parameter) one value for each
+ * component of the key of the table whose index is given
+ * by the first parameter, in the order used in
+ * fmrtDefineCompositeKey(), and stores the encoded key into
+ * the buffer pointed by the last parameter (see
+ * encodeComponent())
+ ***********************************************************/
+static void readCompositeArg (fmrtId tableIndex, va_list *args, char *encoded)
+{
+    /* Local Variables */
+    uint8_t         c;
+    fmrtKeyValue    value;
+
+    /* Unused bytes of string components are cleared, so that equal keys have equal encodings */
+    memset (encoded, 0, Tables[tableIndex].key.len);
+    for (c=0; c<Tables[tableIndex].numKeyComps; c++)
+    {   /* Loop on the components of the key */
+        readValueArg (&(Tables[tableIndex].keyComps[c]), args, &value);
+        encodeComponent (&(Tables[tableIndex].keyComps[c]), &value, encoded);
+    }
 
-        /* Now currentPtr points to the element that shall be filled, in both cases of new element or existing one */
-        /* Fill the element with the key and the fields read from CSV file */
-        switch (Tables[i].key.type)
-        {
-            case FMRTINT:
-            {
-                *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
-                break;
-            }
-            case FMRTSIGNED:
-            {
-                *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
-                break;
-            }
-            case FMRTDOUBLE:
-            {
-                *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
-                break;
-            }
-            case FMRTCHAR:
-            {
-                *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
-                break;
-            }
-            case FMRTSTRING:
-            {   /* Please observe that keyString has been truncated when it has been read from the input csv file */
-                strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
-                break;
-            }
-            case FMRTTIMESTAMP:
-            {
-                *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
-                break;
-            }
-        }   /* switch (Tables[i].key.type) */
+    return;
+}
 
-        /* Now copy the fields copied into buffer all at once */
-        memcpy ((void *)(currentPtr+Tables[i].fields[0].delta), Tables[i].row, fieldsLen);
 
-        /* Element has been inserted - if duplKey==0 (i.e. new element) go through the   */
-        /* traversal LIFO structure and rebalance fmrt tree starting from the bottom and  */
-        /* going up to the root. This shal not be done if duplKey==1 (the element already*/
-        /* exists and it is assumed that it is already balanced                          */
-        if (duplKey==0)
-        {
-            rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
-            while (rebalPtr!=NULL)
-            {   /* rebalance the subtree whose root is the current node */
-                rebalIndex = rebalanceSubTree (i,rebalPtr->index);  /* the root might change due to rotations */
-                /* go up to the parent */
-                rebalPtr = rebalPtr->next;
-                if (rebalPtr!=NULL)
-                {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
-                    if (rebalPtr->go == LEFT)
-                        currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
-                    else
-                        currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
-                    /* The proper pointer is updated with the output of the rebalance structure */
-                    *((fmrtIndex*)currentPtr) = rebalIndex;
-                }   /* if (rebalPtr!=NULL) */
-                else
-                    /* There is no parent node - Rotation implies a change of the fmrt root pointer */
-                    Tables[i].fmrtRoot = rebalIndex;
-            }   /* while (rebalPtr!=NULL) */
-        }   /* if (duplKey==0) */
+/***********************************************************
+ * readKeyArg()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that take a
+ * key value from their variable list of arguments.
+ * It reads from args (second parameter) one key of the type
+ * defined through fmrtDefineKey() for the table whose index
+ * is given by the first parameter, and stores it into the
+ * proper member of the fmrtKeyValue structure (last
+ * parameter), see readValueArg()
+ ***********************************************************/
+static void readKeyArg (fmrtId tableIndex, va_list *args, fmrtKeyValue *key)
+{
+    /* Composite keys take one argument for each component and are stored encoded into keyString */
+    if (Tables[tableIndex].key.type==FMRTCOMPOSITE)
+        readCompositeArg (tableIndex, args, key->keyString);
+    else
+        readValueArg (&(Tables[tableIndex].key), args, key);
+
+    return;
+}
+
+
+/***********************************************************
+ * valueMember()
+ * ---------------------------------------------------------
+ * Given a fmrtKeyValue structure (last parameter), this
+ * function provides a pointer to the member matching the
+ * type given by the first parameter. The pointed data have
+ * the same representation used to store keys and fields
+ * into the table elements
+ ***********************************************************/
+static void *valueMember (fmrtType type, fmrtKeyValue *value)
+{
+    switch (type)
+    {
+        case FMRTINT:
+            return ((void *) &(value->keyInt));
+        case FMRTSIGNED:
+            return ((void *) &(value->keySigned));
+        case FMRTDOUBLE:
+            return ((void *) &(value->keyDouble));
+        case FMRTCHAR:
+            return ((void *) &(value->keyChar));
+        case FMRTSTRING:
+        case FMRTCOMPOSITE:
+            return ((void *) value->keyString);
+        case FMRTTIMESTAMP:
+            return ((void *) &(value->keyTimestamp));
+    }   /* switch (type) */
+
+    return (NULL);
+}
+
+
+/***********************************************************
+ * keyValuePtr()
+ * ---------------------------------------------------------
+ * Given a fmrtKeyValue structure (second parameter), this
+ * function provides a pointer to the member matching the
+ * key type of the table whose index is given by the first
+ * parameter (see valueMember())
+ ***********************************************************/
+static void *keyValuePtr (fmrtId tableIndex, fmrtKeyValue *key)
+{
+    return ( valueMember (Tables[tableIndex].key.type, key) );
+}
+
+
+/***********************************************************
+ * checkUniqueArgs()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that write
+ * the fields of an element from their variable list of
+ * arguments. It reads one value for each field from args
+ * (second parameter) and checks that the values of the
+ * fields selected by mask (third parameter, see fmrtModify())
+ * having a unique secondary index are not already present
+ * in elements other than the one given by the last
+ * parameter (FMRTNULLPTR for new elements)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   No unique value is duplicated
+ * - FMRTDUPLICATEVALUE
+ *   At least one unique value is already present
+ ***********************************************************/
+static fmrtResult checkUniqueArgs (fmrtId tableIndex, va_list *args, fmrtParamMask mask, fmrtIndex self)
+{
+    /* Local Variables */
+    uint8_t         j,k;
+    fmrtKeyValue    value;
+
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        readValueArg (&(Tables[tableIndex].fields[j]), args, &value);
+        for (k=0; k<Tables[tableIndex].numIndexes; k++)
+            if ( (Tables[tableIndex].indexes[k].field==j) && (Tables[tableIndex].indexes[k].unique) && ((mask>>j)&1) &&
+                 (indexConflict(tableIndex, k, valueMember(Tables[tableIndex].fields[j].type,&value), self)) )
+                return (FMRTDUPLICATEVALUE);
+    }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * reserveStringArgs()
+ * ---------------------------------------------------------
+ * This function reserves the string heap space needed by
+ * the FMRTSTRING fields read from the variable list of
+ * arguments (second parameter, that shall be a copy of the
+ * one used to store the fields) whose bit is set in mask,
+ * so that they can be stored without failing
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   The fields can be stored
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to grow the heap
+ ***********************************************************/
+static fmrtResult reserveStringArgs (fmrtId tableIndex, va_list *args, fmrtParamMask mask)
+{
+    /* Local Variables */
+    uint8_t         j;
+    uint64_t        len = 0;
+    fmrtKeyValue    value;
+
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        readValueArg (&(Tables[tableIndex].fields[j]), args, &value);
+        if ( (Tables[tableIndex].fields[j].type==FMRTSTRING) && ((mask>>j)&1) )
+            len += stringHeapLen (tableIndex, j, value.keyString);
+    }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+
+    return (reserveStringHeap (tableIndex, len));
+}
+
+
+/***********************************************************
+ * checkUniqueRow()
+ * ---------------------------------------------------------
+ * This function is the counterpart of checkUniqueArgs()
+ * for rows read from a CSV file (second parameter, where
+ * each field takes its maximum length, see storeRow()).
+ * All the fields are checked
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   No unique value is duplicated
+ * - FMRTDUPLICATEVALUE
+ *   At least one unique value is already present
+ ***********************************************************/
+static fmrtResult checkUniqueRow (fmrtId tableIndex, void *rowPtr, fmrtIndex self)
+{
+    /* Local Variables */
+    uint8_t         j,k;
+    void            *valuePtr;
+    fmrtKeyValue    value;
+
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {
+        for (k=0; k<Tables[tableIndex].numIndexes; k++)
+        {
+            if ( (Tables[tableIndex].indexes[k].field!=j) || (!Tables[tableIndex].indexes[k].unique) )
+                continue;
+            /* Values in the row are not aligned, they are copied unless they are strings */
+            valuePtr = rowPtr;
+            if (Tables[tableIndex].fields[j].type!=FMRTSTRING)
+            {
+                valuePtr = valueMember (Tables[tableIndex].fields[j].type, &value);
+                memcpy (valuePtr, rowPtr, Tables[tableIndex].fields[j].len);
+            }
+            if (indexConflict(tableIndex, k, valuePtr, self))
+                return (FMRTDUPLICATEVALUE);
+        }   /* for (k=0; k<Tables[tableIndex].numIndexes; k++) */
+        rowPtr += Tables[tableIndex].fields[j].len;
+    }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * loadKeyValue()
+ * ---------------------------------------------------------
+ * This function copies the key of the element pointed by
+ * the second parameter into the proper member of the
+ * fmrtKeyValue structure given by the last parameter
+ ***********************************************************/
+static void loadKeyValue (fmrtId tableIndex, void *currentPtr, fmrtKeyValue *key)
+{
+    if (Tables[tableIndex].key.type==FMRTSTRING)
+        strcpy (key->keyString, (char *)(currentPtr+Tables[tableIndex].key.delta));
+    else
+        memcpy (keyValuePtr(tableIndex,key), currentPtr+Tables[tableIndex].key.delta, Tables[tableIndex].key.len);
+
+    return;
+}
+
+
+/***********************************************************
+ * compareKey()
+ * ---------------------------------------------------------
+ * This function compares the key stored into a fmrtKeyValue
+ * structure (second parameter) with the key pointed by the
+ * third parameter (e.g. the key of a table element, i.e.
+ * currentPtr+key.delta, or a pointer obtained through
+ * keyValuePtr()). The first parameter is the index of the
+ * table in the Table[] array.
+ * ---------------------------------------------------------
+ * It returns a negative value, 0 or a positive value if the
+ * key is respectively lower, equal or greater than the one
+ * pointed by the third parameter
+ ***********************************************************/
+static int compareKey (fmrtId tableIndex, fmrtKeyValue *key, void *keyPtr)
+{
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+            return ( FMRTCOMPARE (key->keyInt, *((uint32_t *)keyPtr)) );
+        case FMRTSIGNED:
+            return ( FMRTCOMPARE (key->keySigned, *((int32_t *)keyPtr)) );
+        case FMRTDOUBLE:
+            return ( FMRTCOMPARE (key->keyDouble, *((double *)keyPtr)) );
+        case FMRTCHAR:
+            return ( FMRTCOMPARE (key->keyChar, *((char *)keyPtr)) );
+        case FMRTSTRING:
+            return ( strcmp (key->keyString, (char *)keyPtr) );
+        case FMRTTIMESTAMP:
+            return ( FMRTCOMPARE (key->keyTimestamp, *((time_t *)keyPtr)) );
+        case FMRTCOMPOSITE:
+            return ( memcmp (key->keyString, keyPtr, Tables[tableIndex].key.len) );
+    }   /* switch (Tables[tableIndex].key.type) */
+
+    return (0);
+}
+
+
+/***********************************************************
+ * extractFields()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that provide
+ * back the content of an element (e.g. fmrtRead()). It
+ * reads from args (last parameter) one pointer for each
+ * field defined through fmrtDefineFields() and fills it with
+ * the value of the corresponding field of the element
+ * pointed by currentPtr (second parameter)
+ ***********************************************************/
+static void extractFields (fmrtId tableIndex, void *currentPtr, va_list *args)
+{
+    /* Local Variables */
+    uint8_t     j;
+    void        *fieldsPtr;
+
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* @@@ - By removing comment from the following line we obtain for each field the pair name, value */
+        /* @@@ - If the comment is present, we obtain only a list of values according to the same order    */
+        /* @@@ - defined in fmrtDefineFields() library call                                                 */
+        /* strcpy (va_arg (*args, char *),Tables[tableIndex].fields[j].name); */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                *va_arg (*args, uint32_t *) = *((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta));
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                *va_arg (*args, int32_t *) = *((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta));
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                *va_arg (*args, double *) = *((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta));
+                break;
+            }
+            case FMRTCHAR:
+            {
+                *va_arg (*args, char *) = *((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta));
+                break;
+            }
+            case FMRTSTRING:
+            {
+                strcpy (va_arg (*args, char *),fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> use raw timestamp from argument */
+                    *va_arg (*args, time_t *) = *((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    strcpy (va_arg (*args, char *),timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[tableIndex].fields[j].type) */
+    }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+
+    return;
+}
+
+
+/***********************************************************
+ * extractKey()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that provide
+ * back the key of an element (e.g. fmrtFloor()). It reads
+ * from args (last parameter) one pointer of the type defined
+ * through fmrtDefineKey() and fills it with the key of the
+ * element pointed by currentPtr (second parameter). String
+ * and formatted timestamp keys require a char buffer large
+ * enough to hold the result. FMRTCOMPOSITE keys take one
+ * pointer for each component
+ ***********************************************************/
+static void extractKey (fmrtId tableIndex, void *currentPtr, va_list *args)
+{
+    /* Local Variables */
+    uint8_t         c;
+    fmrtKeyValue    value;
+
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+        {
+            *va_arg (*args, uint32_t *) = *((uint32_t *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            *va_arg (*args, int32_t *) = *((int32_t *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            *va_arg (*args, double *) = *((double *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            *va_arg (*args, char *) = *((char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {
+            strcpy (va_arg (*args, char *),(char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> provide raw timestamp */
+                *va_arg (*args, time_t *) = *((time_t *)(currentPtr+Tables[tableIndex].key.delta));
+            else
+            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                char  timestamp[MAXFMRTSTRINGLEN+1];
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                strcpy (va_arg (*args, char *),timestamp);
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One pointer for each component, of the type given in fmrtDefineCompositeKey() */
+            for (c=0; c<Tables[tableIndex].numKeyComps; c++)
+            {
+                decodeComponent (&(Tables[tableIndex].keyComps[c]), currentPtr+Tables[tableIndex].key.delta, &value);
+                switch (Tables[tableIndex].keyComps[c].type)
+                {
+                    case FMRTINT:
+                    {
+                        *va_arg (*args, uint32_t *) = value.keyInt;
+                        break;
+                    }   /* case FMRTINT */
+                    case FMRTSIGNED:
+                    {
+                        *va_arg (*args, int32_t *) = value.keySigned;
+                        break;
+                    }   /* case FMRTSIGNED */
+                    case FMRTDOUBLE:
+                    {
+                        *va_arg (*args, double *) = value.keyDouble;
+                        break;
+                    }   /* case FMRTDOUBLE */
+                    case FMRTCHAR:
+                    {
+                        *va_arg (*args, char *) = value.keyChar;
+                        break;
+                    }   /* case FMRTCHAR */
+                    case FMRTSTRING:
+                    {
+                        strcpy (va_arg (*args, char *),value.keyString);
+                        break;
+                    }   /* case FMRTSTRING */
+                    case FMRTTIMESTAMP:
+                    {
+                        if (fmrtTimeFormat[0]=='\0')
+                            /* time format empty --> provide raw timestamp */
+                            *va_arg (*args, time_t *) = value.keyTimestamp;
+                        else
+                        {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                            char  timestamp[MAXFMRTSTRINGLEN+1];
+                            strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime(&(value.keyTimestamp)));
+                            strcpy (va_arg (*args, char *),timestamp);
+                        }
+                        break;
+                    }   /* case FMRTTIMESTAMP */
+                }   /* switch (Tables[tableIndex].keyComps[c].type) */
+            }   /* for (c=0; c<Tables[tableIndex].numKeyComps; c++) */
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[tableIndex].key.type) */
+
+    return;
+}
+
+
+/***********************************************************
+ * searchNearest()
+ * ---------------------------------------------------------
+ * This function is used by fmrtFloor(), fmrtCeil(),
+ * fmrtPrev(), fmrtNext(), fmrtMin() and fmrtMax() library
+ * calls. It performs a single bounded descent from the root
+ * of the table whose index is given by the first parameter,
+ * looking for the element whose key is the nearest to the
+ * given one (second parameter) according to the selected
+ * mode (third parameter):
+ * - NEARESTFLOOR  greatest key lower than or equal to key
+ * - NEARESTCEIL   lowest key greater than or equal to key
+ * - NEARESTPREV   greatest key strictly lower than key
+ * - NEARESTNEXT   lowest key strictly greater than key
+ * - NEARESTMIN    lowest key in the table (key not used)
+ * - NEARESTMAX    greatest key in the table (key not used)
+ * ---------------------------------------------------------
+ * It returns the index of the element found or FMRTNULLPTR
+ * if no element satisfies the condition
+ ***********************************************************/
+static fmrtIndex searchNearest (fmrtId tableIndex, fmrtKeyValue *key, uint8_t mode)
+{
+    /* Local Variables */
+    int         cmp;
+    fmrtIndex   current,
+                best = FMRTNULLPTR;
+    void        *currentPtr;
+
+    /* If the table is empty there is nothing to search for */
+    if (Tables[tableIndex].fmrtData==NULL)
+        return (FMRTNULLPTR);
+
+    current = Tables[tableIndex].fmrtRoot;
+    while (current!=FMRTNULLPTR)
+    {   /* currentPtr is set to the first byte of the element indexed by current */
+        currentPtr = Tables[tableIndex].fmrtData + current*Tables[tableIndex].elemSize;
+
+        /* Min and Max simply descend on the leftmost or rightmost path */
+        if (mode==NEARESTMIN)
+            cmp = -1;
+        else if (mode==NEARESTMAX)
+            cmp = 1;
+        else
+            cmp = compareKey (tableIndex, key, currentPtr+Tables[tableIndex].key.delta);
+
+        /* Exact match is the answer for floor and ceiling */
+        if ( (cmp==0) && ((mode==NEARESTFLOOR)||(mode==NEARESTCEIL)) )
+            return (current);
+
+        if (cmp>0)
+        {   /* current key is lower than the searched one - it is a candidate for floor/prev/max */
+            if ( (mode==NEARESTFLOOR) || (mode==NEARESTPREV) || (mode==NEARESTMAX) )
+                best = current;
+            /* go through the right subtree */
+            current = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+        }
+        else if (cmp<0)
+        {   /* current key is greater than the searched one - it is a candidate for ceil/next/min */
+            if ( (mode==NEARESTCEIL) || (mode==NEARESTNEXT) || (mode==NEARESTMIN) )
+                best = current;
+            /* go through the left subtree */
+            current = *((fmrtIndex *) currentPtr);
+        }
+        else if (mode==NEARESTPREV)
+            /* equal key - predecessor is in the left subtree */
+            current = *((fmrtIndex *) currentPtr);
+        else
+            /* equal key - successor is in the right subtree */
+            current = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    }   /* while (current!=FMRTNULLPTR) */
+
+    return (best);
+}
+
+
+/***********************************************************
+ * prefixScanRecurse()
+ * ---------------------------------------------------------
+ * This function is used by fmrtPrefixScan() to visit in
+ * ascending order all the elements of the subtree rooted at
+ * nodeIndex whose FMRTSTRING key starts with prefix (whose
+ * length is prefixLen). Subtrees that cannot contain matching
+ * keys are pruned. Each matching key is provided to sink
+ * (if not NULL) and counted into count; the recursion stops
+ * as soon as limit is reached or sink returns non-zero.
+ * ---------------------------------------------------------
+ * It returns 1 if the scan shall be stopped, 0 otherwise
+ ***********************************************************/
+static uint8_t prefixScanRecurse (fmrtId tableIndex, fmrtIndex nodeIndex, char *prefix, size_t prefixLen, fmrtIndex limit, fmrtKeySink sink, void *userData, fmrtIndex *count)
+{
+    /* Local Variables */
+    void        *currentPtr;
+    char        *nodeKey;
+    int         cmp;
+
+    /* If nodeIndex is NULL exit without actions */
+    if (nodeIndex==FMRTNULLPTR)
+        return (0);
+
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    nodeKey = (char *) (currentPtr+Tables[tableIndex].key.delta);
+    cmp = strncmp (nodeKey, prefix, prefixLen);
+
+    if (cmp<0)
+        /* current key is lower than any matching key -> go through the right subtree only */
+        return ( prefixScanRecurse (tableIndex, *((fmrtIndex *)(currentPtr+sizeof(fmrtIndex))), prefix, prefixLen, limit, sink, userData, count) );
+    if (cmp>0)
+        /* current key is greater than any matching key -> go through the left subtree only */
+        return ( prefixScanRecurse (tableIndex, *((fmrtIndex *)currentPtr), prefix, prefixLen, limit, sink, userData, count) );
+
+    /* current key matches: visit left subtree, then the node itself, then right subtree */
+    if (prefixScanRecurse (tableIndex, *((fmrtIndex *)currentPtr), prefix, prefixLen, limit, sink, userData, count))
+        return (1);
+    if ( (limit!=0) && (*count>=limit) )
+        return (1);
+    *count += 1;
+    if ( (sink!=NULL) && (sink(nodeKey, userData)!=0) )
+        return (1);
+    return ( prefixScanRecurse (tableIndex, *((fmrtIndex *)(currentPtr+sizeof(fmrtIndex))), prefix, prefixLen, limit, sink, userData, count) );
+}
+
+
+/***********************************************************
+ * countSubtreeNodes()
+ * ---------------------------------------------------------
+ * This function is used to count the number of nodes of
+ * the subtree whose root node is given by the second
+ * parameter.
+ * The function is implemented through direct recursion
+ * ---------------------------------------------------------
+ * It returns the number of nodes including the root
+ ***********************************************************/
+static int8_t countSubtreeNodes (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local variables */
+    void        *currentPtr;
+    fmrtIndex    leftIndex, rightIndex;
+    int8_t      leftNodes=0, rightNodes=0;
+
+    /* If fmrtIndex is NULL exit */
+    if (node==FMRTNULLPTR)
+        return (0);
+
+    /* fmrtIndex is not NULL, evaluate currentPtr and Left and Right subtree indexes */
+    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* If the node is a leaf provide 1 */
+    if ( (leftIndex==FMRTNULLPTR) && (rightIndex==FMRTNULLPTR) )
+        return (1);
+
+    if (leftIndex!=FMRTNULLPTR)
+        leftNodes = countSubtreeNodes(tableIndex,leftIndex);
+    if (rightIndex!=FMRTNULLPTR)
+        rightNodes = countSubtreeNodes(tableIndex,rightIndex);
+
+    return (1+leftNodes+rightNodes);
+}
+
+
+/***********************************************************
+ * nodeHeight()
+ * ---------------------------------------------------------
+ * This function is used by fmrt library calls that perform
+ * write access to the structure.
+ * Given a tableId (first parameter) and the fmrtIndex of a
+ * node (second parameter), it provides the corresponding
+ * height, defined as:
+ *    1+max[height(leftsubtree),height(rightsubtree)]
+ * (where leafs have height 0 by definition).
+ * The function is implemented through direct recursion
+ * ---------------------------------------------------------
+ * It returns the height
+ ***********************************************************/
+static int8_t nodeHeight (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local variables */
+    void        *currentPtr;
+    fmrtIndex    leftIndex, rightIndex;
+    int8_t      leftHeight=-1,
+                rightHeight=-1;
+
+    /* If fmrtIndex is NULL exit */
+    if (node==FMRTNULLPTR)
+        return (-1);
+
+    /* fmrtIndex is not NULL, evaluate currentPtr and Left and Right subtree indexes */
+    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    leftHeight = nodeHeight(tableIndex,leftIndex);
+    rightHeight = nodeHeight(tableIndex,rightIndex);
+
+    return ( 1+((leftHeight>rightHeight)?leftHeight:rightHeight) );
+}
+
+
+/***********************************************************
+ * aggregateFieldValue()
+ * ---------------------------------------------------------
+ * This function provides the value of the aggregated field
+ * (see fmrtDefineAggregate()) of the element pointed by the
+ * second parameter, converted to double
+ ***********************************************************/
+static double aggregateFieldValue (fmrtId tableIndex, void *currentPtr)
+{
+    /* Local variables */
+    fmrtField   *field;
+    void        *fieldsPtr;
+
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    field = &(Tables[tableIndex].fields[Tables[tableIndex].aggField]);
+    switch (field->type)
+    {
+        case FMRTINT:
+            return ( (double) *((uint32_t *)(fieldsPtr+field->delta)) );
+        case FMRTSIGNED:
+            return ( (double) *((int32_t *)(fieldsPtr+field->delta)) );
+        case FMRTDOUBLE:
+            return ( *((double *)(fieldsPtr+field->delta)) );
+    }   /* switch (field->type) */
+
+    return (0.0);
+}
+
+
+/***********************************************************
+ * updateNodeAggregate()
+ * ---------------------------------------------------------
+ * This function recomputes the subtree aggregates (count,
+ * sum, min and max of the aggregated field) stored into the
+ * node given by the second parameter, starting from the
+ * value of the node itself and from the aggregates of its
+ * children, which are assumed to be already up to date.
+ * Nothing is done if no aggregate has been defined for the
+ * table through fmrtDefineAggregate()
+ ***********************************************************/
+static void updateNodeAggregate (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local variables */
+    void                *currentPtr;
+    fmrtIndex            child;
+    fmrtNodeAggregate   *nodeAgg,
+                        *childAgg;
+    double               value;
+    int                  k;
+
+    /* If no aggregate is defined or node is NULL exit without actions */
+    if ( (Tables[tableIndex].aggField==FMRTNOAGGREGATE) || (node==FMRTNULLPTR) )
+        return;
+
+    /* Start from the value stored into the node itself */
+    currentPtr = Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize;
+    nodeAgg = (fmrtNodeAggregate *) (currentPtr+Tables[tableIndex].aggDelta);
+    value = aggregateFieldValue (tableIndex, currentPtr);
+    nodeAgg->count = 1;
+    nodeAgg->sum = nodeAgg->min = nodeAgg->max = value;
+
+    /* Then merge aggregates of left (k=0) and right (k=1) subtrees */
+    for (k=0; k<2; k++)
+    {
+        child = *((fmrtIndex *) (currentPtr+k*sizeof(fmrtIndex)));
+        if (child==FMRTNULLPTR)
+            continue;
+        childAgg = (fmrtNodeAggregate *) (Tables[tableIndex].fmrtData + child*Tables[tableIndex].elemSize + Tables[tableIndex].aggDelta);
+        nodeAgg->count += childAgg->count;
+        nodeAgg->sum += childAgg->sum;
+        if (childAgg->min < nodeAgg->min)
+            nodeAgg->min = childAgg->min;
+        if (childAgg->max > nodeAgg->max)
+            nodeAgg->max = childAgg->max;
+    }   /* for (k=0; k<2; k++) */
+
+    return;
+}
+
+
+/***********************************************************
+ * updatePathAggregate()
+ * ---------------------------------------------------------
+ * This function recomputes the subtree aggregates of all
+ * nodes contained into the traversal LIFO structure built
+ * by searchElem() (second parameter), going from the top of
+ * the stack up to the root. It is used when the aggregated
+ * field of an existing element is modified, i.e. when the
+ * tree is not rebalanced
+ ***********************************************************/
+static void updatePathAggregate (fmrtId tableIndex, fmrtNodeTraversalStack *stackPtr)
+{
+    /* If no aggregate is defined exit without actions */
+    if (Tables[tableIndex].aggField==FMRTNOAGGREGATE)
+        return;
+
+    for ( ; stackPtr!=NULL; stackPtr=stackPtr->next)
+        updateNodeAggregate (tableIndex, stackPtr->index);
+
+    return;
+}
+
+
+/***********************************************************
+ * aggregateRangeRecurse()
+ * ---------------------------------------------------------
+ * This function is used by fmrtAggregateRange() to merge
+ * into the last parameter the aggregates of all elements
+ * in the subtree rooted at nodeIndex whose key lies in the
+ * interval [keyMin,keyMax].
+ * lowBounded and highBounded specify whether keyMin and
+ * keyMax actually constrain the subtree: as soon as both
+ * of them are 0, the whole subtree lies in the interval and
+ * the aggregates stored into its root are used directly.
+ * Therefore the function visits at most two paths from the
+ * root to the leaves, i.e. its complexity is O(log(n))
+ ***********************************************************/
+static void aggregateRangeRecurse (fmrtId tableIndex, fmrtIndex nodeIndex, fmrtKeyValue *keyMin, fmrtKeyValue *keyMax, uint8_t lowBounded, uint8_t highBounded, fmrtAggregate *agg)
+{
+    /* Local variables */
+    void                *currentPtr;
+    fmrtNodeAggregate   *nodeAgg;
+    fmrtNodeAggregate    single;
+
+    /* If nodeIndex is NULL exit without actions */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    if ( (lowBounded) && (compareKey(tableIndex,keyMin,currentPtr+Tables[tableIndex].key.delta)>0) )
+    {   /* current key is below keyMin -> only the right subtree may contain elements in range */
+        aggregateRangeRecurse (tableIndex, *((fmrtIndex *)(currentPtr+sizeof(fmrtIndex))), keyMin, keyMax, lowBounded, highBounded, agg);
+        return;
+    }
+    if ( (highBounded) && (compareKey(tableIndex,keyMax,currentPtr+Tables[tableIndex].key.delta)<0) )
+    {   /* current key is above keyMax -> only the left subtree may contain elements in range */
+        aggregateRangeRecurse (tableIndex, *((fmrtIndex *)currentPtr), keyMin, keyMax, lowBounded, highBounded, agg);
+        return;
+    }
+
+    if ( (!lowBounded) && (!highBounded) )
+        /* The whole subtree is in range, use aggregates stored into the node */
+        nodeAgg = (fmrtNodeAggregate *) (currentPtr+Tables[tableIndex].aggDelta);
+    else
+    {   /* The current node is in range, go on in both subtrees (each one is bounded only on one side) */
+        aggregateRangeRecurse (tableIndex, *((fmrtIndex *)currentPtr), keyMin, keyMax, lowBounded, 0, agg);
+        aggregateRangeRecurse (tableIndex, *((fmrtIndex *)(currentPtr+sizeof(fmrtIndex))), keyMin, keyMax, 0, highBounded, agg);
+        single.count = 1;
+        single.sum = single.min = single.max = aggregateFieldValue (tableIndex, currentPtr);
+        nodeAgg = &single;
+    }
+
+    /* Merge nodeAgg into the result */
+    if (agg->count==0)
+    {
+        agg->min = nodeAgg->min;
+        agg->max = nodeAgg->max;
+    }
+    else
+    {
+        if (nodeAgg->min < agg->min)
+            agg->min = nodeAgg->min;
+        if (nodeAgg->max > agg->max)
+            agg->max = nodeAgg->max;
+    }
+    agg->count += nodeAgg->count;
+    agg->sum += nodeAgg->sum;
+
+    return;
+}
+
+
+/***********************************************************
+ * rotateLeft()
+ * ---------------------------------------------------------
+ * This function performs left rotation on the subtree whose
+ * root node is given by the second parameter.
+ * ---------------------------------------------------------
+ * It returns the index of the subtree after rotation
+ ***********************************************************/
+static fmrtIndex rotateLeft (fmrtId tableIndex, fmrtIndex index)
+{
+    /* Local variables */
+    fmrtIndex    index1,
+                index2;
+    void        *ptr,
+                *ptr1;
+
+    /* If index is NULL exit without actions */
+    if (index==FMRTNULLPTR)
+        return (FMRTNULLPTR);
+
+    /* Set ptr to the first byte of the structure that contains the given index */
+    ptr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
+
+    /* index1(ptr1) is the right child of the node pointed by index(ptr) */
+    index1 = *((fmrtIndex *) (ptr+sizeof(fmrtIndex)));
+    ptr1 = Tables[tableIndex].fmrtData + index1*Tables[tableIndex].elemSize;
+
+    /* index2(ptr2) is the left chid of index1(ptr1) */
+    index2 = *((fmrtIndex *) ptr1);
+
+    /* rotate left... */
+    /* let index(ptr) become left subtree of index1(ptr1)*/
+    *((fmrtIndex *) ptr1) = index;
+    /* then left subtree of index(ptr) points to index2(ptr2) */
+    *((fmrtIndex *) (ptr+sizeof(fmrtIndex))) = index2;
+
+    /* refresh subtree aggregates, bottom-up (index is now a child of index1) */
+    updateNodeAggregate (tableIndex, index);
+    updateNodeAggregate (tableIndex, index1);
+
+    /* the new root is index1(ptr1) */
+    return (index1);
+}
+
+
+/***********************************************************
+ * rotateRight()
+ * ---------------------------------------------------------
+ * This function performs right rotation on the subtree whose
+ * root node is given by the second parameter.
+ * ---------------------------------------------------------
+ * It returns the index of the subtree after rotation
+ ***********************************************************/
+static fmrtIndex rotateRight (fmrtId tableIndex, fmrtIndex index)
+{
+    /* Local variables */
+    fmrtIndex    index1,
+                index2;
+    void        *ptr,
+                *ptr1;
+
+    /* If index is NULL exit without actions */
+    if (index==FMRTNULLPTR)
+        return (FMRTNULLPTR);
+
+    /* Set ptr to the first byte of the structure that contains the given index */
+    ptr = Tables[tableIndex].fmrtData + index*Tables[tableIndex].elemSize;
+
+    /* index1(ptr1) is the left child of the node pointed by index(ptr) */
+    index1 = *((fmrtIndex *) ptr);
+    ptr1 = Tables[tableIndex].fmrtData + index1*Tables[tableIndex].elemSize;
+
+    /* index2(ptr2) is the right chid of index1(ptr1) */
+    index2 = *((fmrtIndex *) (ptr1+sizeof(fmrtIndex)));
+
+    /* rotate right... */
+    /* let index(ptr) become right subtree of index1(ptr1)*/
+    *((fmrtIndex *) (ptr1+sizeof(fmrtIndex))) = index;
+    /* then left subtree of index(ptr) points to index2(ptr2) */
+    *((fmrtIndex *) ptr) = index2;
+
+    /* refresh subtree aggregates, bottom-up (index is now a child of index1) */
+    updateNodeAggregate (tableIndex, index);
+    updateNodeAggregate (tableIndex, index1);
+
+    /* the new root is index1(ptr1) */
+    return (index1);
+}
+
+
+/***********************************************************
+ * rebalanceSubTree()
+ * ---------------------------------------------------------
+ * This function is used to rebalance a subtree whose index
+ * is given as second parameter. The first parameter is the
+ * index of the table in the Table[] array, the third one
+ * tells whether rebalancing follows an insertion or a
+ * deletion (FMRTROTINSERT or FMRTROTDELETE), in order to
+ * count the rotations (see fmrtGetTreeInfo()).
+ * Balance factor is defined here as:
+ *    BF = height(right subtree) - height(left subtree)
+ * (if BF>0 subtree on the right has an higher height
+ *  vs left subtree and vice versa. In some papers/articles
+ *  the opposite definition is assumed)
+ * ---------------------------------------------------------
+ * It returns the fmrtIndex pointer of the re-balanced tree
+ ***********************************************************/
+static fmrtIndex rebalanceSubTree (fmrtId tableIndex, fmrtIndex nodeIndex, uint8_t op)
+{
+    /* Local variables */
+    int8_t      balance,
+                lefthgt,
+                righthgt;
+    fmrtIndex    leftIndex,
+                rightIndex,
+                workIndex,
+                leftsubtree,
+                rightsubtree;
+    void        *currentPtr,
+                *subtreePtr;
+
+    /* If nodeIndex is NULL exit without actions */
+    if (nodeIndex==FMRTNULLPTR)
+        return (FMRTNULLPTR);
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Left, Right and current subtree indexes */
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    workIndex = nodeIndex;
+
+    /* evaluate balance factor of current node */
+    righthgt = nodeHeight(tableIndex,rightIndex);
+    lefthgt = nodeHeight(tableIndex,leftIndex);
+    balance = righthgt-lefthgt;
+
+    if (balance>1)
+    {   /* the subtree whose root is nodeIndex=workIndex is unbalanced -> right subtree has higher height */
+        /* Evaluate heights on the right and left subtrees of the right child                             */
+        /* Since (balance>=2)   ==>   height(right subtree)>=2   ==>   rightIndex!=FMRTNULLPTR             */
+        subtreePtr = Tables[tableIndex].fmrtData + rightIndex*Tables[tableIndex].elemSize;
+        leftsubtree = *((fmrtIndex *) subtreePtr);
+        rightsubtree = *((fmrtIndex *) (subtreePtr+sizeof(fmrtIndex)));
+
+        if ( nodeHeight(tableIndex,rightsubtree)>=nodeHeight(tableIndex,leftsubtree) )
+        {   /* if right subtree of the right child has highest (or equal) height simply rotate left */
+            workIndex = rotateLeft(tableIndex,nodeIndex);
+            Tables[tableIndex].rotations[op][0] += 1;
+            FMRTPROBE4 (rotate, Tables[tableIndex].tableId, nodeIndex, op, 0);
+        }
+        else
+        {   /* otherwise we have to combine right and left rotation */
+            *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = rotateRight(tableIndex,rightIndex);
+            workIndex = rotateLeft(tableIndex,nodeIndex);
+            Tables[tableIndex].rotations[op][1] += 1;
+            FMRTPROBE4 (rotate, Tables[tableIndex].tableId, nodeIndex, op, 1);
+        }
+        return (workIndex);
+    }   /* if (balance>1) */
+
+    if (balance<-1)
+    {   /* the subtree whose root is nodeIndex=workIndex is unbalanced -> left subtree has higher height */
+        /* Evaluate heights on the right and left subtrees of the left child                             */
+        /* Since (balance<=-2)   ==>   height(left subtree)>=2   ==>   leftIndex!=FMRTNULLPTR             */
+        subtreePtr = Tables[tableIndex].fmrtData + leftIndex*Tables[tableIndex].elemSize;
+        leftsubtree = *((fmrtIndex *) subtreePtr);
+        rightsubtree = *((fmrtIndex *) (subtreePtr+sizeof(fmrtIndex)));
+
+        if ( nodeHeight(tableIndex,leftsubtree)>=nodeHeight(tableIndex,rightsubtree) )
+        {   /* if left subtree of the left child has highest (or equal) height simply rotate right */
+            workIndex = rotateRight(tableIndex,nodeIndex);
+            Tables[tableIndex].rotations[op][0] += 1;
+            FMRTPROBE4 (rotate, Tables[tableIndex].tableId, nodeIndex, op, 0);
+        }
+        else
+        {   /* otherwise we have to combine left and Right rotation */
+            *((fmrtIndex *) (currentPtr) ) = rotateLeft(tableIndex,leftIndex);;
+            workIndex = rotateRight(tableIndex,nodeIndex);
+            Tables[tableIndex].rotations[op][1] += 1;
+            FMRTPROBE4 (rotate, Tables[tableIndex].tableId, nodeIndex, op, 1);
+        }
+        return (workIndex);
+    }   /* if (balance<-1) */
+
+    /* No rotation needed, but subtree aggregates of the node shall be refreshed anyway */
+    updateNodeAggregate (tableIndex, nodeIndex);
+
+    return (workIndex);
+
+}
+
+
+/***********************************************************
+ * leftMostChild()
+ * ---------------------------------------------------------
+ * This function is used by fmrtDelete() library call. Given
+ * a specified table (whose index is provided by the first
+ * parameter) and a node index (second parameter), it looks
+ * for the leftmost child of that node, i.e. the leaf that
+ * can be reached by descending the tree only on the left
+ * subtree. The routine provides back the fmrtIndex of such
+ * node along with a LIFO structure that represents the
+ * path to it
+ * ---------------------------------------------------------
+ * It returns the fmrtIndex pointer of the leftmost child
+ ***********************************************************/
+static fmrtIndex leftMostChild (fmrtId tableIndex, fmrtIndex index, fmrtNodeTraversalStack **stackPtr)
+{
+    /* Local Variables */
+    fmrtIndex    current, leftmost;
+    void        *currentPtr;
+    fmrtNodeTraversalStack *stackElem = NULL;
+
+    /* Pre-initialize return parameters */
+    *stackPtr = NULL;
+
+    /* The FMRT tree is not empty. Set current to the root index, then start traversing the tree */
+    current = leftmost = index;
+    while (current != FMRTNULLPTR)
+    {
+        currentPtr = Tables[tableIndex].fmrtData + current*Tables[tableIndex].elemSize;
+
+        /* Allocate an element to keep track of node traversal into a LIFO structure */
+        stackElem = (fmrtNodeTraversalStack *) malloc(sizeof(fmrtNodeTraversalStack));
+        stackElem->next = *stackPtr;
+        *stackPtr = stackElem;
+        (*stackPtr)->index = current;
+        (*stackPtr)->go = LEFT;
+
+        leftmost = current;
+        current = *((fmrtIndex *) currentPtr);
+    }   /* while (current != FMRTNULLPTR) */
+
+    return (leftmost);
+}
+
+
+/***********************************************************
+ * expiryOf()
+ * ---------------------------------------------------------
+ * This function provides a pointer to the expiry information
+ * stored into the node given by the second parameter (see
+ * fmrtDefineExpiry())
+ ***********************************************************/
+static fmrtNodeExpiry *expiryOf (fmrtId tableIndex, fmrtIndex node)
+{
+    return ( (fmrtNodeExpiry *) (Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize + Tables[tableIndex].expDelta) );
+}
+
+
+/***********************************************************
+ * expiryHead()
+ * ---------------------------------------------------------
+ * This function provides a pointer to the head of the list
+ * the element with the given expiry information belongs to.
+ * Elements are hashed in the timer wheel slot given by their
+ * deadline (modulo FMRTWHEELSIZE), while elements already
+ * expired and waiting to be removed (deadline==FMRTEXPIRING)
+ * are kept in a separate list stored after the last slot
+ ***********************************************************/
+static fmrtIndex *expiryHead (fmrtId tableIndex, fmrtNodeExpiry *expiry)
+{
+    if (expiry->deadline==FMRTEXPIRING)
+        return ( &(Tables[tableIndex].wheel[FMRTWHEELSIZE]) );
+
+    return ( &(Tables[tableIndex].wheel[expiry->deadline % FMRTWHEELSIZE]) );
+}
+
+
+/***********************************************************
+ * linkExpiry()
+ * ---------------------------------------------------------
+ * This function inserts the node given by the second
+ * parameter in front of the list corresponding to its
+ * deadline. Nothing is done if expiry is not enabled or if
+ * the element never expires (deadline==0)
+ ***********************************************************/
+static void linkExpiry (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local Variables */
+    fmrtNodeExpiry  *expiry;
+    fmrtIndex       *head;
+
+    if (Tables[tableIndex].wheel==NULL)
+        return;
+
+    expiry = expiryOf (tableIndex, node);
+    if (expiry->deadline==0)
+        return;
+
+    head = expiryHead (tableIndex, expiry);
+    expiry->prev = FMRTNULLPTR;
+    expiry->next = *head;
+    if (*head!=FMRTNULLPTR)
+        expiryOf(tableIndex, *head)->prev = node;
+    *head = node;
+
+    return;
+}
+
+
+/***********************************************************
+ * unlinkExpiry()
+ * ---------------------------------------------------------
+ * This function removes the node given by the second
+ * parameter from the list it belongs to and marks it as
+ * never expiring (deadline==0). Nothing is done if expiry
+ * is not enabled or if the element is not linked
+ ***********************************************************/
+static void unlinkExpiry (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local Variables */
+    fmrtNodeExpiry  *expiry;
+
+    if (Tables[tableIndex].wheel==NULL)
+        return;
+
+    expiry = expiryOf (tableIndex, node);
+    if (expiry->deadline==0)
+        return;
+
+    if (expiry->prev!=FMRTNULLPTR)
+        expiryOf(tableIndex, expiry->prev)->next = expiry->next;
+    else
+        *expiryHead (tableIndex, expiry) = expiry->next;
+    if (expiry->next!=FMRTNULLPTR)
+        expiryOf(tableIndex, expiry->next)->prev = expiry->prev;
+    expiry->deadline = 0;
+
+    return;
+}
+
+
+/***********************************************************
+ * initElemExpiry()
+ * ---------------------------------------------------------
+ * This function sets the deadline of a newly created
+ * element (second parameter) according to the default TTL
+ * of the table and links it into the timer wheel
+ ***********************************************************/
+static void initElemExpiry (fmrtId tableIndex, fmrtIndex node)
+{
+    /* Local Variables */
+    fmrtNodeExpiry  *expiry;
+
+    if (Tables[tableIndex].wheel==NULL)
+        return;
+
+    expiry = expiryOf (tableIndex, node);
+    expiry->deadline = (Tables[tableIndex].defaultTtl>0) ? time(NULL)+Tables[tableIndex].defaultTtl : 0;
+    linkExpiry (tableIndex, node);
+
+    return;
+}
+
+
+/***********************************************************
+ * relocateElem()
+ * ---------------------------------------------------------
+ * This function is invoked every time the content of an
+ * element is moved from the slot fromIndex (third parameter)
+ * to the slot toIndex (second parameter), e.g. by copyNode().
+ * It updates the auxiliary structures that refer to the
+ * element through its slot index
+ ***********************************************************/
+static void relocateElem (fmrtId tableIndex, fmrtIndex toIndex, fmrtIndex fromIndex)
+{
+    /* Local Variables */
+    uint8_t         k;
+    fmrtNodeExpiry  *expiry;
+
+    /* Expiry wheel - neighbours in the list (or list head) shall point to the new slot */
+    if (Tables[tableIndex].wheel!=NULL)
+    {
+        expiry = expiryOf (tableIndex, toIndex);
+        if (expiry->deadline!=0)
+        {
+            if (expiry->prev!=FMRTNULLPTR)
+                expiryOf(tableIndex, expiry->prev)->next = toIndex;
+            else
+                *expiryHead (tableIndex, expiry) = toIndex;
+            if (expiry->next!=FMRTNULLPTR)
+                expiryOf(tableIndex, expiry->next)->prev = toIndex;
+        }
+    }   /* if (Tables[tableIndex].wheel!=NULL) */
+
+    /* Secondary indexes - nodes are stored in arrays parallel to the elements */
+    for (k=0; k<Tables[tableIndex].numIndexes; k++)
+        indexRelocate (tableIndex, k, toIndex, fromIndex);
+
+    return;
+}
+
+
+/***********************************************************
+ * copyNode()
+ * ---------------------------------------------------------
+ * This function is used by fmrtDelete() library call. Given
+ * a specified table (whose index is provided by the first
+ * parameter) it copies all the data from source node (third
+ * parameter) to the destination node (second parameter).
+ * Data means the key alomg with all relevant fields.
+ * ---------------------------------------------------------
+ * It does not return anything
+ ***********************************************************/
+static void copyNode (fmrtId tableIndex, fmrtIndex toIndex, fmrtIndex fromIndex)
+{
+    /* Local Variables */
+    void        *fromPtr,
+                *toPtr;
+    int         numBytes;
+
+    if ( (fromIndex==FMRTNULLPTR) || (toIndex==FMRTNULLPTR) )
+        return;
+
+    fromPtr = Tables[tableIndex].fmrtData + fromIndex*Tables[tableIndex].elemSize+2*sizeof(fmrtIndex);
+    toPtr = Tables[tableIndex].fmrtData + toIndex*Tables[tableIndex].elemSize+2*sizeof(fmrtIndex);
+    numBytes = Tables[tableIndex].elemSize - 2*sizeof(fmrtIndex);
+
+    memcpy (toPtr, fromPtr, numBytes);
+
+    /* With the split layout fields are stored in the payload array and shall be copied as well */
+    if (Tables[tableIndex].layout & FMRTLAYOUTSPLIT)
+        memcpy (Tables[tableIndex].fmrtPayload + toIndex*Tables[tableIndex].fieldsLen,
+                Tables[tableIndex].fmrtPayload + fromIndex*Tables[tableIndex].fieldsLen,
+                Tables[tableIndex].fieldsLen);
+
+    /* The element now lives in toIndex, update structures referring to its slot */
+    relocateElem (tableIndex, toIndex, fromIndex);
+
+    return;
+
+}
+
+
+/***********************************************************
+ * deleteElem()
+ * ---------------------------------------------------------
+ * This function removes an element from the fmrt tree of
+ * the table whose index is given by the first parameter.
+ * The second parameter is the LIFO structure built by
+ * searchElem(), whose top element is the node to be
+ * deleted. The function rebalances the tree, updates the
+ * number of stored elements and releases the LIFO structure.
+ * It is used by fmrtDelete() and by all internal routines
+ * that remove elements (e.g. expiry)
+ ***********************************************************/
+static void deleteElem (fmrtId tableIndex, fmrtNodeTraversalStack *traversal)
+{
+    /* Local Variables */
+    void        *currentPtr;
+    fmrtIndex    leftSubtree,
+                rightSubtree,
+                leftmost,
+                leftmostRightChild,
+                rebalIndex;
+    fmrtNodeTraversalStack  *toLeaf,
+                            *rebalPtr;
+
+    if (FMRTPROBEENABLED(delete))
+        FMRTPROBE3 (delete, Tables[tableIndex].tableId, traceElemHash(tableIndex,traversal->index), traversal->index);
+
+    /* Detach the element from auxiliary structures before it is overwritten or released */
+    unlinkExpiry (tableIndex, traversal->index);
+    unlinkIndexes (tableIndex, traversal->index, (fmrtParamMask)-1);
+    clearElemStrings (tableIndex, traversal->index, 1);
+
+    /* With the B+-tree and hash engines the element is just unlinked from the index and released */
+    if (Tables[tableIndex].engine!=FMRTENGINEAVL)
+    {
+        if (Tables[tableIndex].engine==FMRTENGINEBTREE)
+            btRemove (tableIndex, traversal->index);
+        else
+            hashRemove (tableIndex, traversal->index);
+        freeEmptyElem (tableIndex, traversal->index);
+        Tables[tableIndex].currentNumElem -= 1;
+        clearNodeTraversalStack (traversal);
+        return;
+    }
+
+    /* The top element of traversal contains the index of the node to delete */
+    /* Set currentPtr to point to the first byte of the structure           */
+    currentPtr = Tables[tableIndex].fmrtData + (traversal->index)*Tables[tableIndex].elemSize;
+
+    /* Extract left and right subtree pointers associated to the node to be deleted and initialize a pointer needed in case of leftMostChild() search */
+    leftSubtree = *((fmrtIndex *) (currentPtr));
+    rightSubtree = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+    toLeaf = NULL;
+
+    /* Now there are 3 possible cases:                                              */
+    /* 1 - the node is a leaf           -> delete it                                */
+    /* 2 - the node has only one child  -> substitute the content of the current    */
+    /*                                     node with the child and delete the child */
+    /* 3 - the node has both subtrees   -> find the left most child on the right    */
+    /*                                     subtree, substitute the content of the   */
+    /*                                     current node with it and delete it       */
+
+    if ( (leftSubtree==FMRTNULLPTR) && (rightSubtree==FMRTNULLPTR) )
+    {   /* case 1 - the node is a leaf */
+        rebalPtr = traversal->next;
+        if (rebalPtr!=NULL)
+        {   /* the leaf we are deleting is not the root */
+            /* Set left or right pointer of the parent (depending on content of traversal LIFO) to FMRTNULLPTR */
+            currentPtr = Tables[tableIndex].fmrtData + (rebalPtr->index)*Tables[tableIndex].elemSize;
+            if (rebalPtr->go == LEFT)
+                *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
+            else
+                *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+        }   /* if (rebalPtr!=NULL) */
+        else
+        {   /* the node we are deleting is a leaf, but it is also the root */
+            /*  Set fmrt Root pointer to FMRTNULLPTR */
+            Tables[tableIndex].fmrtRoot = FMRTNULLPTR;
+        }
+        /* return deleted element to the empty list and remove element from traversal LIFO */
+        freeEmptyElem (tableIndex,traversal->index);
+        free (traversal);
+        traversal = rebalPtr;
+    }   /* if ( (leftSubtree==FMRTNULLPTR) && (rightSubtree==FMRTNULLPTR) ) */
+
+    else if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) )
+    {   /* case 3 - the node has both subtrees */
+        /* find the leftmost child on the right subtree and substitute its content with the node to delete */
+        leftmost = leftMostChild(tableIndex,rightSubtree,&toLeaf);
+        copyNode (tableIndex,traversal->index,leftmost);
+        currentPtr = Tables[tableIndex].fmrtData + leftmost*Tables[tableIndex].elemSize;
+        /* The leftmost child on the right subtree is either a leaf or has just one child on the right subtree - there are no other possibilities */
+        leftmostRightChild = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+        if (leftmostRightChild==FMRTNULLPTR)
+        {   /* The leftmost child on the right subtree is a leaf */
+            freeEmptyElem (tableIndex,leftmost);
+            rebalPtr = toLeaf->next;
+            free (toLeaf);
+            toLeaf=rebalPtr;
+            if (toLeaf!=NULL)
+            {
+                currentPtr = Tables[tableIndex].fmrtData + (toLeaf->index)*Tables[tableIndex].elemSize;
+                *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
+            }
+            else
+            {   /* the leftmost child is the right child itself -> clear the right pointer of the current node */
+                currentPtr = Tables[tableIndex].fmrtData + (traversal->index)*Tables[tableIndex].elemSize;
+                *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+            }
+        }   /* if (leftmostRightChild==FMRTNULLPTR) */
+        else
+        {
+            copyNode (tableIndex,leftmost,leftmostRightChild);
+            freeEmptyElem (tableIndex,leftmostRightChild);
+            if (toLeaf!=NULL)
+            {
+                currentPtr = Tables[tableIndex].fmrtData + (toLeaf->index)*Tables[tableIndex].elemSize;
+                *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+            }
+        }   /* else if (leftmostRightChild==FMRTNULLPTR) */
+        /* join traversal and toLeaf LIFO traversal structures to allow rebalance on the whole path */
+        traversal->go = RIGHT;
+        rebalPtr = toLeaf;
+        while (rebalPtr != NULL)
+        {
+            if (rebalPtr->next==NULL)
+            {
+                rebalPtr->next=traversal;
+                traversal = toLeaf;
+                rebalPtr = NULL;
+            }
+            else
+                rebalPtr=rebalPtr->next;
+        }   /* while (toLeaf != NULL) */
+
+    }   /* if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) ) */
+
+    else
+    {   /* case 2 - the node has only one child -> Since the tree is balanced, this child cannot have further children -> this child is a leaf */
+        if (leftSubtree!=FMRTNULLPTR)
+        {   /* the child is on the left subtree */
+            /* copy the content of the child into the node to be deleted */
+            /* update the pointer and return the child to the list of empty nodes */
+            copyNode (tableIndex,traversal->index,leftSubtree);
+            freeEmptyElem (tableIndex,leftSubtree);
+            currentPtr = Tables[tableIndex].fmrtData + (traversal->index)*Tables[tableIndex].elemSize;
+            *((fmrtIndex *) (currentPtr)) = FMRTNULLPTR;
+        }   /* if (leftSubtree!=FMRTNULLPTR) */
+        else
+        {   /* the child is on the right subtree */
+            /* copy the content of the child into the node to be deleted */
+            /* update the pointer and return the child to the list of empty nodes */
+            copyNode (tableIndex,traversal->index,rightSubtree);
+            freeEmptyElem (tableIndex,rightSubtree);
+            currentPtr = Tables[tableIndex].fmrtData + (traversal->index)*Tables[tableIndex].elemSize;
+            *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+        }   /* else if (leftSubtree!=FMRTNULLPTR) */
+    }   /* else if ( (leftSubtree!=FMRTNULLPTR) && (rightSubtree!=FMRTNULLPTR) ) */
+
+    /* Element has been deleted, now rebalance the FMRT tree */
+    /* starting from the bottom and going up to the root    */
+    rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. from the leaf */
+    while (rebalPtr!=NULL)
+    {   /* rebalance the subtree whose root is the current node */
+        rebalIndex = rebalanceSubTree (tableIndex,rebalPtr->index,FMRTROTDELETE);  /* the root might change due to rotations */
+        /* go up to the parent */
+        rebalPtr = rebalPtr->next;
+        if (rebalPtr!=NULL)
+        {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
+            if (rebalPtr->go == LEFT)
+                currentPtr = Tables[tableIndex].fmrtData + (rebalPtr->index)*Tables[tableIndex].elemSize;
+            else
+                currentPtr = Tables[tableIndex].fmrtData + (rebalPtr->index)*Tables[tableIndex].elemSize+sizeof(fmrtIndex);
+            /* The proper pointer is updated with the output of the rebalance structure */
+            *((fmrtIndex*)currentPtr) = rebalIndex;
+        }   /* if (rebalPtr!=NULL) */
+        else
+            /* There is no parent node - Rotation implies a change of the fmrt root pointer */
+            Tables[tableIndex].fmrtRoot = rebalIndex;
+    }   /* while (rebalPtr!=NULL) */
+
+    #ifdef FMRTDEBUG
+    printf ("\n\nDeleted node\n");
+    printf ("Path from deleted node up to the root:\n");
+    __fmrtPrintStack(tableIndex,traversal);
+    #endif
+
+    /* decrement number of stored elements and clear node traversal LIFO structure */
+    Tables[tableIndex].currentNumElem -= 1;
+    clearNodeTraversalStack (traversal);
+
+    return;
+}
+
+
+/***********************************************************
+ * expireElems()
+ * ---------------------------------------------------------
+ * This is the expiry sweeper. It visits the timer wheel
+ * slots corresponding to the seconds elapsed since the last
+ * sweep (at most FMRTWHEELSIZE slots), moves the elements
+ * whose deadline has been reached into the list of expiring
+ * elements and then deletes them from the table. Elements
+ * hashed in a visited slot but due in a later round of the
+ * wheel are left untouched. Therefore the cost depends on
+ * the number of expired elements and not on the table size.
+ * It is invoked under the table lock by every library call
+ * accessing the elements of the table (lookups, writes,
+ * scans, exports and counts), so that elements whose
+ * deadline has been reached are never visible, and by
+ * fmrtExpire()
+ * ---------------------------------------------------------
+ * It returns the number of elements removed
+ ***********************************************************/
+static fmrtIndex expireElems (fmrtId tableIndex, time_t now)
+{
+    /* Local Variables */
+    time_t          t,
+                    slots;
+    fmrtIndex       node,
+                    next,
+                    expired = 0;
+    fmrtNodeExpiry  *expiry;
+    fmrtKeyValue    key;
+    fmrtNodeTraversalStack *traversal;
+
+    if ( (Tables[tableIndex].wheel==NULL) || (Tables[tableIndex].fmrtData==NULL) )
+        return (0);
+
+    /* Move elements due in the elapsed slots into the list of expiring elements */
+    if (now>Tables[tableIndex].lastSweep)
+    {
+        slots = now - Tables[tableIndex].lastSweep;
+        if (slots>FMRTWHEELSIZE)
+            slots = FMRTWHEELSIZE;
+        for (t=Tables[tableIndex].lastSweep+1; slots>0; t++, slots--)
+        {
+            for (node=Tables[tableIndex].wheel[t % FMRTWHEELSIZE]; node!=FMRTNULLPTR; node=next)
+            {
+                expiry = expiryOf (tableIndex, node);
+                next = expiry->next;
+                if (expiry->deadline<=now)
+                {
+                    unlinkExpiry (tableIndex, node);
+                    expiry->deadline = FMRTEXPIRING;
+                    linkExpiry (tableIndex, node);
+                }
+            }   /* for (node=...) */
+        }   /* for (t=...) */
+        Tables[tableIndex].lastSweep = now;
+    }   /* if (now>Tables[tableIndex].lastSweep) */
+
+    /* Delete expiring elements one by one (deleteElem() may relocate them, so always restart from the head) */
+    while ( (node=Tables[tableIndex].wheel[FMRTWHEELSIZE]) != FMRTNULLPTR)
+    {
+        loadKeyValue (tableIndex, Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize, &key);
+        if (searchElem(tableIndex, key.keyInt, key.keySigned, key.keyDouble, key.keyChar, key.keyString, key.keyTimestamp, &traversal) == FMRTOK)
+        {
+            deleteElem (tableIndex, traversal);
+            expired += 1;
+        }
+        else
+        {   /* Should never happen - detach the element anyway to avoid looping forever */
+            clearNodeTraversalStack (traversal);
+            unlinkExpiry (tableIndex, node);
+        }
+    }   /* while (...) */
+
+    return (expired);
+}
+
+
+/***********************************************************
+ * readNearest()
+ * ---------------------------------------------------------
+ * Common implementation of fmrtFloor(), fmrtCeil(),
+ * fmrtPrev(), fmrtNext(), fmrtMin() and fmrtMax(). The
+ * variable list of arguments (third parameter) contains the
+ * key to look for (only for modes other than NEARESTMIN and
+ * NEARESTMAX), then a pointer filled with the key found and
+ * the list of pointers filled with the fields, in the same
+ * order used by fmrtRead()
+ ***********************************************************/
+static fmrtResult readNearest (fmrtId tableId, uint8_t mode, va_list *args)
+{
+    /* Local Variables */
+    fmrtId          i;
+    fmrtResult      res;
+    fmrtIndex       found;
+    fmrtKeyValue    key;
+    void            *currentPtr;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+        return (FMRTNOTSUPPORTED);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLFLOOR+mode);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Read the key (if needed) and look for the nearest element */
+    if ( (mode!=NEARESTMIN) && (mode!=NEARESTMAX) )
+        readKeyArg (i, args, &key);
+    if ( (found=searchNearest(i, &key, mode)) == FMRTNULLPTR)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTFOUND);
+    }
+
+    /* Provide back key and fields of the element found */
+    currentPtr = Tables[i].fmrtData + found*Tables[i].elemSize;
+    extractKey (i, currentPtr, args);
+    extractFields (i, currentPtr, args);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * formatElem()
+ * ---------------------------------------------------------
+ * This function formats the element pointed by the second
+ * parameter as a CSV line (key followed by all fields,
+ * separated by sep, without trailing newline), using the
+ * same representation adopted by fmrtExportTableCsv(). The
+ * result is written into buf, whose size is bufLen (the
+ * line is truncated if longer)
+ ***********************************************************/
+static void formatElem (fmrtId tableIndex, void *currentPtr, char sep, char *buf, size_t bufLen)
+{
+    /* Local Variables */
+    uint8_t     j;
+    size_t      len;
+    void        *fieldsPtr;
+    char        timestamp[MAXFMRTSTRINGLEN+1];
+
+    /* Print the key... */
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+        {
+            len = snprintf (buf, bufLen, "%u",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            len = snprintf (buf, bufLen, "%d",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            len = snprintf (buf, bufLen, "%lf",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            len = snprintf (buf, bufLen, "%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {
+            len = snprintf (buf, bufLen, "%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> print raw timestamp */
+                len = snprintf (buf, bufLen, "%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            else
+            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                len = snprintf (buf, bufLen, "%s",timestamp);
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* The components of the key take one column each */
+            len = formatCompositeKey (tableIndex, currentPtr+Tables[tableIndex].key.delta, sep, buf, bufLen);
+            break;
+        }   /* case FMRTCOMPOSITE */
+        default:
+            len = 0;
+    }   /* switch (Tables[tableIndex].key.type) */
+
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; (j<Tables[tableIndex].numFields)&&(len<bufLen); j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c%u",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                len += snprintf (buf+len, bufLen-len, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    len += snprintf (buf+len, bufLen-len, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    len += snprintf (buf+len, bufLen-len, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[tableIndex].fields[j].type) */
+    }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+
+    return;
+}
+
+
+/***********************************************************
+ * evictElem()
+ * ---------------------------------------------------------
+ * This function is used by write operations on full tables
+ * with eviction enabled (see fmrtDefineEviction()). It
+ * selects a victim through the CLOCK algorithm: the clock
+ * hand goes around the slots of the table, giving a second
+ * chance to elements whose reference flag is set (the flag
+ * is cleared) and stopping at the first element whose flag
+ * is not set. Since the table is full, all slots contain
+ * valid elements. The victim is passed to the eviction
+ * callback (if any) and then deleted from the table
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   One element has been evicted, a free slot is available
+ * - FMRTOUTOFMEMORY
+ *   Eviction is not enabled or the table is not full
+ ***********************************************************/
+static fmrtResult evictElem (fmrtId tableIndex)
+{
+    /* Local Variables */
+    fmrtIndex       victim;
+    uint8_t         *ref;
+    void            *currentPtr;
+    fmrtKeyValue    key;
+    char            row[MAXFMRTROWLEN];
+    fmrtNodeTraversalStack *traversal;
+
+    if ( (!Tables[tableIndex].evictMode) || (Tables[tableIndex].fmrtData==NULL) || (Tables[tableIndex].currentNumElem<Tables[tableIndex].tableMaxElem) )
+        return (FMRTOUTOFMEMORY);
+
+    /* Advance the clock hand until an element not referenced is found (at most one full round + 1) */
+    while (1)
+    {
+        victim = Tables[tableIndex].clockHand;
+        Tables[tableIndex].clockHand = (victim+1) % Tables[tableIndex].tableMaxElem;
+        ref = (uint8_t *) (Tables[tableIndex].fmrtData + victim*Tables[tableIndex].elemSize + Tables[tableIndex].refDelta);
+        if (*ref==0)
+            break;
+        *ref = 0;
+    }   /* while (1) */
+
+    /* Give the victim to the eviction callback, then delete it */
+    currentPtr = Tables[tableIndex].fmrtData + victim*Tables[tableIndex].elemSize;
+    if (Tables[tableIndex].evictSink!=NULL)
+    {
+        formatElem (tableIndex, currentPtr, Tables[tableIndex].evictSep, row, MAXFMRTROWLEN);
+        Tables[tableIndex].evictSink (Tables[tableIndex].tableId, row, Tables[tableIndex].evictData);
+    }
+    loadKeyValue (tableIndex, currentPtr, &key);
+    if (searchElem(tableIndex, key.keyInt, key.keySigned, key.keyDouble, key.keyChar, key.keyString, key.keyTimestamp, &traversal) != FMRTOK)
+    {   /* Should never happen */
+        clearNodeTraversalStack (traversal);
+        return (FMRTOUTOFMEMORY);
+    }
+    deleteElem (tableIndex, traversal);
+    Tables[tableIndex].evictions += 1;
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * referenceElem()
+ * ---------------------------------------------------------
+ * This function sets the CLOCK reference flag of the node
+ * given by the second parameter, if eviction is enabled
+ ***********************************************************/
+static void referenceElem (fmrtId tableIndex, fmrtIndex node)
+{
+    if (Tables[tableIndex].evictMode)
+        *((uint8_t *) (Tables[tableIndex].fmrtData + node*Tables[tableIndex].elemSize + Tables[tableIndex].refDelta)) = 1;
+
+    return;
+}
+
+
+/***********************************************************
+ * initFifo()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt internal function
+ * exportTableOptimized(). It takes the table index (first
+ * parameter, which is the index of the Table[] array, not
+ * the TableId) and the requested FIFO Size. It allocates
+ * a FIFO associated to the given table, to be used when
+ * exporting it in FMRTOPTIMIZED
+ ***********************************************************/
+static fmrtResult initFifo (fmrtId index, fmrtIndex fifoSize)
+{
+    /* Local Variables */
+    fmrtIndex * fifoPtr;
+
+    if ( (fifoPtr=calloc(fifoSize,sizeof(fmrtIndex))) == NULL)
+    {
+        Tables[index].fifo = NULL;
+        Tables[index].fifoSize = Tables[index].fifoIn = Tables[index].fifoOut = 0;
+        return (FMRTOUTOFMEMORY);
+    }
+
+    Tables[index].fifo = fifoPtr;
+    Tables[index].fifoSize = fifoSize;
+    Tables[index].fifoIn = Tables[index].fifoOut = 0;
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * releaseFifo()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt internal function
+ * exportTableOptimized(). It takes the table index (first
+ * parameter, which is the index of the Table[] array, not
+ * the TableId) and releases memory allocated for the
+ * FIFO
+ ***********************************************************/
+static void releaseFifo (fmrtId index)
+{
+    if (Tables[index].fifo)
+        free (Tables[index].fifo);
+
+    Tables[index].fifo = NULL;
+    Tables[index].fifoSize = Tables[index].fifoIn = Tables[index].fifoOut = 0;
+
+    return;
+}
+
+
+/***********************************************************
+ * getFifoSize()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt internal function
+ * exportTableOptimized(). It takes the table index (first
+ * parameter, which is the index of the Table[] array, not
+ * the TableId) and provides the current queue size of the
+ * FIFO used to export data according to level order traversal
+ * ---------------------------------------------------------
+ * NOTE WELL: the implementation of this FIFO is simplified
+ * for efficiency reasons. Specifically:
+ *    - In and Out pointers cannot overlap, otherwise the
+ *      FIFO is considered empty (i.e. given N the FIFO
+ *      dimension, it can host up to (N-1) elements)
+ *    - There is no control upon insertion or extraction
+ *      about the number of elements already queued, and
+ *      insertFifo() and extractFifo() routines do not
+ *      provide errors
+ ***********************************************************/
+static fmrtIndex getFifoSize (fmrtId index)
+{
+    /* Local Variables */
+    fmrtIndex currSize;
+
+    if ( (currSize=Tables[index].fifoIn-Tables[index].fifoOut) < 0)
+        currSize = currSize+Tables[index].fifoSize;
+
+    return (currSize);
+
+}
+
+
+/***********************************************************
+ * insertFifo()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt internal function
+ * exportTableOptimized(). It takes the table index (first
+ * parameter, which is the index of the Table[] array, not
+ * the TableId) and puts the element given as second parameter
+ * in the FIFO structure used to explore the tree according
+ * to level order traversal (elements in the FIFO represent
+ * the indexes of AVL Tree nodes that belong to the table)
+ * ---------------------------------------------------------
+ * NOTE WELL: the implementation of this FIFO is simplified
+ * for efficiency reasons. Specifically:
+ *    - In and Out pointers cannot overlap, otherwise the
+ *      FIFO is considered empty (i.e. given N the FIFO
+ *      dimension, it can host up to (N-1) elements)
+ *    - There is no control upon insertion or extraction
+ *      about the number of elements already queued, and
+ *      insertFifo() and extractFifo() routines do not
+ *      provide errors
+ ***********************************************************/
+static void insertFifo (fmrtId index, fmrtIndex node)
+{
+    /* Local Variables */
+    fmrtIndex i;
+
+    i = Tables[index].fifoIn;
+
+    Tables[index].fifo[i] = node;
+    Tables[index].fifoIn = (i+1) % Tables[index].fifoSize;
+
+    return;
+}
+
+
+/***********************************************************
+ * extractFifo()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt internal function
+ * exportTableOptimized(). It takes the table index (first
+ * parameter, which is the index of the Table[] array, not
+ * the TableId) and provides the next element extracted
+ * from the FIFO structure, which represents the next node
+ * to explore according to level order traversal (elements
+ * in the FIFO represent the indexes of AVL Tree nodes that
+ * belong to the table)
+ * ---------------------------------------------------------
+ * NOTE WELL: the implementation of this FIFO is simplified
+ * for efficiency reasons. Specifically:
+ *    - In and Out pointers cannot overlap, otherwise the
+ *      FIFO is considered empty (i.e. given N the FIFO
+ *      dimension, it can host up to (N-1) elements)
+ *    - There is no control upon insertion or extraction
+ *      about the number of elements already queued, and
+ *      insertFifo() and extractFifo() routines do not
+ *      provide errors
+ ***********************************************************/
+static fmrtIndex extractFifo (fmrtId index)
+{
+    /* Local Variables */
+    fmrtIndex i, ret;
+
+    i = Tables[index].fifoOut;
+    ret = Tables[index].fifo[i];
+    Tables[index].fifoOut = (i+1) % Tables[index].fifoSize;
+
+    return(ret);
+
+}
+
+
+/***********************************************************
+ * inOrderRecurse()
+ * ---------------------------------------------------------
+ * This function appends to the array given as third
+ * parameter the indexes of the nodes of the subtree rooted
+ * in nodeIndex, in key order (ascending or descending
+ * depending on ordering). count is the number of entries
+ * already in the array and is updated accordingly
+ ***********************************************************/
+static void inOrderRecurse (fmrtId tableIndex, fmrtIndex nodeIndex, fmrtIndex *order, fmrtIndex *count, uint8_t ordering)
+{
+    /* Local Variables */
+    void        *currentPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+    inOrderRecurse (tableIndex, *((fmrtIndex *) ((ordering==FMRTASCENDING) ? currentPtr : currentPtr+sizeof(fmrtIndex))), order, count, ordering);
+    order[(*count)++] = nodeIndex;
+    inOrderRecurse (tableIndex, *((fmrtIndex *) ((ordering==FMRTASCENDING) ? currentPtr+sizeof(fmrtIndex) : currentPtr)), order, count, ordering);
+}
+
+
+/***********************************************************
+ * releaseTail()
+ * ---------------------------------------------------------
+ * This function gives back to the operating system the
+ * memory pages of an array of elements lying entirely
+ * after the element given by the third parameter (elements
+ * from used onwards are not in use). The pages stay mapped
+ * and read as zero, so the elements can be used again
+ * later, while the memory is allocated again only when
+ * they are actually written
+ ***********************************************************/
+static void releaseTail (fmrtId tableIndex, void *array, uint16_t stride, fmrtIndex used)
+{
+    /* Local Variables */
+    uintptr_t   pageSize = (uintptr_t) sysconf (_SC_PAGESIZE),
+                begin = FMRTALIGN ((uintptr_t) array + (uintptr_t) used*stride, pageSize),
+                end = ((uintptr_t) array + (uintptr_t) Tables[tableIndex].tableMaxElem*stride) & ~(pageSize-1);
+
+    if ( (array!=NULL) && (begin<end) )
+        madvise ((void *) begin, end-begin, MADV_DONTNEED);
+}
+
+
+/***********************************************************
+ * relayoutTree()
+ * ---------------------------------------------------------
+ * This function rewrites the array of elements of the
+ * table whose index is given as a parameter, moving all
+ * the nodes of the fmrt tree to the beginning of the array
+ * in the order given by the second parameter:
+ * - FMRTASCENDING, FMRTDESCENDING
+ *   key order, so that range scans and exports walk the
+ *   array sequentially
+ * - FMRTOPTIMIZED
+ *   breadth first (level) order: the root goes into slot 0,
+ *   its children into slots 1 and 2 and so on (Eytzinger
+ *   layout). Top levels of the tree, which are visited by
+ *   every search, are then packed into few cache lines and
+ *   pages
+ * while the order of the nodes left by inserts and deletes
+ * is random. Links, expiry lists and the clock hand are
+ * remapped accordingly, while secondary indexes are rebuilt
+ * on the new slots. The remaining elements are marked
+ * as unused and their memory pages are released. During
+ * the operation a second copy of the array is allocated
+ * ---------------------------------------------------------
+ * Possible return values:
+ * - FMRTOK
+ *   The table has been rewritten
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory (the table is left untouched)
+ ***********************************************************/
+static fmrtResult relayoutTree (fmrtId tableIndex, uint8_t ordering)
+{
+    /* Local Variables */
+    fmrtIndex       *order,
+                    *newIndex,
+                    head, tail, node, k;
+    void            *newData,
+                    *newPayload = NULL,
+                    *currentPtr;
+    fmrtNodeExpiry  *expiry;
+    uint16_t        elemSize = Tables[tableIndex].elemSize;
+    uint8_t         idx;
+
+    if (Tables[tableIndex].fmrtData==NULL)
+        return (FMRTOK);
+
+    /* Allocate the new array(s) along with the list of nodes in the new order and the map from old to new indexes */
+    order = (fmrtIndex *) malloc (Tables[tableIndex].tableMaxElem*sizeof(fmrtIndex));
+    newIndex = (fmrtIndex *) malloc (Tables[tableIndex].tableMaxElem*sizeof(fmrtIndex));
+    newData = calloc (Tables[tableIndex].tableMaxElem, elemSize);
+    if (Tables[tableIndex].layout & FMRTLAYOUTSPLIT)
+        newPayload = calloc (Tables[tableIndex].tableMaxElem, Tables[tableIndex].fieldsLen);
+    if ( (order==NULL) || (newIndex==NULL) || (newData==NULL) || ( (Tables[tableIndex].layout & FMRTLAYOUTSPLIT) && (newPayload==NULL) ) )
+    {
+        free (order);
+        free (newIndex);
+        free (newData);
+        free (newPayload);
+        return (FMRTOUTOFMEMORY);
+    }
+
+    /* Build the list of nodes in the new order */
+    tail = 0;
+    if (ordering==FMRTOPTIMIZED)
+    {   /* Level order traversal of the tree (order[] is used as a queue) */
+        head = 0;
+        if (Tables[tableIndex].fmrtRoot!=FMRTNULLPTR)
+            order[tail++] = Tables[tableIndex].fmrtRoot;
+        while (head<tail)
+        {
+            currentPtr = Tables[tableIndex].fmrtData + order[head++]*elemSize;
+            if (*((fmrtIndex *) currentPtr)!=FMRTNULLPTR)
+                order[tail++] = *((fmrtIndex *) currentPtr);
+            if (*((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)))!=FMRTNULLPTR)
+                order[tail++] = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+        }   /* while (head<tail) */
+    }
+    else
+        inOrderRecurse (tableIndex, Tables[tableIndex].fmrtRoot, order, &tail, ordering);
+    for (k=0; k<tail; k++)
+        newIndex[order[k]] = k;
+
+    /* Copy each node into its new slot, remapping the links */
+    for (k=0; k<tail; k++)
+    {
+        currentPtr = newData + k*elemSize;
+        memcpy (currentPtr, Tables[tableIndex].fmrtData + order[k]*elemSize, elemSize);
+        if (*((fmrtIndex *) currentPtr)!=FMRTNULLPTR)
+            *((fmrtIndex *) currentPtr) = newIndex[*((fmrtIndex *) currentPtr)];
+        if (*((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)))!=FMRTNULLPTR)
+            *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex))) = newIndex[*((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)))];
+        if (Tables[tableIndex].expDelta)
+        {
+            expiry = (fmrtNodeExpiry *) (currentPtr+Tables[tableIndex].expDelta);
+            if (expiry->prev!=FMRTNULLPTR)
+                expiry->prev = newIndex[expiry->prev];
+            if (expiry->next!=FMRTNULLPTR)
+                expiry->next = newIndex[expiry->next];
+        }
+        if (newPayload!=NULL)
+            memcpy (newPayload + k*Tables[tableIndex].fieldsLen, Tables[tableIndex].fmrtPayload + order[k]*Tables[tableIndex].fieldsLen, Tables[tableIndex].fieldsLen);
+    }   /* for (k=0; k<tail; k++) */
+
+    /* Lists of the expiry timer wheel */
+    for (k=0; (Tables[tableIndex].wheel!=NULL)&&(k<=FMRTWHEELSIZE); k++)
+        if (Tables[tableIndex].wheel[k]!=FMRTNULLPTR)
+            Tables[tableIndex].wheel[k] = newIndex[Tables[tableIndex].wheel[k]];
+
+    /* Elements after the last node are unused */
+    node = Tables[tableIndex].fmrtRoot;
+    Tables[tableIndex].fmrtRoot = (node!=FMRTNULLPTR) ? newIndex[node] : FMRTNULLPTR;
+    Tables[tableIndex].fmrtFree = FMRTNULLPTR;
+    Tables[tableIndex].fmrtUnused = tail;
+    Tables[tableIndex].clockHand = 0;
+
+    /* Replace the old arrays, releasing the pages of the unused elements */
+    free (Tables[tableIndex].fmrtData);
+    Tables[tableIndex].fmrtData = newData;
+    releaseTail (tableIndex, newData, elemSize, tail);
+    if (newPayload!=NULL)
+    {
+        free (Tables[tableIndex].fmrtPayload);
+        Tables[tableIndex].fmrtPayload = newPayload;
+        releaseTail (tableIndex, newPayload, Tables[tableIndex].fieldsLen, tail);
+    }
+
+    /* Secondary indexes are rebuilt, since their nodes follow the elements */
+    for (idx=0; idx<Tables[tableIndex].numIndexes; idx++)
+    {
+        Tables[tableIndex].indexes[idx].root = FMRTNULLPTR;
+        for (k=0; k<tail; k++)
+            indexInsert (tableIndex, idx, k);
+        releaseTail (tableIndex, Tables[tableIndex].indexes[idx].nodes, sizeof(fmrtIndexNode), tail);
+    }
+    free (order);
+    free (newIndex);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * btExport()
+ * ---------------------------------------------------------
+ * This is the counterpart of exportTableRecurse() for
+ * tables using the B+-tree engine: elements are exported
+ * by walking the list of leaves, in ascending order or,
+ * if ordering is FMRTDESCENDING, in descending order.
+ * If keyMin (normalized value and, for FMRTSTRING keys,
+ * string) is not NULL, only elements whose key is between
+ * keyMin and keyMax are exported: the walk starts from the
+ * leaf containing the first key in the range and stops at
+ * the first key beyond it
+ ***********************************************************/
+static void btExport (fmrtId tableIndex, FILE *fPtr, char sep, uint8_t ordering, uint64_t *keyMin, char *stringMin, uint64_t *keyMax, char *stringMax)
+{
+    /* Local Variables */
+    fmrtIndex   leaf;
+    uint16_t    pos;
+    int32_t     j;
+    fmrtBtNode  *node;
+    char        row[MAXFMRTROWLEN];
+
+    /* Find the first leaf and position to be exported */
+    if (ordering==FMRTDESCENDING)
+    {
+        leaf = Tables[tableIndex].btLast;
+        pos = (leaf!=FMRTNULLPTR) ? btNode(tableIndex,leaf)->count : 0;
+        if ( (keyMax!=NULL) && (btLocate(tableIndex, *keyMax, stringMax, &leaf, &pos)) )
+            pos += 1;   /* keyMax itself is included */
+    }
+    else
+    {
+        leaf = Tables[tableIndex].btFirst;
+        pos = 0;
+        if (keyMin!=NULL)
+            btLocate (tableIndex, *keyMin, stringMin, &leaf, &pos);
+    }
+
+    while (leaf!=FMRTNULLPTR)
+    {
+        node = btNode (tableIndex, leaf);
+        for (j = (ordering==FMRTDESCENDING) ? pos-1 : pos; (j>=0) && (j<node->count); j += (ordering==FMRTDESCENDING) ? -1 : 1)
+        {   /* Stop at the first key out of the range */
+            if ( (keyMin!=NULL) && (ordering==FMRTDESCENDING) && (btCompare(tableIndex, *keyMin, stringMin, node, j) > 0) )
+                return;
+            if ( (keyMax!=NULL) && (ordering!=FMRTDESCENDING) && (btCompare(tableIndex, *keyMax, stringMax, node, j) < 0) )
+                return;
+            formatElem (tableIndex, Tables[tableIndex].fmrtData + btElems(tableIndex,node)[j]*Tables[tableIndex].elemSize, sep, row, MAXFMRTROWLEN);
+            fprintf (fPtr, "%s\n", row);
+        }   /* for (j = ...) */
+
+        /* Go on with the next leaf */
+        if (ordering==FMRTDESCENDING)
+        {
+            leaf = node->prev;
+            pos = (leaf!=FMRTNULLPTR) ? btNode(tableIndex,leaf)->count : 0;
+        }
+        else
+        {
+            leaf = node->next;
+            pos = 0;
+        }
+    }   /* while (leaf!=FMRTNULLPTR) */
+
+    return;
+}
+
+
+/***********************************************************
+ * hashSortElems()
+ * ---------------------------------------------------------
+ * This function sorts by key the array of elements given as
+ * second parameter, whose size is num, through a bottom-up
+ * merge sort using the array given as third parameter,
+ * with the same size, as work area
+ * ---------------------------------------------------------
+ * It returns the array holding the sorted elements (either
+ * the first or the second one)
+ ***********************************************************/
+static fmrtIndex *hashSortElems (fmrtId tableIndex, fmrtIndex *elems, fmrtIndex *work, fmrtIndex num)
+{
+    /* Local Variables */
+    fmrtIndex   width,
+                lo,
+                mid,
+                hi,
+                a,
+                b,
+                k,
+                *swap;
+    void        *aPtr;
+
+    for (width=1; width<num; width*=2)
+    {   /* Merge pairs of adjacent runs of width elements into the work area */
+        for (lo=0; lo<num; lo+=2*width)
+        {
+            mid = (lo+width<num) ? lo+width : num;
+            hi = (lo+2*width<num) ? lo+2*width : num;
+            for (a=lo, b=mid, k=lo; k<hi; k++)
+            {
+                aPtr = Tables[tableIndex].fmrtData + elems[a]*Tables[tableIndex].elemSize;
+                if ( (a<mid) && ((b>=hi) || (hashCompare(tableIndex, elemKey(tableIndex,aPtr), (char *)(aPtr+Tables[tableIndex].key.delta), elems[b])<0)) )
+                    work[k] = elems[a++];
+                else
+                    work[k] = elems[b++];
+            }   /* for (a=lo, ...) */
+        }   /* for (lo=0; ...) */
+        swap = elems;
+        elems = work;
+        work = swap;
+    }   /* for (width=1; ...) */
+
+    return (elems);
+}
+
+
+/***********************************************************
+ * hashExport()
+ * ---------------------------------------------------------
+ * This is the counterpart of exportTableRecurse() for
+ * tables using the hash engine. With FMRTOPTIMIZED ordering
+ * elements are exported in the order of the slots of the
+ * hash index, otherwise they are collected and sorted by
+ * key first. If keyMin (normalized value and, for
+ * FMRTSTRING keys, string) is not NULL, only elements whose
+ * key is between keyMin and keyMax are exported, in
+ * ascending order unless ordering is FMRTDESCENDING
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Export was successful
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to sort the elements
+ ***********************************************************/
+static fmrtResult hashExport (fmrtId tableIndex, FILE *fPtr, char sep, uint8_t ordering, uint64_t *keyMin, char *stringMin, uint64_t *keyMax, char *stringMax)
+{
+    /* Local Variables */
+    fmrtIndex   pos,
+                num = 0,
+                k,
+                *elems,
+                *sorted;
+    fmrtHashSlot *slots = Tables[tableIndex].hashSlots;
+    char        row[MAXFMRTROWLEN];
+
+    /* Unordered export: just walk the slots */
+    if ( (keyMin==NULL) && (ordering!=FMRTASCENDING) && (ordering!=FMRTDESCENDING) )
+    {
+        for (pos=0; pos<=Tables[tableIndex].hashMask; pos++)
+            if (slots[pos].hash!=0)
+            {
+                formatElem (tableIndex, Tables[tableIndex].fmrtData + slots[pos].elem*Tables[tableIndex].elemSize, sep, row, MAXFMRTROWLEN);
+                fprintf (fPtr, "%s\n", row);
+            }
+        return (FMRTOK);
+    }
+
+    if (Tables[tableIndex].currentNumElem==0)
+        return (FMRTOK);
+
+    /* Collect the elements to be exported (the second half of the array is the work area) */
+    elems = (fmrtIndex *) malloc (2*Tables[tableIndex].currentNumElem*sizeof(fmrtIndex));
+    if (elems==NULL)
+        return (FMRTOUTOFMEMORY);
+    for (pos=0; pos<=Tables[tableIndex].hashMask; pos++)
+        if ( (slots[pos].hash!=0) &&
+             ( (keyMin==NULL) || ( (hashCompare(tableIndex, *keyMin, stringMin, slots[pos].elem)<=0) &&
+                                   (hashCompare(tableIndex, *keyMax, stringMax, slots[pos].elem)>=0) ) ) )
+            elems[num++] = slots[pos].elem;
+
+    /* Sort and export them */
+    sorted = hashSortElems (tableIndex, elems, elems+Tables[tableIndex].currentNumElem, num);
+    for (k=0; k<num; k++)
+    {
+        pos = (ordering==FMRTDESCENDING) ? sorted[num-1-k] : sorted[k];
+        formatElem (tableIndex, Tables[tableIndex].fmrtData + pos*Tables[tableIndex].elemSize, sep, row, MAXFMRTROWLEN);
+        fprintf (fPtr, "%s\n", row);
+    }
+    free (elems);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * exportTableRecurse()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportTableCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields and a flag that indicates
+ * the export ordering. The routine consider the
+ * index as the root of a subtree which is printed into
+ * the file pointed by the third parameter by using
+ * in order approach.
+ ***********************************************************/
+static void exportTableRecurse (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex;
+    uint8_t     j;
+    void        *currentPtr,
+                *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Left and Right subtree indexes */
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    if (ordering==FMRTASCENDING)
+        exportTableRecurse (tableIndex, leftIndex, fPtr, sep, ordering);
+    else
+        exportTableRecurse (tableIndex, rightIndex, fPtr, sep, ordering);
+
+    /* In-order traversal -> ... then current node... */
+    /* Print the key... */
+    switch (Tables[tableIndex].key.type)
+    {
+        case FMRTINT:
+        {
+            fprintf (fPtr, "%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTINT */
+        case FMRTSIGNED:
+        {
+            fprintf (fPtr, "%d",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTSIGNED */
+        case FMRTDOUBLE:
+        {
+            fprintf (fPtr, "%lf",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTDOUBLE */
+        case FMRTCHAR:
+        {
+            fprintf (fPtr, "%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+            break;
+        }   /* case FMRTCHAR */
+        case FMRTSTRING:
+        {
+            fprintf (fPtr, "%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
+            break;
+        }   /* case FMRTSTRING */
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> print raw timestamp */
+                fprintf (fPtr, "%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+            else
+            {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                char  timestamp[MAXFMRTSTRINGLEN+1];
+                strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                fprintf (fPtr, "%s",timestamp);
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* The components of the key take one column each */
+            char  key[MAXFMRTROWLEN];
+            formatCompositeKey (tableIndex, currentPtr+Tables[tableIndex].key.delta, sep, key, sizeof(key));
+            fprintf (fPtr, "%s",key);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTASCENDING)
+        exportTableRecurse (tableIndex, rightIndex, fPtr, sep, ordering);
+    else
+        exportTableRecurse (tableIndex, leftIndex, fPtr, sep, ordering);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportTableOptimized()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportTableCsv(), and implements an iterative level
+ * order traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter) and a char representing a user defined
+ * separator between fields. The routine prints the
+ * content of the table into the file specified by filePtr
+ * by using a level order traversal, so that the
+ * subsequent reload does not require any rebalancing and
+ * occurs in an optimized way
+ ***********************************************************/
+static fmrtResult exportTableOptimized (fmrtId tableIndex, fmrtIndex rootIndex, FILE *fPtr, char sep)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex, currentIndex, fifoSize;
+    uint8_t      j;
+    fmrtResult   res;
+    void        *currentPtr,
+                *fieldsPtr;
+
+    /* Exit if rootIndex is NULL */
+    if (rootIndex==FMRTNULLPTR)
+        return (FMRTOK);
+
+    /* Initialize FIFO Queue used for level order traversal           */
+    /* Since the tree is balanced, the lowest  level contains at most */
+    /* half of the current number of elements plus 1. This is the     */
+    /* maximum number of elements in the FIFO structure. However,     */
+    /* allocate one more element to be on the safe side               */
+    fifoSize = Tables[tableIndex].currentNumElem/2 + 2;
+    if ( (res=initFifo (tableIndex,fifoSize)) != FMRTOK)
+        return (res);
+
+    /* Insert root node into the queue */
+    insertFifo (tableIndex,rootIndex);
+
+    /* While loop until the queue is empty */
+    while ( (fifoSize=getFifoSize(tableIndex)) )
+    {
+        /* Index of the element just extracted from the FIFO structure */
+        currentIndex = extractFifo (tableIndex);
+
+        /* Set currentPtr to the first byte of the structure that contains the index just extracted */
+        currentPtr = Tables[tableIndex].fmrtData + currentIndex*Tables[tableIndex].elemSize;
+
+        /* Left and Right subtree indexes */
+        leftIndex = *((fmrtIndex *) currentPtr);
+        rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+        /* Process current node... First print the key... */
+        switch (Tables[tableIndex].key.type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%d",*((uint32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%d",*((int32_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%lf",*((double *)(currentPtr+Tables[tableIndex].key.delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c",*((char *)(currentPtr+Tables[tableIndex].key.delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%s",(char *)(currentPtr+Tables[tableIndex].key.delta));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%ld",*((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(currentPtr+Tables[tableIndex].key.delta)));
+                    fprintf (fPtr, "%s",timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+            case FMRTCOMPOSITE:
+            {   /* The components of the key take one column each */
+                char  key[MAXFMRTROWLEN];
+                formatCompositeKey (tableIndex, currentPtr+Tables[tableIndex].key.delta, sep, key, sizeof(key));
+                fprintf (fPtr, "%s",key);
+                break;
+            }   /* case FMRTCOMPOSITE */
+        }   /* switch (Tables[tableIndex].key.type) */
+        fieldsPtr = fieldsOf (tableIndex, currentPtr);
+        /* then loop through all the fields and print them separated by sep */
+        for (j=0; j<Tables[tableIndex].numFields; j++)
+        {   /* Loop through all fields */
+            switch (Tables[tableIndex].fields[j].type)
+            {
+                case FMRTINT:
+                {
+                    fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    break;
+                }   /* case FMRTINT */
+                case FMRTSIGNED:
+                {
+                    fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    break;
+                }   /* case FMRTSIGNED */
+                case FMRTDOUBLE:
+                {
+                    fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    break;
+                }   /* case FMRTDOUBLE */
+                case FMRTCHAR:
+                {
+                    fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    break;
+                }   /* case FMRTCHAR */
+                case FMRTSTRING:
+                {
+                    fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                    break;
+                }   /* case FMRTSTRING */
+                case FMRTTIMESTAMP:
+                {
+                    if (fmrtTimeFormat[0]=='\0')
+                        /* time format empty --> print raw timestamp */
+                        fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    else
+                    {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                        char  timestamp[MAXFMRTSTRINGLEN+1];
+                        strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                        fprintf (fPtr, "%c%s",sep,timestamp);
+                    }
+                    break;
+                }   /* case FMRTTIMESTAMP */
+            }   /* switch (Tables[tableIndex].fields[j].type) */
+        }   /* for (j=0; j<Tables[tableIndex].numFields; j++) */
+        fprintf (fPtr,"\n");
+
+        /* Now insert in FIFO the root nodes of the left and right subtree  to go to the next level */
+        if (leftIndex!=FMRTNULLPTR)
+            insertFifo (tableIndex,leftIndex);
+        if (rightIndex!=FMRTNULLPTR)
+            insertFifo (tableIndex,rightIndex);
+
+    }   /* while ( fifoSize = getFifoSize(tableIndex) ) */
+
+    /* the Queue is empty -> the table has been completely traversed */
+    /* release Fifo and exit */
+    releaseFifo(tableIndex);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * exportRangeRecurseInt()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two integer values representing respectively
+ * the minimum and maximum key value.
+ * The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseInt (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, uint32_t keyMin, uint32_t keyMax)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex;
+    uint8_t     j;
+    uint32_t    key;
+    void        *currentPtr,
+                *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    key = *((uint32_t *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (key<keyMin)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (key>keyMax)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    fprintf (fPtr, "%d",key);
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseInt (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseInt (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseSigned()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two signed integer values
+ * representing respectively the minimum and maximum key
+ * value. The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseSigned (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, int32_t keyMin, int32_t keyMax)
+{
+    /* Local Variables */
+    fmrtIndex   leftIndex, rightIndex;
+    uint8_t     j;
+    int32_t     key;
+    void       *currentPtr,
+               *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    key = *((int32_t *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (key<keyMin)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (key>keyMax)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                             */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    fprintf (fPtr, "%d",key);
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseSigned (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseSigned (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseDouble()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two double values
+ * representing respectively the minimum and maximum key
+ * value. The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseDouble (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, double keyMin, double keyMax)
+{
+    /* Local Variables */
+    fmrtIndex   leftIndex, rightIndex;
+    uint8_t     j;
+    double      key;
+    void       *currentPtr,
+               *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    key = *((double *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (key<keyMin)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (key>keyMax)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    fprintf (fPtr, "%lf",key);
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseDouble (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseDouble (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseChar()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two char values
+ * representing respectively the minimum and maximum key
+ * value. The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseChar (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, char keyMin, char keyMax)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex;
+    uint8_t     j;
+    char        key;
+    void        *currentPtr,
+                *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    key = *((char *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (key<keyMin)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (key>keyMax)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    fprintf (fPtr, "%c",key);
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseChar (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseChar (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseString()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two string values
+ * representing respectively the minimum and maximum key
+ * value. The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseString (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, char *keyMin, char *keyMax)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex;
+    uint8_t     j;
+    char        key[MAXFMRTSTRINGLEN+1];
+    void        *currentPtr,
+                *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    strcpy (key,(char *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (strcmp(key,keyMin)<0)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (strcmp(key,keyMax)>0)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    fprintf (fPtr, "%s",key);
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseString (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseString (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseTimestamp()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree.
+ * It takes the table index (first parameter, which is the
+ * index of the Table[] array, not the TableId), the
+ * current node index (second parameter), a file pointer
+ * (third parameter), a char representing a user defined
+ * separator between fields, a flag indicating the export
+ * ordering and two time_t values
+ * representing respectively the minimum and maximum key
+ * value. The routine consider the index as the root of a
+ * subtree which is printed into the file pointed by the
+ * third parameter by using in order approach.
+ ***********************************************************/
+static void exportRangeRecurseTimestamp (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, time_t keyMin, time_t keyMax)
+{
+    /* Local Variables */
+    fmrtIndex   leftIndex, rightIndex;
+    uint8_t     j;
+    time_t      key;
+    void       *currentPtr,
+               *fieldsPtr;
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    key = *((time_t *)(currentPtr+Tables[tableIndex].key.delta));
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (key<keyMin)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (key>keyMax)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node... */
+    /* Print the key... */
+    if (fmrtTimeFormat[0]=='\0')
+        /* time format empty --> print raw timestamp */
+        fprintf (fPtr, "%ld",key);
+    else
+    {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+        char  timestamp[MAXFMRTSTRINGLEN+1];
+        strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(&key)));
+        fprintf (fPtr, "%c%s",sep,timestamp);
+    }
+    fieldsPtr = fieldsOf (tableIndex, currentPtr);
+    /* then loop through all the fields and print them separated by sep */
+    for (j=0; j<Tables[tableIndex].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[tableIndex].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fprintf (fPtr, "%c%d",sep,*((uint32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTINT */
+            case FMRTSIGNED:
+            {
+                fprintf (fPtr, "%c%d",sep,*((int32_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTSIGNED */
+            case FMRTDOUBLE:
+            {
+                fprintf (fPtr, "%c%lf",sep,*((double *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTDOUBLE */
+            case FMRTCHAR:
+            {
+                fprintf (fPtr, "%c%c",sep,*((char *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                break;
+            }   /* case FMRTCHAR */
+            case FMRTSTRING:
+            {
+                fprintf (fPtr, "%c%s",sep,fieldString (tableIndex, fieldsPtr, j));
+                break;
+            }   /* case FMRTSTRING */
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> print raw timestamp */
+                    fprintf (fPtr, "%c%ld",sep,*((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                else
+                {   /* convert raw timestamp into a string formatted according to fmrtTimeFormat */
+                    char  timestamp[MAXFMRTSTRINGLEN+1];
+                    strftime(timestamp, MAXFMRTSTRINGLEN, fmrtTimeFormat, localtime((time_t *)(fieldsPtr+Tables[tableIndex].fields[j].delta)));
+                    fprintf (fPtr, "%c%s",sep,timestamp);
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    fprintf (fPtr,"\n");
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseTimestamp (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseTimestamp (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/***********************************************************
+ * exportRangeRecurseComposite()
+ * ---------------------------------------------------------
+ * This function is used by the fmrt library call
+ * fmrtExportRangeCsv(), and implements a recursive in-order
+ * traversal of the fmrt tree for FMRTCOMPOSITE keys.
+ * It takes the same parameters used by the other
+ * exportRangeRecurse functions, with minimum and maximum
+ * key values encoded as in the elements (see
+ * encodeComponent()), so that they are compared through
+ * memcmp(). When the lower components of keyMin and keyMax
+ * are set to their minimum and maximum values, the range
+ * selects all the elements sharing the leading components
+ ***********************************************************/
+static void exportRangeRecurseComposite (fmrtId tableIndex, fmrtIndex nodeIndex, FILE *fPtr, char sep, uint8_t ordering, char *keyMin, char *keyMax)
+{
+    /* Local Variables */
+    fmrtIndex    leftIndex, rightIndex;
+    void        *currentPtr,
+                *keyPtr;
+    char        row[MAXFMRTROWLEN];
+
+    /* If nodeIndex is NULL stop recursion */
+    if (nodeIndex==FMRTNULLPTR)
+        return;
+
+    /* Set currentPtr to the first byte of the structure that contains the given index */
+    currentPtr = Tables[tableIndex].fmrtData + nodeIndex*Tables[tableIndex].elemSize;
+
+    /* Extract Key, Left and Right subtree indexes */
+    keyPtr = currentPtr+Tables[tableIndex].key.delta;
+    leftIndex = *((fmrtIndex *) currentPtr);
+    rightIndex = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+
+    /* In-order traversal -> First left subtree (in case ordering==FMRTASCENDING, right subtree otherwise)... */
+    /* ... but skip unnecessary node traversal in case the current key is outside the range                   */
+    if (memcmp(keyPtr,keyMin,Tables[tableIndex].key.len)<0)
+    {   /* current element is lower than keyMin -> explore only right subtree */
+        exportRangeRecurseComposite (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    if (memcmp(keyPtr,keyMax,Tables[tableIndex].key.len)>0)
+    {   /* current element is higher than keyMax -> explore only left subtree */
+        exportRangeRecurseComposite (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+        return;
+    }
+    /* Current key is within the interval... explore both subtrees, with */
+    /* order depending on ordering parameter                              */
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseComposite (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseComposite (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    /* In-order traversal -> ... after subtree print current node (key components and fields) */
+    formatElem (tableIndex, currentPtr, sep, row, sizeof(row));
+    fprintf (fPtr, "%s\n",row);
+
+    /* In-order traversal -> ... last right subtree (in case ordering==FMRTASCENDING, left subtree otherwise)*/
+    if (ordering==FMRTDESCENDING)
+        exportRangeRecurseComposite (tableIndex, leftIndex, fPtr, sep, ordering, keyMin, keyMax);
+    else
+        exportRangeRecurseComposite (tableIndex, rightIndex, fPtr, sep, ordering, keyMin, keyMax);
+
+    return;
+}
+
+
+/**********************************
+ *  Public Functions              *
+ * ------------------------------ *
+ * (can be used outside this file *
+ *  and are part of the library)  *
+ **********************************/
+/***********************************************************
+ * fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Define a new table with the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535
+ * - tableName
+ *   string of up to 32 chars identifying table name
+ * - tableNumElem
+ *   max number of elements in table between 1 and 2^26,
+ *   or 2^40 if the library is built with 64 bit element
+ *   indexes (see fmrtIndex)
+ * This shall necessarily be the first library function
+ * invoked by the caller.
+ * A table cannot be redefined unless it is cleared first
+ * through fmrtClearTable()
+ * The library supports the definition of up to 65536
+ * tables, the memory for the descriptor of each table is
+ * allocated only when a table with that tableId is defined
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Table successfully defined
+ * - FMRTKO
+ *   Result obtained when the number of elements is outside the
+ *   allowed interval (1 - 2^26, or 1 - 2^40)
+ * - FMRTIDALREADYEXISTS
+ *   tableId is already in use by another table
+ * - FMRTMAXTABLEREACHED
+ *   Result obtained when the address space for the table
+ *   descriptors cannot be reserved (first definition)
+ * - FMRTOUTOFMEMORY
+ *   The memory budget would be exceeded (see
+ *   fmrtSetMemoryBudget()), or the memory of the table
+ *   descriptor cannot be committed
+ ***********************************************************/
+fmrtResult fmrtDefineTable (fmrtId tableId, char* tableName, fmrtIndex tableNumElem)
+{
+    /* Local Variables */
+    fmrtId      i;
+    uint8_t     j;
+
+    /* Set global lock to avoid cuncurrent access in case of parallel definition/clear of tables by different threads */
+    lockGlobal (FMRTCALLDEFINETABLE);
+
+    /* If this is the first invocation of the library reserve the address space of Tables[]       */
+    /* without access rights, so that no memory is allocated nor committed: the pages of each     */
+    /* descriptor are made accessible once the table is defined (see commitDescriptor()), and     */
+    /* descriptors never move while other threads use them. Tables is published to the threads  */
+    /* not holding the global lock by the release store of fmrtFirstInvocation (registryReady()) */
+    if (fmrtFirstInvocation)
+    {
+        Tables = mmap (NULL, MAXTABLES*sizeof(fmrtTableItem), PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+        if (Tables==MAP_FAILED)
+        {   /* Remove global lock before exiting */
+            Tables = NULL;
+            unlockGlobal ();
+            return (FMRTMAXTABLEREACHED);
+        }
+        __atomic_store_n (&fmrtFirstInvocation, 0, __ATOMIC_RELEASE);
+    }   /* if (fmrtFirstInvocation) */
+
+    /* The descriptor of the table is the element of Tables[] indexed by tableId */
+    i = tableId;
+
+    /* If tableId is already used return FMRTIDALREADYEXISTS */
+    if (tableDefined(i))
+    {   /* Remove global lock before exiting */
+        unlockGlobal ();
+        return (FMRTIDALREADYEXISTS);
+    }
+
+    /* Check the requested number of elements against MAXFMRTELEM and eventually provide FMRTKO */
+    if ( (tableNumElem < 1) || (tableNumElem > MAXFMRTELEM) )
+    {   /* Remove global lock before exiting */
+        unlockGlobal ();
+        return (FMRTKO);
+    }
+
+    /* Make the descriptor accessible */
+    if (commitDescriptor(i)!=FMRTOK)
+    {   /* Remove global lock before exiting */
+        unlockGlobal ();
+        return (FMRTOUTOFMEMORY);
+    }
+
+    /* Allocate the statistics shards only if statistics are enabled (see fmrtEnableStats()) */
+    Tables[i].stats = NULL;
+    if ( (fmrtStatsEnabled) &&
+         (posix_memalign ((void **) &(Tables[i].stats), FMRTCACHELINE, FMRTSTATSHARDS*sizeof(fmrtStatsShard)) != 0) )
+    {   /* Remove global lock before exiting */
+        releaseDescriptor (i);
+        unlockGlobal ();
+        return (FMRTKO);
+    }
+    if (Tables[i].stats!=NULL)
+        memset (Tables[i].stats, 0, FMRTSTATSHARDS*sizeof(fmrtStatsShard));
+
+    /* Allocate the lock statistics only if lock statistics are enabled (see fmrtEnableLockStats()) */
+    Tables[i].lockStats = NULL;
+    if ( (fmrtLockStatsEnabled) &&
+         ((Tables[i].lockStats=calloc (FMRTCALLS, sizeof(fmrtLockStats))) == NULL) )
+    {   /* Remove global lock before exiting */
+        free (Tables[i].stats);
+        releaseDescriptor (i);
+        unlockGlobal ();
+        return (FMRTKO);
+    }
+
+    /* If control reaches here, i is the index of the free element to use */
+    Tables[i].tableId = tableId;
+    Tables[i].status = DEFINED;
+    Tables[i].numFields = 0;
+    /* Assign Table Name truncating it to MAXFMRTTABLENAME if too long */
+    strncpy(Tables[i].tableName,tableName,MAXFMRTTABLENAME+1);
+    Tables[i].tableName[MAXFMRTTABLENAME] ='\0';
+    Tables[i].tableMaxElem = tableNumElem;
+    Tables[i].currentNumElem = 0;
+    /* Set key and field names to empty string */
+    Tables[i].key.name[0]='\0';
+    Tables[i].numKeyComps = 0;
+    for (j=0;j<MAXFMRTFIELDNUM;j++)
+        Tables[i].fields[j].name[0] = '\0';
+    /* Initial size consists in left ptr + right ptr */
+    Tables[i].elemSize = 2*sizeof (fmrtIndex);
+    Tables[i].fieldsLen = 0;
+    /* No aggregate defined by default */
+    Tables[i].aggField = FMRTNOAGGREGATE;
+    Tables[i].aggDelta = 0;
+    /* No expiry defined by default */
+    Tables[i].wheel = NULL;
+    Tables[i].defaultTtl = 0;
+    Tables[i].lastSweep = 0;
+    Tables[i].expDelta = 0;
+    /* No eviction by default, clear cache statistics */
+    Tables[i].evictMode = 0;
+    Tables[i].evictSink = NULL;
+    Tables[i].evictData = NULL;
+    Tables[i].clockHand = 0;
+    Tables[i].refDelta = 0;
+    Tables[i].hits = Tables[i].misses = Tables[i].evictions = 0;
+    memset (Tables[i].rotations, 0, sizeof(Tables[i].rotations));
+    Tables[i].lockSince = 0;
+    Tables[i].fmrtRoot = FMRTNULLPTR;
+    Tables[i].fmrtFree = FMRTNULLPTR;
+    Tables[i].fmrtUnused = 0;
+    Tables[i].fmrtData = NULL;
+    Tables[i].fmrtPayload = NULL;
+    Tables[i].layout = FMRTLAYOUTUNIFIED;
+    Tables[i].fieldsDelta = 0;
+    Tables[i].frozen = 0;
+    Tables[i].stringHeap = 0;
+    Tables[i].strHeap = NULL;
+    Tables[i].heapSize = Tables[i].heapUsed = Tables[i].heapLive = 0;
+    /* AVL tree engine by default (see fmrtDefineEngine()) */
+    Tables[i].engine = FMRTENGINEAVL;
+    Tables[i].btHeight = 0;
+    Tables[i].btNodeSize = Tables[i].btFanout = 0;
+    Tables[i].btRoot = Tables[i].btFirst = Tables[i].btLast = Tables[i].btFree = FMRTNULLPTR;
+    Tables[i].btUnused = Tables[i].btNumNodes = Tables[i].btMaxNodes = 0;
+    Tables[i].btNodes = Tables[i].btScratch = NULL;
+    Tables[i].hashSlots = NULL;
+    Tables[i].hashMask = 0;
+    /* No secondary index (see fmrtDefineIndex()) */
+    Tables[i].numIndexes = 0;
+    /* The table (statistics shards and array of elements so far) shall fit into the memory budget */
+    Tables[i].memCommitted = Tables[i].memReserved = 0;
+    if (admitMemory (i, 0)!=FMRTOK)
+    {   /* Remove global lock before exiting */
+        free (Tables[i].stats);
+        free (Tables[i].lockStats);
+        releaseDescriptor (i);
+        unlockGlobal ();
+        return (FMRTOUTOFMEMORY);
+    }
+    /* Initialize Table specific mutex and mark the table as defined in the map of Tables[], */
+    /* publishing the descriptor to the threads not holding the global lock (tableDefined())  */
+    pthread_mutex_init(&(Tables[i].tableMtx), NULL);
+    __atomic_fetch_or (&(fmrtTableMap[i>>6]), (uint64_t)1 << (i&63), __ATOMIC_RELEASE);
+
+    /* Remove global lock before exiting */
+    unlockGlobal ();
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineTable() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtClearTable()
+ * ---------------------------------------------------------
+ * Deallocate a previously allocated table:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Table successfully deallocated
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtClearTable (fmrtId tableId)
+{
+    /* Local Variables */
+    fmrtId      i;
+    uint8_t     k;
+    fmrtResult   res;
+
+    /* Set global lock to avoid cuncurrent access in case of parallel definition/clear of tables by different threads */
+    lockGlobal (FMRTCALLCLEARTABLE);
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+    {   /* Remove global lock before exiting */
+        unlockGlobal ();
+        return (res);
+    }
+
+    /* Otherwise deallocate stored data, set busy flag to 0 and destroy Table specific mutex */
+    if (Tables[i].fmrtData)
+        free (Tables[i].fmrtData);
+    if (Tables[i].fmrtPayload)
+        free (Tables[i].fmrtPayload);
+    if (Tables[i].strHeap)
+        free (Tables[i].strHeap);
+    if (Tables[i].wheel)
+        free (Tables[i].wheel);
+    if (Tables[i].btNodes)
+        free (Tables[i].btNodes);
+    if (Tables[i].btScratch)
+        free (Tables[i].btScratch);
+    if (Tables[i].hashSlots)
+        free (Tables[i].hashSlots);
+    for (k=0; k<Tables[i].numIndexes; k++)
+        free (Tables[i].indexes[k].nodes);
+    if (Tables[i].stats)
+        free (Tables[i].stats);
+    Tables[i].stats = NULL;
+    if (Tables[i].lockStats)
+        free (Tables[i].lockStats);
+    Tables[i].lockStats = NULL;
+    Tables[i].status = FREE;
+    __atomic_fetch_and (&(fmrtTableMap[i>>6]), ~((uint64_t)1 << (i&63)), __ATOMIC_RELEASE);
+    chargeMemory (i);
+    pthread_mutex_destroy(&(Tables[i].tableMtx));
+    releaseDescriptor (i);
+
+    /* Remove global lock before exiting */
+    unlockGlobal ();
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtClearTable() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineKey()
+ * ---------------------------------------------------------
+ * Define key name, type (and also key length for string key
+ * type) for a previously defined Table:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - keyName
+ *   descriptive name of the key (up to 16 chars allowed,
+ *   in case of length exceeding this limit the name will
+ *   be truncated)
+ * - keyType
+ *   identifies key type. Allowed values defined in header
+ *   fmrt.h (FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR,
+ *   FMRTSTRING and FMRTTIMESTAMP)
+ * - keyLen
+ *   meaningful only in case of keyType==FMRTSTRING, when it
+ *   represents the maximum string length for the key value
+ *   Allowed values are in the interval 1-256.
+ *   For FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR and
+ *   FMRTTIMESTAMP types, the parameter is meaningless,
+ *   since by default key lengths in those cases are
+ *   fixed (e.g. 1 for FMRTCHAR, 4 for FMRTINT, etc.).
+ * This call can be invoked only once after fmrtDefineTable()
+ * and before invoking fmrtDefineFields(). In case of
+ * multiple invokations a proper error is provided (see
+ * below the list of possible Return Values)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Key definition successful
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when keyType parameter
+ *   is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The key cannot be redefined (it has been already
+ *   defined)
+ * - FMRTFIELDTOOLONG
+ *   In case of keyType==FMRTSTRING the keyLen parameter is
+ *   outside the allowed interval
+ ***********************************************************/
+fmrtResult fmrtDefineKey (fmrtId tableId, char* keyName, fmrtType keyType, fmrtLen keyLen)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* If found, set lock and check that the key has not been already defined, otherwise provide error FMRTREDEFPROHIBITED */
+    lockTable (i, FMRTCALLDEFINEKEY);
+    if ( (Tables[i].status >= KEYDEFINED) || (Tables[i].numKeyComps>0) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Check keyType and, in case of string type, also keyLen     */
+    /* Also, set properly keytype and keylen into Table[] element */
+    switch (keyType)
+    {
+        case FMRTINT:
+        {
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = sizeof (uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = sizeof (int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = sizeof (double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = sizeof (char);
+            break;
+        }
+        case FMRTSTRING:
+        {
+            if ( (keyLen<=0) || (keyLen>MAXFMRTSTRINGLEN) )
+            {   /* Clear lock before exiting */
+                unlockTable (i);
+                return (FMRTFIELDTOOLONG);
+            }
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = keyLen + 1;
+            /* The normalized prefix of the key (see keyPrefix()) is stored right before the key */
+            Tables[i].elemSize += sizeof (uint64_t);
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            Tables[i].key.type = keyType;
+            Tables[i].key.len = sizeof (time_t);
+            break;
+        }
+        default:
+        {   /* Clear lock before exiting */
+            unlockTable (i);
+            return (FMRTKO);
+        }
+    }   /* switch (keyType) */
+
+    /* Assign Key Name truncating it to MAXFMRTNAMELEN if too long */
+    strncpy (Tables[i].key.name,keyName,MAXFMRTNAMELEN+1);
+    Tables[i].key.name[MAXFMRTNAMELEN]='\0';
+
+    /* Set also key.delta and update Table[] element size */
+    Tables[i].key.delta = Tables[i].elemSize;
+    Tables[i].elemSize += Tables[i].key.len;
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineKey() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineCompositeKey()
+ * ---------------------------------------------------------
+ * Define a composite key, made of up to 4 typed components,
+ * for a previously defined Table. This is an alternative to
+ * fmrtDefineKey(), and the key type is FMRTCOMPOSITE.
+ * Elements are ordered by the first component, then by the
+ * second one and so on (lexicographic order). Components
+ * are stored packed in the element, encoded so that the
+ * encoded keys can be compared with memcmp(), i.e. with a
+ * single byte-wise comparison at each node of the tree.
+ * It is a call with a variable number of arguments. The
+ * first three parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - keyName
+ *   descriptive name of the key (up to 16 chars allowed,
+ *   in case of length exceeding this limit the name will
+ *   be truncated)
+ * - numComponents
+ *   number of components, in the interval 2-4
+ * The following parameters specify name, type (and also
+ * length for string components) of each component, as in
+ * fmrtDefineFields():
+ * - component name
+ *   descriptive name of the component (up to 16 chars), it
+ *   is used as column name in CSV exports
+ * - component type
+ *   FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR, FMRTSTRING
+ *   or FMRTTIMESTAMP
+ * - component len
+ *   THIS SHALL BE INSERTED ONLY if component type is
+ *   FMRTSTRING, it represents the maximum string length
+ * Library calls taking a key (e.g. fmrtRead(), fmrtCreate()
+ * or fmrtDelete()) take one argument for each component
+ * instead, in the same order and with the same types used
+ * for fields. Similarly, fmrtExportRangeCsv() takes all the
+ * components of the minimum key followed by all the
+ * components of the maximum key, therefore the elements
+ * sharing the leading components are exported by setting
+ * the remaining components to their minimum and maximum
+ * values. In CSV files each component takes one column.
+ * This call can be invoked only once after fmrtDefineTable()
+ * and before invoking fmrtDefineFields(). Tables with a
+ * composite key support only the default engine (see
+ * fmrtDefineEngine())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Key definition successful
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when one of the component
+ *   type parameters is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The key cannot be redefined (it has been already
+ *   defined, either through this call or through
+ *   fmrtDefineKey()) or fields have been already defined
+ * - FMRTMAXFIELDSINVALID
+ *   The specified number of components is outside the
+ *   allowed range (2-4)
+ * - FMRTFIELDTOOLONG
+ *   The maximum length specified for one of the FMRTSTRING
+ *   components is outside the allowed interval (1-254) or
+ *   the components take more than 255 bytes overall
+ ***********************************************************/
+fmrtResult fmrtDefineCompositeKey (fmrtId tableId, char *keyName, uint8_t numComponents, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtId      i;
+    uint8_t     c;
+    char        *name;
+    int         type,len;
+    uint16_t    keyLen;
+    fmrtField   *comp;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* If found, set lock and check that neither the key nor the fields have been already defined */
+    /* (elements still contain only left and right pointers), otherwise provide FMRTREDEFPROHIBITED */
+    lockTable (i, FMRTCALLDEFINECOMPOSITEKEY);
+    if ( (Tables[i].status >= KEYDEFINED) || (Tables[i].elemSize != 2*sizeof(fmrtIndex)) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* If specified number of components is outside the allowed range provide an error */
+    if ( (numComponents<2) || (numComponents>MAXFMRTKEYCOMPS) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTMAXFIELDSINVALID);
+    }
+
+    /* Start parsing variable arguments */
+    va_start(args, numComponents);
+
+    for (c=0, keyLen=0; c<numComponents; c++)
+    {   /* Loop on the number of components */
+        comp = &(Tables[i].keyComps[c]);
+        /* The first expected argument is component name (up to 16 chars, otherwise it is truncated) */
+        name = va_arg (args,char*);
+        strncpy (comp->name,name,MAXFMRTNAMELEN+1);
+        comp->name[MAXFMRTNAMELEN]='\0';
+        /* The second expected argument is component type */
+        type = va_arg (args, int);
+        if ( (type<FMRTINT) || (type>FMRTTIMESTAMP) )
+        {   /* Clear lock before exiting */
+            unlockTable (i);
+            va_end (args);
+            return (FMRTKO);
+        }
+        comp->type = (fmrtType) type;
+        /* In case of FMRTSTRING type we expect also string length (up to MAXFMRTSTRINGLEN characters) */
+        if (type==FMRTSTRING)
+        {
+            len = va_arg (args, int);
+            if ( (len<=0) || (len>=MAXFMRTSTRINGLEN) )
+            {   /* Clear lock before exiting */
+                unlockTable (i);
+                va_end (args);
+                return (FMRTFIELDTOOLONG);
+            }
+        }   /* if (type==FMRTSTRING) */
+
+        /* Components are stored packed, each one takes the bytes needed by its encoding (see encodeComponent()) */
+        switch (type)
+        {
+            case FMRTINT:
+            {
+                comp->len = sizeof (uint32_t);
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                comp->len = sizeof (int32_t);
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                comp->len = sizeof (double);
+                break;
+            }
+            case FMRTCHAR:
+            {
+                comp->len = sizeof (char);
+                break;
+            }
+            case FMRTSTRING:
+            {
+                comp->len = (fmrtLen) len + 1;
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                comp->len = sizeof (time_t);
+                break;
+            }
+        }   /* switch (type) */
+        comp->delta = keyLen;
+        keyLen += comp->len;
+    }   /* for (c=0; c<numComponents; c++) */
+    va_end (args);
+
+    /* The encoded key is handled through the same buffers used for FMRTSTRING keys */
+    if (keyLen>MAXFMRTSTRINGLEN)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTFIELDTOOLONG);
+    }
+
+    /* Assign Key Name truncating it to MAXFMRTNAMELEN if too long, then set type, len and delta */
+    strncpy (Tables[i].key.name,keyName,MAXFMRTNAMELEN+1);
+    Tables[i].key.name[MAXFMRTNAMELEN]='\0';
+    Tables[i].key.type = FMRTCOMPOSITE;
+    Tables[i].key.len = (fmrtLen) keyLen;
+    Tables[i].key.delta = Tables[i].elemSize;
+    Tables[i].elemSize += Tables[i].key.len;
+    Tables[i].numKeyComps = numComponents;
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineCompositeKey() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineFields()
+ * ---------------------------------------------------------
+ * Define fields for each table entry. It is a call with a
+ * variable number of arguments. The first two parameters
+ * (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - numFields
+ *   number of fields, in the interval 1-16 (excluding the
+ *   key, which is defined apart through fmrtDefineKey() )
+ * The parameters after the two above mentioned are used
+ * to specify name, type (and also length for string field
+ * type). Specifically, for each field, there shall be:
+ * - field name
+ *   descriptive name of the field (up to 16 chars allowed,
+ *   in case of length exceeding this limit the name will
+ *   be truncated)
+ * - field type
+ *   identifies field type. Allowed values defined in header
+ *   fmrt.h (FMRTINT, FMRTSIGNED, FMRTDOUBLE, FMRTCHAR,
+ *   FMRTSTRING and FMRTTIMESTAMP)
+ * - field len
+ *   THIS SHALL BE INSERTED ONLY if field type == FMRTSTRING.
+ *   DO NOT INSERT FIELD LEN FOR OTHER TYPES
+ *   It represents the maximum string length for the field
+ *   value. Allowed values are in the interval 1-256.
+ * This call can be invoked only once after fmrtDefineKey()
+ * and before invoking fmrtCreate(). In case of
+ * multiple invokations a proper error is provided (see
+ * below the list of possible Return Values)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Fields definition successful
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when one of the field
+ *   type parameters is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The fields cannot be redefined (they have been already
+ *   defined)
+ * - FMRTMAXFIELDSINVALID
+ *   The specified number of fields is outside the allowed
+ *   range (1-16)
+ * - FMRTFIELDTOOLONG
+ *   The maximum length specified for one of the FMRTSTRING
+ *   parameters is outside the allowed interval (1-256)
+ * - FMRTOUTOFMEMORY
+ *   The array of elements of the table, allocated at the
+ *   first insertion, would exceed the memory budget (see
+ *   fmrtSetMemoryBudget()). Fields are not defined
+ ***********************************************************/
+fmrtResult fmrtDefineFields (fmrtId tableId, uint8_t numFields, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtId      i;
+    uint8_t     j;
+    uint16_t    keySize;
+    char        *name;
+    int         type,len;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* If found, set lock and check that the fields have not been already defined, otherwise provide error FMRTREDEFPROHIBITED */
+    lockTable (i, FMRTCALLDEFINEFIELDS);
+    if (Tables[i].status >= FIELDSDEFINED)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* If specified number of fields is outside the allowed range provide an error */
+    if ( (numFields<=0) || (numFields>MAXFMRTFIELDNUM) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTMAXFIELDSINVALID);
+    }
+
+    /* Start parsing variable arguments */
+    va_start(args, numFields);
+
+    for (j=0; j<numFields; j++)
+    {   /* Loop on the number of fields */
+        /* The first expected argument is field name (up to 16 chars, otherwise it is truncated) */
+        name = va_arg (args,char*);
+        strncpy (Tables[i].fields[j].name,name,MAXFMRTNAMELEN+1);
+        Tables[i].fields[j].name[MAXFMRTNAMELEN]='\0';
+        /* The second expected argument is argument type */
+        type = va_arg (args, int);
+        if ( (type<FMRTINT) || (type>FMRTTIMESTAMP) )
+        {   /* Clear lock before exiting */
+            unlockTable (i);
+            va_end (args);
+            return (FMRTKO);
+        }
+        Tables[i].fields[j].type = (fmrtType) type;
+        /* In case of FMRTSTRING type we expect also string length (up to MAXFMRTSTRINGLEN characters) */
+        if (type==FMRTSTRING)
+        {
+            len = va_arg (args, int);
+            if ( (len<=0) || (len>MAXFMRTSTRINGLEN) )
+            {   /* Clear lock before exiting */
+                unlockTable (i);
+                va_end (args);
+                return (FMRTFIELDTOOLONG);
+            }
+        }   /* if (type==FMRTSTRING) */
+
+        switch (type)
+        {
+            case FMRTINT:
+            {
+                Tables[i].fields[j].len = sizeof (uint32_t);
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                Tables[i].fields[j].len = sizeof (int32_t);
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                Tables[i].fields[j].len = sizeof (double);
+                break;
+            }
+            case FMRTCHAR:
+            {
+                Tables[i].fields[j].len = sizeof (char);
+                break;
+            }
+            case FMRTSTRING:
+            {
+                Tables[i].fields[j].len = (fmrtLen) len + 1;
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                Tables[i].fields[j].len = sizeof (time_t);
+                break;
+            }
+        }   /* switch (type) */
+    }   /* for (j=0; j<numFields; j++) */
+
+    /* All fields have been read, update numberof fields in Table[], */
+    /* close the variable list argument and return FMRTOK             */
+    Tables[i].numFields = numFields;
+    va_end (args);
+
+    /* Fields are stored (aligned) after the key, sorted by alignment (see layoutFields()) */
+    keySize = Tables[i].elemSize;
+    Tables[i].fieldsDelta = FMRTALIGN (Tables[i].elemSize, FMRTMAXALIGN);
+    layoutFields (i);
+    Tables[i].elemSize = Tables[i].fieldsDelta + Tables[i].fieldsLen;
+
+    /* Now the size of the elements is known: the array of elements shall fit into the memory budget */
+    if (admitMemory (i, 0)!=FMRTOK)
+    {   /* Fields are not defined, clear lock before exiting */
+        Tables[i].numFields = 0;
+        Tables[i].elemSize = keySize;
+        Tables[i].fieldsDelta = Tables[i].fieldsLen = 0;
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineFields() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtRead()
+ * ---------------------------------------------------------
+ * This library call is used to read an entry from the fmrt
+ * tree. It is a call with a variable number of arguments.
+ * The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call. The library behaviour is undefined
+ *   if this constraint is not satisfied. In case of string
+ *   key, the length is truncated to the max length specified
+ *   at key definition through fmrtDefineKey().
+ * After those mandatory parameters, there is a list of
+ * pointer parameters that are filled with values read
+ * from the entry (if present). Parameters are ordered
+ * according to the same order used in definition (i.e.
+ * in fmrtDefinFields() library call). Be aware that
+ * parameters number and types shall be correct, otherwise
+ * the call may cause run-time errors.
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the table
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtRead (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    va_list     args;
+    fmrtId      i;
+    uint8_t     maxLen;
+    void        *currentPtr;
+    fmrtResult   res;
+    uint32_t    keyInt;
+    int32_t     keySigned;
+    double      keyDouble;
+    time_t      keyTimestamp;
+    char        keyChar,
+                *string,
+                keyString[MAXFMRTSTRINGLEN+1];
+    fmrtNodeTraversalStack *traversal;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLREAD);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Initialize the list of variable arguments in order to read the key first */
+    va_start (args,tableId);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyInt = va_arg (args, uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySigned = va_arg (args, int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDouble = va_arg (args, double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyChar = (unsigned char) va_arg (args,int);
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            string = va_arg (args,char*);
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            strncpy (keyString,string,maxLen);
+            keyString[maxLen-1] = '\0';
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                keyTimestamp = va_arg (args, time_t);
+            else
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestamp = mktime (&TimeFromString);
+                else
+                    keyTimestamp = 0;
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One argument for each component, the key is stored encoded into keyString (see readCompositeArg()) */
+            readCompositeArg (i, &args, keyString);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+
+    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
+    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+    {
+        __atomic_store_n (&(Tables[i].misses), Tables[i].misses+1, __ATOMIC_RELAXED);
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATREAD, start, res));
+    }
+
+    /* The element was found and traversal is a pointer to a LIFO structure */
+    /* whose top element contains the index of the node we searched         */
+    /* Set currentPtr to point to the first byte of the structure           */
+    currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+
+    /* Now read all remaining arguments and fill them with the fields */
+    extractFields (i, currentPtr, &args);
+
+    /* Update cache statistics and mark the element as recently used */
+    __atomic_store_n (&(Tables[i].hits), Tables[i].hits+1, __ATOMIC_RELAXED);
+    referenceElem (i, traversal->index);
+    va_end (args);
+
+    #ifdef FMRTDEBUG
+    printf ("\n\nRead node at index: %llu\n",(unsigned long long)traversal->index);
+    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
+    printf ("Path from node up to the root:\n");
+    __fmrtPrintStack(i,traversal);
+    #endif
+
+    /* clear node traversal LIFO structure allocated by searchElem() and exit */
+    clearNodeTraversalStack (traversal);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATREAD, start, FMRTOK));
+}
+
+
+/***********************************************************
+ * fmrtCreate()
+ * ---------------------------------------------------------
+ * This library call is used to insert a new entry into the
+ * fmrt tree. It is a call with a variable number of
+ * arguments. The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call. The library behaviour is undefined
+ *   if this constraint is not satisfied. In case of string
+ *   key, the length is truncated to the max length specified
+ *   at key definition through fmrtDefineKey().
+ * After those mandatory parameters, there is a list of
+ * parameters that are used to fill the fields of the new
+ * entry that is going to be created. Parameters are ordered
+ * according to the same order used in definition (i.e.
+ * in fmrtDefinFields() library call). Be aware that
+ * parameters number and types shall be correct, otherwise
+ * the call may cause run-time errors. In case of string
+ * parameters, the length is truncated to the max length
+ * specified at field definition through fmrtDefineFields().
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been correctly inserted into the tree
+ * - FMRTDUPLICATEKEY
+ *   The specified key is already present in the AVL Tree
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   The FMRT tree is full, or there is not enough memory
+ *   to grow the string heap (see fmrtDefineStringHeap());
+ *   the table is left untouched
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
+ ***********************************************************/
+fmrtResult fmrtCreate (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    va_list     args,
+                check;
+    fmrtId      i;
+    uint8_t     j,maxLen;
+    fmrtIndex    newElement,
+                rebalIndex;
+    void        *currentPtr,
+                *fieldsPtr;
+    fmrtResult   res;
+    uint32_t    keyInt;
+    int32_t     keySigned;
+    double      keyDouble;
+    time_t      keyTimestamp;
+    char        keyChar,
+                *string,
+                keyString[MAXFMRTSTRINGLEN+1];
+    fmrtNodeTraversalStack  *traversal,
+                            *rebalPtr;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLCREATE);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATCREATE, start, FMRTFROZEN));
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Initialize the list of variable arguments in order to read the key first */
+    va_start (args,tableId);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyInt = va_arg (args, uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySigned = va_arg (args, int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDouble = va_arg (args, double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyChar = (unsigned char) va_arg (args,int);
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            string = va_arg (args,char*);
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            strncpy (keyString,string,maxLen);
+            keyString[maxLen-1] = '\0';
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                keyTimestamp = va_arg (args, time_t);
+            else
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestamp = mktime (&TimeFromString);
+                else
+                    keyTimestamp = 0;
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One argument for each component, the key is stored encoded into keyString (see readCompositeArg()) */
+            readCompositeArg (i, &args, keyString);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+
+    /* call searchElem() internal function to look for the element and provide error if result is FMRTOK */
+    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTOK)
+    {   /* The element has been found, therefore it is already present */
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATCREATE, start, FMRTDUPLICATEKEY));
+    }
+    if (res!=FMRTNOTFOUND)
+    {   /* go on only if key is not present, otherwise provide error and return */
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATCREATE, start, res));
+    }
+
+    /* Values of fields with a unique secondary index shall not be present in other elements, */
+    /* and the string heap shall have room for the new strings before the element is changed */
+    va_copy (check, args);
+    res = checkUniqueArgs (i, &check, (fmrtParamMask)-1, FMRTNULLPTR);
+    va_end (check);
+    if (res==FMRTOK)
+    {
+        va_copy (check, args);
+        res = reserveStringArgs (i, &check, (fmrtParamMask)-1);
+        va_end (check);
+    }
+    if (res!=FMRTOK)
+    {
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATCREATE, start, res));
+    }
+
+    /* The element is not present and traversal is a pointer to a LIFO structure     */
+    /* whose top element contains the index of the parent node and the corresponding */
+    /* subtree on which insertion shall be done                                      */
+
+    /* If not already called before, this is the first insertion */
+    if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
+    {   /* Initialize Empty elements list */
+        res = initEmptyList(i);
+        if (res!=FMRTOK)
+        {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
+            va_end (args);
+            clearNodeTraversalStack (traversal);
+            /* Clear the lock before exiting */
+            unlockTable (i);
+            return (recordStats (i, FMRTSTATCREATE, start, res));
+        }
+    }   /* if ( (Tables[i].fmrtData==NULL) ... */
+
+    /* If the table is full and eviction is enabled, free a slot by evicting an element; */
+    /* the tree has changed, therefore the path to the new element is searched again     */
+    if ( (Tables[i].currentNumElem==Tables[i].tableMaxElem) && (evictElem(i)==FMRTOK) )
+    {
+        clearNodeTraversalStack (traversal);
+        searchElem (i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal);
+    }
+
+    /* Get an empty element from the list of empty nodes */
+    if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
+    {   /* Not able to fetch an empty element - Probably the table is full */
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATCREATE, start, FMRTOUTOFMEMORY));
+    }
+
+    /* Link the new element to the existing structure (if present) */
+    if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
+        Tables[i].fmrtRoot = (Tables[i].engine==FMRTENGINEAVL) ? newElement : FMRTNULLPTR;   /* Other engines: see btInsert() and hashInsert() below */
+    else if (traversal->go == LEFT)
+    {   /* the stack exists and the path from parent node goes through the left subtree */
+        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+        *((fmrtIndex*)currentPtr) = newElement;
+    }
+    else
+    {   /* the stack exists and the path from parent node goes through the right subtree */
+        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
+        *((fmrtIndex*)currentPtr) = newElement;
+    }
+
+    /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
+    currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+
+    /* Insert null pointers to left and right subtree */
+    *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
+    *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+
+    /* copy the key into the newly created element */
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
+            break;
+        }
+        case FMRTCHAR:
+        {
+            *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Please observe that keyString has been truncated when it has been read from the function argument */
+            strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
+            *((uint64_t *)(currentPtr+Tables[i].key.delta-sizeof(uint64_t))) = keyPrefix (keyString);
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
+            break;
+        }
+        case FMRTCOMPOSITE:
+        {   /* keyString holds the encoded key (see readCompositeArg()) */
+            memcpy (currentPtr+Tables[i].key.delta, keyString, Tables[i].key.len);
+            break;
+        }
+    }   /* switch (Tables[i].key.type) */
+
+    fieldsPtr = fieldsOf (i, currentPtr);
+    /* Now read the variable list of arguments and use them to fill in the fields */
+    for (j=0; j<Tables[i].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[i].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                *((uint32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = va_arg (args,uint32_t);
+                 break;
+            }
+            case FMRTSIGNED:
+            {
+                *((int32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = va_arg (args,int32_t);
+                 break;
+            }
+            case FMRTDOUBLE:
+            {
+                *((double *)(fieldsPtr+Tables[i].fields[j].delta)) = va_arg (args,double);
+                 break;
+            }
+            case FMRTCHAR:
+            {
+                *((char *)(fieldsPtr+Tables[i].fields[j].delta)) = (unsigned char) va_arg (args,int);
+                break;
+            }
+            case FMRTSTRING:
+            {   /* In case of string exceeding the maximum length it is automatically truncated */
+                string = va_arg (args, char*);
+                storeString (i, fieldsPtr, j, string);
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> read raw timestamp from argument */
+                    *((time_t *)(fieldsPtr+Tables[i].fields[j].delta)) = va_arg (args,time_t);
+                else
+                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                    struct tm   TimeFromString;
+                    string = va_arg (args, char*);
+                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                        *((time_t *)(fieldsPtr+Tables[i].fields[j].delta)) = mktime (&TimeFromString);
+                    else
+                        *((time_t *)(fieldsPtr+Tables[i].fields[j].delta)) = 0;
+                }
+                break;
+            }
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    va_end (args);
+
+    /* With the B+-tree and hash engines, the element is linked now that its key has been stored */
+    if (Tables[i].engine==FMRTENGINEBTREE)
+        btInsert (i,newElement);
+    else if (Tables[i].engine==FMRTENGINEHASH)
+        hashInsert (i,newElement);
+
+    /* Link the element into the secondary indexes, now that its fields have been stored */
+    linkIndexes (i,newElement,(fmrtParamMask)-1);
+
+    /* Initialize subtree aggregates of the new leaf (ancestors are refreshed while rebalancing) */
+    updateNodeAggregate (i,newElement);
+
+    /* Set the deadline of the new element (if expiry is enabled) and give it a second chance against eviction */
+    initElemExpiry (i,newElement);
+    if (FMRTPROBEENABLED(insert))
+        FMRTPROBE4 (insert, Tables[i].tableId, traceElemHash(i,newElement), newElement, Tables[i].currentNumElem+1);
+    referenceElem (i,newElement);
+
+    /* Element has been inserted - Now go through the traversal LIFO structure and */
+    /* rebalance fmrt tree starting from the bottom and going up to the root        */
+    rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
+    while (rebalPtr!=NULL)
+    {   /* rebalance the subtree whose root is the current node */
+        rebalIndex = rebalanceSubTree (i,rebalPtr->index,FMRTROTINSERT);  /* the root might change due to rotations */
+        /* go up to the parent */
+        rebalPtr = rebalPtr->next;
+        if (rebalPtr!=NULL)
+        {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
+            if (rebalPtr->go == LEFT)
+                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
+            else
+                currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
+            /* The proper pointer is updated with the output of the rebalance structure */
+            *((fmrtIndex*)currentPtr) = rebalIndex;
+        }   /* if (rebalPtr!=NULL) */
+        else
+            /* There is no parent node - Rotation implies a change of the fmrt root pointer */
+            Tables[i].fmrtRoot = rebalIndex;
+    }   /* while (rebalPtr!=NULL) */
+
+    #ifdef FMRTDEBUG
+    printf ("\n\nCreated node at index: %llu\n",(unsigned long long)newElement);
+    __fmrtDebugPrintNode (Tables[i].tableId, newElement);
+    printf ("Path from node up to the root:\n");
+    __fmrtPrintStack(i,traversal);
+    #endif
+
+    /* set Tables[i].status, increment number of stored elements, clear node traversal LIFO structure allocated by searchElem() and exit */
+    Tables[i].status = NOTEMPTY;
+    Tables[i].currentNumElem += 1;
+    clearNodeTraversalStack (traversal);
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATCREATE, start, FMRTOK));
+}
+
+
+/***********************************************************
+ * fmrtModify()
+ * ---------------------------------------------------------
+ * This library call is used to update an existing entry
+ * into the fmrt tree. It is a call with a variable number of
+ * arguments. The first three parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - paramMask
+ *   It is a bitwise mask that is used to identify the
+ *   parameters to be changed. For example, assuming that
+ *   5 parameters have been defined through fmrtDefineFields(),
+ *   e.g.
+ *     fmrtDefineFields(tableId,5,param#0,..,param#1,..param#4)
+ *   and that we want to update only parameters 0,1 and 4,
+ *   we would set paramMask as follows:
+ *     paramMask = 19  -->  binary 10011
+ *   The rightmost bit represents the first parameter in
+ *   fmrtDefineFields(), the one immediately at its left is the
+ *   second parameter, and so on.
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call. The library behaviour is undefined
+ *   if this constraint is not satisfied. In case of string
+ *   key, the length is truncated to the max length specified
+ *   at key definition through fmrtDefineKey().
+ * After those mandatory parameters, there is a list of
+ * parameters that are used to update the fields of the
+ * entry that is going to be modified. Parameters are ordered
+ * according to the same order used in definition (i.e.
+ * in fmrtDefinFields() library call). Be aware that
+ * parameters number and types shall be correct, otherwise
+ * the call may cause run-time errors. All parameters shall be
+ * included in the call, but the only ones that will be updated
+ * are those pointed by the paramMask, as explained above.
+ * In case of string parameters, the length is truncated to
+ * the max length specified at field definition through
+ * fmrtDefineFields().
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been correctly updated into the tree
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the table
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
+ * - FMRTOUTOFMEMORY
+ *   There is not enough memory to grow the string heap
+ *   (see fmrtDefineStringHeap()); the table is left
+ *   untouched
+ ***********************************************************/
+fmrtResult fmrtModify (fmrtId tableId, fmrtParamMask paramMask, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    va_list     args,
+                check;
+    fmrtId      i;
+    uint8_t     j,maxLen;
+    void        *currentPtr,
+                *fieldsPtr;
+    fmrtResult   res;
+    uint32_t    keyInt,
+                fieldInt;
+    int32_t     keySigned,
+                fieldSigned;
+    double      keyDouble,
+                fieldDouble;
+    time_t      keyTimestamp,
+                fieldTimestamp;
+    char        keyChar,
+                fieldChar,
+                *string,
+                keyString[MAXFMRTSTRINGLEN+1];
+    fmrtParamMask    mask;
+    fmrtNodeTraversalStack *traversal;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLMODIFY);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATMODIFY, start, FMRTFROZEN));
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Initialize the list of variable arguments in order to read the key first */
+    va_start (args,paramMask);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyInt = va_arg (args, uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySigned = va_arg (args, int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDouble = va_arg (args, double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyChar = (unsigned char) va_arg (args,int);
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            string = va_arg (args,char*);
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            strncpy (keyString,string,maxLen);
+            keyString[maxLen-1] = '\0';
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                keyTimestamp = va_arg (args, time_t);
+            else
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestamp = mktime (&TimeFromString);
+                else
+                    keyTimestamp = 0;
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One argument for each component, the key is stored encoded into keyString (see readCompositeArg()) */
+            readCompositeArg (i, &args, keyString);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+
+    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
+    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+    {
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATMODIFY, start, res));
+    }
+
+    /* The element was found and traversal is a pointer to a LIFO structure */
+    /* whose top element contains the index of the node we searched         */
+    /* Set currentPtr to point to the first byte of the structure           */
+    currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+
+    /* Values of fields with a unique secondary index shall not be present in other elements, */
+    /* and the string heap shall have room for the new strings before the element is changed */
+    va_copy (check, args);
+    res = checkUniqueArgs (i, &check, paramMask, traversal->index);
+    va_end (check);
+    if (res==FMRTOK)
+    {
+        va_copy (check, args);
+        res = reserveStringArgs (i, &check, paramMask);
+        va_end (check);
+    }
+    if (res!=FMRTOK)
+    {
+        va_end (args);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATMODIFY, start, res));
+    }
+
+    /* Secondary indexes of the fields to be updated are detached until the new values are stored */
+    unlinkIndexes (i, traversal->index, paramMask);
+
+    /* Now read the variable list of arguments and use them to fill in the fields according to the param mask */
+    mask=paramMask;
+    fieldsPtr = fieldsOf (i, currentPtr);
+    for (j=0; j<Tables[i].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[i].fields[j].type)
+        {   /* read all parameters, but update them if and only if the orresponding bit in the mask is set */
+            case FMRTINT:
+            {
+                fieldInt = va_arg (args,uint32_t);
+                if (mask%2)
+                    *((uint32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldInt;
+                 break;
+            }
+            case FMRTSIGNED:
+            {
+                fieldSigned = va_arg (args,int32_t);
+                if (mask%2)
+                    *((int32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldSigned;
+                 break;
+            }
+            case FMRTDOUBLE:
+            {
+                fieldDouble = va_arg (args,double);
+                if (mask%2)
+                    *((double *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldDouble;
+                 break;
+            }
+            case FMRTCHAR:
+            {
+                fieldChar = (unsigned char) va_arg (args,int);
+                if (mask%2)
+                    *((char *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldChar;
+                break;
+            }
+            case FMRTSTRING:
+            {   /* In case of string exceeding the maximum length it is automatically truncated */
+                string = va_arg (args,char*);
+                if (mask%2)
+                    storeString (i, fieldsPtr, j, string);
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> read raw timestamp from argument */
+                    fieldTimestamp = va_arg (args,time_t);
+                else
+                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                    struct tm   TimeFromString;
+                    string = va_arg (args, char*);
+                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                        fieldTimestamp = mktime (&TimeFromString);
+                    else
+                        fieldTimestamp = 0;
+                }
+                if (mask%2)
+                    *((time_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldTimestamp;
+                 break;
+            }
+        }   /* switch (Tables[i].fields[j].type) */
+        mask>>=1;
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    va_end (args);
+    linkIndexes (i, traversal->index, paramMask);
+
+    /* Element has been updated - There is no need to rebalance the fmrt tree,  */
+    /* but subtree aggregates shall be refreshed on the whole path to the root */
+    updatePathAggregate (i,traversal);
+    referenceElem (i,traversal->index);
+
+    #ifdef FMRTDEBUG
+    printf ("\n\nModified node at index: %llu\n",(unsigned long long)traversal->index);
+    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
+    printf ("Path from node up to the root:\n");
+    __fmrtPrintStack(i,traversal);
+    #endif
+
+    /* clear node traversal LIFO structure allocated by searchElem() and exit */
+    clearNodeTraversalStack (traversal);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATMODIFY, start, FMRTOK));
+}
+
+
+/***********************************************************
+ * fmrtCreateModify()
+ * ---------------------------------------------------------
+ * This library call is used to insert or update an entry
+ * into the fmrt tree. If the entry esists, its data are
+ * updated according to the mask specified as second
+ * parameter. Rather, if the entry does not exist, it is
+ * created. In this case the bitwise mask is meaningless, i.e.
+ * all parameters specified are used to fill the content of
+ * corresponding fields in the newly created element.
+ * The first three parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - paramMask
+ *   It is a bitwise mask that is used to identify the
+ *   parameters to be changed (in case of entry already
+ *   present in the table). For example, assuming that
+ *   5 parameters have been defined through fmrtDefineFields(),
+ *   e.g.
+ *     fmrtDefineFields(tableId,5,param#0,..,param#1,..param#4)
+ *   and that we want to update only parameters 0,1 and 4,
+ *   we would set paramMask as follows:
+ *     paramMask = 19  -->  binary 10011
+ *   The rightmost bit represents the first parameter in
+ *   fmrtDefineFields(), the one immediately at its left is the
+ *   second parameter, and so on.
+ *   This parameter is meaningless in case of new element
+ *   created in the table.
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call. The library behaviour is undefined
+ *   if this constraint is not satisfied. In case of string
+ *   key, the length is truncated to the max length specified
+ *   at key definition through fmrtDefineKey().
+ * After those mandatory parameters, there is a list of
+ * parameters that are used to update the fields of the
+ * entry that is going to be modified. Parameters are ordered
+ * according to the same order used in definition (i.e.
+ * in fmrtDefinFields() library call). Be aware that
+ * parameters number and types shall be correct, otherwise
+ * the call may cause run-time errors. All parameters shall be
+ * included in the call, but the only ones that will be updated
+ * are those pointed by the paramMask, as explained above.
+ * In case of string parameters, the length is truncated to
+ * the max length specified at field definition through
+ * fmrtDefineFields().
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been correctly inserted or updated into
+ *   the tree
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   The FMRT tree is full, or there is not enough memory
+ *   to grow the string heap (see fmrtDefineStringHeap());
+ *   the table is left untouched
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element; the table is left untouched
+ ***********************************************************/
+fmrtResult fmrtCreateModify (fmrtId tableId, fmrtParamMask paramMask, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    uint8_t     statOp = FMRTSTATMODIFY;
+    va_list         args,
+                    check;
+    fmrtId          i;
+    uint8_t         j,maxLen,duplKey;
+    void            *currentPtr,
+                    *fieldsPtr;
+    fmrtResult      res;
+    fmrtIndex       newElement = FMRTNULLPTR,
+                    rebalIndex;
+    uint32_t        keyInt,
+                    fieldInt[MAXFMRTFIELDNUM];
+    int32_t         keySigned,
+                    fieldSigned[MAXFMRTFIELDNUM];
+    double          keyDouble,
+                    fieldDouble[MAXFMRTFIELDNUM];
+    time_t          keyTimestamp,
+                    fieldTimestamp[MAXFMRTFIELDNUM];
+    char            keyChar,
+                    fieldChar[MAXFMRTFIELDNUM],
+                    *string,
+                    keyString[MAXFMRTSTRINGLEN+1],
+                    fieldString[MAXFMRTFIELDNUM][MAXFMRTSTRINGLEN+1];
+    uint64_t        heapLen;
+    fmrtParamMask    mask;
+    fmrtNodeTraversalStack *traversal,
+                           *rebalPtr;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLCREATEMODIFY);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, statOp, start, FMRTFROZEN));
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Initialize the list of variable arguments in order to read the key first */
+    va_start (args,paramMask);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyInt = va_arg (args, uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySigned = va_arg (args, int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDouble = va_arg (args, double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyChar = (unsigned char) va_arg (args,int);
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            string = va_arg (args,char*);
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            strncpy (keyString,string,maxLen);
+            keyString[maxLen-1] = '\0';
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                keyTimestamp = va_arg (args, time_t);
+            else
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestamp = mktime (&TimeFromString);
+                else
+                    keyTimestamp = 0;
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One argument for each component, the key is stored encoded into keyString (see readCompositeArg()) */
+            readCompositeArg (i, &args, keyString);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+
+    /* Now read the variable list of arguments and use them to fill in the fields (a copy is kept to check unique values) */
+    va_copy (check, args);
+    for (j=0; j<Tables[i].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[i].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                fieldInt[j] = va_arg (args,uint32_t);
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                fieldSigned[j] = va_arg (args,int32_t);
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                fieldDouble[j] = va_arg (args,double);
+                break;
+            }
+            case FMRTCHAR:
+            {
+                fieldChar[j] = (unsigned char) va_arg (args,int);
+                break;
+            }
+            case FMRTSTRING:
+            {   /* In case of string exceeding the maximum length it is automatically truncated */
+                string = va_arg (args,char*);
+                maxLen = Tables[i].fields[j].len;       /* This field is max string length + trailing 0 */
+                strncpy (fieldString[j],string,maxLen);
+                fieldString[j][maxLen-1] = '\0';
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> read raw timestamp from argument */
+                    fieldTimestamp[j] = va_arg (args,time_t);
+                else
+                {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                    struct tm   TimeFromString;
+                    string = va_arg (args, char*);
+                    if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                        fieldTimestamp[j] = mktime (&TimeFromString);
+                    else
+                        fieldTimestamp[j] = 0;
+                }
+                break;
+            }
+        }   /* switch (Tables[i].fields[j].type) */
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+    va_end (args);
+
+    /* call searchElem() internal function to look for the element and provide error if result is FMRTKO */
+
+    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTKO)
+    {   /* This is a blocking error -> release traversal stack, clear the lock and exit */
+        va_end (check);
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, statOp, start, FMRTKO));
+    }
+
+    /* If the element is already present set duplKey to 1 and use input parameter mask*/
+    if (res==FMRTOK)
+    {   /* the element exists and shall be modified changing only parameters specified by paramMask */
+        duplKey = 1;
+        mask = paramMask;
+    }
+    else
+    {   /* the element does not exist and shall be created - mask is set to all 1's in order to set all elements */
+        duplKey = 0;
+        mask = -1;
+        statOp = FMRTSTATCREATE;
+    }
+
+    /* Values of fields with a unique secondary index shall not be present in other elements */
+    res = checkUniqueArgs (i, &check, mask, (duplKey) ? traversal->index : FMRTNULLPTR);
+    va_end (check);
+
+    /* The string heap shall have room for the new strings before the element is changed */
+    if (res==FMRTOK)
+    {
+        for (j=0, heapLen=0; j<Tables[i].numFields; j++)
+            if ( (Tables[i].fields[j].type==FMRTSTRING) && ((mask>>j)&1) )
+                heapLen += stringHeapLen (i, j, fieldString[j]);
+        res = reserveStringHeap (i, heapLen);
+    }
+    if (res!=FMRTOK)
+    {
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, statOp, start, res));
+    }
+
+    /* traversal is a pointer to a LIFO structure, while duplKey specifies if the key */
+    /* is already present in the table (and shall be overwritten), or is new. In the  */
+    /* former case the top element of traversal stack points directly to the index    */
+    /* in the FMRT structure, while in the latter it points to the parent on which     */
+    /* insertion shall be done                                                        */
+
+    if (duplKey)
+    {   /* the element is still present, overwrite data contained into the internal structure */
+        /* since the element has been found traversal cannot be NULL in this case             */
+        currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+        /* Secondary indexes of the fields to be updated are detached until the new values are stored */
+        unlinkIndexes (i, traversal->index, mask);
+    }   /* if (duplKey) */
+    else
+    {   /* the element is not present -> create it */
+        /* Check if this is the first insertion */
+        if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
+        {   /* Initialize Empty elements list */
+            res = initEmptyList(i);
+            if (res!=FMRTOK)
+            {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
+                clearNodeTraversalStack (traversal);
+                /* Clear the lock before exiting */
+                unlockTable (i);
+                return (recordStats (i, statOp, start, res));
+            }
+        }   /* if ( (Tables[i].fmrtData==NULL) ... */
+
+        /* If the table is full and eviction is enabled, free a slot by evicting an element; */
+        /* the tree has changed, therefore the path to the new element is searched again     */
+        if ( (Tables[i].currentNumElem==Tables[i].tableMaxElem) && (evictElem(i)==FMRTOK) )
+        {
+            clearNodeTraversalStack (traversal);
+            searchElem (i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal);
+        }
+
+        /* Get an empty element from the list of empty nodes */
+        if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
+        {   /* Not able to fetch an empty element - Probably the table is full */
+            clearNodeTraversalStack (traversal);
+            /* Clear the lock before exiting */
+            unlockTable (i);
+            return (recordStats (i, statOp, start, FMRTOUTOFMEMORY));
+        }
+
+        /* Link the new element to the existing structure (if present) */
+        if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
+            Tables[i].fmrtRoot = (Tables[i].engine==FMRTENGINEAVL) ? newElement : FMRTNULLPTR;   /* Other engines: see btInsert() and hashInsert() below */
+        else if (traversal->go == LEFT)
+        {   /* the stack exists and the path from parent node goes through the left subtree */
+            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+            *((fmrtIndex*)currentPtr) = newElement;
+        }
+        else
+        {   /* the stack exists and the path from parent node goes through the right subtree */
+            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
+            *((fmrtIndex*)currentPtr) = newElement;
+        }
+
+        /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
+        currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+
+        /* Insert null pointers to left and right subtree */
+        *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
+        *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+
+        Tables[i].status = NOTEMPTY;
+        Tables[i].currentNumElem += 1;
+    }   /* else if (duplKey) */
+
+    /* Now currentPtr points to the element that shall be filled, in both cases of new element or existing one */
+    /* Fill the element with the key and the fields read from CSV file */
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
+            break;
+        }
+        case FMRTCHAR:
+        {
+            *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Please observe that keyString has been truncated when it has been read from the input csv file */
+            strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
+            *((uint64_t *)(currentPtr+Tables[i].key.delta-sizeof(uint64_t))) = keyPrefix (keyString);
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
+            break;
+        }
+        case FMRTCOMPOSITE:
+        {   /* keyString holds the encoded key (see readCompositeArg()) */
+            memcpy (currentPtr+Tables[i].key.delta, keyString, Tables[i].key.len);
+            break;
+        }
+    }   /* switch (Tables[i].key.type) */
+
+    fieldsPtr = fieldsOf (i, currentPtr);
+    /* Now read the variable list of arguments and use them to fill in the fields */
+    for (j=0; j<Tables[i].numFields; j++)
+    {   /* Loop through all fields */
+        switch (Tables[i].fields[j].type)
+        {
+            case FMRTINT:
+            {
+                if (mask%2)
+                    *((uint32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldInt[j];
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                if (mask%2)
+                    *((int32_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldSigned[j];
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                if (mask%2)
+                    *((double *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldDouble[j];
+                break;
+            }
+            case FMRTCHAR:
+            {
+                if (mask%2)
+                    *((char *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldChar[j];
+                break;
+            }
+            case FMRTSTRING:
+            {   /* Please observe that fieldsString[j] has been truncated when it has been read from the input csv file */
+                if (mask%2)
+                    storeString (i, fieldsPtr, j, fieldString[j]);
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (mask%2)
+                    *((time_t *)(fieldsPtr+Tables[i].fields[j].delta)) = fieldTimestamp[j];
+                break;
+            }
+        }   /* switch (Tables[i].fields[j].type) */
+        mask>>=1;
+    }   /* for (j=0; j<Tables[i].numFields; j++) */
+
+    /* Refresh subtree aggregates: a new leaf is initialized here, along with its     */
+    /* deadline (ancestors are refreshed while rebalancing), an updated element       */
+    /* requires refreshing the whole path                                             */
+    if (duplKey==0)
+    {
+        if (Tables[i].engine==FMRTENGINEBTREE)
+            btInsert (i,newElement);
+        else if (Tables[i].engine==FMRTENGINEHASH)
+            hashInsert (i,newElement);
+        linkIndexes (i,newElement,(fmrtParamMask)-1);
+        updateNodeAggregate (i,newElement);
+        initElemExpiry (i,newElement);
+        if (FMRTPROBEENABLED(insert))
+            FMRTPROBE4 (insert, Tables[i].tableId, traceElemHash(i,newElement), newElement, Tables[i].currentNumElem+1);
+        referenceElem (i,newElement);
+    }
+    else
+    {
+        linkIndexes (i,traversal->index,paramMask);
+        updatePathAggregate (i,traversal);
+        referenceElem (i,traversal->index);
+    }
+
+    /* Element has been inserted - if duplKey==0 (i.e. new element) go through the   */
+    /* traversal LIFO structure and rebalance fmrt tree starting from the bottom and  */
+    /* going up to the root. This shal not be done if duplKey==1 (the element already*/
+    /* exists and it is assumed that it is already balanced                          */
+    if (duplKey==0)
+    {
+        rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
+        while (rebalPtr!=NULL)
+        {   /* rebalance the subtree whose root is the current node */
+            rebalIndex = rebalanceSubTree (i,rebalPtr->index,FMRTROTINSERT);  /* the root might change due to rotations */
+            /* go up to the parent */
+            rebalPtr = rebalPtr->next;
+            if (rebalPtr!=NULL)
+            {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
+                if (rebalPtr->go == LEFT)
+                    currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
+                else
+                    currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
+                /* The proper pointer is updated with the output of the rebalance structure */
+                *((fmrtIndex*)currentPtr) = rebalIndex;
+            }   /* if (rebalPtr!=NULL) */
+            else
+                /* There is no parent node - Rotation implies a change of the fmrt root pointer */
+                Tables[i].fmrtRoot = rebalIndex;
+        }   /* while (rebalPtr!=NULL) */
+    }   /* if (duplKey==0) */
+
+    #ifdef FMRTDEBUG
+    printf ("\n\nCreateModify node at index: %llu\n",(unsigned long long)traversal->index);
+    __fmrtDebugPrintNode (Tables[i].tableId, traversal->index);
+    printf ("Path from node up to the root:\n");
+    __fmrtPrintStack(i,traversal);
+    #endif
+
+    /* clear node traversal LIFO structure allocated by searchElem() and exit */
+    clearNodeTraversalStack (traversal);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (recordStats (i, statOp, start, FMRTOK));
+
+}
+
+
+/***********************************************************
+ * fmrtDelete()
+ * ---------------------------------------------------------
+ * This library call is used to delete an existing entry
+ * from the fmrt tree. It is a call with two parameters,
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call. The library behaviour is undefined
+ *   if this constraint is not satisfied. In case of string
+ *   key, the length is truncated to the max length specified
+ *   at key definition through fmrtDefineKey().
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been correctly deleted from the tree
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the table
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ ***********************************************************/
+fmrtResult fmrtDelete (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    va_list     args;
+    fmrtId      i;
+    uint8_t     maxLen;
+    fmrtResult   res;
+    uint32_t    keyInt;
+    int32_t     keySigned;
+    double      keyDouble;
+    time_t      keyTimestamp;
+    char        keyChar,
+                *string,
+                keyString[MAXFMRTSTRINGLEN+1];
+    fmrtNodeTraversalStack  *traversal;
+
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDELETE);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATDELETE, start, FMRTFROZEN));
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Initialize the list of variable arguments in order to read the key */
+    va_start (args,tableId);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyInt = va_arg (args, uint32_t);
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySigned = va_arg (args, int32_t);
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDouble = va_arg (args, double);
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyChar = (unsigned char) va_arg (args,int);
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            string = va_arg (args,char*);
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            strncpy (keyString,string,maxLen);
+            keyString[maxLen-1] = '\0';
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+                /* time format empty --> read raw timestamp from argument */
+                keyTimestamp = va_arg (args, time_t);
+            else
+            {   /* convert string read from argument to raw timestamp according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestamp = mktime (&TimeFromString);
+                else
+                    keyTimestamp = 0;
+            }
+            break;
+        }   /* case FMRTTIMESTAMP */
+        case FMRTCOMPOSITE:
+        {   /* One argument for each component, the key is stored encoded into keyString (see readCompositeArg()) */
+            readCompositeArg (i, &args, keyString);
+            break;
+        }   /* case FMRTCOMPOSITE */
+    }   /* switch (Tables[i].key.type) */
+    va_end (args);
+
+    /* call searchElem() internal function to look for the element and provide error if result is not FMRTOK */
+    if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) != FMRTOK)
+    {
+        clearNodeTraversalStack (traversal);
+        /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATDELETE, start, res));
+    }
+
+    /* The element was found and traversal is a pointer to a LIFO structure */
+    /* whose top element contains the index of the node to be deleted       */
+    deleteElem (i, traversal);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATDELETE, start, FMRTOK));
+}
+
+
+/***********************************************************
+ * fmrtImportTableCsv()
+ * ---------------------------------------------------------
+ * This library call is used to import the content of a
+ * given file in CSV format (specified by the file pointer
+ * given by the second parameter) into the table whose id
+ * is provided by the first parameter.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - filePtr
+ *   pointer to a file opened by the caller in read
+ *   mode. It cannot be NULL, otherwise an error will be
+ *   provided
+ * - separator
+ *   It is a char specified by the caller that is recognized
+ *   as a separator between consecutive fields into the
+ *   input CSV file
+ * - lines
+ *   is a pointer to a fmrtIndex parameter that is provided
+ *   back by the call. It contains either the total number
+ *   of lines read from the file (if result is FMRTOK) or the
+ *   line number affected by the error (in case of error)
+ * Please note that the file shall be opened before calling
+ * this function, otherwise a run-time error will occur.
+ * Similarly, the function call does not close the input
+ * file, which must be closed by the caller.
+ * Data read from the file are appended to existing data
+ * in the table (if the input table is not empty).
+ * In case of duplicate key, the entry is overwritten:
+ * no errors are provided in this case
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table has been successfully imported from CSV file.
+ *   The last parameter contains the total number of lines
+ *   read from the file
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller or when the specified file
+ *   pointer is NULL. In those cases the last parameter
+ *   provides 0. This result code is also obtained when
+ *   an error is detected while reading input lines
+ *   from the file (e.g. incomplete line); in such cases
+ *   the last parameter reports the line where the error
+ *   has been detected. Elements read from the file up to
+ *   the wrong line are inserted into the table
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   while inserting data into the table from the CSV file
+ *   the maximum number of elements has been reached (the
+ *   maximum number of elements is specified at table
+ *   definition as a parameter of fmrtDefineTable() ), or
+ *   there is not enough memory to grow the string heap
+ *   (see fmrtDefineStringHeap()). The last parameter
+ *   identifies the line in the input file where data import
+ *   was stopped.
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ * - FMRTDUPLICATEVALUE
+ *   The value of a field with a unique secondary index
+ *   (see fmrtDefineIndex()) is already present in another
+ *   element. The last parameter identifies the line in the
+ *   input file where data import was stopped
+ ***********************************************************/
+fmrtResult fmrtImportTableCsv (fmrtId tableId, FILE *filePtr, char separator, fmrtIndex *lines)
+{
+    /* Local Variables */
+    uint64_t    start;
+    char                    *p,
+                            *q,
+                            keyChar,
+                            keyString[MAXFMRTSTRINGLEN+1],
+                            inputString[MAXCSVLINELEN];
+    void                   *currentPtr,
+                           *fieldsPtr,
+                           *rowPtr;
+    fmrtId                  i;
+    uint8_t                 j, duplKey, maxLen;
+    uint32_t                keyInt,
+                            fieldsLen;
+    int32_t                 keySigned;
+    double                  keyDouble;
+    time_t                  keyTimestamp;
+    fmrtKeyValue            value;
+    fmrtResult              res;
+    fmrtIndex               newElement = FMRTNULLPTR,
+                            rebalIndex;
+    fmrtNodeTraversalStack *traversal,
+                           *rebalPtr;
+
+    /* Reset line counter */
+    *lines=0;
+
+    /* If file pointer is NULL, return FMRTKO */
+    if (filePtr==NULL)
+        return (FMRTKO);
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLIMPORTTABLECSV);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATIMPORT, start, FMRTFROZEN));
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Allocate a buffer that will be used to store data read line by line (strings at their max length) */
+    for (j=0, fieldsLen=0; j<Tables[i].numFields; j++)
+        fieldsLen += Tables[i].fields[j].len;
+    if  ( (rowPtr=(void *) malloc(fieldsLen)) == NULL)
+    {   /* Not enough system memory to read the row -> clear the lock and exit */
+        unlockTable (i);
+        return (recordStats (i, FMRTSTATIMPORT, start, FMRTOUTOFMEMORY));
+    }
+    Tables[i].row = rowPtr;
+
+    /* Read lines from CSV input file and fill the structure */
+    while (fgets (inputString,MAXCSVLINELEN,filePtr))
+    {
+        (*lines) += 1;
+        /* skip empty lines */
+        if (inputString[0] == '\0')
+            continue;
+
+        /* skip leading spaces and tabs */
+        p = inputString;
+        while ( (*p==' ') || (*p=='\t') )
+            p++;
+
+        /* Check whether this is an empty line or a comment and, if so, skip this line */
+        if ( (*p=='\0') || (*p=='#') )
+            continue ;
+
+        /* the line is neither a comment nor an empty line - therefore we assume it is a valid line */
+        for (q=p; (*q!='\0')&&(*q!=separator)&&(*q!='\n'); q+=1); /* stop at EOL or at separator */
+        if ( (p==q) && (*q=='\n') )
+            continue;
+        *q = '\0';  /* p and q now points to the beginning and to the end of the first parameter, which should be the key */
+
+        switch (Tables[i].key.type)
+        {
+            case FMRTINT:
+            {
+                keyInt = atoi (p);
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                keySigned = atoi (p);
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                keyDouble = atof (p);
+                break;
+            }
+            case FMRTCHAR:
+            {
+                keyChar = *p;
+                break;
+            }
+            case FMRTSTRING:
+            {   /* Read the key and truncate to the maximum length specified during definition */
+                maxLen = Tables[i].key.len;    /* This field is max string length + trailing 0 */
+                strncpy (keyString,p,maxLen);
+                keyString[maxLen-1] = '\0';
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> read raw timestamp from input line */
+                    keyTimestamp = atol (p);
+                else
+                {   /* convert string read from input line to raw timestamp according to fmrtTimeFormat */
+                    struct tm   TimeFromString;
+                    if (strptime (p, fmrtTimeFormat, &TimeFromString) != NULL)
+                        keyTimestamp = mktime (&TimeFromString);
+                    else
+                        keyTimestamp = 0;
+                }
+                break;
+            }   /* case FMRTTIMESTAMP */
+            case FMRTCOMPOSITE:
+            {   /* The components of the key take consecutive columns, q is moved to the end of the last one */
+                if ( (q=parseCompositeKey (i, p, q, separator, keyString)) == NULL)
+                {   /* This is a blocking error -> clear the lock and exit */
+                    free (Tables[i].row);
+                    Tables[i].row = NULL;
+                    unlockTable (i);
+                    return (recordStats (i, FMRTSTATIMPORT, start, FMRTKO));
+                }
+                break;
+            }   /* case FMRTCOMPOSITE */
+        }   /* switch (Tables[i].key.type) */
+
+        /* Restore pointer at the beginning of the buffer to be filled up with relevat fields and clear data */
+        rowPtr = Tables[i].row;
+        memset (rowPtr,0,fieldsLen);
+        /* Now loop through all fields and fill the buffer: fields are packed, therefore */
+        /* numeric values are not aligned and they are copied (see storeRow())           */
+        for (j=0; j<Tables[i].numFields; j++)
+        {
+            p=q+1;
+            if (*p=='\0')
+                break;
+
+            for (q=p; (*q!='\0')&&(*q!=separator)&&(*q!='\n'); q+=1); /* stop at EOL or at separator */
+            *q = '\0';  /* p and q now points to the beginning and to the end of the j-th parameter  */
+
+            switch (Tables[i].fields[j].type)
+            {
+                case FMRTINT:
+                {
+                    value.keyInt = atoi (p);
+                    memcpy (rowPtr, &(value.keyInt), sizeof (uint32_t));
+                    rowPtr += sizeof (uint32_t);
+                    break;
+                }
+                case FMRTSIGNED:
+                {
+                    value.keySigned = atoi (p);
+                    memcpy (rowPtr, &(value.keySigned), sizeof (int32_t));
+                    rowPtr += sizeof (int32_t);
+                    break;
+                }
+                case FMRTDOUBLE:
+                {
+                    value.keyDouble = atof (p);
+                    memcpy (rowPtr, &(value.keyDouble), sizeof (double));
+                    rowPtr += sizeof (double);
+                    break;
+                }
+                case FMRTCHAR:
+                {
+                    *((char *)rowPtr) = *p;
+                    rowPtr += sizeof (char);
+                    break;
+                }
+                case FMRTSTRING:
+                {   /* In case of string exceeding the maximum length it is automatically truncated */
+                    maxLen = Tables[i].fields[j].len;    /* This field is max string length + trailing 0 */
+                    strncpy ((char*)rowPtr,p,maxLen);
+                    rowPtr += maxLen-1;
+                    *((char*)rowPtr) = '\0';
+                    rowPtr +=1;
+                    break;
+                }
+            case FMRTTIMESTAMP:
+            {
+                if (fmrtTimeFormat[0]=='\0')
+                    /* time format empty --> read raw timestamp from input line */
+                    value.keyTimestamp = atol (p);
+                else
+                {   /* convert string read from input line to raw timestamp according to fmrtTimeFormat */
+                    struct tm   TimeFromString;
+                    if (strptime (p, fmrtTimeFormat, &TimeFromString) != NULL)
+                        value.keyTimestamp = mktime (&TimeFromString);
+                    else
+                        value.keyTimestamp = 0;
+                }
+                memcpy (rowPtr, &(value.keyTimestamp), sizeof (time_t));
+                rowPtr += sizeof (time_t);
+                break;
+            }   /* case FMRTTIMESTAMP */
+            }   /* switch (Tables[i].fields[j].type) */
+        }   /* for (j=0; j<Tables[i].numFields; j++) */
+
+        if (j<Tables[i].numFields)
+        {   /* This is a blocking error -> clear the lock and exit */
+            free (Tables[i].row);
+            Tables[i].row = NULL;
+            unlockTable (i);
+            return (recordStats (i, FMRTSTATIMPORT, start, FMRTKO));
+        }
+
+        /* call searchElem() internal function to look for the element and provide error if result is FMRTKO */
+        duplKey = 0;
+        if ( (res=searchElem(i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal)) == FMRTKO)
+        {   /* This is a blocking error -> release resources, clear the lock and exit */
+            clearNodeTraversalStack (traversal);
+            free (Tables[i].row);
+            Tables[i].row = NULL;
+            /* Clear the lock before exiting */
+            unlockTable (i);
+            return (recordStats (i, FMRTSTATIMPORT, start, FMRTKO));
+        }
+
+        /* If the element is already present set duplKey to 1 */
+        if (res==FMRTOK)
+            duplKey = 1;
+
+        /* Values of fields with a unique secondary index shall not be present in other elements */
+        if (checkUniqueRow (i, Tables[i].row, (duplKey) ? traversal->index : FMRTNULLPTR) != FMRTOK)
+        {   /* This is a blocking error -> release resources, clear the lock and exit */
+            clearNodeTraversalStack (traversal);
+            free (Tables[i].row);
+            Tables[i].row = NULL;
+            /* Clear the lock before exiting */
+            unlockTable (i);
+            return (recordStats (i, FMRTSTATIMPORT, start, FMRTDUPLICATEVALUE));
+        }
+
+        /* The string heap shall have room for the strings of the row before the element is changed */
+        if (reserveStringRow (i, Tables[i].row) != FMRTOK)
+        {   /* This is a blocking error -> release resources, clear the lock and exit */
+            clearNodeTraversalStack (traversal);
+            free (Tables[i].row);
+            Tables[i].row = NULL;
+            /* Clear the lock before exiting */
+            unlockTable (i);
+            return (recordStats (i, FMRTSTATIMPORT, start, FMRTOUTOFMEMORY));
+        }
+
+        /* traversal is a pointer to a LIFO structure, while duplKey specifies if the key */
+        /* is already present in the table (and shall be overwritten), or is new. In the  */
+        /* former case the top element of traversal stack points directly to the index    */
+        /* in the FMRT structure, while in the latter it points to the parent on which     */
+        /* insertion shall be done                                                        */
+
+        if (duplKey)
+        {   /* the element is already present, overwrite data contained into the internal structure with those read from CSV */
+            /* since the element has been found traversal cannot be NULL in this case */
+            currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+            /* Secondary indexes are detached until the new values are stored */
+            unlinkIndexes (i, traversal->index, (fmrtParamMask)-1);
+        }   /* if (duplKey) */
+        else
+        {   /* the element is not present -> create it */
+            /* Check if this is the first insertion */
+            if ( (Tables[i].fmrtData==NULL) || (Tables[i].status<NOTEMPTY) )
+            {   /* Initialize Empty elements list */
+                res = initEmptyList(i);
+                if (res!=FMRTOK)
+                {   /* Not able to allocate memory and initialize empty list - very likely we have not enough memory free */
+                    clearNodeTraversalStack (traversal);
+                    free (Tables[i].row);
+                    Tables[i].row = NULL;
+                    /* Clear the lock before exiting */
+                    unlockTable (i);
+                    return (recordStats (i, FMRTSTATIMPORT, start, res));
+                }
+            }   /* if ( (Tables[i].fmrtData==NULL) ... */
+
+            /* If the table is full and eviction is enabled, free a slot by evicting an element; */
+            /* the tree has changed, therefore the path to the new element is searched again     */
+            if ( (Tables[i].currentNumElem==Tables[i].tableMaxElem) && (evictElem(i)==FMRTOK) )
+            {
+                clearNodeTraversalStack (traversal);
+                searchElem (i, keyInt, keySigned, keyDouble, keyChar, keyString, keyTimestamp, &traversal);
+            }
+
+            /* Get an empty element from the list of empty nodes */
+            if ( (newElement=getEmptyElem(i)) == FMRTNULLPTR)
+            {   /* Not able to fetch an empty element - Probably the table is full */
+                clearNodeTraversalStack (traversal);
+                free (Tables[i].row);
+                Tables[i].row = NULL;
+                /* Clear the lock before exiting */
+                unlockTable (i);
+                return (recordStats (i, FMRTSTATIMPORT, start, FMRTOUTOFMEMORY));
+            }
+
+            /* Link the new element to the existing structure (if present) */
+            if (traversal==NULL)    /* the stack of nodes traversed is empty -> we are creating the root node (newElement is the root index) */
+                Tables[i].fmrtRoot = (Tables[i].engine==FMRTENGINEAVL) ? newElement : FMRTNULLPTR;   /* Other engines: see btInsert() and hashInsert() below */
+            else if (traversal->go == LEFT)
+            {   /* the stack exists and the path from parent node goes through the left subtree */
+                currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize;
+                *((fmrtIndex*)currentPtr) = newElement;
+            }
+            else
+            {   /* the stack exists and the path from parent node goes through the right subtree */
+                currentPtr = Tables[i].fmrtData + (traversal->index)*Tables[i].elemSize + sizeof(fmrtIndex);
+                *((fmrtIndex*)currentPtr) = newElement;
+            }
+
+            /* Set currentPtr to point to this new element, which is always a leaf (at least initially) */
+            currentPtr = Tables[i].fmrtData + newElement*Tables[i].elemSize;
+
+            /* Insert null pointers to left and right subtree */
+            *((fmrtIndex*)currentPtr) = FMRTNULLPTR;
+            *((fmrtIndex*)(currentPtr+sizeof(fmrtIndex))) = FMRTNULLPTR;
+
+            Tables[i].status = NOTEMPTY;
+            Tables[i].currentNumElem += 1;
+        }   /* else if (duplKey) */
+
+        /* Now currentPtr points to the element that shall be filled, in both cases of new element or existing one */
+        /* Fill the element with the key and the fields read from CSV file */
+        switch (Tables[i].key.type)
+        {
+            case FMRTINT:
+            {
+                *((uint32_t *)(currentPtr+Tables[i].key.delta)) = keyInt;
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                *((int32_t *)(currentPtr+Tables[i].key.delta)) = keySigned;
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                *((double *)(currentPtr+Tables[i].key.delta)) = keyDouble;
+                break;
+            }
+            case FMRTCHAR:
+            {
+                *((char *)(currentPtr+Tables[i].key.delta)) = keyChar;
+                break;
+            }
+            case FMRTSTRING:
+            {   /* Please observe that keyString has been truncated when it has been read from the input csv file */
+                strcpy ((char *)(currentPtr+Tables[i].key.delta),keyString);
+                *((uint64_t *)(currentPtr+Tables[i].key.delta-sizeof(uint64_t))) = keyPrefix (keyString);
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                *((time_t *)(currentPtr+Tables[i].key.delta)) = keyTimestamp;
+                break;
+            }
+            case FMRTCOMPOSITE:
+            {   /* keyString holds the encoded key (see readCompositeArg()) */
+                memcpy (currentPtr+Tables[i].key.delta, keyString, Tables[i].key.len);
+                break;
+            }
+        }   /* switch (Tables[i].key.type) */
+
+        fieldsPtr = fieldsOf (i, currentPtr);
+        /* Now copy the fields copied into buffer into the element */
+        storeRow (i, fieldsPtr, Tables[i].row);
+
+        /* Refresh subtree aggregates: a new leaf is initialized here, along with its     */
+        /* deadline (ancestors are refreshed while rebalancing), an updated element       */
+        /* requires refreshing the whole path                                             */
+        if (duplKey==0)
+        {
+            if (Tables[i].engine==FMRTENGINEBTREE)
+                btInsert (i,newElement);
+            else if (Tables[i].engine==FMRTENGINEHASH)
+                hashInsert (i,newElement);
+            linkIndexes (i,newElement,(fmrtParamMask)-1);
+            updateNodeAggregate (i,newElement);
+            initElemExpiry (i,newElement);
+            if (FMRTPROBEENABLED(insert))
+                FMRTPROBE4 (insert, Tables[i].tableId, traceElemHash(i,newElement), newElement, Tables[i].currentNumElem+1);
+            referenceElem (i,newElement);
+        }
+        else
+        {
+            linkIndexes (i,traversal->index,(fmrtParamMask)-1);
+            updatePathAggregate (i,traversal);
+            referenceElem (i,traversal->index);
+        }
+
+        /* Element has been inserted - if duplKey==0 (i.e. new element) go through the   */
+        /* traversal LIFO structure and rebalance fmrt tree starting from the bottom and  */
+        /* going up to the root. This shal not be done if duplKey==1 (the element already*/
+        /* exists and it is assumed that it is already balanced                          */
+        if (duplKey==0)
+        {
+            rebalPtr = traversal;   /* start traversing from the top of the stack, i.e. the parent of the node just inserted) */
+            while (rebalPtr!=NULL)
+            {   /* rebalance the subtree whose root is the current node */
+                rebalIndex = rebalanceSubTree (i,rebalPtr->index,FMRTROTINSERT);  /* the root might change due to rotations */
+                /* go up to the parent */
+                rebalPtr = rebalPtr->next;
+                if (rebalPtr!=NULL)
+                {   /* There is a parent node - update pointer (left or right depending on the content of traversal structure) */
+                    if (rebalPtr->go == LEFT)
+                        currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize;
+                    else
+                        currentPtr = Tables[i].fmrtData + (rebalPtr->index)*Tables[i].elemSize+sizeof(fmrtIndex);
+                    /* The proper pointer is updated with the output of the rebalance structure */
+                    *((fmrtIndex*)currentPtr) = rebalIndex;
+                }   /* if (rebalPtr!=NULL) */
+                else
+                    /* There is no parent node - Rotation implies a change of the fmrt root pointer */
+                    Tables[i].fmrtRoot = rebalIndex;
+            }   /* while (rebalPtr!=NULL) */
+        }   /* if (duplKey==0) */
+
+        clearNodeTraversalStack (traversal);
+        FMRTPROBE3 (import__line, Tables[i].tableId, *lines, duplKey);
+
+    }   /* while (fgets (inputString)... */
+
+    /* Release memory allocated for row, clear the lock and exit */
+    free (Tables[i].row);
+    Tables[i].row=NULL;
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATIMPORT, start, FMRTOK));
+}
+
+
+/***********************************************************
+ * fmrtExportTableCsv()
+ * ---------------------------------------------------------
+ * This library call is used to export the content of the
+ * given table into a specified file in CSV format.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - filePtr
+ *   pointer to a file opened by the caller in write/append
+ *   mode. The output will be written on that file. If NULL
+ *   output is written on stdout
+ * - separator
+ *   It is a char specified by the caller that is used to
+ *   separate fields into the output
+ * - selectedOrder
+ *   it can assume the following values: FMRTASCENDING, to
+ *   export data in ascending order with respect to the key,
+ *   FMRTDESCENDING to use descending order, and
+ *   FMRTOPTIMIZED to export data using an order optimized
+ *   to speed up data reload through fmrtImportTableCsv().
+ *   If an unrecognized value is specified, by default the
+ *   call will export data assuming FMRTOPTIMIZED.
+ * Please note that the file shall be opened before calling
+ * this function, otherwise a run-time error will occur.
+ * Similarly, the function call does not close the output
+ * file, which must be closed by the caller
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Export was successful
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   There is not enough memory to allocate data structures
+ *   needed to export the table in FMRTOPTIMIZED order or,
+ *   for tables using the hash engine, to sort the elements
+ ***********************************************************/
+fmrtResult fmrtExportTableCsv (fmrtId tableId, FILE *filePtr, char separator, uint8_t selectedOrder)
+{
+    /* Local Variables */
+    uint64_t    start;
+    fmrtId      i;
+    uint8_t     j;
+    fmrtResult   res;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLEXPORTTABLECSV);
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+    FMRTPROBE2 (export__start, Tables[i].tableId, Tables[i].currentNumElem);
+
+    /* if file pointer is NULL, print output on stdout */
+    if (filePtr==NULL)
+        filePtr = stdout;
+
+    fprintf (filePtr, "#Table: %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
+    fprintf (filePtr, "#");
+    printKeyNames (i, filePtr, separator);
+    for (j=0; j<Tables[i].numFields; j++)
+        fprintf (filePtr, "%c%s", separator, Tables[i].fields[j].name);
+    fprintf (filePtr,"\n");
+
+    /* Start recursion from root node (B+-tree: walk the list of leaves, hash: walk the slots) */
+    res = FMRTOK;
+    if (Tables[i].engine==FMRTENGINEBTREE)
+        btExport (i, filePtr, separator, selectedOrder, NULL, NULL, NULL, NULL);
+    else if (Tables[i].engine==FMRTENGINEHASH)
+        res = hashExport (i, filePtr, separator, selectedOrder, NULL, NULL, NULL, NULL);
+    else if ( (selectedOrder==FMRTASCENDING) || (selectedOrder==FMRTDESCENDING) )
+        exportTableRecurse (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder);
+    else
+        res = exportTableOptimized (i, Tables[i].fmrtRoot, filePtr, separator);
+
+    /* Clear the lock before exiting */
+    FMRTPROBE3 (export__done, Tables[i].tableId, res, (start!=0) ? monotonicNs()-start : 0);
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATEXPORT, start, res));
+}
+
+
+/***********************************************************
+ * fmrtExportRangeCsv()
+ * ---------------------------------------------------------
+ * This library call is used to export a subset of the
+ * content of the given table into a specified file in
+ * CSV format. Specifically, the export contains all the
+ * table entries in the range between a minimum and a maximum
+ * key value (specified by the last two parameters).
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - filePtr
+ *   pointer to a file opened by the caller in write/append
+ *   mode. The output will be written on that file. If NULL
+ *   output is written on stdout
+ * - separator
+ *   It is a char specified by the caller that is used to
+ *   separate fields into the output
+ * - selectedOrder
+ *   it can assume the following values: FMRTASCENDING, to
+ *   export data in ascending order with respect to the key,
+ *   FMRTDESCENDING to use descending order. Differently
+ *   from fmrtExportTableCsv(), FMRTOPTIMIZED ordering is
+ *   not supported for ranges. If an unrecognized value is
+ *   specified, by default data will be exported assuming
+ *   FMRTASCENDING order.
+ * - keyMin
+ *   Minimum value of the key. It must be of the same type
+ *   specified at key definition (fmrtDefineKey() call).
+ *   Library call behaviour is undefined if this condition
+ *   is not satisfied
+ * - keyMax
+ *   Maximum value of the key. It must be of the same type
+ *   specified at key definition (fmrtDefineKey() call).
+ *   Library call behaviour is undefined if this condition
+ *   is not satisfied
+ * With FMRTCOMPOSITE keys, keyMin and keyMax take one
+ * argument for each component (see fmrtDefineCompositeKey())
+ * Please note that the file shall be opened before calling
+ * this function, otherwise a run-time error will occur.
+ * Similarly, the function call does not close the output
+ * file, which must be closed by the caller
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Export was successful
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller or when the keyMin parameter
+ *   is greater than keyMax
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   There is not enough memory to sort the elements of a
+ *   table using the hash engine (see fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtExportRangeCsv (fmrtId tableId, FILE *filePtr, char separator, uint8_t selectedOrder, ...)
+{
+    /* Local Variables */
+    uint64_t    start;
+    va_list     args;
+    fmrtId      i;
+    uint8_t     j,maxLen;
+    fmrtResult   res;
+    uint32_t    keyIntMin,
+                keyIntMax;
+    int32_t     keySignedMin,
+                keySignedMax;
+    double      keyDoubleMin,
+                keyDoubleMax;
+    time_t      keyTimestampMin,
+                keyTimestampMax;
+    char        keyCharMin,
+                keyCharMax,
+                keyStringMin[MAXFMRTSTRINGLEN+1],
+                keyStringMax[MAXFMRTSTRINGLEN+1],
+                *string;
+    uint64_t    keyMin,
+                keyMax;
+
+    /* Start time of the call, accounted in the statistics of the table (see fmrtEnableStats()) */
+    start = statsStart ();
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Parse Min and Max key Value (depending on key type) */
+    va_start (args, selectedOrder);
+    switch (Tables[i].key.type)
+    {
+        case FMRTINT:
+        {
+            keyIntMin = va_arg (args, uint32_t);
+            keyIntMax = va_arg (args, uint32_t);
+            if (keyIntMin>keyIntMax)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTSIGNED:
+        {
+            keySignedMin = va_arg (args, int32_t);
+            keySignedMax = va_arg (args, int32_t);
+            if (keySignedMin>keySignedMax)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTDOUBLE:
+        {
+            keyDoubleMin = va_arg (args, double);
+            keyDoubleMax = va_arg (args, double);
+            if (keyDoubleMin>keyDoubleMax)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTCHAR:
+        {
+            keyCharMin = (unsigned char) va_arg (args,int);
+            keyCharMax = (unsigned char) va_arg (args,int);
+            if (keyCharMin>keyCharMax)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTSTRING:
+        {   /* Read the key and truncate to the maximum length specified during definition */
+            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
+            string = va_arg (args,char*);
+            strncpy (keyStringMin,string,maxLen);
+            keyStringMin[maxLen-1] = '\0';
+            string = va_arg (args,char*);
+            strncpy (keyStringMax,string,maxLen);
+            keyStringMax[maxLen-1] = '\0';
+            if (strcmp(keyStringMin,keyStringMax)>0)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTTIMESTAMP:
+        {
+            if (fmrtTimeFormat[0]=='\0')
+            {
+                /* time format empty --> read raw timestamps from arguments */
+                keyTimestampMin = va_arg (args, time_t);
+                keyTimestampMax = va_arg (args, time_t);
+            }
+            else
+            {   /* convert strings read from arguments to raw timestamps according to fmrtTimeFormat */
+                struct tm   TimeFromString;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestampMin = mktime (&TimeFromString);
+                else
+                    keyTimestampMin = 0;
+                string = va_arg (args,char*);
+                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
+                    keyTimestampMax = mktime (&TimeFromString);
+                else
+                    keyTimestampMax = 0;
+            }
+            if (keyTimestampMin>keyTimestampMax)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+        case FMRTCOMPOSITE:
+        {   /* keyMin and keyMax take one argument for each component and are stored encoded */
+            readCompositeArg (i, &args, keyStringMin);
+            readCompositeArg (i, &args, keyStringMax);
+            if (memcmp(keyStringMin,keyStringMax,Tables[i].key.len)>0)
+            {
+                va_end (args);
+                return (recordStats (i, FMRTSTATEXPORT, start, FMRTKO));
+            }
+            break;
+        }
+    }   /* switch (Tables[i].key.type) */
+    va_end (args);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLEXPORTRANGECSV);
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+    FMRTPROBE2 (export__start, Tables[i].tableId, Tables[i].currentNumElem);
+
+    /* if file pointer is NULL, print output on stdout */
+    if (filePtr==NULL)
+        filePtr = stdout;
+
+    fprintf (filePtr, "#Table: %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
+    fprintf (filePtr, "#");
+    printKeyNames (i, filePtr, separator);
+    for (j=0; j<Tables[i].numFields; j++)
+        fprintf (filePtr, "%c%s", separator, Tables[i].fields[j].name);
+    fprintf (filePtr,"\n");
+
+    /* With the B+-tree engine the list of leaves is walked from the first key in the range, */
+    /* with the hash engine the elements in the range are collected and sorted               */
+    res = FMRTOK;
+    if (Tables[i].engine!=FMRTENGINEAVL)
+    {
+        keyMin = normalizeKey (i, keyIntMin, keySignedMin, keyDoubleMin, keyCharMin, keyStringMin, keyTimestampMin);
+        keyMax = normalizeKey (i, keyIntMax, keySignedMax, keyDoubleMax, keyCharMax, keyStringMax, keyTimestampMax);
+        if (Tables[i].engine==FMRTENGINEBTREE)
+            btExport (i, filePtr, separator, selectedOrder, &keyMin, keyStringMin, &keyMax, keyStringMax);
+        else
+            res = hashExport (i, filePtr, separator, selectedOrder, &keyMin, keyStringMin, &keyMax, keyStringMax);
+    }
+    else
+    {   /* Start exporting recursively from the root node (depending on key type) */
+        switch (Tables[i].key.type)
+        {
+            case FMRTINT:
+            {
+                exportRangeRecurseInt (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyIntMin, keyIntMax);
+                break;
+            }
+            case FMRTSIGNED:
+            {
+                exportRangeRecurseSigned (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keySignedMin, keySignedMax);
+                break;
+            }
+            case FMRTDOUBLE:
+            {
+                exportRangeRecurseDouble (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyDoubleMin, keyDoubleMax);
+                break;
+            }
+            case FMRTCHAR:
+            {
+                exportRangeRecurseChar (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyCharMin, keyCharMax);
+                break;
+            }
+            case FMRTSTRING:
+            {
+                exportRangeRecurseString (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyStringMin, keyStringMax);
+                break;
+            }
+            case FMRTTIMESTAMP:
+            {
+                exportRangeRecurseTimestamp (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyTimestampMin, keyTimestampMax);
+                break;
+            }
+            case FMRTCOMPOSITE:
+            {
+                exportRangeRecurseComposite (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyStringMin, keyStringMax);
+                break;
+            }
+        }   /* switch (Tables[i].key.type) */
+    }
+
+
+    /* Clear the lock before exiting */
+    FMRTPROBE3 (export__done, Tables[i].tableId, res, (start!=0) ? monotonicNs()-start : 0);
+    unlockTable (i);
+
+    return (recordStats (i, FMRTSTATEXPORT, start, res));
+}
+
+
+/***********************************************************
+ * fmrtCountEntries()
+ * ---------------------------------------------------------
+ * This library call is used to count the number of elements
+ * stored into the table. It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * It returns the number of elements contained into the
+ * table or FMRTNULLPTR in case of any problem (e.g. tableId
+ * not defined)
+ ***********************************************************/
+fmrtIndex fmrtCountEntries(fmrtId tableId)
+{
+    /* Local variables */
+    fmrtId      i;
+    fmrtIndex    num;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    /* To be completely safe, searchTable() shoud be called by locking    */
+    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
+    /* tries to access a table which is still under definition, therefore */
+    /* we prefer to avoid bottlenecks                                     */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (FMRTNULLPTR);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLCOUNTENTRIES);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* countSubtreeNodes() counts the number of elements recursively, it might require too many iterations in case of large tables */
+    /* num = countSubtreeNodes (i, Tables[i].fmrtRoot); */
+    num = Tables[i].currentNumElem;
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (num);
+}
+
+
+/***********************************************************
+ * fmrtGetMemoryFootPrint()
+ * ---------------------------------------------------------
+ * This library call provides the memory footprint of the
+ * table whose tableId is given as a parameter.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * It returns the number of bytes currently allocated for
+ * the given table (0 in case of any problem, e.g. tableId
+ * not defined). Please note that the array of elements is
+ * allocated at the first insertion. A detailed breakdown
+ * is provided by fmrtGetMemoryInfo()
+ ***********************************************************/
+long fmrtGetMemoryFootPrint(fmrtId tableId)
+{
+    /* Local variables */
+    fmrtMemoryInfo info;
+
+    if (fmrtGetMemoryInfo (tableId, &info)!=FMRTOK)
+        return (0);
+
+    return ( (long) info.allocated );
+}
+
+
+/***********************************************************
+ * fmrtDefineTimeFormat()
+ * ---------------------------------------------------------
+ * This library call allows to change time format
+ * representation of FMRTTIMEFORMAT data handled by the
+ * library.
+ * Please observe that the library manages internally
+ * timestamps using always the linux representation (i.e.
+ * seconds from Epoch, Jan 1st 1970, 00:00:00 UTC), however
+ * it allows changing the format used to display and enter
+ * FMRTTIMEFORMAT data. When a format is specified, then
+ * timestamp keys and fields in fmrtRead(), fmrtCreate(),
+ * etc. must be defined as character strings with the
+ * correct format (e.g. "Mon Jun 21 17:08:55 2021").
+ * The library allows also the usage of raw time format; in
+ * that case, timestamp keys and fields in fmrtXxxx()
+ * routines must be defined as time_t data.
+ * The call takes just one input parameter:
+ * - fmrtFormat
+ *   This is a string representing the desired time format,
+ *   according to the same convention specified by strftime()
+ *   man page (e.g. "%c" for full date and time, "%T" for
+ *   time in HH:MM:YY format, "%F" for date in the format
+ *   YYYY-MM-DD, etc.).
+ *   In case the parameter is either NULL or an empty
+ *   string, then time format is set to raw (i.e. timestamps
+ *   are represented as raw time_t data)
+ * This routine is OPTIONAL. If not called, default time
+ * format will be set to "%c", i.e. current locale.
+ * The routine can be called as many times as desired. This
+ * will not affect internal data representation, but only
+ * data management and display (e.g. the format of timestamp
+ * data in CSV output files).
+ * Finally, observe that timestamp format is GLOBAL, i.e.
+ * it is a configuration that affects all tables
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Time format correctly defined and set
+ * - FMRTKO
+ *   Time format not accepted (e.g. due to wrong fmrtFormat
+ *   parameter)
+ ***********************************************************/
+fmrtResult fmrtDefineTimeFormat(char * fmrtFormat)
+{
+    /* Local Variables */
+    struct tm   TimeFromString;
+    time_t      now;
+    char        TimeDateString[MAXFMRTSTRINGLEN];
+
+    if ( (fmrtFormat==NULL) || (fmrtFormat[0]=='\0') )
+    {
+        fmrtTimeFormat[0] = '\0';
+        return (FMRTOK);
+    }
+
+    /* Try to retrieve current time and to format it according to specified format */
+    /* This is done to understand if the specified format is correct               */
+    time (&now);
+    strftime(TimeDateString, MAXFMRTSTRINGLEN-1, fmrtFormat, localtime(&now));
+    if (strptime (TimeDateString, fmrtFormat, &TimeFromString) == NULL)
+        return (FMRTKO);
+
+    strcpy (fmrtTimeFormat,fmrtFormat);
+    return (FMRTOK);
+
+ }
+
+
+/***********************************************************
+ * fmrtEncodeTimeStamp()
+ * ---------------------------------------------------------
+ * This library call takes an input string representing
+ * a time stamp and provides back the corresponding value
+ * encoded as a time_t (Linux time). The input string shall
+ * be formatted according to the timestamp format defined
+ * through fmrtDefineTimeFormat()
+ * ---------------------------------------------------------
+ * It provides the timestamp encoded as a time_t data or
+ * 0 in case of errors
+ ***********************************************************/
+time_t fmrtEncodeTimeStamp(char * timeStamp)
+{
+    struct tm   TimeFromString;
+
+    if (strptime (timeStamp, fmrtTimeFormat, &TimeFromString) != NULL)
+        return ( mktime(&TimeFromString) );
+    else
+        return (0);
+
+}
+
+
+/***********************************************************
+ * fmrtDecodeTimeStamp()
+ * ---------------------------------------------------------
+ * This library call takes a raw time stamp (i.e. a time_t
+ * data) as first parameter and provides back in the second
+ * parameter a string formatted according to the timestamp
+ * format defined through fmrtDefineTimeFormat().
+ * The string must be allocated before calling this function
+ * ---------------------------------------------------------
+ * It does not return anything
+ ***********************************************************/
+void fmrtDecodeTimeStamp(time_t rawTimeStamp, char * formattedTimeStamp)
+{
+    strftime(formattedTimeStamp, strlen(formattedTimeStamp), fmrtTimeFormat, localtime(&rawTimeStamp));
+    return ;
+}
+
+
+/***********************************************************
+ * fmrtDefineAggregate()
+ * ---------------------------------------------------------
+ * Enable subtree aggregates on a numeric field of a
+ * previously defined table. When enabled, each node of the
+ * fmrt tree keeps count, sum, min and max of the selected
+ * field over the subtree it roots; those values are kept up
+ * to date along the write path and during rotations, and
+ * allow fmrtAggregateRange() to work in O(log(n)).
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   index of the field to be aggregated, according to the
+ *   same order used in fmrtDefineFields() (0 is the first
+ *   field). The field shall be of type FMRTINT, FMRTSIGNED
+ *   or FMRTDOUBLE
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 32 additional bytes
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Aggregate successfully defined
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when fieldIdx does not identify a
+ *   numeric field
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTREDEFPROHIBITED
+ *   An aggregate has been already defined or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineAggregate (fmrtId tableId, uint8_t fieldIdx)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult   res;
+    uint16_t    elemSize;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINEAGGREGATE);
+
+    /* The aggregate cannot be redefined, neither it can be defined once the table has been populated */
+    if ( (Tables[i].aggField!=FMRTNOAGGREGATE) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
+
+    /* Fields shall be already defined and the selected one shall be numeric */
+    if ( (fieldIdx>=Tables[i].numFields) ||
+         ( (Tables[i].fields[fieldIdx].type!=FMRTINT) && (Tables[i].fields[fieldIdx].type!=FMRTSIGNED) && (Tables[i].fields[fieldIdx].type!=FMRTDOUBLE) ) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Append per-node aggregates at the end of each element and update element size */
+    elemSize = Tables[i].elemSize;
+    Tables[i].aggField = fieldIdx;
+    Tables[i].aggDelta = FMRTALIGN (Tables[i].elemSize, FMRTMAXALIGN);
+    Tables[i].elemSize = Tables[i].aggDelta + sizeof (fmrtNodeAggregate);
+
+    /* The array of larger elements shall fit into the memory budget */
+    if (admitMemory (i, 0)!=FMRTOK)
+    {   /* Aggregate is not defined, clear lock before exiting */
+        Tables[i].aggField = FMRTNOAGGREGATE;
+        Tables[i].aggDelta = 0;
+        Tables[i].elemSize = elemSize;
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    chargeMemory (i);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineAggregate() -> TableId: %d - Table[] index: %d - Field: %d\n",Tables[i].tableId,i,fieldIdx);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtAggregateRange()
+ * ---------------------------------------------------------
+ * This library call provides count, sum, min and max of the
+ * aggregated field (see fmrtDefineAggregate()) over all the
+ * entries whose key lies in a given interval. It is a call
+ * with a variable number of arguments. It takes the
+ * following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   index of the aggregated field, i.e. the same value
+ *   passed to fmrtDefineAggregate()
+ * - keyMin, keyMax
+ *   these are two parameters that specify the interval of
+ *   keys (extremes included). They shall be of the same type
+ *   defined by the fmrtDefineKey() call. The library
+ *   behaviour is undefined if this constraint is not
+ *   satisfied
+ * - agg
+ *   pointer to a fmrtAggregate structure filled by the call.
+ *   If no entries are found in the interval, count, sum,
+ *   min and max are all set to 0
+ * The call does not scan the entries in the interval, but it
+ * uses the aggregates stored into the tree nodes, therefore
+ * its complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Aggregates successfully computed
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when keyMin is greater than
+ *   keyMax, when agg is NULL or when fieldIdx does not
+ *   identify the aggregated field
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtAggregateRange (fmrtId tableId, uint8_t fieldIdx, ...)
+{
+    /* Local Variables */
+    va_list         args;
+    fmrtId          i;
+    fmrtResult      res;
+    fmrtKeyValue    keyMin,
+                    keyMax;
+    fmrtAggregate  *agg;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLAGGREGATERANGE);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Parse Min and Max key Value (depending on key type) and the pointer to the result */
+    va_start (args, fieldIdx);
+    readKeyArg (i, &args, &keyMin);
+    readKeyArg (i, &args, &keyMax);
+    agg = va_arg (args, fmrtAggregate *);
+    va_end (args);
+
+    if ( (agg==NULL) || (fieldIdx!=Tables[i].aggField) || (compareKey(i,&keyMin,keyValuePtr(i,&keyMax))>0) )
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Start from an empty result and descend from the root node */
+    agg->count = 0;
+    agg->sum = agg->min = agg->max = 0.0;
+    if (Tables[i].fmrtData!=NULL)
+        aggregateRangeRecurse (i, Tables[i].fmrtRoot, &keyMin, &keyMax, 1, 1, agg);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtFloor()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key lower than or equal to the given key. It is
+ * a call with a variable number of arguments. The first
+ * two parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtFloor (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTFLOOR, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtCeil()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key greater than or equal to the given key. It is
+ * a call with a variable number of arguments. The first
+ * two parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtCeil (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTCEIL, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtPrev()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key strictly lower than the given key
+ * (predecessor). It is a call with a variable number of
+ * arguments. The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtPrev (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTPREV, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtNext()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key strictly greater than the given key
+ * (successor). It is a call with a variable number of
+ * arguments. The first two parameters (always present) are
+ * respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - key
+ *   contains the reference key value. It shall be of the
+ *   same type defined by the fmrtDefineKey() call (it does
+ *   not need to be present in the table)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtRead().
+ * Complexity is O(log(n)) (single descent from the root)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry satisfying the condition
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtNext (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTNEXT, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtMin()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * lowest key in the table. It is a call with a variable
+ * number of arguments. The first parameter (always present)
+ * is:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * After it, there is a pointer that is filled with the key
+ * of the entry found (a char buffer for string keys and for
+ * timestamps when a time format is defined), followed by the
+ * list of pointer parameters that are filled with the
+ * fields, exactly as in fmrtRead().
+ * Complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   The table is empty
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtMin (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTMIN, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtMax()
+ * ---------------------------------------------------------
+ * This library call is used to read the entry with the
+ * greatest key in the table. It is a call with a variable
+ * number of arguments. The first parameter (always present)
+ * is:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * After it, there is a pointer that is filled with the key
+ * of the entry found (a char buffer for string keys and for
+ * timestamps when a time format is defined), followed by the
+ * list of pointer parameters that are filled with the
+ * fields, exactly as in fmrtRead().
+ * Complexity is O(log(n))
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   The table is empty
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtMax (fmrtId tableId, ...)
+{
+    /* Local Variables */
+    va_list     args;
+    fmrtResult  res;
+
+    va_start (args,tableId);
+    res = readNearest (tableId, NEARESTMAX, &args);
+    va_end (args);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtPrefixScan()
+ * ---------------------------------------------------------
+ * This library call looks for all the entries of a table
+ * with FMRTSTRING key whose key starts with a given prefix,
+ * and provides them in ascending order through a callback
+ * function. It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - prefix
+ *   the prefix to look for (an empty string matches all
+ *   the keys)
+ * - limit
+ *   maximum number of matching keys to be provided (0 means
+ *   no limit)
+ * - sink
+ *   callback function invoked for each matching key, with
+ *   the key and userData as parameters. If it returns a
+ *   non-zero value the scan is stopped. If NULL the call
+ *   only counts the matching keys. Please observe that the
+ *   callback is invoked while the table is locked, therefore
+ *   it shall not invoke library calls on the same table
+ * - userData
+ *   opaque pointer passed as it is to the callback
+ * - count
+ *   pointer to a variable filled with the number of matching
+ *   keys provided to the callback (or counted, if sink is
+ *   NULL). It can be NULL if not needed
+ * The subtrees that cannot contain matching keys are never
+ * visited, therefore complexity is O(log(n)+matches)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Scan completed (even if no keys have been found)
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when prefix is NULL or when
+ *   the key type of the table is not FMRTSTRING
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ ***********************************************************/
+fmrtResult fmrtPrefixScan (fmrtId tableId, char *prefix, fmrtIndex limit, fmrtKeySink sink, void *userData, fmrtIndex *count)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+    fmrtIndex   matches = 0;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+        return (FMRTNOTSUPPORTED);
+
+    /* Prefix search is meaningful only for string keys */
+    if ( (prefix==NULL) || (Tables[i].key.type!=FMRTSTRING) )
+        return (FMRTKO);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLPREFIXSCAN);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Start the pruned in-order visit from the root node */
+    if (Tables[i].fmrtData!=NULL)
+        prefixScanRecurse (i, Tables[i].fmrtRoot, prefix, strlen(prefix), limit, sink, userData, &matches);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    if (count!=NULL)
+        *count = matches;
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineExpiry()
+ * ---------------------------------------------------------
+ * Enable per-entry expiry on a previously defined table.
+ * When enabled, each entry carries a deadline: entries whose
+ * deadline has been reached are removed from the table by a
+ * sweeper based on a timer wheel with 1 second resolution.
+ * The sweeper runs automatically at the beginning of every
+ * library call accessing the entries of the table (reads,
+ * writes, nearest key searches, scans, aggregates, counts
+ * and exports), so that expired entries are never visible,
+ * or explicitly through fmrtExpire(), and its cost depends
+ * on the number of expired entries, not on the table size.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - defaultTtl
+ *   time to live (in seconds) assigned to each new entry
+ *   when it is created. If 0, new entries never expire
+ *   unless a deadline is set through fmrtSetExpiry()
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 16 additional bytes
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Expiry successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when defaultTtl is negative
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine()) or it is frozen (see fmrtFreeze())
+ * - FMRTREDEFPROHIBITED
+ *   Expiry has been already enabled or the table already
+ *   contains data
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to allocate the timer wheel, or the
+ *   memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineExpiry (fmrtId tableId, time_t defaultTtl)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult   res;
+    int         k;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINEEXPIRY);
+
+    /* Expiry cannot be redefined, neither it can be defined once the table has been populated */
+    if ( (Tables[i].wheel!=NULL) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()), nor on frozen tables */
+    if ( (Tables[i].engine!=FMRTENGINEAVL) || (Tables[i].frozen) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
+
+    /* Fields shall be already defined and TTL shall not be negative */
+    if ( (Tables[i].numFields==0) || (defaultTtl<0) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Allocate timer wheel slots plus the list of expiring elements, all empty */
+    if (admitMemory (i, (FMRTWHEELSIZE+1)*sizeof(fmrtIndex))!=FMRTOK)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    Tables[i].wheel = (fmrtIndex *) malloc ((FMRTWHEELSIZE+1)*sizeof(fmrtIndex));
+    if (Tables[i].wheel==NULL)
+    {   /* Clear lock before exiting */
+        chargeMemory (i);
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    for (k=0; k<=FMRTWHEELSIZE; k++)
+        Tables[i].wheel[k] = FMRTNULLPTR;
+    chargeMemory (i);
+
+    /* Append per-node expiry information at the end of each element and update element size */
+    Tables[i].defaultTtl = defaultTtl;
+    Tables[i].lastSweep = time(NULL);
+    Tables[i].expDelta = FMRTALIGN (Tables[i].elemSize, FMRTMAXALIGN);
+    Tables[i].elemSize = Tables[i].expDelta + sizeof (fmrtNodeExpiry);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineExpiry() -> TableId: %d - Table[] index: %d - TTL: %ld\n",Tables[i].tableId,i,(long)defaultTtl);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtSetExpiry()
+ * ---------------------------------------------------------
+ * This library call is used to set the time to live of an
+ * existing entry of a table with expiry enabled (see
+ * fmrtDefineExpiry()). It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - ttl
+ *   new time to live of the entry in seconds, starting from
+ *   now. If 0, the entry never expires
+ * - key
+ *   contains the key value to be searched into the table.
+ *   It shall be of the same type defined by the
+ *   fmrtDefineKey() call
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The deadline of the entry has been updated
+ * - FMRTNOTFOUND
+ *   The entry with the given key is not present in the table
+ *   (or it has already expired)
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when expiry is not enabled
+ *   on the table or when ttl is negative
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ ***********************************************************/
+fmrtResult fmrtSetExpiry (fmrtId tableId, time_t ttl, ...)
+{
+    /* Local Variables */
+    va_list         args;
+    fmrtId          i;
+    fmrtResult      res;
+    fmrtKeyValue    key;
+    fmrtNodeTraversalStack *traversal;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLSETEXPIRY);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTFROZEN);
+    }
+
+    /* Expiry shall be enabled on the table */
+    if ( (Tables[i].wheel==NULL) || (ttl<0) )
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* Read the key and look for the element */
+    va_start (args,ttl);
+    readKeyArg (i, &args, &key);
+    va_end (args);
+    if ( (res=searchElem(i, key.keyInt, key.keySigned, key.keyDouble, key.keyChar, key.keyString, key.keyTimestamp, &traversal)) == FMRTOK)
+    {   /* Move the element to the wheel slot corresponding to the new deadline */
+        unlinkExpiry (i, traversal->index);
+        expiryOf(i, traversal->index)->deadline = (ttl>0) ? time(NULL)+ttl : 0;
+        linkExpiry (i, traversal->index);
+    }
+    clearNodeTraversalStack (traversal);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtExpire()
+ * ---------------------------------------------------------
+ * This library call runs the expiry sweeper on a table with
+ * expiry enabled (see fmrtDefineExpiry()), removing all the
+ * entries whose deadline has been reached. It can be used
+ * by applications that need to release space without
+ * waiting for the next write operation. It takes the
+ * following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - expired
+ *   pointer to a variable filled with the number of entries
+ *   removed. It can be NULL if not needed
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Sweep completed
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when expiry is not enabled
+ *   on the table
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze())
+ ***********************************************************/
+fmrtResult fmrtExpire (fmrtId tableId, fmrtIndex *expired)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+    fmrtIndex   num;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLEXPIRE);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTFROZEN);
+    }
+
+    /* Expiry shall be enabled on the table */
+    if (Tables[i].wheel==NULL)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    num = expireElems (i, time(NULL));
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    if (expired!=NULL)
+        *expired = num;
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineEviction()
+ * ---------------------------------------------------------
+ * Turn a previously defined table into a capacity-bounded
+ * cache. When eviction is enabled, inserting a new entry
+ * into a full table does not fail with FMRTOUTOFMEMORY:
+ * one of the existing entries is evicted instead, selected
+ * through the CLOCK algorithm (an approximation of LRU in
+ * which each entry keeps a reference flag, set on insert,
+ * read and modify). It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - separator
+ *   character used to separate key and fields in the line
+ *   passed to the callback (same format used by
+ *   fmrtExportTableCsv())
+ * - sink
+ *   callback invoked with each evicted entry before it is
+ *   removed (e.g. to write it back to a slower storage). It
+ *   is called with the table lock held, hence it shall not
+ *   invoke library calls on the same table. It can be NULL
+ * - userData
+ *   opaque pointer passed unchanged to the callback
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Each element takes 1 additional byte
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Eviction successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when fields have not been
+ *   defined yet
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTREDEFPROHIBITED
+ *   Eviction has been already enabled or the table already
+ *   contains data
+ ***********************************************************/
+fmrtResult fmrtDefineEviction (fmrtId tableId, char separator, fmrtEvictSink sink, void *userData)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINEEVICTION);
+
+    /* Eviction cannot be redefined, neither it can be enabled once the table has been populated */
+    if ( (Tables[i].evictMode) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
+
+    /* Fields shall be already defined */
+    if (Tables[i].numFields==0)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Append the reference flag at the end of each element and update element size */
+    Tables[i].evictMode = 1;
+    Tables[i].evictSep = separator;
+    Tables[i].evictSink = sink;
+    Tables[i].evictData = userData;
+    Tables[i].clockHand = 0;
+    Tables[i].refDelta = Tables[i].elemSize;
+    Tables[i].elemSize += sizeof (uint8_t);
+
+    /* The array of larger elements shall fit into the memory budget */
+    if (admitMemory (i, 0)!=FMRTOK)
+    {   /* Eviction is not enabled, clear lock before exiting */
+        Tables[i].elemSize = Tables[i].refDelta;
+        Tables[i].refDelta = 0;
+        Tables[i].evictMode = 0;
+        Tables[i].evictSink = NULL;
+        Tables[i].evictData = NULL;
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    chargeMemory (i);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineEviction() -> TableId: %d - Table[] index: %d\n",Tables[i].tableId,i);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtGetCacheStats()
+ * ---------------------------------------------------------
+ * This library call provides the cache statistics of a
+ * table, i.e. the number of successful and unsuccessful
+ * fmrtRead() calls and the number of entries evicted (see
+ * fmrtDefineEviction()) since the table was defined. Hits
+ * and misses are collected even when statistics are
+ * disabled, and they are cleared by fmrtResetStats(). It
+ * takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - hits, misses, evictions
+ *   pointers to the variables filled with the statistics.
+ *   Any of them can be NULL if not needed
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetCacheStats (fmrtId tableId, uint64_t *hits, uint64_t *misses, uint64_t *evictions)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLGETCACHESTATS);
+
+    if (hits!=NULL)
+        *hits = __atomic_load_n (&(Tables[i].hits), __ATOMIC_RELAXED);
+    if (misses!=NULL)
+        *misses = __atomic_load_n (&(Tables[i].misses), __ATOMIC_RELAXED);
+    if (evictions!=NULL)
+        *evictions = Tables[i].evictions;
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineLayout()
+ * ---------------------------------------------------------
+ * Select the memory layout used to store the elements of a
+ * previously defined table. With the default layout
+ * (FMRTLAYOUTUNIFIED) each element holds links, key and
+ * all fields in a single block, therefore on wide tables
+ * a tree descent reads several cache lines per level just
+ * to access links and key. With the split layout
+ * (FMRTLAYOUTSPLIT) links and key are kept in a compact
+ * index array, while fields are moved into a parallel
+ * payload array addressed by the same index, which is
+ * accessed only once the element has been found. Moreover,
+ * the size of the elements can be padded (FMRTLAYOUTPADDED)
+ * to the next power of 2 up to 64 bytes, or to a multiple
+ * of 64 bytes above, so that each element spans the
+ * minimum number of cache lines.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - layout
+ *   either FMRTLAYOUTUNIFIED or FMRTLAYOUTSPLIT, possibly
+ *   combined with FMRTLAYOUTPADDED (bitwise or)
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. The memory footprint is unchanged, unless
+ * FMRTLAYOUTPADDED is specified
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Layout successfully selected
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when layout is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The layout has been already selected or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineLayout (fmrtId tableId, uint8_t layout)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult   res;
+    uint16_t    elemSize,
+                aggDelta,
+                expDelta,
+                refDelta;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINELAYOUT);
+
+    /* The layout cannot be redefined, neither it can be changed once the table has been populated */
+    if ( (Tables[i].layout!=FMRTLAYOUTUNIFIED) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Fields shall be already defined and layout shall be valid */
+    if ( (Tables[i].numFields==0) || (layout & ~(FMRTLAYOUTSPLIT|FMRTLAYOUTPADDED)) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    elemSize = Tables[i].elemSize;
+    aggDelta = Tables[i].aggDelta;
+    expDelta = Tables[i].expDelta;
+    refDelta = Tables[i].refDelta;
+    if (layout & FMRTLAYOUTSPLIT)
+    {   /* Fields are moved out of the element: trailers appended so far (aggregates, */
+        /* expiry, eviction) follow the fields, hence they are moved back accordingly */
+        if (Tables[i].aggDelta)
+            Tables[i].aggDelta -= Tables[i].fieldsLen;
+        if (Tables[i].expDelta)
+            Tables[i].expDelta -= Tables[i].fieldsLen;
+        if (Tables[i].refDelta)
+            Tables[i].refDelta -= Tables[i].fieldsLen;
+        Tables[i].elemSize -= Tables[i].fieldsLen;
+    }
+    Tables[i].layout = layout;
+
+    /* The arrays of (padded) elements and of fields shall fit into the memory budget */
+    if (admitMemory (i, 0)!=FMRTOK)
+    {   /* Layout is not changed, clear lock before exiting */
+        Tables[i].elemSize = elemSize;
+        Tables[i].aggDelta = aggDelta;
+        Tables[i].expDelta = expDelta;
+        Tables[i].refDelta = refDelta;
+        Tables[i].layout = FMRTLAYOUTUNIFIED;
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    chargeMemory (i);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineLayout() -> TableId: %d - Table[] index: %d - Layout: %d\n",Tables[i].tableId,i,layout);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineStringHeap()
+ * ---------------------------------------------------------
+ * Enable out-of-line storage for the FMRTSTRING fields of a
+ * previously defined table. By default each string field
+ * takes its maximum length (plus the trailing 0) in every
+ * element, whatever the actual length of the stored value.
+ * When the string heap is enabled, string fields longer
+ * than 15 characters take a fixed 16 bytes slot in the
+ * element: shorter values are stored inline in the slot,
+ * longer values are stored in a per-table heap that grows
+ * on demand and is compacted when grown. The space of
+ * released strings is recovered at the next compaction
+ * (see also fmrtCompactStringHeap()). Write operations
+ * that cannot grow the heap fail with FMRTOUTOFMEMORY,
+ * leaving the element untouched.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * This call is OPTIONAL. It can be invoked after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   String heap successfully enabled
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when fields have not been
+ *   defined yet
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The string heap has been already enabled or the table
+ *   already contains data
+ ***********************************************************/
+fmrtResult fmrtDefineStringHeap (fmrtId tableId)
+{
+    /* Local Variables */
+    fmrtId      i;
+    uint16_t    shrink;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINESTRINGHEAP);
+
+    /* The string heap cannot be redefined, neither it can be enabled once the table has been populated */
+    if ( (Tables[i].stringHeap) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Fields shall be already defined */
+    if (Tables[i].numFields==0)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Recompute field offsets, long string fields are replaced by string slots */
+    shrink = Tables[i].fieldsLen;
+    Tables[i].stringHeap = 1;
+    layoutFields (i);
+    shrink -= Tables[i].fieldsLen;
+
+    /* With the default layout, trailers appended so far follow the fields and are moved back accordingly */
+    if (!(Tables[i].layout & FMRTLAYOUTSPLIT))
+    {
+        if (Tables[i].aggDelta)
+            Tables[i].aggDelta -= shrink;
+        if (Tables[i].expDelta)
+            Tables[i].expDelta -= shrink;
+        if (Tables[i].refDelta)
+            Tables[i].refDelta -= shrink;
+        Tables[i].elemSize -= shrink;
+    }
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineStringHeap() -> TableId: %d - Table[] index: %d - Saved: %d bytes per element\n",Tables[i].tableId,i,shrink);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtCompactStringHeap()
+ * ---------------------------------------------------------
+ * This library call compacts the string heap of a table
+ * (see fmrtDefineStringHeap()), recovering the space left
+ * by released strings and shrinking the heap to the size
+ * of the strings actually stored. It can be used after
+ * massive deletions or modifications.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The string heap has been compacted
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller or when the string heap is
+ *   not enabled on the table
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to allocate the compacted heap (the
+ *   table is left untouched)
+ ***********************************************************/
+fmrtResult fmrtCompactStringHeap (fmrtId tableId)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLCOMPACTSTRINGHEAP);
+
+    /* The string heap shall be enabled on the table */
+    if (!Tables[i].stringHeap)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    res = compactStringHeap (i, Tables[i].heapLive);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtFreeze()
+ * ---------------------------------------------------------
+ * Freeze a table, i.e. make it read-only and rewrite its
+ * elements in breadth first order (root first, then the
+ * nodes of the second level and so on). This is meant for
+ * tables that are loaded once (e.g. reference tables that
+ * are rebuilt periodically) and then only read: after many
+ * inserts and deletes the nodes are scattered randomly in
+ * memory, while in breadth first order the top levels of
+ * the tree, visited by every search, are packed together.
+ * While the table is frozen, all write operations (create,
+ * modify, delete, import, expiry) are rejected with
+ * FMRTFROZEN, until fmrtThaw() is invoked.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * During the operation memory is allocated for a second
+ * copy of the table, which is released before returning
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table is frozen
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine()) or it has expiry enabled (see
+ *   fmrtDefineExpiry()), as expired entries are removed
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to rewrite the table (the table is
+ *   left untouched and not frozen)
+ ***********************************************************/
+fmrtResult fmrtFreeze (fmrtId tableId)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+        return (FMRTNOTSUPPORTED);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLFREEZE);
+
+    /* Expiry removes elements from the table, therefore tables with expiry cannot be frozen */
+    if (Tables[i].wheel!=NULL)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
+
+    /* Rewrite the tree, unless already frozen */
+    if ( (!Tables[i].frozen) && ((res=relayoutTree(i,FMRTOPTIMIZED))==FMRTOK) )
+        Tables[i].frozen = 1;
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtFreeze() -> TableId: %d - Table[] index: %d - Result: %d\n",Tables[i].tableId,i,res);
+    #endif
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtThaw()
+ * ---------------------------------------------------------
+ * This library call makes a table frozen through
+ * fmrtFreeze() writable again. The layout of the elements
+ * is not changed, it is progressively lost as the table is
+ * modified.
+ * It takes just one input parameter:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table is writable
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtThaw (fmrtId tableId)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLTHAW);
+
+    Tables[i].frozen = 0;
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtCompact()
+ * ---------------------------------------------------------
+ * This library call defragments the array of elements of
+ * a table. After many deletes the elements still in use
+ * are scattered across the whole array and new elements
+ * are placed wherever a slot was freed, so that memory
+ * locality is lost and the memory of the array cannot be
+ * given back. The call moves all the elements to the
+ * beginning of the array, in the order given as second
+ * parameter, and releases the memory pages left unused to
+ * the operating system (they are allocated again only when
+ * the table grows again). The content of the table is not
+ * changed, there is no need for an export/import cycle.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - selectedOrder
+ *   it can assume the following values: FMRTASCENDING or
+ *   FMRTDESCENDING, to place the elements in key order
+ *   (best for range scans and exports), and FMRTOPTIMIZED
+ *   to place them in breadth first order, root first (best
+ *   for point lookups). If an unrecognized value is
+ *   specified, FMRTOPTIMIZED is assumed
+ * During the operation memory is allocated for a second
+ * copy of the table, which is released before returning
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The table has been compacted
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
+ * - FMRTFROZEN
+ *   The table is frozen (see fmrtFreeze()), i.e. already
+ *   compacted in breadth first order
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory to rewrite the table (the table is
+ *   left untouched)
+ ***********************************************************/
+fmrtResult fmrtCompact (fmrtId tableId, uint8_t selectedOrder)
+{
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+        return (FMRTNOTSUPPORTED);
+
+    if ( (selectedOrder!=FMRTASCENDING) && (selectedOrder!=FMRTDESCENDING) )
+        selectedOrder = FMRTOPTIMIZED;
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLCOMPACT);
+
+    /* Frozen tables cannot be modified (see fmrtFreeze()) */
+    if (Tables[i].frozen)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTFROZEN);
+    }
+
+    res = relayoutTree (i, selectedOrder);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtCompact() -> TableId: %d - Table[] index: %d - Result: %d\n",Tables[i].tableId,i,res);
+    #endif
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtDefineEngine()
+ * ---------------------------------------------------------
+ * Select the storage engine used to index the elements of
+ * a previously defined table. With the default engine
+ * (FMRTENGINEAVL) each element is a node of an AVL tree,
+ * therefore a lookup visits about 1.44*log2(n) elements,
+ * each one in a different cache line. With the B+-tree
+ * engine (FMRTENGINEBTREE) elements are indexed by a
+ * B+-tree whose nodes hold many keys packed together, so
+ * that a lookup visits only a few nodes and most of the
+ * comparisons are performed within the same cache lines.
+ * Leaves are linked together, hence exports and range
+ * exports are sequential scans. With the hash engine
+ * (FMRTENGINEHASH) elements are indexed by an open
+ * addressing hash table (Robin Hood hashing) sized for the
+ * max number of elements of the table, so that exact key
+ * lookups probe about one slot regardless of the size of
+ * the table, at the cost of ordered access: ascending,
+ * descending and range exports sort the elements at export
+ * time, while FMRTOPTIMIZED exports them unordered.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - engine
+ *   either FMRTENGINEAVL, FMRTENGINEBTREE or FMRTENGINEHASH
+ * - nodeSize
+ *   size in bytes of the nodes of the B+-tree (e.g. 64 or
+ *   256 to fit one or a few cache lines, 4096 to fit a
+ *   memory page), at least FMRTBTREEMINNODE (64 bytes, or
+ *   96 with 64 bit element indexes, so that each node holds
+ *   at least 2 keys). It is rounded down to a multiple of 8
+ *   and ignored by other engines
+ * This call is OPTIONAL. It can be invoked only once after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. B+-tree and hash engines support
+ * fmrtRead(), fmrtCreate(), fmrtModify(),
+ * fmrtCreateModify(), fmrtDelete(), fmrtCountEntries(),
+ * import/export of CSV files (FMRTOPTIMIZED exports in
+ * ascending order with the B+-tree) and range exports,
+ * with the split layout and the string heap. Aggregates,
+ * nearest key searches, prefix scans, expiry, eviction,
+ * fmrtFreeze() and fmrtCompact() are not supported and
+ * return FMRTNOTSUPPORTED
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Engine successfully selected
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet or when engine or nodeSize are not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The engine has been already selected or the table
+ *   already contains data
+ * - FMRTNOTSUPPORTED
+ *   Aggregates, expiry, eviction or a FMRTCOMPOSITE key
+ *   have been defined on the table, which are not supported
+ *   by the selected engine
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory for the B+-tree work area or for the
+ *   hash index, or the memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineEngine (fmrtId tableId, uint8_t engine, uint16_t nodeSize)
+{
+    /* Local Variables */
+    fmrtId      i;
+    uint16_t    fanout;
+    fmrtIndex   slots;
+    fmrtResult   res;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINEENGINE);
+
+    /* The engine cannot be redefined, neither it can be changed once the table has been populated */
+    if ( (Tables[i].engine!=FMRTENGINEAVL) || (Tables[i].fmrtData!=NULL) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Fields shall be already defined, engine and node size shall be valid */
+    if ( (Tables[i].numFields==0) || (engine>FMRTENGINEHASH) ||
+         ((engine==FMRTENGINEBTREE) && (nodeSize<FMRTBTREEMINNODE)) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    if (engine==FMRTENGINEAVL)
+    {   /* Nothing to do, this is the default engine */
+        unlockTable (i);
+        return (FMRTOK);
+    }
+
+    /* Aggregates, expiry and eviction rely on the AVL tree nodes, composite keys are not normalized */
+    if ( (Tables[i].aggField!=FMRTNOAGGREGATE) || (Tables[i].wheel!=NULL) || (Tables[i].evictMode) || (Tables[i].key.type==FMRTCOMPOSITE) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
+
+    if (engine==FMRTENGINEHASH)
+    {   /* The hash index has room for all the elements with a load factor up to 80% */
+        for (slots=FMRTHASHMINSLOTS; slots<Tables[i].tableMaxElem+Tables[i].tableMaxElem/4; slots<<=1);
+        if (admitMemory (i, (uint64_t)slots*sizeof(fmrtHashSlot))!=FMRTOK)
+        {   /* Clear lock before exiting */
+            unlockTable (i);
+            return (FMRTOUTOFMEMORY);
+        }
+        Tables[i].hashSlots = (fmrtHashSlot *) calloc (slots, sizeof(fmrtHashSlot));
+        if (Tables[i].hashSlots==NULL)
+        {   /* Clear lock before exiting */
+            chargeMemory (i);
+            unlockTable (i);
+            return (FMRTOUTOFMEMORY);
+        }
+        Tables[i].hashMask = slots-1;
+        Tables[i].engine = engine;
+        chargeMemory (i);
+
+        /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTOK);
+    }
+
+    /* Each node holds the header, up to fanout keys with the corresponding elements and up to */
+    /* fanout+1 children; the scratch area holds a full node plus the key which splits it      */
+    nodeSize &= ~(sizeof(uint64_t)-1);
+    fanout = (nodeSize-FMRTBTHEADER-sizeof(fmrtIndex)) / (sizeof(uint64_t)+2*sizeof(fmrtIndex));
+    if (admitMemory (i, (fanout+1)*(sizeof(uint64_t)+sizeof(fmrtIndex)) + (fanout+2)*sizeof(fmrtIndex))!=FMRTOK)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    Tables[i].btScratch = malloc ((fanout+1)*(sizeof(uint64_t)+sizeof(fmrtIndex)) + (fanout+2)*sizeof(fmrtIndex));
+    if (Tables[i].btScratch==NULL)
+    {   /* Clear lock before exiting */
+        chargeMemory (i);
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    Tables[i].btNodeSize = nodeSize;
+    Tables[i].btFanout = fanout;
+    Tables[i].engine = engine;
+    chargeMemory (i);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineEngine() -> TableId: %d - Table[] index: %d - Engine: %d - Fanout: %d\n",Tables[i].tableId,i,engine,fanout);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtDefineIndex()
+ * ---------------------------------------------------------
+ * Define a secondary index on a field of a previously
+ * defined table, so that entries can be looked up by the
+ * value of that field (see fmrtReadByIndex()) and exported
+ * in field order (see fmrtExportIndexRangeCsv()) in
+ * O(log(n)), rather than by scanning the whole table.
+ * Indexes are kept up to date by all write operations. Each
+ * index takes a node for each element of the table (about
+ * 32 bytes), allocated along with the index.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the field to be indexed (0 is the first
+ *   field specified in fmrtDefineFields())
+ * - unique
+ *   either FMRTINDEXUNIQUE, if two entries cannot share the
+ *   same value of the field, or FMRTINDEXNONUNIQUE. With
+ *   unique indexes, write operations that would duplicate
+ *   a value are rejected with FMRTDUPLICATEVALUE
+ * This call is OPTIONAL. It can be invoked up to
+ * MAXFMRTINDEXES times (once per field) after
+ * fmrtDefineFields() and before inserting the first element
+ * into the table. Indexes are supported by all the storage
+ * engines (see fmrtDefineEngine())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Index successfully defined
+ * - FMRTKO
+ *   Result obtained either when this is the first library
+ *   call invoked by the caller, when fields have not been
+ *   defined yet, when fieldIdx or unique are not valid or
+ *   when the max number of indexes has been reached
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTREDEFPROHIBITED
+ *   The field is already indexed or the table already
+ *   contains data
+ * - FMRTOUTOFMEMORY
+ *   Not enough memory for the nodes of the index, or the
+ *   memory budget would be exceeded
+ ***********************************************************/
+fmrtResult fmrtDefineIndex (fmrtId tableId, uint8_t fieldIdx, uint8_t unique)
+{
+    /* Local Variables */
+    fmrtId      i;
+    uint8_t     k;
+    fmrtResult   res;
+    fmrtSecondaryIndex  *index;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLDEFINEINDEX);
+
+    /* Indexes cannot be defined once the table has been populated, neither a field can be indexed twice */
+    if ( (Tables[i].fmrtData!=NULL) || (searchIndex(i,fieldIdx,&k)==FMRTOK) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTREDEFPROHIBITED);
+    }
+
+    /* Fields shall be already defined, field and unique flag shall be valid */
+    if ( (Tables[i].numFields==0) || (fieldIdx>=Tables[i].numFields) ||
+         (unique>FMRTINDEXUNIQUE) || (Tables[i].numIndexes==MAXFMRTINDEXES) )
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Nodes are allocated for all the elements, in an array parallel to the elements */
+    index = &(Tables[i].indexes[Tables[i].numIndexes]);
+    if (admitMemory (i, (uint64_t)Tables[i].tableMaxElem*sizeof(fmrtIndexNode))!=FMRTOK)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    index->nodes = (fmrtIndexNode *) calloc (Tables[i].tableMaxElem, sizeof(fmrtIndexNode));
+    if (index->nodes==NULL)
+    {   /* Clear lock before exiting */
+        chargeMemory (i);
+        unlockTable (i);
+        return (FMRTOUTOFMEMORY);
+    }
+    index->field = fieldIdx;
+    index->unique = unique;
+    index->root = FMRTNULLPTR;
+    Tables[i].numIndexes += 1;
+    chargeMemory (i);
+
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    #ifdef FMRTDEBUG
+    printf ("Inside fmrtDefineIndex() -> TableId: %d - Table[] index: %d - Field: %d - Unique: %d\n",Tables[i].tableId,i,fieldIdx,unique);
+    #endif
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtReadByIndex()
+ * ---------------------------------------------------------
+ * This library call is used to read an entry given the
+ * value of an indexed field (see fmrtDefineIndex()). It is
+ * a call with a variable number of arguments. The first
+ * three parameters (always present) are respectively:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the indexed field (0 is the first field
+ *   specified in fmrtDefineFields())
+ * - value
+ *   contains the value to be searched. It shall be of the
+ *   same type of the field (a string for timestamps when a
+ *   time format is defined)
+ * After those mandatory parameters, there is a pointer that
+ * is filled with the key of the entry found (a char buffer
+ * for string keys and for timestamps when a time format is
+ * defined), followed by the list of pointer parameters that
+ * are filled with the fields, exactly as in fmrtFloor().
+ * With non unique indexes, the first entry inserted with
+ * the given value is provided.
+ * Complexity is O(log(n)) (single descent from the root of
+ * the index)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   The entry has been found and corresponding parameters
+ *   extracted
+ * - FMRTNOTFOUND
+ *   There is no entry with the given value
+ * - FMRTKO
+ *   Result obtained when this is the first library
+ *   call invoked by the caller or when the field is not
+ *   indexed
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtReadByIndex (fmrtId tableId, uint8_t fieldIdx, ...)
+{
+    /* Local Variables */
+    va_list         args;
+    fmrtId          i;
+    uint8_t         k;
+    fmrtResult      res;
+    fmrtIndex       found;
+    fmrtKeyValue    value;
+    fmrtType        type;
+    char            *string;
+    uint64_t        nvalue;
+    void            *currentPtr;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLREADBYINDEX);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    if (searchIndex(i,fieldIdx,&k)!=FMRTOK)
+    {   /* Clear the lock before exiting */
+        unlockTable (i);
+        return (FMRTKO);
+    }
+
+    /* Read the value and look for the first element having it */
+    va_start (args, fieldIdx);
+    readValueArg (&(Tables[i].fields[fieldIdx]), &args, &value);
+    type = Tables[i].fields[fieldIdx].type;
+    string = (type==FMRTSTRING) ? value.keyString : NULL;
+    nvalue = normalizeValue (type, valueMember(type,&value));
+    found = indexBound (i, k, nvalue, string, 0);
+    if ( (found==FMRTNULLPTR) || (indexCompare(i, k, nvalue, string, found)!=0) )
+    {   /* Clear the lock before exiting */
+        va_end (args);
+        unlockTable (i);
+        return (FMRTNOTFOUND);
+    }
+
+    /* Provide back key and fields of the element found */
+    currentPtr = Tables[i].fmrtData + found*Tables[i].elemSize;
+    extractKey (i, currentPtr, &args);
+    extractFields (i, currentPtr, &args);
+    va_end (args);
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtExportIndexRangeCsv()
+ * ---------------------------------------------------------
+ * This library call is the counterpart of
+ * fmrtExportRangeCsv() for indexed fields (see
+ * fmrtDefineIndex()): it exports in CSV format all the
+ * table entries whose value of the indexed field is in the
+ * range between a minimum and a maximum value (specified
+ * by the last two parameters), ordered by that field.
+ * It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - fieldIdx
+ *   position of the indexed field (0 is the first field
+ *   specified in fmrtDefineFields())
+ * - filePtr
+ *   pointer to a file opened by the caller in write/append
+ *   mode. The output will be written on that file. If NULL
+ *   output is written on stdout
+ * - separator
+ *   It is a char specified by the caller that is used to
+ *   separate fields into the output
+ * - selectedOrder
+ *   either FMRTASCENDING or FMRTDESCENDING, with respect to
+ *   the value of the field (entries sharing the same value
+ *   follow insertion order). If an unrecognized value is
+ *   specified, by default data will be exported assuming
+ *   FMRTASCENDING order.
+ * - valueMin
+ *   Minimum value of the field. It must be of the same type
+ *   of the field
+ * - valueMax
+ *   Maximum value of the field. It must be of the same type
+ *   of the field
+ * Please note that the file shall be opened before calling
+ * this function, otherwise a run-time error will occur.
+ * Similarly, the function call does not close the output
+ * file, which must be closed by the caller
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Export was successful
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, when the field is not indexed
+ *   or when valueMin is greater than valueMax
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtExportIndexRangeCsv (fmrtId tableId, uint8_t fieldIdx, FILE *filePtr, char separator, uint8_t selectedOrder, ...)
+{
+    /* Local Variables */
+    va_list         args;
+    fmrtId          i;
+    uint8_t         j,k;
+    fmrtResult      res;
+    fmrtIndex       node;
+    fmrtKeyValue    valueMin,
+                    valueMax;
+    fmrtType        type;
+    char            *stringMin,
+                    *stringMax,
+                    row[MAXFMRTROWLEN];
+    uint64_t        nvalueMin,
+                    nvalueMax;
+
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* The field shall be indexed */
+    if ( (fieldIdx>=Tables[i].numFields) || (searchIndex(i,fieldIdx,&k)!=FMRTOK) )
+        return (FMRTKO);
+
+    /* Parse Min and Max Value (depending on field type) */
+    va_start (args, selectedOrder);
+    readValueArg (&(Tables[i].fields[fieldIdx]), &args, &valueMin);
+    readValueArg (&(Tables[i].fields[fieldIdx]), &args, &valueMax);
+    va_end (args);
+    type = Tables[i].fields[fieldIdx].type;
+    stringMin = (type==FMRTSTRING) ? valueMin.keyString : NULL;
+    stringMax = (type==FMRTSTRING) ? valueMax.keyString : NULL;
+    nvalueMin = normalizeValue (type, valueMember(type,&valueMin));
+    nvalueMax = normalizeValue (type, valueMember(type,&valueMax));
+    if ( (nvalueMin>nvalueMax) || ((nvalueMin==nvalueMax) && (type==FMRTSTRING) && (strcmp(stringMin,stringMax)>0)) )
+        return (FMRTKO);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLEXPORTINDEXRANGECSV);
+
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
+
+    /* if file pointer is NULL, print output on stdout */
+    if (filePtr==NULL)
+        filePtr = stdout;
+
+    fprintf (filePtr, "#Table: %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
+    fprintf (filePtr, "#");
+    printKeyNames (i, filePtr, separator);
+    for (j=0; j<Tables[i].numFields; j++)
+        fprintf (filePtr, "%c%s", separator, Tables[i].fields[j].name);
+    fprintf (filePtr,"\n");
+
+    /* Walk the index from one end of the range up to the other one */
+    if (selectedOrder==FMRTDESCENDING)
+    {
+        for (node = indexBound (i, k, nvalueMax, stringMax, 1);
+             (node!=FMRTNULLPTR) && (indexCompare(i, k, nvalueMin, stringMin, node)<=0);
+             node = indexStep (i, k, node, LEFT))
+        {
+            formatElem (i, Tables[i].fmrtData + node*Tables[i].elemSize, separator, row, MAXFMRTROWLEN);
+            fprintf (filePtr, "%s\n", row);
+        }
+    }
+    else
+    {
+        for (node = indexBound (i, k, nvalueMin, stringMin, 0);
+             (node!=FMRTNULLPTR) && (indexCompare(i, k, nvalueMax, stringMax, node)>=0);
+             node = indexStep (i, k, node, RIGHT))
+        {
+            formatElem (i, Tables[i].fmrtData + node*Tables[i].elemSize, separator, row, MAXFMRTROWLEN);
+            fprintf (filePtr, "%s\n", row);
+        }
+    }
+
+    /* Clear the lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
+}
+
+
+/***********************************************************
+ * fmrtEnableStats()
+ * ---------------------------------------------------------
+ * Switch on or off the collection of the statistics
+ * provided by fmrtGetStats() for all the tables. Collection
+ * is disabled by default; when disabled, the cost on the
+ * library calls is limited to a test of a global flag. The
+ * statistics shards of a table are allocated only once
+ * collection is switched on (when the table is defined, if
+ * collection is already on), and they are charged against
+ * the memory budget (see fmrtSetMemoryBudget()). It takes
+ * the following parameter:
+ * - enable
+ *   1 to start collecting statistics, 0 to stop. Statistics
+ *   already collected are kept (see fmrtResetStats())
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Collection switched on or off
+ * - FMRTOUTOFMEMORY
+ *   Collection switched on, but the statistics shards of
+ *   some tables could not be allocated, their statistics
+ *   are not collected
+ ***********************************************************/
+fmrtResult fmrtEnableStats (uint8_t enable)
+{
+    /* Local Variables */
+    uint32_t    i;
+    fmrtResult  res = FMRTOK;
+
+    /* Set global lock, so that tables are not defined or cleared while their shards are allocated */
+    lockGlobal (FMRTCALLENABLESTATS);
+
+    fmrtStatsEnabled = (enable!=0);
+    for (i=nextTable(0); (i<MAXTABLES)&&(fmrtStatsEnabled); i=nextTable(i+1))
+    {
+        lockTable (i, FMRTCALLENABLESTATS);
+        if (allocStatsShards(i)!=FMRTOK)
+            res = FMRTOUTOFMEMORY;
+        unlockTable (i);
+    }
+
+    /* Remove global lock before exiting */
+    unlockGlobal ();
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtGetStats()
+ * ---------------------------------------------------------
+ * This library call provides the operation counters and
+ * the latency histograms of a table, collected while
+ * statistics are enabled (see fmrtEnableStats()) since the
+ * table was defined or since the last fmrtResetStats().
+ * Counters include reads (with hits and misses, which are
+ * collected even when statistics are disabled, see
+ * fmrtGetCacheStats()), created, modified and deleted
+ * entries (fmrtCreateModify() counts as a creation or as a
+ * modification depending on the key being new or not),
+ * creations failed for duplicate key,
+ * successful imports and exports, and calls failed with
+ * FMRTOUTOFMEMORY. Each operation class (FMRTSTATREAD ...
+ * FMRTSTATEXPORT) has a histogram of the latency of its
+ * calls, lock wait included: bucket b counts the calls
+ * lasting from 2^b to 2^(b+1)-1 ns (bucket 0 also counts
+ * 0 ns, the last bucket counts all longer calls).
+ * Statistics are kept in per-thread shards and summed on
+ * request. It takes the following parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - stats
+ *   pointer to the structure filled with the statistics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ ***********************************************************/
+fmrtResult fmrtGetStats (fmrtId tableId, fmrtStats *stats)
+{
+    /* Local Variables */
+    fmrtId          i;
+    uint8_t         k,op,b;
+    fmrtResult      res;
+    fmrtStatsShard  *shards;
+    fmrtStats       *shard;
 
-        clearNodeTraversalStack (traversal);
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
 
-    }   /* while (fgets (inputString)... */
+    /* Hits and misses are the cache statistics of the table (see fmrtGetCacheStats()) */
+    memset (stats, 0, sizeof(fmrtStats));
+    stats->hits = __atomic_load_n (&(Tables[i].hits), __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n (&(Tables[i].misses), __ATOMIC_RELAXED);
 
-    /* Release memory allocated for row, clear the lock and exit */
-    free (Tables[i].row);
-    Tables[i].row=NULL;
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+    /* Sum all the shards, which are updated without holding the table lock */
+    shards = __atomic_load_n (&(Tables[i].stats), __ATOMIC_ACQUIRE);
+    for (k=0; (k<FMRTSTATSHARDS)&&(shards!=NULL); k++)
+    {
+        shard = &(shards[k].stats);
+        stats->reads += __atomic_load_n (&(shard->reads), __ATOMIC_RELAXED);
+        stats->creates += __atomic_load_n (&(shard->creates), __ATOMIC_RELAXED);
+        stats->duplicates += __atomic_load_n (&(shard->duplicates), __ATOMIC_RELAXED);
+        stats->modifies += __atomic_load_n (&(shard->modifies), __ATOMIC_RELAXED);
+        stats->deletes += __atomic_load_n (&(shard->deletes), __ATOMIC_RELAXED);
+        stats->imports += __atomic_load_n (&(shard->imports), __ATOMIC_RELAXED);
+        stats->exports += __atomic_load_n (&(shard->exports), __ATOMIC_RELAXED);
+        stats->outOfMemory += __atomic_load_n (&(shard->outOfMemory), __ATOMIC_RELAXED);
+        for (op=0; op<FMRTSTATCLASSES; op++)
+            for (b=0; b<FMRTSTATBUCKETS; b++)
+                stats->latency[op][b] += __atomic_load_n (&(shard->latency[op][b]), __ATOMIC_RELAXED);
+    }   /* for (k=0; k<FMRTSTATSHARDS; k++) */
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtExportTableCsv()
+ * fmrtResetStats()
  * ---------------------------------------------------------
- * This library call is used to export the content of the
- * given table into a specified file in CSV format.
- * It takes the following parameters:
+ * Clear the operation counters and the latency histograms
+ * of a table (see fmrtGetStats()). Operations completing
+ * while the statistics are cleared may be lost. It takes
+ * the following parameter:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
- * - filePtr
- *   pointer to a file opened by the caller in write/append
- *   mode. The output will be written on that file. If NULL
- *   output is written on stdout
- * - separator
- *   It is a char specified by the caller that is used to
- *   separate fields into the output
- * - selectedOrder
- *   it can assume the following values: FMRTASCENDING, to
- *   export data in ascending order with respect to the key,
- *   FMRTDESCENDING to use descending order, and
- *   FMRTOPTIMIZED to export data using an order optimized
- *   to speed up data reload through fmrtImportTableCsv().
- *   If an unrecognized value is specified, by default the
- *   call will export data assuming FMRTOPTIMIZED.
- * Please note that the file shall be opened before calling
- * this function, otherwise a run-time error will occur.
- * Similarly, the function call does not close the output
- * file, which must be closed by the caller
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   Export was successful
+ *   Statistics cleared
  * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
  * - FMRTIDNOTFOUND
  *   tableId is not defined
- * - FMRTOUTOFMEMORY
- *   There is not enough memory to allocate data structures
- *   needed to export the table in FMRTOPTIMIZED order
  ***********************************************************/
-fmrtResult fmrtExportTableCsv (fmrtId tableId, FILE *filePtr, char separator, uint8_t selectedOrder)
+fmrtResult fmrtResetStats (fmrtId tableId)
 {
     /* Local Variables */
-    uint8_t     i,j;
-    fmrtResult   res;
+    fmrtId          i;
+    fmrtResult      res;
+    fmrtStatsShard  *shards;
 
     /* Call searchTable() internal function to look for the given tableId */
     /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
     if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
         return (res);
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
-
-    /* if file pointer is NULL, print output on stdout */
-    if (filePtr==NULL)
-        filePtr = stdout;
-
-    fprintf (filePtr, "#Table: %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
-    fprintf (filePtr, "#%s", Tables[i].key.name);
-    for (j=0; j<Tables[i].numFields; j++)
-        fprintf (filePtr, "%c%s", separator, Tables[i].fields[j].name);
-    fprintf (filePtr,"\n");
-
-    /* Start recursion from root node */
-    res = FMRTOK;
-    if ( (selectedOrder==FMRTASCENDING) || (selectedOrder==FMRTDESCENDING) )
-        exportTableRecurse (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder);
-    else
-        res = exportTableOptimized (i, Tables[i].fmrtRoot, filePtr, separator);
-
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+    if ( (shards=__atomic_load_n(&(Tables[i].stats), __ATOMIC_ACQUIRE)) != NULL )
+        memset (shards, 0, FMRTSTATSHARDS*sizeof(fmrtStatsShard));
+    __atomic_store_n (&(Tables[i].hits), 0, __ATOMIC_RELAXED);
+    __atomic_store_n (&(Tables[i].misses), 0, __ATOMIC_RELAXED);
 
-    return (res);
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtExportRangeCsv()
+ * fmrtGetTreeInfo()
  * ---------------------------------------------------------
- * This library call is used to export a subset of the
- * content of the given table into a specified file in
- * CSV format. Specifically, the export contains all the
- * table entries in the range between a minimum and a maximum
- * key value (specified by the last two parameters).
+ * This library call provides diagnostics about the shape
+ * of the AVL tree of a table, useful to decide when the
+ * table shall be compacted or rebuilt (see fmrtCompact()).
+ * The tree is walked iteratively, holding the table lock,
+ * hence the call takes O(n) time. The following info are
+ * provided:
+ * - entries, height, average and maximum lookup depth
+ *   (number of nodes visited to find an existing key, the
+ *   root being at depth 1)
+ * - single and double rotations performed to rebalance the
+ *   tree after insertions and deletions, since the table
+ *   was defined
+ * - elements in the free list (released by deletions and
+ *   reused first), elements never used so far and capacity
+ *   of the table
+ * - fragmentation of the element array: avgGap is the
+ *   average distance (in elements) between nodes adjacent
+ *   in key order, fragmentation is the fraction of them
+ *   that are not stored in consecutive elements. Both are
+ *   minimal (1.0 and 0.0) after fmrtCompact() with
+ *   FMRTASCENDING order
  * It takes the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
- * - filePtr
- *   pointer to a file opened by the caller in write/append
- *   mode. The output will be written on that file. If NULL
- *   output is written on stdout
- * - separator
- *   It is a char specified by the caller that is used to
- *   separate fields into the output
- * - selectedOrder
- *   it can assume the following values: FMRTASCENDING, to
- *   export data in ascending order with respect to the key,
- *   FMRTDESCENDING to use descending order. Differently
- *   from fmrtExportTableCsv(), FMRTOPTIMIZED ordering is
- *   not supported for ranges. If an unrecognized value is
- *   specified, by default data will be exported assuming
- *   FMRTASCENDING order.
- * - keyMin
- *   Minimum value of the key. It must be of the same type
- *   specified at key definition (fmrtDefineKey() call).
- *   Library call behaviour is undefined if this condition
- *   is not satisfied
- * - keyMax
- *   Maximum value of the key. It must be of the same type
- *   specified at key definition (fmrtDefineKey() call).
- *   Library call behaviour is undefined if this condition
- *   is not satisfied
- * Please note that the file shall be opened before calling
- * this function, otherwise a run-time error will occur.
- * Similarly, the function call does not close the output
- * file, which must be closed by the caller
+ * - info
+ *   pointer to the structure filled with the diagnostics
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   Export was successful
+ *   Diagnostics provided
  * - FMRTKO
- *   Result obtained when this is the first library
- *   call invoked by the caller or when the keyMin parameter
- *   is greater than keyMax
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, or when the tree is corrupted
+ *   (i.e. higher than the maximum AVL tree height)
  * - FMRTIDNOTFOUND
  *   tableId is not defined
+ * - FMRTNOTSUPPORTED
+ *   The table does not use the AVL tree engine (see
+ *   fmrtDefineEngine())
  ***********************************************************/
-fmrtResult fmrtExportRangeCsv (fmrtId tableId, FILE *filePtr, char separator, uint8_t selectedOrder, ...)
+fmrtResult fmrtGetTreeInfo (fmrtId tableId, fmrtTreeInfo *info)
 {
     /* Local Variables */
-    va_list     args;
-    uint8_t     i,j,maxLen;
-    fmrtResult   res;
-    uint32_t    keyIntMin,
-                keyIntMax;
-    int32_t     keySignedMin,
-                keySignedMax;
-    double      keyDoubleMin,
-                keyDoubleMax;
-    time_t      keyTimestampMin,
-                keyTimestampMax;
-    char        keyCharMin,
-                keyCharMax,
-                keyStringMin[MAXFMRTSTRINGLEN+1],
-                keyStringMax[MAXFMRTSTRINGLEN+1],
-                *string;
+    fmrtId      i;
+    uint8_t     top,d,
+                depth[FMRTMAXHEIGHT];
+    fmrtIndex   node,prev,gap,scattered,
+                stack[FMRTMAXHEIGHT];
+    uint64_t    sumDepth,sumGap;
+    void        *currentPtr;
+    fmrtResult  res;
 
     /* Call searchTable() internal function to look for the given tableId */
     /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
     if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
         return (res);
 
-    /* Parse Min and Max key Value (depending on key type) */
-    va_start (args, selectedOrder);
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            keyIntMin = va_arg (args, uint32_t);
-            keyIntMax = va_arg (args, uint32_t);
-            if (keyIntMin>keyIntMax)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            keySignedMin = va_arg (args, int32_t);
-            keySignedMax = va_arg (args, int32_t);
-            if (keySignedMin>keySignedMax)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-        case FMRTDOUBLE:
-        {
-            keyDoubleMin = va_arg (args, double);
-            keyDoubleMax = va_arg (args, double);
-            if (keyDoubleMin>keyDoubleMax)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-        case FMRTCHAR:
-        {
-            keyCharMin = (unsigned char) va_arg (args,int);
-            keyCharMax = (unsigned char) va_arg (args,int);
-            if (keyCharMin>keyCharMax)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-        case FMRTSTRING:
-        {   /* Read the key and truncate to the maximum length specified during definition */
-            maxLen = Tables[i].key.len;     /* This field is max string length + trailing 0 */
-            string = va_arg (args,char*);
-            strncpy (keyStringMin,string,maxLen);
-            keyStringMin[maxLen-1] = '\0';
-            string = va_arg (args,char*);
-            strncpy (keyStringMax,string,maxLen);
-            keyStringMax[maxLen-1] = '\0';
-            if (strcmp(keyStringMin,keyStringMax)>0)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-        case FMRTTIMESTAMP:
-        {
-            if (fmrtTimeFormat[0]=='\0')
-            {
-                /* time format empty --> read raw timestamps from arguments */
-                keyTimestampMin = va_arg (args, time_t);
-                keyTimestampMax = va_arg (args, time_t);
-            }
-            else
-            {   /* convert strings read from arguments to raw timestamps according to fmrtTimeFormat */
-                struct tm   TimeFromString;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestampMin = mktime (&TimeFromString);
-                else
-                    keyTimestampMin = 0;
-                string = va_arg (args,char*);
-                if (strptime (string, fmrtTimeFormat, &TimeFromString) != NULL)
-                    keyTimestampMax = mktime (&TimeFromString);
-                else
-                    keyTimestampMax = 0;
-            }
-            if (keyTimestampMin>keyTimestampMax)
-            {
-                va_end (args);
-                return (FMRTKO);
-            }
-            break;
-        }
-    }   /* switch (Tables[i].key.type) */
-    va_end (args);
-
     /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    lockTable (i, FMRTCALLGETTREEINFO);
 
-    /* if file pointer is NULL, print output on stdout */
-    if (filePtr==NULL)
-        filePtr = stdout;
+    /* Expiry sweep - remove elements whose deadline has been reached, so that they are never visible */
+    expireElems (i, time(NULL));
 
-    fprintf (filePtr, "#Table: %s (Id: %d)\n",Tables[i].tableName, Tables[i].tableId);
-    fprintf (filePtr, "#%s", Tables[i].key.name);
-    for (j=0; j<Tables[i].numFields; j++)
-        fprintf (filePtr, "%c%s", separator, Tables[i].fields[j].name);
-    fprintf (filePtr,"\n");
+    /* Not available with storage engines other than the AVL tree (see fmrtDefineEngine()) */
+    if (Tables[i].engine!=FMRTENGINEAVL)
+    {   /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTNOTSUPPORTED);
+    }
 
-    /* Start exporting recursively from the root node (depending on key type) */
-    switch (Tables[i].key.type)
-    {
-        case FMRTINT:
-        {
-            exportRangeRecurseInt (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyIntMin, keyIntMax);
-            break;
-        }
-        case FMRTSIGNED:
-        {
-            exportRangeRecurseSigned (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keySignedMin, keySignedMax);
-            break;
-        }
-        case FMRTDOUBLE:
-        {
-            exportRangeRecurseDouble (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyDoubleMin, keyDoubleMax);
-            break;
-        }
-        case FMRTCHAR:
-        {
-            exportRangeRecurseChar (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyCharMin, keyCharMax);
-            break;
-        }
-        case FMRTSTRING:
+    memset (info, 0, sizeof(fmrtTreeInfo));
+    info->capacity = Tables[i].tableMaxElem;
+    info->insertSingleRotations = Tables[i].rotations[FMRTROTINSERT][0];
+    info->insertDoubleRotations = Tables[i].rotations[FMRTROTINSERT][1];
+    info->deleteSingleRotations = Tables[i].rotations[FMRTROTDELETE][0];
+    info->deleteDoubleRotations = Tables[i].rotations[FMRTROTDELETE][1];
+
+    /* Elements are never used until the array is allocated (see initEmptyList()) */
+    if (Tables[i].fmrtData==NULL)
+    {
+        info->unused = Tables[i].tableMaxElem;
+        /* Clear lock before exiting */
+        unlockTable (i);
+        return (FMRTOK);
+    }
+    info->unused = Tables[i].tableMaxElem - Tables[i].fmrtUnused;
+    for (node=Tables[i].fmrtFree; node!=FMRTNULLPTR; node=*((fmrtIndex *) (Tables[i].fmrtData + node*Tables[i].elemSize)))
+        info->freeList++;
+
+    /* In-order walk of the tree with an explicit stack of the nodes whose left subtree is being visited */
+    sumDepth = sumGap = 0;
+    scattered = 0;
+    prev = FMRTNULLPTR;
+    node = Tables[i].fmrtRoot;
+    top = 0;
+    d = 1;
+    while ( (node!=FMRTNULLPTR) || (top>0) )
+    {
+        /* Go down to the leftmost node of the current subtree */
+        while (node!=FMRTNULLPTR)
         {
-            exportRangeRecurseString (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyStringMin, keyStringMax);
-            break;
+            if (top==FMRTMAXHEIGHT)
+            {   /* Clear lock before exiting */
+                unlockTable (i);
+                return (FMRTKO);
+            }
+            stack[top] = node;
+            depth[top++] = d++;
+            node = *((fmrtIndex *) (Tables[i].fmrtData + node*Tables[i].elemSize));
         }
-        case FMRTTIMESTAMP:
+
+        /* Visit the node on top of the stack */
+        node = stack[--top];
+        d = depth[top];
+        info->entries++;
+        sumDepth += d;
+        if (d>info->maxDepth)
+            info->maxDepth = d;
+        if (prev!=FMRTNULLPTR)
         {
-            exportRangeRecurseTimestamp (i, Tables[i].fmrtRoot, filePtr, separator, selectedOrder, keyTimestampMin, keyTimestampMax);
-            break;
+            gap = (node>prev) ? node-prev : prev-node;
+            sumGap += gap;
+            scattered += (gap!=1);
         }
-    }   /* switch (Tables[i].key.type) */
-
+        prev = node;
+
+        /* Then go on with its right subtree */
+        currentPtr = Tables[i].fmrtData + node*Tables[i].elemSize;
+        node = *((fmrtIndex *) (currentPtr+sizeof(fmrtIndex)));
+        d++;
+    }   /* while ( (node!=FMRTNULLPTR) || (top>0) ) */
+
+    info->height = info->maxDepth;
+    if (info->entries>0)
+        info->avgDepth = (double) sumDepth / info->entries;
+    if (info->entries>1)
+    {
+        info->avgGap = (double) sumGap / (info->entries-1);
+        info->fragmentation = (double) scattered / (info->entries-1);
+    }
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+    /* Clear lock before exiting */
+    unlockTable (i);
 
     return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtCountEntries()
+ * fmrtEnableLockStats()
  * ---------------------------------------------------------
- * This library call is used to count the number of elements
- * stored into the table. It takes just one input parameter:
+ * Switch on or off the instrumentation of the locks of the
+ * library, i.e. the global lock used to define and clear
+ * tables and by the other calls listed in
+ * fmrtGetGlobalLockStats(), and the lock of each table. Instrumentation is
+ * disabled by default; when enabled, each acquisition is
+ * first attempted without blocking, in order to detect
+ * contention, and wait and hold times are measured, adding
+ * some overhead to every library call. Statistics are
+ * kept for each lock and for each library call acquiring
+ * it (see fmrtGetLockStats()). The statistics of a table
+ * lock are allocated only once instrumentation is switched
+ * on (when the table is defined, if it is already on), and
+ * they are charged against the memory budget (see
+ * fmrtSetMemoryBudget()). It takes the following parameter:
+ * - enable
+ *   1 to start the instrumentation, 0 to stop it.
+ *   Statistics already collected are kept
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Instrumentation switched on or off
+ * - FMRTOUTOFMEMORY
+ *   Instrumentation switched on, but the statistics of the
+ *   locks of some tables could not be allocated, their
+ *   locks are not instrumented
+ ***********************************************************/
+fmrtResult fmrtEnableLockStats (uint8_t enable)
+{
+    /* Local Variables */
+    uint32_t    i;
+    fmrtResult  res = FMRTOK;
+
+    /* Set global lock, so that tables are not defined or cleared while their lock statistics are allocated */
+    lockGlobal (FMRTCALLENABLESTATS);
+
+    fmrtLockStatsEnabled = (enable!=0);
+    for (i=nextTable(0); (i<MAXTABLES)&&(fmrtLockStatsEnabled); i=nextTable(i+1))
+    {
+        lockTable (i, FMRTCALLENABLESTATS);
+        if (allocLockStats(i)!=FMRTOK)
+            res = FMRTOUTOFMEMORY;
+        unlockTable (i);
+    }
+
+    /* Remove global lock before exiting */
+    unlockGlobal ();
+
+    return (res);
+}
+
+
+/***********************************************************
+ * fmrtGetLockStats()
+ * ---------------------------------------------------------
+ * This library call provides the statistics of the lock of
+ * a table, collected while lock instrumentation is enabled
+ * (see fmrtEnableLockStats()) since the table was defined:
+ * number of acquisitions, number of acquisitions finding
+ * the lock busy, total and maximum time spent waiting for
+ * the lock and holding it (in ns). It takes the following
+ * parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
+ * - call
+ *   the library call acquiring the lock (FMRTCALLREAD,
+ *   FMRTCALLEXPORTTABLECSV, ...), or FMRTCALLALL to sum the
+ *   statistics of all the calls (maximum times are the
+ *   maximum among all the calls)
+ * - stats
+ *   pointer to the structure filled with the statistics
  * ---------------------------------------------------------
- * It returns the number of elements contained into the
- * table or FMRTNULLPTR in case of any problem (e.g. tableId
- * not defined)
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller, or when call is not valid
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
  ***********************************************************/
-fmrtIndex fmrtCountEntries(fmrtId tableId)
+fmrtResult fmrtGetLockStats (fmrtId tableId, uint8_t call, fmrtLockStats *stats)
 {
-    /* Local variables */
-    uint8_t     i;
-    fmrtIndex    num;
-    fmrtResult   res;
+    /* Local Variables */
+    fmrtId          i;
+    fmrtResult      res;
+    fmrtLockStats   *lockStats;
 
     /* Call searchTable() internal function to look for the given tableId */
     /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
     if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (FMRTNULLPTR);
+        return (res);
 
-    /* Set Table specific lock */
-    pthread_mutex_lock(&(Tables[i].tableMtx));
+    /* The lock is not taken, so that statistics are available even while the lock is held for a long time */
+    if ( (lockStats=__atomic_load_n(&(Tables[i].lockStats), __ATOMIC_ACQUIRE)) == NULL )
+    {
+        if ( (call>=FMRTCALLS) && (call!=FMRTCALLALL) )
+            return (FMRTKO);
+        memset (stats, 0, sizeof(fmrtLockStats));
+        return (FMRTOK);
+    }
+    return (sumLockStats (lockStats, call, stats));
+}
 
-    /* countSubtreeNodes() counts the number of elements recursively, it might require too many iterations in case of large tables */
-    /* num = countSubtreeNodes (i, Tables[i].fmrtRoot); */
-    num = Tables[i].currentNumElem;
 
-    /* Clear the lock before exiting */
-    pthread_mutex_unlock(&(Tables[i].tableMtx));
+/***********************************************************
+ * fmrtGetGlobalLockStats()
+ * ---------------------------------------------------------
+ * This library call provides the statistics of the global
+ * lock, acquired by fmrtDefineTable(), fmrtClearTable(),
+ * fmrtGetTotalMemoryInfo(), fmrtEnableStats(),
+ * fmrtEnableLockStats() and fmrtDumpLockStats() (including
+ * the periodic dumps), in the same format of
+ * fmrtGetLockStats(). It takes the following parameters:
+ * - call
+ *   the library call acquiring the lock
+ *   (FMRTCALLDEFINETABLE, FMRTCALLCLEARTABLE,
+ *   FMRTCALLGETMEMORYINFO for fmrtGetTotalMemoryInfo(), or
+ *   FMRTCALLENABLESTATS for the calls enabling and dumping
+ *   statistics), or FMRTCALLALL to sum the statistics of
+ *   all of them
+ * - stats
+ *   pointer to the structure filled with the statistics
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics provided
+ * - FMRTKO
+ *   call is not valid
+ ***********************************************************/
+fmrtResult fmrtGetGlobalLockStats (uint8_t call, fmrtLockStats *stats)
+{
+    return (sumLockStats (fmrtGlobalLockStats, call, stats));
+}
 
-    return (num);
+
+/***********************************************************
+ * fmrtDumpLockStats()
+ * ---------------------------------------------------------
+ * This library call prints the lock statistics (see
+ * fmrtGetLockStats()) of the global lock and of all the
+ * defined tables to a file, in CSV format: a comment line
+ * with the current time, a header line and one line for
+ * each lock and library call that acquired it at least
+ * once, with the following columns: lock ("global" or
+ * the tableId), table name, library call, acquisitions,
+ * contended acquisitions, total and max wait time, total
+ * and max hold time (in ns). Statistics are printed right
+ * away and, if a period is given, periodically until
+ * this call is invoked again: the periodic dump is printed
+ * by a thread started by this call, so that no library
+ * call pays for it. The global lock is held while the
+ * statistics are printed. It takes the following
+ * parameters:
+ * - filePtr
+ *   the output file. It shall be opened before calling this
+ *   function and, with periodic dumps, it shall not be
+ *   closed until periodic dumps are stopped. NULL stops the
+ *   periodic dumps without printing anything
+ * - period
+ *   interval between dumps (in seconds), 0 for a single
+ *   dump
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Statistics printed and periodic dump (re)scheduled
+ * - FMRTKO
+ *   Statistics printed, but the thread printing the
+ *   periodic dump could not be started
+ ***********************************************************/
+fmrtResult fmrtDumpLockStats (FILE *filePtr, time_t period)
+{
+    /* Local Variables */
+    fmrtResult  res = FMRTOK;
+
+    /* Calls are serialized, so that only one of them stops and restarts the dump thread */
+    pthread_mutex_lock (&fmrtLockDumpCallMtx);
+
+    /* Stop periodic dumps first, waiting for the dump thread to terminate */
+    pthread_mutex_lock (&fmrtLockDumpMtx);
+    fmrtLockDumpPeriod = 0;
+    pthread_cond_signal (&fmrtLockDumpCond);
+    pthread_mutex_unlock (&fmrtLockDumpMtx);
+    if (fmrtLockDumpRunning)
+    {
+        pthread_join (fmrtLockDumpThread, NULL);
+        fmrtLockDumpRunning = 0;
+    }
+
+    /* Then print the statistics and possibly start the dump thread */
+    if (filePtr!=NULL)
+    {
+        dumpLockStats (filePtr);
+        if (period>0)
+        {
+            fmrtLockDumpFile = filePtr;
+            fmrtLockDumpPeriod = period;
+            if (pthread_create (&fmrtLockDumpThread, NULL, lockDumpThread, NULL) == 0)
+                fmrtLockDumpRunning = 1;
+            else
+            {
+                fmrtLockDumpPeriod = 0;
+                res = FMRTKO;
+            }
+        }
+    }
+
+    /* Clear lock before exiting */
+    pthread_mutex_unlock (&fmrtLockDumpCallMtx);
+
+    return (res);
 }
 
 
 /***********************************************************
- * fmrtGetMemoryFootPrint()
+ * fmrtGetMemoryInfo()
  * ---------------------------------------------------------
- * This library call provides the memory footprint of the
- * table whose tableId is given as a parameter.
- * It takes just one input parameter:
+ * This library call provides a detailed breakdown of the
+ * memory used by a table, for capacity planning:
+ * - allocated: bytes currently allocated for the table,
+ *   i.e. the sum of descriptor, elements, stringHeap,
+ *   engine, indexes, expiry and stats
+ * - resident: allocated bytes actually resident in RAM,
+ *   i.e. in pages touched so far and not swapped out
+ * - descriptor: bytes of the internal table descriptor
+ * - elements: bytes of the array of elements (0 until the
+ *   first insertion), which is split into live (elements
+ *   holding entries), freeList (elements released and
+ *   available for reuse) and unused (elements never used
+ *   so far, usually not resident)
+ * - padding: bytes of the elements lost to alignment (see
+ *   fmrtDefineLayout())
+ * - stringHeap, stringLive: size of the string heap and
+ *   bytes of the live strings it holds (see
+ *   fmrtDefineStringHeap())
+ * - engine: B+-tree nodes or hash slots (see
+ *   fmrtDefineEngine())
+ * - indexes: secondary indexes (see fmrtDefineIndex())
+ * - expiry: timer wheel (see fmrtDefineExpiry())
+ * - stats: statistics shards (see fmrtEnableStats())
+ * - transient: estimated peak of the temporary buffers
+ *   allocated by a single library call on the table in its
+ *   current state (traversal stack, export and import
+ *   buffers). They are not included in allocated
+ * - elemSize: bytes taken by each element
+ * It takes the following parameters:
  * - tableId
- *   unique identifier of the table between 0 and 255. The
+ *   unique identifier of the table between 0 and 65535. The
  *   table shall be defined first through fmrtDefineTable()
+ * - info
+ *   pointer to the structure filled with the information
  * ---------------------------------------------------------
- * It returns the number of bytes allocated for the given
- * table (0 in case of any problem, e.g. tableId not defined)
+ * Possible Return Values:
+ * - FMRTOK
+ *   Information provided
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
  ***********************************************************/
-long fmrtGetMemoryFootPrint(fmrtId tableId)
+fmrtResult fmrtGetMemoryInfo (fmrtId tableId, fmrtMemoryInfo *info)
 {
-    /* Local variables */
-    uint8_t     i;
-    long        bytes;
-    fmrtResult   res;
+    /* Local Variables */
+    fmrtId      i;
+    fmrtResult  res;
 
     /* Call searchTable() internal function to look for the given tableId */
     /* In case of error exit and report error to the calling program      */
-    /* To be completely safe, searchTable() shoud be called by locking    */
-    /* global mutex (fmrtGlobalMtx), but it is very unlikely that a thread */
-    /* tries to access a table which is still under definition, therefore */
-    /* we prefer to avoid bottlenecks                                     */
     if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
-        return (0);
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLGETMEMORYINFO);
 
-    bytes = sizeof(fmrtTableItem) + Tables[i].tableMaxElem*Tables[i].elemSize;
+    memoryInfo (i, info, 1);
 
-    return (bytes);
+    /* Clear lock before exiting */
+    unlockTable (i);
+
+    return (FMRTOK);
 }
 
 
 /***********************************************************
- * fmrtDefineTimeFormat()
+ * fmrtGetTotalMemoryInfo()
  * ---------------------------------------------------------
- * This library call allows to change time format
- * representation of FMRTTIMEFORMAT data handled by the
- * library.
- * Please observe that the library manages internally
- * timestamps using always the linux representation (i.e.
- * seconds from Epoch, Jan 1st 1970, 00:00:00 UTC), however
- * it allows changing the format used to display and enter
- * FMRTTIMEFORMAT data. When a format is specified, then
- * timestamp keys and fields in fmrtRead(), fmrtCreate(),
- * etc. must be defined as character strings with the
- * correct format (e.g. "Mon Jun 21 17:08:55 2021").
- * The library allows also the usage of raw time format; in
- * that case, timestamp keys and fields in fmrtXxxx()
- * routines must be defined as time_t data.
- * The call takes just one input parameter:
- * - fmrtFormat
- *   This is a string representing the desired time format,
- *   according to the same convention specified by strftime()
- *   man page (e.g. "%c" for full date and time, "%T" for
- *   time in HH:MM:YY format, "%F" for date in the format
- *   YYYY-MM-DD, etc.).
- *   In case the parameter is either NULL or an empty
- *   string, then time format is set to raw (i.e. timestamps
- *   are represented as raw time_t data)
- * This routine is OPTIONAL. If not called, default time
- * format will be set to "%c", i.e. current locale.
- * The routine can be called as many times as desired. This
- * will not affect internal data representation, but only
- * data management and display (e.g. the format of timestamp
- * data in CSV output files).
- * Finally, observe that timestamp format is GLOBAL, i.e.
- * it is a configuration that affects all tables
+ * This library call provides the memory used by all the
+ * tables defined, in the same format of fmrtGetMemoryInfo().
+ * Each item is the sum of the items of the tables, except
+ * elemSize, which is set to 0, and descriptor, which also
+ * accounts the map of the defined tables. It takes just
+ * one parameter:
+ * - info
+ *   pointer to the structure filled with the information
  * ---------------------------------------------------------
  * Possible Return Values:
  * - FMRTOK
- *   Time format correctly defined and set
- * - FMRTKO
- *   Time format not accepted (e.g. due to wrong fmrtFormat
- *   parameter)
+ *   Information provided
  ***********************************************************/
-fmrtResult fmrtDefineTimeFormat(char * fmrtFormat)
+fmrtResult fmrtGetTotalMemoryInfo (fmrtMemoryInfo *info)
 {
     /* Local Variables */
-    struct tm   TimeFromString;
-    time_t      now;
-    char        TimeDateString[MAXFMRTSTRINGLEN];
+    uint32_t        i;
+    fmrtMemoryInfo  table;
 
-    if ( (fmrtFormat==NULL) || (fmrtFormat[0]=='\0') )
-    {
-        fmrtTimeFormat[0] = '\0';
+    memset (info, 0, sizeof(fmrtMemoryInfo));
+    info->descriptor = info->allocated = info->resident = sizeof(fmrtTableMap);
+    if (!registryReady())
         return (FMRTOK);
-    }
 
-    /* Try to retrieve current time and to format it according to specified format */
-    /* This is done to understand if the specified format is correct               */
-    time (&now);
-    strftime(TimeDateString, MAXFMRTSTRINGLEN-1, fmrtFormat, localtime(&now));
-    if (strptime (TimeDateString, fmrtFormat, &TimeFromString) == NULL)
-        return (FMRTKO);
+    /* The global lock prevents tables from being defined or cleared meanwhile */
+    lockGlobal (FMRTCALLGETMEMORYINFO);
+    for (i=nextTable(0); i<MAXTABLES; i=nextTable(i+1))
+    {
+        lockTable (i, FMRTCALLGETMEMORYINFO);
+        memoryInfo (i, &table, 1);
+        unlockTable (i);
+
+        info->descriptor += table.descriptor;
+        info->allocated += table.allocated;
+        info->resident += table.resident;
+        info->elements += table.elements;
+        info->live += table.live;
+        info->freeList += table.freeList;
+        info->unused += table.unused;
+        info->padding += table.padding;
+        info->stringHeap += table.stringHeap;
+        info->stringLive += table.stringLive;
+        info->engine += table.engine;
+        info->indexes += table.indexes;
+        info->expiry += table.expiry;
+        info->stats += table.stats;
+        info->transient += table.transient;
+    }   /* for (i=nextTable(0); i<MAXTABLES; i=nextTable(i+1)) */
+
+    /* Clear lock before exiting */
+    unlockGlobal ();
 
-    strcpy (fmrtTimeFormat,fmrtFormat);
     return (FMRTOK);
+}
 
- }
+
+/***********************************************************
+ * fmrtSetMemoryBudget()
+ * ---------------------------------------------------------
+ * This library call sets a budget for the memory allocated
+ * by all the tables of the process, so that an oversized
+ * configuration is detected when tables are defined,
+ * rather than when they are filled. Each table is charged
+ * with the memory it allocates (see fmrtGetMemoryInfo(),
+ * descriptors excluded) or, if greater, with the memory
+ * reserved for it (see fmrtReserveMemory()); the array of
+ * elements, allocated at the first insertion, is charged
+ * since the table is defined, according to the element
+ * size defined so far. Calls that would exceed the budget
+ * fail with FMRTOUTOFMEMORY: fmrtDefineTable(),
+ * fmrtDefineFields(), fmrtDefineAggregate(),
+ * fmrtDefineEviction(), fmrtDefineLayout(),
+ * fmrtDefineEngine(), fmrtDefineIndex(),
+ * fmrtDefineExpiry(), fmrtReserveMemory() and insertions
+ * allocating the array of elements or growing the nodes of
+ * the B+-tree engine, as well as write operations growing
+ * the string heap (see fmrtDefineStringHeap()), which leave
+ * the element untouched. Temporary buffers allocated by
+ * the library calls are not charged. It takes just one
+ * parameter:
+ * - budget
+ *   max number of bytes, 0 to remove the budget (default)
+ * ---------------------------------------------------------
+ * Possible Return Values:
+ * - FMRTOK
+ *   Budget set
+ * - FMRTOUTOFMEMORY
+ *   The memory already charged to the tables exceeds the
+ *   budget, which is not changed
+ ***********************************************************/
+fmrtResult fmrtSetMemoryBudget (uint64_t budget)
+{
+    pthread_mutex_lock (&fmrtMemoryMtx);
+    if ( (budget>0) && (fmrtMemoryCommitted>budget) )
+    {
+        pthread_mutex_unlock (&fmrtMemoryMtx);
+        return (FMRTOUTOFMEMORY);
+    }
+    fmrtMemoryBudget = budget;
+    pthread_mutex_unlock (&fmrtMemoryMtx);
+
+    return (FMRTOK);
+}
 
 
 /***********************************************************
- * fmrtEncodeTimeStamp()
+ * fmrtReserveMemory()
  * ---------------------------------------------------------
- * This library call takes an input string representing
- * a time stamp and provides back the corresponding value
- * encoded as a time_t (Linux time). The input string shall
- * be formatted according to the timestamp format defined
- * through fmrtDefineTimeFormat()
+ * This library call reserves part of the memory budget (see
+ * fmrtSetMemoryBudget()) for a table, which is charged with
+ * the memory reserved until it allocates more than that.
+ * Therefore the table can grow up to its reservation (e.g.
+ * B+-tree nodes, string heap) even when the other tables
+ * have exhausted the budget. Reservations are accounted
+ * whether a budget is set or not. It takes the following
+ * parameters:
+ * - tableId
+ *   unique identifier of the table between 0 and 65535. The
+ *   table shall be defined first through fmrtDefineTable()
+ * - bytes
+ *   memory reserved for the table, 0 to cancel the
+ *   reservation
  * ---------------------------------------------------------
- * It provides the timestamp encoded as a time_t data or
- * 0 in case of errors
+ * Possible Return Values:
+ * - FMRTOK
+ *   Memory reserved
+ * - FMRTKO
+ *   Result obtained when this is the first library call
+ *   invoked by the caller
+ * - FMRTIDNOTFOUND
+ *   tableId is not defined
+ * - FMRTOUTOFMEMORY
+ *   The reservation would exceed the memory budget, the
+ *   previous reservation is kept
  ***********************************************************/
-time_t fmrtEncodeTimeStamp(char * timeStamp)
+fmrtResult fmrtReserveMemory (fmrtId tableId, uint64_t bytes)
 {
-    struct tm   TimeFromString;
+    /* Local Variables */
+    fmrtId      i;
+    uint64_t    previous;
+    fmrtResult  res;
 
-    if (strptime (timeStamp, fmrtTimeFormat, &TimeFromString) != NULL)
-        return ( mktime(&TimeFromString) );
-    else
-        return (0);
+    /* Call searchTable() internal function to look for the given tableId */
+    /* In case of error exit and report error to the calling program      */
+    if ( ((res=searchTable(tableId,&i))!=FMRTOK) )
+        return (res);
+
+    /* Set Table specific lock */
+    lockTable (i, FMRTCALLRESERVEMEMORY);
+
+    /* The previous reservation is restored if the new one does not fit into the budget */
+    previous = Tables[i].memReserved;
+    Tables[i].memReserved = bytes;
+    if ( (res=admitMemory(i,0))!=FMRTOK )
+        Tables[i].memReserved = previous;
+
+    /* Clear lock before exiting */
+    unlockTable (i);
 
+    return (res);
 }
 
 
 /***********************************************************
- * fmrtDecodeTimeStamp()
+ * fmrtGetMemoryBudget()
  * ---------------------------------------------------------
- * This library call takes a raw time stamp (i.e. a time_t
- * data) as first parameter and provides back in the second
- * parameter a string formatted according to the timestamp
- * format defined through fmrtDefineTimeFormat().
- * The string must be allocated before calling this function
+ * This library call provides the memory budget (see
+ * fmrtSetMemoryBudget()) and the memory charged to all the
+ * tables against it. It takes the following parameters:
+ * - budget
+ *   pointer to the budget (0 if no budget is set)
+ * - committed
+ *   pointer to the memory charged to the tables
  * ---------------------------------------------------------
- * It does not return anything
+ * Possible Return Values:
+ * - FMRTOK
+ *   Values provided
  ***********************************************************/
-void fmrtDecodeTimeStamp(time_t rawTimeStamp, char * formattedTimeStamp)
+fmrtResult fmrtGetMemoryBudget (uint64_t *budget, uint64_t *committed)
 {
-    strftime(formattedTimeStamp, strlen(formattedTimeStamp), fmrtTimeFormat, localtime(&rawTimeStamp));
-    return ;
+    pthread_mutex_lock (&fmrtMemoryMtx);
+    *budget = fmrtMemoryBudget;
+    *committed = fmrtMemoryCommitted;
+    pthread_mutex_unlock (&fmrtMemoryMtx);
+
+    return (FMRTOK);
 }